@@ -30,8 +30,19 @@ CPP_GUARD_BEGIN
 
 int ADC_init(LoggerConfig *loggerConfig);
 
+/**
+ * Prepares the per channel filter stage.
+ * @param rate_hz The rate at which ADC_filter_all is invoked.
+ */
+void ADC_init_filters(LoggerConfig *loggerConfig, const unsigned int rate_hz);
+
 void ADC_sample_all(void);
 
+/**
+ * Runs the latest sample of each filtered channel through its filter.
+ */
+void ADC_filter_all(void);
+
 float ADC_read(const size_t channel);
 
 CPP_GUARD_END
@@ -59,6 +59,19 @@ float CAN_get_current_channel_value(int index);
  */
 void CAN_set_current_channel_value(int index, float value);
 
+/**
+ * Prepares the filter stage of the CAN channels that have one configured.
+ * @param cfg the CAN channel configuration
+ * @param rate_hz the rate at which CAN_sample_all is invoked
+ * @return true if the initialization was successful
+ */
+bool CAN_init_filters(CANChannelConfig *cfg, const unsigned int rate_hz);
+
+/**
+ * Runs the current value of each filtered CAN channel through its filter.
+ */
+void CAN_sample_all(void);
+
 /**
  * Apply the CAN message to the current list of of CAN channel mappings.
  * @param msg the CAN message containing the raw data
@@ -22,6 +22,7 @@
 #ifndef BASECOMMANDS_H_
 #define BASECOMMANDS_H_
 
+#include "capabilities.h"
 #include "command.h"
 #include "cpp_guard.h"
 #include "constants.h"
@@ -29,9 +30,22 @@
 
 CPP_GUARD_BEGIN
 
+#if TRACE_SUPPORT
+#define TRACE_COMMAND SYSTEM_COMMAND("trace", "Records task switches, " \
+                "queue, ISR and logger events for a timeline",          \
+                "<start [once]|stop|status|dump|save [file]>", Trace)
+#else
+#define TRACE_COMMAND
+#endif
+
 #define BASE_COMMANDS                                                   \
         SYSTEM_COMMAND("showTasks", "Show status of running tasks", "", \
                        ShowTaskInfo)                                    \
+        SYSTEM_COMMAND("showPerf", "Show task CPU, stack and queue use", \
+                       "", ShowPerf)                                    \
+        TRACE_COMMAND                                                   \
+        SYSTEM_COMMAND("showBoot", "Show boot phase timing and cached " \
+                       "device settings", "", ShowBoot)                 \
         SYSTEM_COMMAND("version", "Gets the version numbers", "",       \
                        GetVersion)                                      \
         SYSTEM_COMMAND("showStats", "Info on system statistics.","",    \
@@ -41,6 +55,9 @@ CPP_GUARD_BEGIN
 
 
 void ShowTaskInfo(struct Serial *serial, unsigned int argc, char **argv);
+void ShowPerf(struct Serial *serial, unsigned int argc, char **argv);
+void Trace(struct Serial *serial, unsigned int argc, char **argv);
+void ShowBoot(struct Serial *serial, unsigned int argc, char **argv);
 void GetVersion(struct Serial *serial, unsigned int argc, char **argv);
 void ShowStats(struct Serial *serial, unsigned int argc, char **argv);
 void ResetSystem(struct Serial *serial, unsigned int argc, char **argv);
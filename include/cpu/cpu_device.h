@@ -33,6 +33,21 @@ const char * cpu_device_get_serialnumber(void);
 
 void cpu_device_spin(uint32_t ms);
 
+/**
+ * Starts the free running core cycle counter.
+ */
+void cpu_device_cycle_counter_init(void);
+
+/**
+ * @return The raw core cycle count.  Wraps at 32 bits.
+ */
+uint32_t cpu_device_cycle_count(void);
+
+/**
+ * @return The rate in Hz at which the cycle count advances.
+ */
+uint32_t cpu_device_cycle_hz(void);
+
 CPP_GUARD_END
 
 #endif /* CPU_DEVICE_H_ */
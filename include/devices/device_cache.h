@@ -0,0 +1,92 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DEVICE_CACHE_H_
+#define _DEVICE_CACHE_H_
+
+#include "cpp_guard.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * What the device drivers last found to work, kept in flash with the
+ * logger config so the next boot can try it first instead of probing
+ * every baud rate and asking the modem what it is.  0 means unknown.
+ * This is not user configuration and is not exposed through the
+ * config API.
+ */
+enum device_cache_item {
+        /* Rate the GPS module comes up at before we configure it */
+        DEVICE_CACHE_GPS_BAUD,
+        DEVICE_CACHE_BT_BAUD,
+        /* Rate the WiFi module comes up at after a reset */
+        DEVICE_CACHE_WIFI_BAUD,
+        /* enum cellular_modem */
+        DEVICE_CACHE_CELL_MODEM,
+        DEVICE_CACHE_COUNT,
+};
+
+struct device_cache {
+        uint32_t values[DEVICE_CACHE_COUNT];
+};
+
+void device_cache_reset(struct device_cache *cache);
+
+uint32_t device_cache_get(const enum device_cache_item item);
+
+/**
+ * Updates a cached value and saves it if it changed.  Saves are
+ * coalesced: the config is flashed once the cache has been quiet for a
+ * few seconds, so drivers settling at boot cost a single flash.  The
+ * save is held back while logging, as flashing stalls the CPU, and while
+ * the working config has changes the user has not saved, as those would
+ * be saved with it.  The value is then saved along with the next config
+ * save.
+ * @param item The value to update.
+ * @param value The new value.
+ */
+void device_cache_set(const enum device_cache_item item,
+                      const uint32_t value);
+
+/**
+ * Builds the order to probe a device's baud rates in: the cached rate
+ * first, then the given rates, skipping repeats.
+ * @param item The cached baud rate.
+ * @param bauds The rates to try after the cached one.
+ * @param count The number of rates in bauds.
+ * @param order Filled with the rates to try.  Must hold count + 1.
+ * @return The number of rates in order.
+ */
+size_t device_cache_probe_order(const enum device_cache_item item,
+                                const int bauds[], const size_t count,
+                                int order[]);
+
+/**
+ * @return The API name of a cached value.
+ */
+const char* device_cache_name(const enum device_cache_item item);
+
+CPP_GUARD_END
+
+#endif /* _DEVICE_CACHE_H_ */
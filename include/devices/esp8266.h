@@ -216,7 +216,12 @@ bool esp8266_server_cmd(const enum esp8266_server_action action, int port,
 bool esp8266_set_uart_config_raw(const size_t baud, const size_t bits,
                                  const size_t parity, const size_t stop_bits);
 
-bool esp8266_probe_device(struct Serial* serial, const int fast_baud);
+/**
+ * Looks for the device at each of the given baud rates in turn.
+ * @return The baud rate it answered at, 0 if it did not answer.
+ */
+int esp8266_probe_device(struct Serial* serial, const int bauds[],
+                         const size_t count);
 
 bool esp8266_wait_for_ready(struct Serial* serial);
 
@@ -0,0 +1,97 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SKYTRAQ_FRAME_H_
+#define _SKYTRAQ_FRAME_H_
+
+#include "cpp_guard.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Streaming parser for SkyTraq binary frames:
+ *
+ *   0xA0 0xA1 <len hi> <len lo> <payload...> <xor checksum> 0x0D 0x0A
+ *
+ * Bytes are fed in blocks of any size.  The parser scans for the start
+ * of a frame with memchr and copies payload runs in a single pass that
+ * also folds in the checksum, so the bulk of a frame never goes through
+ * the per byte state machine.
+ */
+
+#define SKYTRAQ_FRAME_SYNC1	0xA0
+#define SKYTRAQ_FRAME_SYNC2	0xA1
+
+enum skytraq_frame_result {
+        SKYTRAQ_FRAME_NONE = 0,
+        SKYTRAQ_FRAME_READY,
+        SKYTRAQ_FRAME_ERROR,
+};
+
+struct skytraq_frame_parser {
+        uint8_t *payload;
+        uint16_t payload_size;
+        uint16_t len;
+        uint16_t pos;
+        uint8_t state;
+        uint8_t checksum;
+        /* Running counters, useful for diagnostics */
+        uint32_t frames;
+        uint32_t errors;
+};
+
+/**
+ * Initializes a parser.
+ * @param p The parser.
+ * @param payload The buffer that receives frame payloads.
+ * @param size The size of the payload buffer. Longer frames are errors.
+ */
+void skytraq_frame_init(struct skytraq_frame_parser *p, uint8_t *payload,
+                        const uint16_t size);
+
+/**
+ * Drops any partially parsed frame and goes back to scanning for sync.
+ */
+void skytraq_frame_reset(struct skytraq_frame_parser *p);
+
+/**
+ * Feeds a block of bytes to the parser.  Parsing stops as soon as a
+ * frame completes or fails so that the caller can act on it; the rest
+ * of the block must be fed again afterwards.
+ * @param p The parser.
+ * @param buf The bytes to parse.
+ * @param len The number of bytes in buf.
+ * @param consumed Set to the number of bytes of buf that were used.
+ * @return SKYTRAQ_FRAME_READY if a frame is available in the payload
+ * buffer (its length is in p->len), SKYTRAQ_FRAME_ERROR if a frame was
+ * malformed, SKYTRAQ_FRAME_NONE if all bytes were used without either.
+ */
+enum skytraq_frame_result skytraq_frame_parse(struct skytraq_frame_parser *p,
+                                              const uint8_t *buf,
+                                              const size_t len,
+                                              size_t *consumed);
+
+CPP_GUARD_END
+
+#endif /* _SKYTRAQ_FRAME_H_ */
@@ -23,13 +23,14 @@
 #define _FILTER_H_
 
 #include "cpp_guard.h"
+#include <stdbool.h>
 #include <stdint.h>
 
 CPP_GUARD_BEGIN
 
 typedef struct _Filter {
         float alpha;
-        int32_t total;
+        int64_t total;
         int32_t current_value;
         int32_t count;
         int32_t max_samples;
@@ -39,6 +40,85 @@ void init_filter(Filter *filter, float alpha);
 
 int32_t update_filter(Filter *filter, int32_t value);
 
+/*
+ * Configurable per-channel filter stage.  The kernels are fixed point
+ * and are run at the acquisition rate, ahead of the decimation down to
+ * the rate a channel is logged at.
+ */
+enum channel_filter_type {
+        CHANNEL_FILTER_NONE,
+        CHANNEL_FILTER_EMA,
+        CHANNEL_FILTER_MOVING_AVERAGE,
+        CHANNEL_FILTER_MEDIAN,
+        CHANNEL_FILTER_BIQUAD_LOWPASS,
+        CHANNEL_FILTER_ENUM_COUNT,
+};
+
+/* Largest window of the moving average and median filters */
+#define CHANNEL_FILTER_MAX_SIZE         8
+#define CHANNEL_FILTER_PARAM_PRECISION  3
+/* Inputs beyond this magnitude are railed */
+#define CHANNEL_FILTER_INPUT_LIMIT      ((1 << 22) - 1)
+
+struct channel_filter_config {
+        /* one of enum channel_filter_type */
+        uint8_t type;
+        /* window size of the moving average and median filters */
+        uint8_t size;
+        /* alpha of the EMA filter, cutoff in Hz of the biquad filter */
+        float param;
+};
+
+struct channel_filter {
+        uint8_t type;
+        uint8_t size;
+        uint8_t count;
+        uint8_t index;
+        int32_t value;
+        union {
+                struct {
+                        int32_t alpha;
+                        int32_t state;
+                } ema;
+                struct {
+                        uint8_t shift;
+                        int32_t sum;
+                        int32_t window[CHANNEL_FILTER_MAX_SIZE];
+                } window;
+                struct {
+                        int32_t b0, b1, b2, a1, a2;
+                        int32_t x1, x2, y1, y2;
+                } biquad;
+        };
+};
+
+void channel_filter_reset_config(struct channel_filter_config *cfg);
+
+/**
+ * Rails a user supplied filter configuration to supported values: an EMA
+ * alpha within what the fixed point kernel can resolve and a moving
+ * average window rounded down to a power of two.
+ */
+void channel_filter_sanitize_config(struct channel_filter_config *cfg);
+
+/**
+ * Prepares the filter state. All floating point work happens here.
+ * @param f The filter state to initialize.
+ * @param cfg The filter configuration.
+ * @param rate_hz The rate, in Hz, at which the filter will be updated.
+ */
+void channel_filter_init(struct channel_filter *f,
+                         const struct channel_filter_config *cfg,
+                         const unsigned int rate_hz);
+
+/**
+ * Feeds a new sample through the filter.
+ * @return The filtered value.  Also available as f->value.
+ */
+int32_t channel_filter_update(struct channel_filter *f, const int32_t value);
+
+bool channel_filter_enabled(const struct channel_filter *f);
+
 CPP_GUARD_END
 
 #endif /* _FILTER_H_ */
@@ -43,13 +43,30 @@ struct GeoCircle gc_createGeoCircle(const GeoPoint gp, const float radius);
 /**
  * Tells us if the given point is within the bound of a given GeoCircle.  Note
  * that this is a circle only and not a sphere.  In otherwords elevation has
- * no effect on this calculation.
+ * no effect on this calculation.  Uses the active track frame, if any.
  * @param point The point in question
  * @param gc The GeoCircle object
  * @return true if it is in side the bounds, false otherwise.
  */
 bool gc_isPointInGeoCircle(const GeoPoint * point, const struct GeoCircle gc);
 
+/**
+ * Finds the part of the straight path from point a to point b that lies
+ * within a given GeoCircle.  Like #gc_isPointInGeoCircle this works on a
+ * flat projection and so is only meaningful over short distances.
+ * Positions along the path are given as a fraction from 0 (a) to 1 (b).
+ * @param a The start of the path.
+ * @param b The end of the path.
+ * @param gc The GeoCircle object
+ * @param enter Set to where the path enters the circle, or 0 if a is in it.
+ * @param leave Set to where the path leaves the circle, or 1 if b is in it.
+ * @return true if any part of the path is within the circle, false
+ * otherwise.
+ */
+bool gc_isSegmentInGeoCircle(const GeoPoint *a, const GeoPoint *b,
+                             const struct GeoCircle gc, float *enter,
+                             float *leave);
+
 /**
  * @return true if its a valid geoCircle, false otherwise.
  */
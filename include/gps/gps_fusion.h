@@ -0,0 +1,156 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GPS_FUSION_H_
+#define _GPS_FUSION_H_
+
+#include "channel_config.h"
+#include "cpp_guard.h"
+#include "dateTime.h"
+#include "geopoint.h"
+#include "gps.h"
+#include "jsmn.h"
+#include "serial.h"
+#include "track_frame.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Dead reckons position, speed and heading between GPS fixes from the
+ * longitudinal acceleration and yaw rate of the IMU, and blends each new
+ * fix back in with a fixed-gain complementary filter.  State is held in
+ * fixed point within a track_frame anchored at the first fix:
+ *
+ * position: cm east/north of the origin, Q10
+ * speed:    cm/s, Q10
+ * heading:  unit vector (east, north), Q14
+ * yaw bias: mdeg/s, learned from the course between fixes
+ */
+#define GPS_FUSION_POS_SHIFT	10
+#define GPS_FUSION_SPEED_SHIFT	10
+#define GPS_FUSION_HDG_SHIFT	14
+
+struct gps_fusion {
+        struct track_frame frame;
+        int64_t x;
+        int64_t y;
+        int32_t speed;
+        int32_t hdg_e;
+        int32_t hdg_n;
+        int32_t yaw_bias;
+        /* Heading at the last fix, for comparing against the course */
+        int32_t fix_hdg_e;
+        int32_t fix_hdg_n;
+        struct track_point fix_point;
+        millis_t fix_time;
+        bool initialized;
+        bool heading_valid;
+};
+
+struct gps_fusion_config {
+        ChannelConfig latitude;
+        ChannelConfig longitude;
+        ChannelConfig speed;
+        ChannelConfig heading;
+        /* Feed the fused position to the lap timer instead of raw fixes */
+        bool lap_timing;
+};
+
+#define DEFAULT_FUSION_LATITUDE_CONFIG {"FusedLat", "Degrees", -180, 180, SAMPLE_DISABLED, 6, 0}
+#define DEFAULT_FUSION_LONGITUDE_CONFIG {"FusedLon", "Degrees", -180, 180, SAMPLE_DISABLED, 6, 0}
+#define DEFAULT_FUSION_SPEED_CONFIG {"FusedSpeed", "", 0, 150, SAMPLE_DISABLED, 2, 0}
+#define DEFAULT_FUSION_HEADING_CONFIG {"Heading", "Degrees", 0, 360, SAMPLE_DISABLED, 1, 0}
+
+void gps_fusion_init(struct gps_fusion *f);
+
+/**
+ * Advances the estimate by one IMU sample.
+ * @param accel_g Longitudinal acceleration in G, positive forward.
+ * @param yaw_dps Yaw rate in degrees/sec, positive clockwise.
+ * @param dt_ms Time since the previous prediction.
+ */
+void gps_fusion_predict(struct gps_fusion *f, const float accel_g,
+                        const float yaw_dps, const uint32_t dt_ms);
+
+/**
+ * Blends a new GPS fix into the estimate.  The first fix anchors the
+ * frame and seeds the state.
+ */
+void gps_fusion_correct(struct gps_fusion *f, const GpsSample *s);
+
+/**
+ * @return The fused position.
+ */
+GeoPoint gps_fusion_get_point(const struct gps_fusion *f);
+
+/**
+ * @return The fused speed in KPH.
+ */
+float gps_fusion_get_speed(const struct gps_fusion *f);
+
+/**
+ * @return The fused heading in degrees clockwise from north.
+ */
+float gps_fusion_get_heading(const struct gps_fusion *f);
+
+void gps_fusion_reset_config(struct gps_fusion_config *cfg);
+
+void gps_fusion_get_config(const struct gps_fusion_config *cfg,
+                           struct Serial *serial, const bool more);
+
+bool gps_fusion_set_config(struct gps_fusion_config *cfg,
+                           const jsmntok_t *json);
+
+/**
+ * @return true if the config needs the filter to run.
+ */
+bool gps_fusion_is_enabled(const struct gps_fusion_config *cfg);
+
+/**
+ * @return true if the lap timer is fed by the filter rather than by the
+ * GPS task.
+ */
+bool gps_fusion_drives_lap_timing(void);
+
+/**
+ * Resets the logger's filter and applies a new configuration.
+ */
+void gps_fusion_init_sampling(const struct gps_fusion_config *cfg);
+
+/**
+ * Runs the logger's filter at the background sample rate: picks up any
+ * new fix, advances the estimate with the current IMU readings and, when
+ * configured, hands the result to the lap timer.
+ */
+void gps_fusion_sample(void);
+
+float gps_fusion_get_latitude(void);
+float gps_fusion_get_longitude(void);
+float gps_fusion_get_speed_kph(void);
+float gps_fusion_get_speed_mph(void);
+float gps_fusion_get_heading_deg(void);
+
+CPP_GUARD_END
+
+#endif /* _GPS_FUSION_H_ */
@@ -0,0 +1,101 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TRACK_FRAME_H_
+#define _TRACK_FRAME_H_
+
+#include "cpp_guard.h"
+#include "geopoint.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * A local tangent plane anchored near the track.  Positions become
+ * integer centimeter offsets east (x) and north (y) of the origin using
+ * scale factors computed once, so distance comparisons need neither trig
+ * nor square roots.  Accuracy degrades with distance from the origin,
+ * which is fine for anything within a few km of a track.
+ */
+/* Bounds offsets to ~5000km so squared distances fit in 64 bits */
+#define TRACK_FRAME_MAX_CM	(1 << 29)
+
+struct track_frame {
+        GeoPoint origin;
+        float cm_per_deg_lat;
+        float cm_per_deg_lon;
+};
+
+struct track_point {
+        int32_t x;
+        int32_t y;
+};
+
+/**
+ * Sets up a frame with its origin at the given point.
+ */
+void track_frame_init(struct track_frame *f, const GeoPoint *origin);
+
+/**
+ * Converts a point to centimeter offsets within the frame.
+ */
+struct track_point track_frame_project(const struct track_frame *f,
+                                       const GeoPoint *p);
+
+/**
+ * Converts centimeter offsets within the frame back to a point.
+ */
+GeoPoint track_frame_unproject(const struct track_frame *f,
+                               const struct track_point *tp);
+
+/**
+ * @return The squared distance between two points in cm^2.
+ */
+int64_t track_point_dist_sq(const struct track_point *a,
+                            const struct track_point *b);
+
+/**
+ * @return The distance between two points in meters.
+ */
+float track_point_dist(const struct track_point *a,
+                       const struct track_point *b);
+
+/**
+ * Anchors the active frame, used by geo circle tests, at the given point.
+ * This is done whenever a track becomes active.
+ */
+void track_frame_set_active(const GeoPoint *origin);
+
+/**
+ * Clears the active frame, reverting geo circle tests to spherical math.
+ */
+void track_frame_clear_active(void);
+
+/**
+ * @return The active frame or NULL if none is set.
+ */
+const struct track_frame* track_frame_get_active(void);
+
+CPP_GUARD_END
+
+#endif /* _TRACK_FRAME_H_ */
@@ -48,6 +48,13 @@ typedef struct _TimeLoc {
         millis_t time;
 } TimeLoc;
 
+/**
+ * Creates the lock that serializes updates to the lap stats.  Call once
+ * before any task that touches them starts.
+ * @return true if successful.
+ */
+bool lapstats_init(void);
+
 void lapstats_config_changed(void);
 
 void lapstats_reset(bool reset_session_time);
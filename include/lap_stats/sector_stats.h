@@ -0,0 +1,113 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SECTOR_STATS_H_
+#define _SECTOR_STATS_H_
+
+#include "capabilities.h"
+#include "cpp_guard.h"
+#include "dateTime.h"
+#include "tracks.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Session statistics built up one sector at a time: the best time for
+ * each sector, how the current lap compares to them and the optimal lap
+ * that stitching the bests together would give.  Every update is O(1).
+ * A track without sectors is treated as having one sector, the lap.
+ */
+
+struct lap_history_entry {
+        int lap;
+        tiny_millis_t lap_time;
+        int sector_count;
+        tiny_millis_t sectors[SECTOR_COUNT];
+};
+
+void sector_stats_reset(void);
+
+/**
+ * Called when a lap starts.  Clears the deltas of the previous lap.
+ */
+void sector_stats_lap_started(const int lap);
+
+/**
+ * Called when a sector of the current lap is completed.
+ * @param sector The index of the sector, 0 being the first of the lap.
+ * @param time How long the sector took in millis.
+ */
+void sector_stats_sector_finished(const int sector, const tiny_millis_t time);
+
+/**
+ * Called when a lap is completed.  Adds it to the lap history.
+ */
+void sector_stats_lap_finished(const tiny_millis_t lap_time);
+
+/**
+ * @return The best time for the sector this session or 0 if there is none.
+ */
+tiny_millis_t sector_stats_best_sector(const int sector);
+
+/**
+ * @return How much slower (positive) or faster (negative) the sector was
+ * on the current lap than the best before it.  0 if there is nothing to
+ * compare.
+ */
+tiny_millis_t sector_stats_sector_delta(const int sector);
+
+/**
+ * @return The delta of the most recently completed sector.
+ */
+tiny_millis_t sector_stats_last_delta(void);
+
+float sector_stats_last_delta_seconds(void);
+
+/**
+ * @return The sum of the best sector times, or 0 until every sector of
+ * the lap has been timed.
+ */
+tiny_millis_t sector_stats_optimal_lap(void);
+
+float sector_stats_optimal_lap_minutes(void);
+
+/**
+ * @return The number of sectors in a lap, as seen on completed laps.
+ */
+int sector_stats_sector_count(void);
+
+/**
+ * @return The number of laps in the history.
+ */
+size_t sector_stats_history_size(void);
+
+/**
+ * @param index 0 for the most recent lap, up to #sector_stats_history_size.
+ * @return The lap or NULL if the index is out of range.
+ */
+const struct lap_history_entry* sector_stats_history_lap(const size_t index);
+
+CPP_GUARD_END
+
+#endif /* _SECTOR_STATS_H_ */
@@ -0,0 +1,80 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ANALOG_SCALING_H_
+#define _ANALOG_SCALING_H_
+
+#include "cpp_guard.h"
+#include "loggerConfig.h"
+
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+struct analog_scaling;
+
+typedef float analog_scale_func_t(const struct analog_scaling *s,
+                                  const float value);
+
+/*
+ * An analog channel's scaling resolved ahead of time.  The scaling
+ * mode is bound to a function and a scaling map is reduced to one
+ * slope/intercept pair per segment so that applying it never has to
+ * consult the config, branch on the mode or divide.
+ */
+struct analog_scaling {
+        analog_scale_func_t *scale;
+        /* SCALING_MODE_LINEAR */
+        float slope;
+        float offset;
+        /* SCALING_MODE_MAP: clamps, segment start points and slopes */
+        uint8_t bins;
+        float low;
+        float high;
+        float raw[ANALOG_SCALING_BINS];
+        float base[ANALOG_SCALING_BINS];
+        float seg_slope[ANALOG_SCALING_BINS - 1];
+};
+
+/**
+ * Resolves the scaling of an analog channel.  Must be called again
+ * whenever the channel's configuration changes.
+ * @param s The scaling to populate.
+ * @param cfg The analog channel configuration.
+ */
+void analog_scaling_compile(struct analog_scaling *s, const ADCConfig *cfg);
+
+/**
+ * Resolves a scaling map on its own, as if the channel were in
+ * SCALING_MODE_MAP.  The map ends at the first raw value that does
+ * not ascend; inputs beyond either end clamp to the end values.
+ */
+void analog_scaling_compile_map(struct analog_scaling *s,
+                                const ScalingMap *map);
+
+/**
+ * Applies a compiled scaling to a raw value.
+ */
+float analog_scaling_apply(const struct analog_scaling *s, const float value);
+
+CPP_GUARD_END
+
+#endif /* _ANALOG_SCALING_H_ */
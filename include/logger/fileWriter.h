@@ -30,7 +30,7 @@
 
 CPP_GUARD_BEGIN
 
-#define FILENAME_LEN 13
+#define FILENAME_LEN 24
 #define FLUSH_INTERVAL_MS 1000
 
 enum writing_status {
@@ -44,14 +44,82 @@ struct logging_status {
         unsigned int rows_written;
         enum writing_status writing_status;
         portTickType flush_tick;
+        /* Logger tick of the first row; time zero in the index */
+        size_t start_tick;
         portTickType last_sample_tick;
+        unsigned int synced_size;
         char name[FILENAME_LEN];
 };
 
+#define LOG_FILE_NAME_LEN	13
+
+struct log_file_info {
+        char name[LOG_FILE_NAME_LEN];
+        uint32_t size;
+        bool dir;
+};
 
 void startFileWriterTask( int priority );
 portBASE_TYPE queue_logfile_record(const LoggerMessage *msg);
 
+/*
+ * SD card access for other tasks.  Requests are queued behind pending
+ * samples and carried out by the file writer task, which owns the
+ * filesystem, so they are safe while logging.  While logging they wait
+ * until the writer has no samples left to write.  Callers block until
+ * done.
+ */
+
+/* Most a read returns while logging, so a sample never waits long */
+#define LOG_FILE_READ_LOGGING_MAX	512
+
+/**
+ * Lists a directory on the SD card.
+ * @param dir The directory, "" for the root.
+ * @param start Number of entries to skip, for paging through directories.
+ * @param count Set to the number of entries returned.
+ * @return 0 on success, a FatFs error code or -1 if the request could not
+ * be queued.
+ */
+int log_file_list(const char *dir, const size_t start,
+                  struct log_file_info *files, const size_t max,
+                  size_t *count);
+
+/**
+ * Reads part of a file on the SD card.  The log being written is cut
+ * off at the data last synced to the card.  While logging at most
+ * LOG_FILE_READ_LOGGING_MAX bytes are read.
+ * @param read Set to the number of bytes read, 0 at the end of the file.
+ * @param size Set to the size of the file.
+ * @return 0 on success, a FatFs error code or -1 if the request could not
+ * be queued.
+ */
+int log_file_read(const char *path, const uint32_t offset, void *buf,
+                  const size_t len, size_t *read, uint32_t *size);
+
+/**
+ * Sink a #log_file_producer_t writes the file through.
+ * @return false if the write failed.
+ */
+typedef bool log_file_sink_t(void *sink, const void *data, const size_t len);
+
+/**
+ * Produces the contents of a file written with #log_file_write.  Runs on
+ * the file writer task.
+ * @return false to abort.
+ */
+typedef bool log_file_producer_t(log_file_sink_t *write, void *sink,
+                                 void *arg);
+
+/**
+ * Creates or replaces a file on the SD card with what produce writes.
+ * Refused while logging, so as not to hold up the samples.
+ * @return 0 on success, a FatFs error code or -1 if the request could not
+ * be queued or produce failed.
+ */
+int log_file_write(const char *path, log_file_producer_t *produce,
+                   void *arg);
+
 CPP_GUARD_END
 
 #endif /* FILEWRITER_H_ */
@@ -0,0 +1,130 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LOG_INDEX_H_
+#define _LOG_INDEX_H_
+
+#include "cpp_guard.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Sidecar index written next to each log file (rc_N.idx for rc_N.log)
+ * so readers can seek to a time or lap without scanning the CSV.  The
+ * file is a log_index_header followed by log_index_entry records, all
+ * little endian.  Every entry points at the first byte of a data row.
+ */
+
+#define LOG_INDEX_MAGIC		"RCIX"
+#define LOG_INDEX_VERSION	1
+#define LOG_INDEX_INTERVAL_MS	1000
+#define LOG_INDEX_PENDING	16
+
+enum log_index_type {
+        LOG_INDEX_START = 1,
+        LOG_INDEX_STOP,
+        LOG_INDEX_TIME,
+        LOG_INDEX_LAP,
+        LOG_INDEX_SECTOR,
+};
+
+struct log_index_header {
+        char magic[4];
+        uint16_t version;
+        uint16_t interval_ms;
+} __attribute__((packed));
+
+struct log_index_entry {
+        /* Byte offset of the row in the log file */
+        uint32_t offset;
+        /* Millis since logging started */
+        uint32_t time;
+        uint16_t lap;
+        uint8_t sector;
+        uint8_t type;
+} __attribute__((packed));
+
+/*
+ * Entries are collected here until the file writer gets round to
+ * appending them to the index file.
+ */
+struct log_index {
+        uint32_t next_time;
+        /* Time, lap and sector of the last row */
+        uint32_t time;
+        int lap;
+        int sector;
+        size_t count;
+        bool overflow;
+        struct log_index_entry pending[LOG_INDEX_PENDING];
+};
+
+void log_index_init(struct log_index *li);
+
+void log_index_header(struct log_index_header *hdr);
+
+/**
+ * Queues an entry.
+ * @return false if the pending buffer is full and the entry was dropped.
+ */
+bool log_index_add(struct log_index *li, const enum log_index_type type,
+                   const uint32_t offset, const uint32_t time,
+                   const int lap, const int sector);
+
+/**
+ * Marks the start of logging at the first data row.  The lap and sector
+ * in progress become the baseline later rows are compared against.
+ */
+void log_index_start(struct log_index *li, const uint32_t offset,
+                     const int lap, const int sector);
+
+/**
+ * Called for every data row before it is written.  Queues a time entry
+ * every LOG_INDEX_INTERVAL_MS and a marker whenever a lap or sector
+ * starts.
+ */
+void log_index_row(struct log_index *li, const uint32_t offset,
+                   const uint32_t time, const int lap, const int sector);
+
+/**
+ * Marks the end of logging after the last row.
+ */
+void log_index_stop(struct log_index *li, const uint32_t offset);
+
+/**
+ * Drops pending entries for rows past offset, which never made it to
+ * the card.  The markers among them are queued again for the rows that
+ * replace them.
+ */
+void log_index_discard(struct log_index *li, const uint32_t offset);
+
+/**
+ * Clears the pending entries once they have been written out.
+ */
+void log_index_consumed(struct log_index *li);
+
+CPP_GUARD_END
+
+#endif /* _LOG_INDEX_H_ */
@@ -37,15 +37,20 @@ CPP_GUARD_BEGIN
 	API_METHOD("addTrackDb", api_addTrackDb)			\
 	API_METHOD("facReset", api_factoryReset)			\
 	API_METHOD("flashCfg", api_flashConfig)				\
+	API_METHOD("getBoot", api_get_boot)				\
 	API_METHOD("getCanCfg", api_getCanConfig)			\
 	API_METHOD("getCanChanCfg", api_get_can_channel_config) \
 	API_METHOD("setCanChanCfg", api_set_can_channel_config) \
+	API_METHOD("getMathCfg", api_get_math_channel_config) \
+	API_METHOD("setMathCfg", api_set_math_channel_config) \
 	API_METHOD("getCapabilities", api_getCapabilities)		\
 	API_METHOD("getConnCfg", api_getConnectivityConfig)		\
 	API_METHOD("getLapCfg", api_getLapConfig)			\
+	API_METHOD("getLapHist", api_get_lap_history)			\
 	API_METHOD("getLogfile", api_getLogfile)			\
 	API_METHOD("getMeta", api_getMeta)				\
 	API_METHOD("getObd2Cfg", api_getObd2Config)			\
+	API_METHOD("getPerf", api_get_perf)				\
 	API_METHOD("getStatus", api_getStatus)				\
 	API_METHOD("getTrackCfg", api_getTrackConfig)			\
 	API_METHOD("getTrackDb", api_getTrackDb)			\
@@ -61,6 +66,7 @@ CPP_GUARD_BEGIN
 	API_METHOD("setCanCfg", api_setCanConfig)			\
 	API_METHOD("setConnCfg", api_setConnectivityConfig)		\
 	API_METHOD("setLapCfg", api_setLapConfig)			\
+	API_METHOD("setRefLap", api_set_ref_lap)			\
  API_METHOD("resetLapStats", api_reset_lap_stats) \
 	API_METHOD("setLogfileLevel", api_setLogfileLevel)		\
 	API_METHOD("setObd2Cfg", api_setObd2Config)			\
@@ -73,6 +79,8 @@ CPP_GUARD_BEGIN
 #define GPS_API_METHODS                         \
     API_METHOD("getGpsCfg", api_getGpsConfig)   \
     API_METHOD("setGpsCfg", api_setGpsConfig)   \
+    API_METHOD("getFusionCfg", api_get_fusion_cfg)   \
+    API_METHOD("setFusionCfg", api_set_fusion_cfg)   \
 
 #else
 #define GPS_API_METHODS
@@ -81,6 +89,8 @@ CPP_GUARD_BEGIN
 #if SDCARD_SUPPORT
 #define AUTOLOGGING_METHODS                                     \
     API_METHOD("getSdLogCtrlCfg", api_get_auto_logger_cfg)     \
+    API_METHOD("getLogList", api_get_log_list)                 \
+    API_METHOD("readLog", api_read_log)                        \
     API_METHOD("setSdLogCtrlCfg", api_set_auto_logger_cfg)
 #else
 #define AUTOLOGGING_METHODS
@@ -179,21 +189,29 @@ int api_getConnectivityConfig(struct Serial *serial, const jsmntok_t *json);
 int api_setConnectivityConfig(struct Serial *serial, const jsmntok_t *json);
 int api_getGpsConfig(struct Serial *serial, const jsmntok_t *json);
 int api_setGpsConfig(struct Serial *serial, const jsmntok_t *json);
+int api_get_fusion_cfg(struct Serial *serial, const jsmntok_t *json);
+int api_set_fusion_cfg(struct Serial *serial, const jsmntok_t *json);
 int api_setLapConfig(struct Serial *serial, const jsmntok_t *json);
 int api_getLapConfig(struct Serial *serial, const jsmntok_t *json);
+int api_get_lap_history(struct Serial *serial, const jsmntok_t *json);
 int api_getTrackConfig(struct Serial *serial, const jsmntok_t *json);
 int api_setTrackConfig(struct Serial *serial, const jsmntok_t *json);
 int api_setLogfileLevel(struct Serial *serial, const jsmntok_t *json);
 int api_getLogfile(struct Serial *serial, const jsmntok_t *json);
 int api_getTrackDb(struct Serial *serial, const jsmntok_t *json);
 int api_addTrackDb(struct Serial *serial, const jsmntok_t *json);
+int api_set_ref_lap(struct Serial *serial, const jsmntok_t *json);
 int api_getObd2Config(struct Serial *serial, const jsmntok_t *json);
 int api_setObd2Config(struct Serial *serial, const jsmntok_t *json);
 int api_getCanConfig(struct Serial *serial, const jsmntok_t *json);
 int api_setCanConfig(struct Serial *serial, const jsmntok_t *json);
 int api_get_can_channel_config(struct Serial *serial, const jsmntok_t *json);
 int api_set_can_channel_config(struct Serial *serial, const jsmntok_t *json);
+int api_get_math_channel_config(struct Serial *serial, const jsmntok_t *json);
+int api_set_math_channel_config(struct Serial *serial, const jsmntok_t *json);
 int api_reset_lap_stats(struct Serial *serial, const jsmntok_t *json);
+int api_get_perf(struct Serial *serial, const jsmntok_t *json);
+int api_get_boot(struct Serial *serial, const jsmntok_t *json);
 
 /* Sensor channels */
 int api_getAnalogConfig(struct Serial *serial, const jsmntok_t *json);
@@ -232,6 +250,13 @@ int api_set_active_track(struct Serial *serial, const jsmntok_t *json);
 #if SDCARD_SUPPORT
 int api_get_auto_logger_cfg(struct Serial *serial, const jsmntok_t *json);
 int api_set_auto_logger_cfg(struct Serial *serial, const jsmntok_t *json);
+int api_get_log_list(struct Serial *serial, const jsmntok_t *json);
+
+/**
+ * Reads a chunk of a file off the SD card.  The reply is a JSON line
+ * describing the chunk followed by exactly "len" raw bytes, then CRLF.
+ */
+int api_read_log(struct Serial *serial, const jsmntok_t *json);
 #endif
 
 #if CAMERA_CONTROL
@@ -44,8 +44,9 @@ CPP_GUARD_BEGIN
         SYSTEM_COMMAND("startTerminal", "Starts a debugging terminal "  \
                        "session on the specified port.",                \
                        "<port> <baud> [echo 1|0]", StartTerminal)       \
-        SYSTEM_COMMAND("setLogLevel", "Sets the log level", "<level>",  \
-                       SetLogLevel)                                     \
+        SYSTEM_COMMAND("setLogLevel", "Sets the log level and "        \
+                       "optionally defers formatting until read",       \
+                       "<level> [deferred 1|0]", SetLogLevel)           \
         SYSTEM_COMMAND("viewLog", "Prints out logging messages to the " \
                        "terminal as they happen", "", ViewLog)          \
         SYSTEM_COMMAND("setSerialLog", "Enables/disables logging of  "  \
@@ -27,7 +27,11 @@
 #include "capabilities.h"
 #include "channel_config.h"
 #include "cpp_guard.h"
+#include "device_cache.h"
+#include "filter.h"
 #include "geopoint.h"
+#include "gps_fusion.h"
+#include "math_channel.h"
 #include "serial_device.h"
 #include "timer_config.h"
 #include "tracks.h"
@@ -130,6 +134,7 @@ typedef struct _ADCConfig {
         float calibration;
         unsigned char scalingMode;
         ScalingMap scalingMap;
+        struct channel_filter_config filter;
 } ADCConfig;
 
 #define DEFAULT_LINEAR_SCALING (1)
@@ -353,6 +358,8 @@ typedef struct _CANMapping {
 typedef struct _CANChannel {
         /* The standard channel configuration */
         CANMapping mapping;
+        /* Filter applied to the mapped value */
+        struct channel_filter_config filter;
 } CANChannel;
 
 typedef struct _CANChannelConfig {
@@ -431,6 +438,8 @@ typedef struct _LapConfig {
         ChannelConfig current_lap_cfg;
         ChannelConfig distance;
         ChannelConfig session_time_cfg;
+        ChannelConfig sector_delta_cfg;
+        ChannelConfig optimal_time_cfg;
 } LapConfig;
 
 #define DEFAULT_LAPSTATS_SAMPLE_RATE SAMPLE_10Hz
@@ -444,6 +453,8 @@ typedef struct _LapConfig {
 #define DEFAULT_CURRENT_LAP_CONFIG {"CurrentLap", "", 0, 0, DEFAULT_LAPSTATS_SAMPLE_RATE, 0, 0}
 #define DEFAULT_DISTANCE_CONFIG {"Distance", "mi", 0, 0, DEFAULT_LAPSTATS_SAMPLE_RATE, 3, 0}
 #define DEFAULT_SESSION_TIME_CONFIG {"SessionTime", "Min", 0, 0, DEFAULT_LAPSTATS_SAMPLE_RATE, 4, 0}
+#define DEFAULT_SECTOR_DELTA_CONFIG {"SectorDelta", "Sec", 0, 0, SAMPLE_5Hz, 3, 0}
+#define DEFAULT_OPTIMAL_TIME_CONFIG {"OptimalTime", "Min", 0, 0, SAMPLE_5Hz, 4, 0}
 
 #define DEFAULT_LAP_CONFIG {                                    \
                 DEFAULT_LAP_COUNT_CONFIG,                       \
@@ -454,7 +465,9 @@ typedef struct _LapConfig {
                         DEFAULT_ELAPSED_LAP_TIME_CONFIG,        \
                         DEFAULT_CURRENT_LAP_CONFIG,             \
                         DEFAULT_DISTANCE_CONFIG,                \
-                        DEFAULT_SESSION_TIME_CONFIG             \
+                        DEFAULT_SESSION_TIME_CONFIG,            \
+                        DEFAULT_SECTOR_DELTA_CONFIG,            \
+                        DEFAULT_OPTIMAL_TIME_CONFIG             \
                         }
 
 typedef struct _TrackConfig {
@@ -571,9 +584,17 @@ typedef struct _LoggerConfig {
         //OBD2 Config
         OBD2Config OBD2Configs;
 
+        //Math channel Config
+        struct math_channel_config math_channel_cfg;
+
         //GPS Configuration
         GPSConfig GPSConfigs;
 
+#if GPS_HARDWARE_SUPPORT
+        //GPS/IMU fusion Configuration
+        struct gps_fusion_config fusion_cfg;
+#endif
+
         //Lap Configuration
         LapConfig LapConfigs;
 
@@ -591,6 +612,9 @@ typedef struct _LoggerConfig {
 #if CAMERA_CONTROL
         struct camera_control_config camera_control_cfg;
 #endif
+        /* Not user configuration.  Keep it last; see device_cache_set */
+        struct device_cache device_cache;
+
         //Padding data to accommodate flash routine
         char padding_data[FLASH_PAGE_SIZE];
 } LoggerConfig;
@@ -631,12 +655,25 @@ void update_calculated_imu_channel_configs(void);
 uint8_t filter_can_bus_channel(uint8_t value);
 
 unsigned int getHighestSampleRate(LoggerConfig *config);
+
+/**
+ * @return The largest interval, in ticks, that every configured channel's
+ * sample interval is a multiple of, or SAMPLE_DISABLED if no channel is
+ * sampled.
+ */
+unsigned int getSampleRateGcd(LoggerConfig *config);
 size_t get_enabled_channel_count(LoggerConfig *loggerConfig);
 
 bool isHigherSampleRate(const int contender, const int champ);
 bool should_sample(const int sample_rate, const int max_rate);
 int getHigherSampleRate(const int a, const int b);
 
+/**
+ * @return The fastest rate that both a and b are a multiple of, that is
+ * the GCD of their sample intervals.  A disabled rate is ignored.
+ */
+int getCommonSampleRate(const int a, const int b);
+
 int flashLoggerConfig(void);
 void reset_logger_config(void);
 int flash_default_logger_config(void);
@@ -29,8 +29,22 @@
 
 CPP_GUARD_BEGIN
 
+/**
+ * Prepares the channel filters for the rate at which doFilterSampling
+ * will be invoked.
+ * @param config The logger configuration.
+ * @param filterRate The sample rate, in ticks, of the filter stage.
+ */
+void init_background_sampling(LoggerConfig *config, const int filterRate);
+
 void doBackgroundSampling();
 
+/**
+ * Steps the channel filters.  Runs at a fixed rate, independent of how
+ * often the inputs are refreshed, so the filters' time constants hold.
+ */
+void doFilterSampling();
+
 CPP_GUARD_END
 
 #endif /* LOGGERDATA_H_ */
@@ -0,0 +1,77 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MATH_CHANNEL_H_
+#define _MATH_CHANNEL_H_
+
+#include "capabilities.h"
+#include "channel_config.h"
+#include "cpp_guard.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+#define MATH_CHANNEL_EXPR_LENGTH        64
+
+struct sample;
+
+struct math_channel {
+        ChannelConfig cfg;
+        char expr[MATH_CHANNEL_EXPR_LENGTH];
+};
+
+struct math_channel_config {
+        struct math_channel channels[MATH_CHANNELS];
+        /* number of math channels set within configuration */
+        uint8_t enabled_channels;
+};
+
+void math_channel_reset_config(struct math_channel_config *cfg);
+
+/**
+ * Checks the syntax of an expression without resolving the channels
+ * it references.
+ * @return true if the expression compiles, false otherwise.
+ */
+bool math_channel_validate_expr(const char *expr);
+
+/**
+ * Compiles the expressions of all enabled math channels against the
+ * channels present in the sample.  A math channel may reference any
+ * non-math channel as well as any math channel that precedes it.
+ * Channels that fail to compile are logged and will read as 0.
+ * @param cfg The math channel configuration.
+ * @param s The sample whose channels the expressions may reference.
+ */
+void math_channel_compile_all(const struct math_channel_config *cfg,
+                              const struct sample *s);
+
+/**
+ * Evaluates the compiled expression of a math channel.  This is the
+ * sample getter for math channels.
+ */
+float math_channel_get_value(int id);
+
+CPP_GUARD_END
+
+#endif /* _MATH_CHANNEL_H_ */
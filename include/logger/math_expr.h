@@ -0,0 +1,103 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MATH_EXPR_H_
+#define _MATH_EXPR_H_
+
+#include "cpp_guard.h"
+#include "sampleRecord.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Limits of a compiled math expression.  These bound both the RAM
+ * used per program and the work done per evaluation.
+ */
+#define MATH_EXPR_MAX_CODE      48
+#define MATH_EXPR_MAX_CONSTS    6
+#define MATH_EXPR_MAX_INPUTS    6
+#define MATH_EXPR_STACK_SIZE    8
+#define MATH_EXPR_MAX_NESTING   16
+
+enum math_expr_status {
+        MATH_EXPR_OK,
+        MATH_EXPR_SYNTAX_ERROR,
+        MATH_EXPR_UNKNOWN_CHANNEL,
+        MATH_EXPR_UNKNOWN_FUNCTION,
+        MATH_EXPR_TOO_COMPLEX,
+};
+
+/*
+ * A compiled expression.  Inputs are copies of the getters of the
+ * channels referenced by the expression, so evaluating a program reads
+ * the current value of each input directly from its source.
+ */
+struct math_expr {
+        uint8_t code_len;
+        uint8_t const_count;
+        uint8_t input_count;
+        uint8_t code[MATH_EXPR_MAX_CODE];
+        float consts[MATH_EXPR_MAX_CONSTS];
+        ChannelSample inputs[MATH_EXPR_MAX_INPUTS];
+};
+
+/**
+ * Resolves a channel name found within an expression to its getter.
+ * @param name The name of the channel. Not NULL terminated.
+ * @param len The length of the name.
+ * @param input The ChannelSample to populate with the channel getter.
+ * @param ctx The context pointer given to math_expr_compile.
+ * @return true if the channel was found, false otherwise.
+ */
+typedef bool math_expr_resolve_t(const char *name, const size_t len,
+                                 ChannelSample *input, void *ctx);
+
+/**
+ * Compiles an expression into a program that can be evaluated by
+ * math_expr_eval.  Supports the + - * / % operators, unary - and !,
+ * comparisons, && and ||, the ?: conditional and the min, max, abs,
+ * sqrt and if functions.
+ * @param prog The program to compile into.
+ * @param expr The NULL terminated expression.
+ * @param resolve The callback used to resolve channel names.
+ * @param ctx Context pointer handed to the resolve callback.
+ * @return MATH_EXPR_OK if successful, the reason for failure otherwise.
+ */
+enum math_expr_status math_expr_compile(struct math_expr *prog,
+                                        const char *expr,
+                                        math_expr_resolve_t *resolve,
+                                        void *ctx);
+
+/**
+ * Evaluates a compiled program.
+ * @param prog The compiled program.
+ * @return The result of the expression.  Division by zero and the square
+ * root of a negative number yield 0.
+ */
+float math_expr_eval(const struct math_expr *prog);
+
+CPP_GUARD_END
+
+#endif /* _MATH_EXPR_H_ */
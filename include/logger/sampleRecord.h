@@ -38,7 +38,8 @@ CPP_GUARD_BEGIN
 enum LoggerMessageType {
         LoggerMessageType_Sample,
         LoggerMessageType_Start,
-        LoggerMessageType_Stop
+        LoggerMessageType_Stop,
+        LoggerMessageType_File
 };
 
 /*
@@ -83,6 +84,9 @@ typedef struct _ChannelSample {
 
 struct sample {
         size_t ticks;
+        /* Lap and sector in progress when the sample was taken */
+        int lap;
+        int sector;
         size_t channel_count;
         ChannelSample *channel_samples;
 };
@@ -93,6 +97,15 @@ typedef struct _LoggerMessage {
         struct sample *sample;
 } LoggerMessage;
 
+/**
+ * Re-carves the sample pool into buffers of count channels each.  Only
+ * possible while none of its buffers are in use.  Buffers that don't fit
+ * the pool, or find it empty, come from the heap instead.
+ * @param count Number of channels that we are logging.
+ * @return true if the pool was re-carved.
+ */
+bool format_sample_pool(const size_t count);
+
 /**
  * Initializes the struct sample channel_sample buffer for use.  May be called
  * again to re-initialize the space.
@@ -93,17 +93,36 @@ enum log_level {
 #define WARNING_LEVEL	(get_log_level() >= WARNING)
 #define TRACE_LEVEL 	(get_log_level() >= TRACE)
 
+/*
+ * In deferred mode only messages known at compile time are stored by
+ * reference.  Anything built at runtime is formatted on the spot, after
+ * the records deferred before it, so the log keeps call order.
+ */
+#define PRINTK_LITERAL(msg)	__builtin_constant_p(msg)
+
+#define printk(level, msg)                                              \
+        printk_ex(level, msg, PRINTK_LITERAL(msg))
+#define printk_bool_msg(level, msg, value)                              \
+        printk_bool_msg_ex(level, msg, value, PRINTK_LITERAL(msg))
+#define printk_float_msg(level, msg, value)                             \
+        printk_float_msg_ex(level, msg, value, PRINTK_LITERAL(msg))
+#define printk_int_msg(level, msg, value)                               \
+        printk_int_msg_ex(level, msg, value, PRINTK_LITERAL(msg))
+
 size_t read_log_to_serial(struct Serial *s, int escape);
 int writek(const char *msg);
 int writek_int(int value);
-int printk(enum log_level level, const char *msg);
-int printk_bool_msg(enum log_level level, const char *msg, const bool value);
+int printk_ex(enum log_level level, const char *msg, const bool literal);
+int printk_bool_msg_ex(enum log_level level, const char *msg,
+                       const bool value, const bool literal);
 int printk_char(enum log_level level, const char c);
 int printk_crlf(enum log_level level);
 int printk_float(enum log_level level, float value);
-int printk_float_msg(enum log_level level, const char *msg, float value);
+int printk_float_msg_ex(enum log_level level, const char *msg, float value,
+                        const bool literal);
 int printk_int(enum log_level level, int value);
-int printk_int_msg(enum log_level level, const char *msg, int value);
+int printk_int_msg_ex(enum log_level level, const char *msg, int value,
+                      const bool literal);
 int printk_str_msg(enum log_level level, const char *msg, const char *value);
 int writek(const char *msg);
 int writek_int(int value);
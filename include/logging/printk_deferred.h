@@ -0,0 +1,106 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PRINTK_DEFERRED_H_
+#define _PRINTK_DEFERRED_H_
+
+#include "capabilities.h"
+#include "cpp_guard.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Deferred printk.  Instead of formatting text and taking the log
+ * buffer mutex on the caller's thread, each call stores a fixed size
+ * record (message pointer, level, tick, raw value) in a ring owned by
+ * the calling task.  Every ring has a single producer and a single
+ * consumer so no locks are taken on the logging path.  Records are
+ * turned into text when the log is drained.  Messages are stored by
+ * reference, so only string literals may be deferred, and the calls
+ * must come from task context, never from an ISR.
+ */
+
+enum printk_record_type {
+        PRINTK_RECORD_MSG,
+        PRINTK_RECORD_CHAR,
+        PRINTK_RECORD_CRLF,
+        PRINTK_RECORD_INT,
+        PRINTK_RECORD_FLOAT,
+        PRINTK_RECORD_INT_MSG,
+        PRINTK_RECORD_FLOAT_MSG,
+        PRINTK_RECORD_BOOL_MSG,
+};
+
+struct printk_record {
+        /* Static message; its address doubles as the format ID */
+        const char *msg;
+        uint32_t ticks;
+        uint8_t level;
+        uint8_t type;
+        union {
+                int i;
+                float f;
+                char c;
+                bool b;
+        } value;
+};
+
+/**
+ * Turns deferred logging on or off.
+ * @param enable true to defer, false to format in place.
+ * @return The resulting state.  Always false if unsupported.
+ */
+bool printk_deferred_enable(const bool enable);
+
+/**
+ * @return true if printk calls are currently deferred.
+ */
+bool printk_deferred_enabled(void);
+
+/**
+ * Stores a record in the calling task's ring.  The tick is filled in
+ * here.  A full ring drops the record and counts it.
+ * @param rec The record to store.
+ * @return true if the record was taken or dropped, false if the caller
+ * should format it in place instead (deferral off, or no ring could be
+ * given to this task).
+ */
+bool printk_deferred_put(struct printk_record *rec);
+
+/**
+ * Removes the oldest record across all rings.
+ * @param rec Where to copy the record.
+ * @return true if a record was copied, false if all rings are empty.
+ */
+bool printk_deferred_get(struct printk_record *rec);
+
+/**
+ * @return The number of records dropped since the last call.
+ */
+uint32_t printk_deferred_dropped(void);
+
+CPP_GUARD_END
+
+#endif /* _PRINTK_DEFERRED_H_ */
@@ -0,0 +1,77 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LUABUDGET_H_
+#define _LUABUDGET_H_
+
+#include "cpp_guard.h"
+#include "lua.h"
+#include "luaTask.h"
+#include <stddef.h>
+
+CPP_GUARD_BEGIN
+
+/* How often, in VM instructions, the budget is checked */
+#define LUA_BUDGET_HOOK_INTERVAL	1000
+
+/*
+ * Loading the script runs its top level chunk, which may legitimately
+ * build tables or do other setup work far beyond what one onTick is
+ * allowed.  It gets its own, much longer, window instead of the tick
+ * budget.
+ */
+#define LUA_BUDGET_LOAD_MAX_INSNS	0
+#define LUA_BUDGET_LOAD_MAX_MS		10000
+
+enum lua_budget_window {
+        /* Running the top level chunk of the script */
+        LUA_BUDGET_LOAD,
+        /* onTick or an interactive command */
+        LUA_BUDGET_TICK,
+};
+
+/**
+ * Installs the budget hook on a Lua state.  Threads created from the
+ * state afterwards inherit it.
+ */
+void lua_budget_install(lua_State *ls);
+
+/**
+ * Starts a new budget window.  Called before every entry into the
+ * interpreter so that each invocation gets its full budget.
+ */
+void lua_budget_start(const enum lua_budget_window window);
+
+/**
+ * Sets the limits of the tick window.  0 means no limit.
+ */
+void lua_budget_set(const size_t max_insns, const size_t max_ms);
+
+struct lua_budget lua_budget_get();
+
+/**
+ * @return The number of invocations aborted for exceeding their budget.
+ */
+size_t lua_budget_get_overruns();
+
+CPP_GUARD_END
+
+#endif /* _LUABUDGET_H_ */
@@ -32,6 +32,17 @@ CPP_GUARD_BEGIN
 struct lua_runtime_info {
         int top_index;
         size_t mem_usage_kb;
+        size_t budget_overruns;
+};
+
+/**
+ * Per invocation limits enforced on the Lua runtime.  Each call to onTick
+ * (or each resume of a yielded onTick) and each interactive command gets
+ * a fresh budget.  A value of 0 means no limit.
+ */
+struct lua_budget {
+        size_t max_insns;
+        size_t max_ms;
 };
 
 void lua_task_run_interactive_cmd(struct Serial *serial, const char* cmd);
@@ -44,6 +55,10 @@ size_t lua_task_set_callback_freq(const size_t freq);
 
 size_t lua_task_get_callback_freq();
 
+void lua_task_set_budget(const size_t max_insns, const size_t max_ms);
+
+struct lua_budget lua_task_get_budget();
+
 bool lua_task_stop();
 
 bool lua_task_start();
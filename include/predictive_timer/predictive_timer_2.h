@@ -26,6 +26,7 @@
 #include "dateTime.h"
 #include "geopoint.h"
 #include "gps.h"
+#include "reference_lap.h"
 
 #include <stdbool.h>
 
@@ -90,6 +91,34 @@ bool isPredictiveTimeAvailable();
  */
 void resetPredictiveTimer();
 
+/**
+ * @return The time of the fast lap or 0 if there is none.
+ */
+tiny_millis_t getFastLapTime();
+
+/**
+ * Copies the fast lap into a reference lap.  The track id and serial are
+ * left for the caller to fill in.
+ * @return true if there was a fast lap to copy, false otherwise.
+ */
+bool getReferenceLap(struct reference_lap *ref);
+
+/**
+ * Resets the predictive timer and makes the given reference lap its fast
+ * lap, so predictions are available from the first lap.
+ * @return true if the reference was valid and loaded, false otherwise.
+ */
+bool setReferenceLap(const struct reference_lap *ref);
+
+/**
+ * Encodes a sample onto the end of a reference lap.  The first sample
+ * becomes the origin of the lap.
+ * @param time The time (millis) since the start of the lap.
+ * @return true if it was added, false if the lap is full.
+ */
+bool appendReferenceLapSample(struct reference_lap *ref,
+                              const GeoPoint *point, const tiny_millis_t time);
+
 /**
  * Finds the percentage that currPt is between startPt and endPt.as a
  * projection of point c onto the vector formed between points s and e.
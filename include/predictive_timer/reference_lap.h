@@ -0,0 +1,105 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _REFERENCE_LAP_H_
+#define _REFERENCE_LAP_H_
+
+#include "capabilities.h"
+#include "cpp_guard.h"
+#include "dateTime.h"
+#include "geopoint.h"
+#include "versionInfo.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * The trace of a lap in the predictive timer's compressed format, along
+ * with what is needed to decode it: the origin of the frame its points
+ * are relative to and the number of samples.
+ */
+struct reference_lap {
+        int32_t track_id;
+        /* Bumped on every save so the least recently saved slot is reused */
+        uint32_t serial;
+        tiny_millis_t lap_time;
+        GeoPoint origin;
+        uint16_t len;
+        uint16_t count;
+        uint8_t buff[PREDICTIVE_TIME_BUFFER_SIZE];
+};
+
+struct reference_laps {
+        VersionInfo versionInfo;
+        struct reference_lap laps[REFERENCE_LAP_SLOTS];
+};
+
+enum reference_lap_add_mode {
+        REFERENCE_LAP_ADD_MODE_IN_PROGRESS = 1,
+        REFERENCE_LAP_ADD_MODE_COMPLETE = 2,
+};
+
+void initialize_reference_laps();
+
+int flash_default_reference_laps(void);
+
+/**
+ * @return The stored reference lap for the track or NULL if there is none.
+ */
+const struct reference_lap* reference_lap_find(const int32_t track_id);
+
+/**
+ * Copies the predictive timer's current fast lap, to become the
+ * reference for the given track.  Call with the predictive timer's state
+ * locked, then store the copy with reference_lap_flash_copy.
+ * @return true if the lap was copied, false if there is none or another
+ * change is in progress.
+ */
+bool reference_lap_copy_fast_lap(const int32_t track_id);
+
+/**
+ * Stores the lap copied by reference_lap_copy_fast_lap, replacing any
+ * previous one for its track.  This erases a flash sector and stalls the
+ * CPU, so don't hold locks or do it while logging.
+ * @return true if it was stored, false otherwise.
+ */
+bool reference_lap_flash_copy(void);
+
+/**
+ * Adds samples to a reference lap being uploaded.  Samples arrive in
+ * chunks; the first chunk starts at index 0 and each chunk must start
+ * where the previous one ended.  The lap is stored once a chunk arrives
+ * with mode REFERENCE_LAP_ADD_MODE_COMPLETE.  An upload that stops
+ * sending chunks is dropped after a few seconds.
+ * @param index The index of the first sample in this chunk.
+ * @return true if the samples were accepted, false otherwise.
+ */
+bool reference_lap_add_samples(const int32_t track_id,
+                               const tiny_millis_t lap_time,
+                               const size_t index, const GeoPoint *points,
+                               const tiny_millis_t *times, const size_t count,
+                               const enum reference_lap_add_mode mode);
+
+CPP_GUARD_END
+
+#endif /* _REFERENCE_LAP_H_ */
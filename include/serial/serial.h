@@ -110,6 +110,9 @@ int serial_read_c(struct Serial *s, char* c);
 
 int serial_read_byte(struct Serial *serial, uint8_t *b, const size_t delay);
 
+int serial_read_buff_wait(struct Serial *s, uint8_t *buff, const size_t len,
+                          const size_t delay);
+
 int serial_read_line(struct Serial *s, char *l, const size_t len);
 
 int serial_read_line_wait(struct Serial *s, char *l, const size_t len,
@@ -0,0 +1,87 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BOOT_STATS_H_
+#define _BOOT_STATS_H_
+
+#include "cpp_guard.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * How long the unit took to come up after power on.  Each phase records
+ * when it began and when it first completed, in ms of uptime.  A phase
+ * that is never begun counts from boot, which makes it a milestone.
+ * Only the first completion counts; later re-inits are ignored.
+ */
+enum boot_phase {
+        BOOT_PHASE_SETUP,
+        BOOT_PHASE_GPS,
+        BOOT_PHASE_BLUETOOTH,
+        BOOT_PHASE_CELLULAR,
+        BOOT_PHASE_WIFI,
+        BOOT_PHASE_FIRST_SAMPLE,
+        BOOT_PHASE_GPS_FIX,
+        BOOT_PHASE_CONNECTION,
+        BOOT_PHASE_COUNT,
+};
+
+struct boot_phase_time {
+        uint32_t start;
+        uint32_t end;
+        bool done;
+};
+
+/**
+ * Marks the start of a phase.  Ignored once the phase has started, so
+ * retries keep counting from the first attempt.
+ */
+void boot_stats_begin(const enum boot_phase phase);
+
+/**
+ * Marks the first completion of a phase.
+ */
+void boot_stats_end(const enum boot_phase phase);
+
+/**
+ * @param phase The phase.
+ * @param time Filled with the phase's times.
+ * @return True if the phase has completed.
+ */
+bool boot_stats_get(const enum boot_phase phase,
+                    struct boot_phase_time *time);
+
+/**
+ * @return The API name of a phase.
+ */
+const char* boot_stats_phase_name(const enum boot_phase phase);
+
+/**
+ * Forgets all phases.  For testing.
+ */
+void boot_stats_reset(void);
+
+CPP_GUARD_END
+
+#endif /* _BOOT_STATS_H_ */
@@ -0,0 +1,141 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PERF_H_
+#define _PERF_H_
+
+#include "FreeRTOS.h"
+#include "cpp_guard.h"
+#include "queue.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Runtime performance telemetry: per task CPU share and stack high
+ * water marks, current/peak depth and failed sends of the registered
+ * queues, and drop counters at the stages of the sample pipeline.
+ * Everything on the hot path is a counter bump; the expensive bits
+ * (walking the task list, computing shares) only happen when somebody
+ * reads the data.
+ */
+
+#define PERF_MAX_TASKS	20
+#define PERF_MAX_QUEUES	12
+#define PERF_TASK_NAME_LEN	configMAX_TASK_NAME_LEN
+
+enum perf_counter {
+        /* Sample not queued to the file writer */
+        PERF_COUNTER_LOG_OVERFLOW,
+        /* API event not queued to a connection */
+        PERF_COUNTER_API_EVENT_DROP,
+        /* CAN frame lost because the RX queue was full */
+        PERF_COUNTER_CAN_RX_DROP,
+        /* Character lost because a serial RX queue was full */
+        PERF_COUNTER_SERIAL_RX_DROP,
+        /* Logger timer period skipped because the logger fell behind */
+        PERF_COUNTER_LOGGER_TICK_MISS,
+        PERF_COUNTER_COUNT,
+};
+
+struct perf_task {
+        char name[PERF_TASK_NAME_LEN];
+        /* Share of the window, in tenths of a percent */
+        uint16_t cpu;
+        /* Configured stack depth in words, 0 if unknown */
+        uint16_t stack_size;
+        /* Least amount of stack ever left unused, in words */
+        uint16_t stack_free;
+};
+
+struct perf_queue {
+        const char *owner;
+        const char *name;
+        uint16_t length;
+        uint16_t depth;
+        uint16_t peak;
+        uint32_t drops;
+};
+
+/**
+ * Records the configured stack depth of a task so it can be reported
+ * next to the task's high water mark.  Call before creating the task.
+ * @param name The name the task will be created with.  Must be static.
+ * @param stack_size The stack depth passed to xTaskCreate, in words.
+ */
+void perf_register_task(const signed char *name, const size_t stack_size);
+
+/**
+ * Adds a queue to the set whose depth is reported.  On targets with the
+ * FreeRTOS trace facility enabled the peak depth and failed sends are
+ * tracked by the queue itself; elsewhere the peak is sampled on read.
+ * @param owner Subsystem owning the queue.  Must be static.
+ * @param name What the queue carries.  Must be static.
+ * @param queue The queue.  Registering the same queue again is a no-op.
+ * @param length The number of items the queue was created to hold.
+ */
+void perf_register_queue(const char *owner, const char *name,
+                         xQueueHandle queue, const size_t length);
+
+/**
+ * Bumps one of the pipeline drop counters.  Safe to call from ISRs.
+ */
+void perf_count(const enum perf_counter counter);
+
+/**
+ * @return The current value of the given drop counter.
+ */
+uint32_t perf_counter_value(const enum perf_counter counter);
+
+/**
+ * @return The short name of the given drop counter.
+ */
+const char* perf_counter_name(const enum perf_counter counter);
+
+/**
+ * Snapshots all running tasks.  CPU shares cover the window since the
+ * previous call, so the first read after boot covers the whole uptime.
+ * @param tasks Array to fill.
+ * @param max Number of entries in tasks.
+ * @param count Set to the number of entries filled.
+ * @return The length of the window in ms.
+ */
+uint32_t perf_get_tasks(struct perf_task *tasks, const size_t max,
+                        size_t *count);
+
+/**
+ * Snapshots the registered queues.
+ * @param queues Array to fill.
+ * @param max Number of entries in queues.
+ * @return The number of entries filled.
+ */
+size_t perf_get_queues(struct perf_queue *queues, const size_t max);
+
+/**
+ * Clears the drop counters and the queue peaks and drop counts.
+ */
+void perf_reset(void);
+
+CPP_GUARD_END
+
+#endif /* _PERF_H_ */
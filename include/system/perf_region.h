@@ -0,0 +1,110 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PERF_REGION_H_
+#define _PERF_REGION_H_
+
+#include "capabilities.h"
+#include "cpp_guard.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Named hot path regions timed with the cpu cycle counter.  Wrap the
+ * code of interest in PERF_REGION_BEGIN/PERF_REGION_END; each region
+ * keeps count, min, max, total and a log2 histogram of its duration.
+ * Only one region may be open per scope.  With PERF_REGION_SUPPORT
+ * set to 0 the macros compile to nothing.
+ */
+
+#define PERF_REGION_MAX		12
+#define PERF_REGION_BUCKETS	24
+
+struct perf_region {
+        const char *name;
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+        uint64_t total;
+        /* Bucket n counts durations in [2^(n-1), 2^n) cycles */
+        uint32_t hist[PERF_REGION_BUCKETS];
+};
+
+#if PERF_REGION_SUPPORT
+#define PERF_REGION_BEGIN(_name)                                        \
+        static struct perf_region *_perf_region_;                       \
+        const uint32_t _perf_region_start_ =                            \
+                perf_region_begin(&_perf_region_, (_name))
+
+#define PERF_REGION_END(_name)                                          \
+        perf_region_end(_perf_region_, _perf_region_start_)
+#else
+#define PERF_REGION_BEGIN(_name)	do {} while (0)
+#define PERF_REGION_END(_name)		do {} while (0)
+#endif /* PERF_REGION_SUPPORT */
+
+/**
+ * Looks up the region on first use and starts timing it.
+ * @param region Per call site cache of the region.
+ * @param name The region name.  Must be static.
+ * @return The cycle count at the start of the region.
+ */
+uint32_t perf_region_begin(struct perf_region **region, const char *name);
+
+/**
+ * Stops timing a region started with #perf_region_begin.
+ * @param region The region, NULL if the table was full.
+ * @param start The value returned by #perf_region_begin.
+ */
+void perf_region_end(struct perf_region *region, const uint32_t start);
+
+/**
+ * Adds one duration to a region's statistics.
+ * @param region The region to update.
+ * @param cycles The duration in cycles.
+ */
+void perf_region_record(struct perf_region *region, const uint32_t cycles);
+
+/**
+ * Copies out a consistent snapshot of one region.
+ * @param index The region index, starting from 0.
+ * @param region Filled with the snapshot.
+ * @return True if the index names a region, false otherwise.
+ */
+bool perf_region_get(const size_t index, struct perf_region *region);
+
+/**
+ * @return The number of cycles per second.
+ */
+uint32_t perf_region_hz(void);
+
+/**
+ * Clears the statistics of all regions.  Regions stay registered.
+ */
+void perf_region_reset(void);
+
+CPP_GUARD_END
+
+#endif /* _PERF_REGION_H_ */
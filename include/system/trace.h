@@ -0,0 +1,200 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include "capabilities.h"
+#include "cpp_guard.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Event trace recorder.  While running, task switches, traffic on the
+ * queues registered with perf, ISR entry and exit and the custom
+ * events below are stamped with the cpu cycle counter and stored as
+ * fixed size records in a RAM ring.  Recording takes no locks and is
+ * safe from any context.  The ring is dumped in a compact binary
+ * format that test/rcptrace turns into Chrome trace / Perfetto JSON.
+ * With TRACE_SUPPORT set to 0 the macros compile to nothing.
+ */
+
+#define TRACE_MAGIC	"RCPT"
+#define TRACE_VERSION	1
+
+enum trace_type {
+        /* arg: task number */
+        TRACE_TYPE_TASK_IN,
+        TRACE_TYPE_TASK_OUT,
+        /* id: queue number, arg: depth after the operation */
+        TRACE_TYPE_QUEUE_SEND,
+        TRACE_TYPE_QUEUE_RECEIVE,
+        TRACE_TYPE_QUEUE_DROP,
+        /* id: enum trace_isr, arg: instance */
+        TRACE_TYPE_ISR_ENTER,
+        TRACE_TYPE_ISR_EXIT,
+        /* id: enum trace_event, arg: event specific value */
+        TRACE_TYPE_BEGIN,
+        TRACE_TYPE_END,
+        TRACE_TYPE_MARK,
+};
+
+enum trace_isr {
+        TRACE_ISR_USART,
+        TRACE_ISR_CAN,
+        TRACE_ISR_USB,
+        TRACE_ISR_COUNT,
+};
+
+enum trace_event {
+        /* arg: low bits of the logger tick */
+        TRACE_EVENT_LOGGER_TICK,
+        TRACE_EVENT_SAMPLE_QUEUED,
+        TRACE_EVENT_SAMPLE_DROPPED,
+        TRACE_EVENT_FILE_WRITE,
+        TRACE_EVENT_FILE_FLUSH,
+        TRACE_EVENT_COUNT,
+};
+
+enum trace_name_kind {
+        TRACE_NAME_TASK,
+        TRACE_NAME_QUEUE,
+        TRACE_NAME_ISR,
+        TRACE_NAME_EVENT,
+};
+
+enum trace_mode {
+        /* Keep the most recent events */
+        TRACE_MODE_RING,
+        /* Stop when the buffer is full */
+        TRACE_MODE_ONCE,
+};
+
+struct trace_record {
+        uint32_t cycles;
+        uint8_t type;
+        uint8_t id;
+        uint16_t arg;
+};
+
+/*
+ * A dump is this header, then names name records, each a struct
+ * trace_name followed by len chars, then events records oldest first.
+ * All fields are little endian.
+ */
+struct trace_header {
+        char magic[4];
+        uint8_t version;
+        uint8_t record_size;
+        uint16_t names;
+        /* Size of the whole dump in bytes */
+        uint32_t size;
+        /* Cycle counter rate */
+        uint32_t hz;
+        uint32_t events;
+        /* Events overwritten in ring mode or refused in once mode */
+        uint32_t lost;
+};
+
+struct trace_name {
+        uint8_t kind;
+        uint8_t len;
+        uint16_t id;
+};
+
+#if TRACE_SUPPORT
+#define TRACE_BEGIN(_event, _arg)	trace_record(TRACE_TYPE_BEGIN, (_event), (_arg))
+#define TRACE_END(_event, _arg)		trace_record(TRACE_TYPE_END, (_event), (_arg))
+#define TRACE_MARK(_event, _arg)	trace_record(TRACE_TYPE_MARK, (_event), (_arg))
+#define TRACE_ISR_ENTER(_isr, _n)	trace_record(TRACE_TYPE_ISR_ENTER, (_isr), (_n))
+#define TRACE_ISR_EXIT(_isr, _n)	trace_record(TRACE_TYPE_ISR_EXIT, (_isr), (_n))
+#else
+#define TRACE_BEGIN(_event, _arg)	do {} while (0)
+#define TRACE_END(_event, _arg)		do {} while (0)
+#define TRACE_MARK(_event, _arg)	do {} while (0)
+#define TRACE_ISR_ENTER(_isr, _n)	do {} while (0)
+#define TRACE_ISR_EXIT(_isr, _n)	do {} while (0)
+#endif /* TRACE_SUPPORT */
+
+/**
+ * Clears the buffer and starts recording.  The buffer of
+ * TRACE_BUFFER_EVENTS records is allocated on first use.
+ * @return false if the buffer could not be allocated.
+ */
+bool trace_start(const enum trace_mode mode);
+
+/**
+ * Stops recording.  The recorded events are kept until the next start.
+ */
+void trace_stop(void);
+
+bool trace_is_running(void);
+
+/**
+ * @param lost Set to the number of events lost so far.
+ * @return The number of events held in the buffer.
+ */
+size_t trace_count(uint32_t *lost);
+
+/**
+ * Records one event if the recorder is running.  Safe from ISRs.
+ */
+void trace_record(const enum trace_type type, const uint8_t id,
+                  const uint16_t arg);
+
+/*
+ * Kernel hooks, called from the trace macros in FreeRTOSConfig.h.
+ */
+void trace_task_in(const unsigned long task);
+void trace_task_out(const unsigned long task);
+void trace_queue_send(const unsigned char queue, const unsigned long depth);
+void trace_queue_receive(const unsigned char queue,
+                         const unsigned long depth);
+void trace_queue_drop(const unsigned char queue);
+
+/**
+ * Sink for #trace_dump.
+ * @return false to abort the dump.
+ */
+typedef bool trace_write_func_t(void *arg, const void *data,
+                                const size_t len);
+
+/**
+ * Stops the recorder and writes out the dump: header, names of the
+ * tasks, queues, ISRs and events, then the buffered events.
+ * @return true if every write succeeded.
+ */
+bool trace_dump(trace_write_func_t *write, void *arg);
+
+/**
+ * Dumps the trace to a file on the SD card, by way of the file writer.
+ * Not while logging.
+ * @return 0 on success, a FatFs error code or -1 otherwise.
+ */
+int trace_save(const char *path);
+
+CPP_GUARD_END
+
+#endif /* _TRACE_H_ */
@@ -30,6 +30,8 @@
 CPP_GUARD_BEGIN
 
 int timer_init(LoggerConfig *loggerConfig);
+void timer_init_filters(LoggerConfig *loggerConfig, const unsigned int rate_hz);
+void timer_sample_all(void);
 uint32_t timer_get_raw(size_t channel);
 uint32_t timer_get_usec(size_t channel);
 uint32_t timer_get_ms(size_t channel);
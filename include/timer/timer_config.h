@@ -24,6 +24,7 @@
 
 #include "channel_config.h"
 #include "cpp_guard.h"
+#include "filter.h"
 
 CPP_GUARD_BEGIN
 
@@ -52,6 +53,7 @@ typedef struct _TimerConfig {
         unsigned short timerSpeed;
         int filter_period_us;
         enum timer_edge edge;
+        struct channel_filter_config filter;
 } TimerConfig;
 
 TimerConfig* get_timer_config(int channel);
@@ -0,0 +1,141 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BLOCK_POOL_H_
+#define _BLOCK_POOL_H_
+
+#include "cpp_guard.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Fixed size block pools carved out of static storage.  Buffers that are
+ * taken and given back over and over live in a pool instead of the heap,
+ * so their churn can't fragment the heap and their memory is reserved at
+ * build time.  Allocating and freeing a block are O(1) and safe from any
+ * task.
+ */
+
+/* Most pools a build may report on */
+#define BLOCK_POOL_MAX_POOLS	8
+#define BLOCK_POOL_ALIGN	8
+#define BLOCK_POOL_BLOCK_SIZE(size)					\
+        (((size) + BLOCK_POOL_ALIGN - 1) & ~((size_t) BLOCK_POOL_ALIGN - 1))
+
+struct block_pool {
+        const char *name;
+        uint8_t *storage;
+        size_t storage_size;
+        size_t block_size;
+        size_t capacity;
+        bool formatted;
+        void *free_list;
+        size_t used;
+        size_t peak;
+        uint32_t failures;
+};
+
+struct block_pool_stats {
+        const char *name;
+        size_t block_size;
+        size_t capacity;
+        size_t used;
+        size_t peak;
+        /* Requests the pool could not serve */
+        uint32_t failures;
+};
+
+/**
+ * Defines a pool of count blocks, each big enough for one type.
+ */
+#define BLOCK_POOL_DEFINE(var, label, type, count)			\
+        BLOCK_POOL_DEFINE_STORAGE(var, label,				\
+                                  BLOCK_POOL_BLOCK_SIZE(sizeof(type)) * (count), \
+                                  BLOCK_POOL_BLOCK_SIZE(sizeof(type)))
+
+/**
+ * Defines size bytes of storage whose block size is set later with
+ * block_pool_format.  For buffers whose size depends on the
+ * configuration.
+ */
+#define BLOCK_POOL_DEFINE_ARENA(var, label, size)			\
+        BLOCK_POOL_DEFINE_STORAGE(var, label, size, 0)
+
+#define BLOCK_POOL_DEFINE_STORAGE(var, label, size, block)		\
+        static uint8_t var ## _storage[size]				\
+        __attribute__((aligned(BLOCK_POOL_ALIGN)));			\
+        static struct block_pool var = {				\
+                .name = label,						\
+                .storage = var ## _storage,				\
+                .storage_size = sizeof(var ## _storage),		\
+                .block_size = block,					\
+        }
+
+/**
+ * Re-carves the pool into blocks of the given size.  Only possible while
+ * no block is taken.
+ * @param block_size The smallest block wanted, in bytes.
+ * @return true if the pool was re-carved, false if it is in use.
+ */
+bool block_pool_format(struct block_pool *pool, const size_t block_size);
+
+/**
+ * Takes a block from the pool.
+ * @param size Bytes needed.  Must fit in the pool's block size.
+ * @return The block, or NULL if the size doesn't fit or the pool is empty.
+ */
+void* block_pool_alloc(struct block_pool *pool, const size_t size);
+
+/**
+ * Gives a block taken with block_pool_alloc back to the pool.
+ */
+void block_pool_free(struct block_pool *pool, void *block);
+
+/**
+ * @return true if ptr points into the pool's storage.
+ */
+bool block_pool_owns(const struct block_pool *pool, const void *ptr);
+
+/**
+ * Like block_pool_alloc, but falls back to the heap when the pool can't
+ * serve the request.  Free the result with block_pool_free_fallback.
+ */
+void* block_pool_alloc_fallback(struct block_pool *pool, const size_t size);
+
+/**
+ * Frees memory from block_pool_alloc_fallback to wherever it came from.
+ */
+void block_pool_free_fallback(struct block_pool *pool, void *ptr);
+
+/**
+ * Snapshots every pool that has been used since boot.
+ * @param stats Array to fill.
+ * @param max Number of entries in stats.
+ * @return The number of entries filled.
+ */
+size_t block_pool_get_stats(struct block_pool_stats *stats, const size_t max);
+
+CPP_GUARD_END
+
+#endif /* _BLOCK_POOL_H_ */
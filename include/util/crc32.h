@@ -0,0 +1,45 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CRC32_H_
+#define _CRC32_H_
+
+#include "cpp_guard.h"
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Standard CRC-32 (IEEE 802.3, as used by zlib and PNG) so that hosts can
+ * check data with their stock crc32 routines.
+ */
+
+/**
+ * Continues a CRC over another block of data.
+ * @param crc The CRC so far, 0 to start a new one.
+ * @return The CRC including the new data.
+ */
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+
+CPP_GUARD_END
+
+#endif /* _CRC32_H_ */
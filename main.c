@@ -30,6 +30,7 @@
 
 #include "FreeRTOS.h"
 #include "CAN_task.h"
+#include "boot_stats.h"
 #include "capabilities.h"
 #include "connectivityTask.h"
 #include "constants.h"
@@ -37,6 +38,7 @@
 #include "fileWriter.h"
 #include "gpioTasks.h"
 #include "gpsTask.h"
+#include "lap_stats.h"
 #include "led.h"
 #include "loggerHardware.h"
 #include "loggerTaskEx.h"
@@ -45,6 +47,7 @@
 #include "messaging.h"
 #include "panic.h"
 #include "printk.h"
+#include "reference_lap.h"
 #include "task.h"
 #include "usb_comm.h"
 #include "wifi.h"
@@ -70,10 +73,25 @@ static const struct app_info_block info_block = {
 #define RCP_OUTPUT_PRIORITY	TASK_PRIORITY(2)
 #define RCP_LUA_PRIORITY	TASK_PRIORITY(1)
 
+#if WIFI_SUPPORT
+/*
+ * Resetting and probing the WiFi module takes seconds, and after a
+ * watchdog reset the Lua start waits on the user for a while, so neither
+ * waits on the other.
+ */
+static void wifi_setup_task(void *param)
+{
+        wifi_init_task(RCP_OUTPUT_PRIORITY, RCP_INPUT_PRIORITY);
+        vTaskDelete(NULL);
+}
+#endif
+
 void setupTask(void *param)
 {
         initialize_tracks();
+        initialize_reference_laps();
         initialize_logger_config();
+        lapstats_init();
 
         InitLoggerHardware();
         initMessaging();
@@ -96,16 +114,19 @@ void setupTask(void *param)
         startFileWriterTask(RCP_OUTPUT_PRIORITY);
 #endif
 
-#if LUA_SUPPORT
-        lua_task_init(RCP_LUA_PRIORITY);
+#if WIFI_SUPPORT
+        static const signed portCHAR wifi_task_name[] = "WiFi Init";
+        xTaskCreate(wifi_setup_task, wifi_task_name,
+                    HARDWARE_INIT_STACK_SIZE, NULL, RCP_LUA_PRIORITY, NULL);
 #endif
 
-#if WIFI_SUPPORT
-        wifi_init_task(RCP_OUTPUT_PRIORITY, RCP_INPUT_PRIORITY);
+#if LUA_SUPPORT
+        lua_task_init(RCP_LUA_PRIORITY);
 #endif
 
         /* Removes this setup task from the scheduler */
         pr_info("[main] Setup Task complete!\r\n");
+        boot_stats_end(BOOT_PHASE_SETUP);
         vTaskDelete(NULL);
 }
 
@@ -0,0 +1,138 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*
+ * FreeRTOS configuration for the Linux platform.  Tasks run as pthreads
+ * under the Posix port (see port/port.c) and the tick comes from
+ * SIGALRM, so these mirror the MK2 settings wherever the host allows.
+ */
+
+#define configUSE_PREEMPTION		1
+#define configUSE_IDLE_HOOK		0
+#define configUSE_TICKLESS_IDLE		0
+#define configUSE_TICK_HOOK		0
+#define configCPU_CLOCK_HZ		( 1000000000UL )
+#define configTICK_RATE_HZ		1000
+#define configMAX_PRIORITIES		((unsigned portBASE_TYPE) 5)
+#define configMINIMAL_STACK_SIZE	((unsigned short) 128)
+#define configMAX_TASK_NAME_LEN		( 16 )
+#define configUSE_TRACE_FACILITY	1
+#define configUSE_16_BIT_TICKS		0
+#define configIDLE_SHOULD_YIELD		1
+#define configUSE_MUTEXES		1
+#define configQUEUE_REGISTRY_SIZE	10
+#define configGENERATE_RUN_TIME_STATS	1
+#define configUSE_STATS_FORMATTING_FUNCTIONS 1
+#define configUSE_RECURSIVE_MUTEXES	1
+#define configUSE_APPLICATION_TASK_TAG	0
+
+/* Task stacks are pthread stacks here, so the kernel can't check them */
+#define configCHECK_FOR_STACK_OVERFLOW	0
+#ifdef ASL_DEBUG
+#define configUSE_MALLOC_FAILED_HOOK	1
+#else
+#define configUSE_MALLOC_FAILED_HOOK	0
+#endif /* ASL_DEBUG */
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES 		0
+#define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+
+#define INCLUDE_vTaskPrioritySet		1
+#define INCLUDE_uxTaskPriorityGet		1
+#define INCLUDE_vTaskDelete			1
+#define INCLUDE_vTaskCleanUpResources		0
+#define INCLUDE_vTaskSuspend			1
+#define INCLUDE_vTaskDelayUntil			1
+#define INCLUDE_vTaskDelay			1
+#define INCLUDE_xTaskGetCurrentTaskHandle	1
+#define INCLUDE_xTaskGetIdleTaskHandle		1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle	1
+#define INCLUDE_xSemaphoreGetMutexHolder	1
+
+/* Software timer configuration. */
+#define configUSE_TIMERS		1
+#define configTIMER_TASK_PRIORITY	( 4 )
+#define configTIMER_QUEUE_LENGTH	( 10 )
+#define configTIMER_TASK_STACK_DEPTH	configMINIMAL_STACK_SIZE
+
+/*
+ * Run time stats and queue tracing feed the perf module (see perf.h).
+ * The run time clock is derived from the host monotonic clock, and only
+ * queues registered with perf_register_queue have a queue number.
+ * Task switches and the same queue traffic also go to the event trace
+ * recorder (see trace.h), which ignores them unless it is running.
+ */
+extern void perf_runtime_init(void);
+extern unsigned long perf_runtime_counter(void);
+extern void perf_trace_queue_send(unsigned char queue, unsigned long depth);
+extern void perf_trace_queue_drop(unsigned char queue);
+extern void trace_task_in(const unsigned long task);
+extern void trace_task_out(const unsigned long task);
+extern void trace_queue_send(const unsigned char queue,
+			     const unsigned long depth);
+extern void trace_queue_receive(const unsigned char queue,
+				const unsigned long depth);
+extern void trace_queue_drop(const unsigned char queue);
+
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	perf_runtime_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()		perf_runtime_counter()
+
+#define PERF_TRACE_QUEUE_SEND(pxQueue)					\
+	do {								\
+		if ((pxQueue)->ucQueueNumber) {				\
+			perf_trace_queue_send((pxQueue)->ucQueueNumber,	\
+					      (pxQueue)->uxMessagesWaiting + 1); \
+			trace_queue_send((pxQueue)->ucQueueNumber,	\
+					 (pxQueue)->uxMessagesWaiting + 1); \
+		}							\
+	} while (0)
+#define PERF_TRACE_QUEUE_DROP(pxQueue)					\
+	do {								\
+		if ((pxQueue)->ucQueueNumber) {				\
+			perf_trace_queue_drop((pxQueue)->ucQueueNumber); \
+			trace_queue_drop((pxQueue)->ucQueueNumber);	\
+		}							\
+	} while (0)
+#define PERF_TRACE_QUEUE_RECEIVE(pxQueue)				\
+	do {								\
+		if ((pxQueue)->ucQueueNumber)				\
+			trace_queue_receive((pxQueue)->ucQueueNumber,	\
+					    (pxQueue)->uxMessagesWaiting - 1); \
+	} while (0)
+
+#define traceQUEUE_SEND(pxQueue)		PERF_TRACE_QUEUE_SEND(pxQueue)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)	PERF_TRACE_QUEUE_SEND(pxQueue)
+#define traceQUEUE_SEND_FAILED(pxQueue)		PERF_TRACE_QUEUE_DROP(pxQueue)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue) PERF_TRACE_QUEUE_DROP(pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue)		PERF_TRACE_QUEUE_RECEIVE(pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)	PERF_TRACE_QUEUE_RECEIVE(pxQueue)
+
+#define traceTASK_SWITCHED_IN()		trace_task_in(pxCurrentTCB->uxTCBNumber)
+#define traceTASK_SWITCHED_OUT()	trace_task_out(pxCurrentTCB->uxTCBNumber)
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,137 @@
+#ifndef CAPABILITIES_H_
+#define CAPABILITIES_H_
+#include "serial.h"
+#include "FreeRTOSConfig.h"
+
+//Capabilities for the Linux platform (mirrors the RCP MK2)
+#define TICK_RATE_HZ	configTICK_RATE_HZ
+#define MS_PER_TICK	1
+
+/* Support Flags */
+#define GPS_HARDWARE_SUPPORT 1
+#define BLUETOOTH_SUPPORT	1
+#define CELLULAR_SUPPORT	1
+#define LUA_SUPPORT		1
+#define SDCARD_SUPPORT		1
+#define USB_SERIAL_SUPPORT	1
+#define VIRTUAL_CHANNEL_SUPPORT	1
+#define WIFI_SUPPORT		1
+#define PERF_REGION_SUPPORT	1
+#define PRINTK_DEFERRED_SUPPORT	1
+#define TRACE_SUPPORT	1
+#define CAMERA_CONTROL      0
+
+/* Wifi Specific Info */
+#define WIFI_MAX_BAUD		230400
+#define WIFI_MAX_SAMPLE_RATE	10
+#define WIFI_ENABLED_DEFAULT	false
+
+/* Rx Max Message length */
+#define RX_MAX_MSG_LEN	768
+
+/* Configuration */
+#define MAX_TRACKS	50
+#define MAX_SECTORS	20
+#define LAP_HISTORY_SIZE	10
+#define MAX_VIRTUAL_CHANNELS	100
+#define LOGGER_MESSAGE_BUFFER_SIZE	10
+/*
+ * Bytes set aside at build time for sample buffers.  The logger's ring
+ * and one off API samples come from here while they fit, so config
+ * changes don't churn the heap.
+ */
+#define SAMPLE_POOL_SIZE	(1024 * 12)
+/* JSON token arrays pooled for API requests being parsed at once */
+#define JSON_TOKEN_ARRAYS	2
+/*
+ * Size in bytes of each predictive time buffer.  More samples == better
+ * resolution.  Samples are delta encoded and average a few bytes each.
+ */
+#define PREDICTIVE_TIME_BUFFER_SIZE	1152
+
+/*
+ * Number of per track reference laps kept in flash.  These seed the
+ * predictive timer so it works from the first lap of a session.
+ */
+#define REFERENCE_LAP_SLOTS	8
+
+/* LUA Configuration */
+
+/*
+ * What is the maximum length of the script that can be provided?
+ * Must be divisible by 256.
+ */
+#define SCRIPT_MEMORY_LENGTH	(1024 * 16)
+
+/*
+ * Defines the memory ceiling for LUA.  In other words, how much RAM can
+ * LUA allocate before we say no.  This keeps LUA from crashing the system
+ * when a memory hog LUA script is running.  Set to 0 for no limit.
+ */
+#define LUA_MEM_MAX (1024 * 50)
+
+/*
+ * These values dictate how the LUA garbage collector will behave.
+ * Tweaking these is necessary in low memory environments to ensure
+ * that LUA's memory footprint does not exceed what can be spared.
+ * A value of 0 means that you want to use the default.  For more info
+ * see http://www.lua.org/manual/5.1/manual.html#2.10
+ */
+/* Pause between runs.  < 100 means don't wait */
+#define LUA_GC_PAUSE_PCT	99
+/* Runtime of GC to malloc.  Setting to 10x for agressive behavior. */
+#define LUA_GC_STEP_MULT_PCT	1000
+
+/*
+ * Controls whether or not we allow LUA to register the nice to have
+ * external libs.  These come at a memory cost, but are useful.
+ */
+#define LUA_REGISTER_EXTERNAL_LIBS	1
+
+
+//Sensor Channels
+#define ANALOG_CHANNELS 		8
+#define IMU_CHANNELS			6
+#define	GPIO_CHANNELS			3
+#define TIMER_CHANNELS			3
+#define PWM_CHANNELS			4
+#define CAN_CHANNELS			2
+#define CAN_SW_TERMINATION      false
+#define CAN_MAPPINGS            100
+#define OBD2_CHANNELS           20
+#define MATH_CHANNELS           10
+//Wireless Channels
+#define CONNECTIVITY_CHANNELS	2
+
+//sample rates
+#define MAX_SENSOR_SAMPLE_RATE	1000
+#define MAX_GPS_SAMPLE_RATE		50
+#define MAX_OBD2_SAMPLE_RATE	1000
+
+//logging
+#define LOG_BUFFER_SIZE			8192
+
+/*
+ * Deferred printk: number of per task record rings and the records
+ * in each (power of 2).  Rings are allocated the first time a task
+ * logs with deferral enabled.
+ */
+#define PRINTK_DEFERRED_RINGS		8
+#define PRINTK_DEFERRED_RING_SIZE	32
+
+/*
+ * Event trace recorder: records held in RAM (power of 2, 8 bytes each).
+ * The buffer is allocated when tracing is first started.
+ */
+#define TRACE_BUFFER_EVENTS		65536
+
+//system info
+#define DEVICE_NAME    "RCP_LINUX"
+#define FRIENDLY_DEVICE_NAME "RaceCapture/Pro Linux"
+
+/* How big is our hardware init stack */
+#define HARDWARE_INIT_STACK_SIZE	256
+
+/* if auxiliary CAN queues are supported */
+#define CAN_AUX_QUEUE_SUPPORT   LUA_SUPPORT
+#endif /* CAPABILITIES_H_ */
@@ -0,0 +1,231 @@
+# The name of our project (and the associated artifacts created)
+TARGET = rcp_linux
+
+#Version of FreeRTOS we'll be using
+FREERTOS = FreeRTOSV7.6.0
+
+#HEAP selection
+FREERTOS_HEAP = heap_4
+
+# Size of the heap_4 region.  The MK2 gets this from its linker script.
+HEAP_SIZE = 0x400000
+
+INCLUDE_DIR := $(APP_PATH)/include
+PLATFORM_DIR := $(APP_PATH)/platform/linux
+HAL_SRC = $(PLATFORM_DIR)/hal
+RCP_SRC = $(APP_PATH)/src
+
+# The kernel, FatFs and the serial port mapping are shared with the MK2
+MK2_DIR := $(APP_PATH)/platform/mk2
+MK2_HAL_SRC = $(MK2_DIR)/hal
+
+# The source files of our application
+APP_SRC = \
+$(APP_PATH)/main.c \
+$(HAL_SRC)/ADC_linux/ADC_device_linux.c \
+$(HAL_SRC)/CAN_linux/CAN_device_linux.c \
+$(HAL_SRC)/GPIO_linux/GPIO_device_linux.c \
+$(HAL_SRC)/LED_linux/led_device_linux.c \
+$(HAL_SRC)/PWM_linux/PWM_device_linux.c \
+$(HAL_SRC)/cell_device/cell_pwr_btn.c \
+$(HAL_SRC)/cpu_linux/cpu_device_linux.c \
+$(HAL_SRC)/fat_sd_linux/diskio_linux.c \
+$(HAL_SRC)/fat_sd_linux/sdcard_device_linux.c \
+$(HAL_SRC)/gps_linux/gps_device_lld_linux.c \
+$(HAL_SRC)/gps_linux/gps_replay.c \
+$(HAL_SRC)/imu_linux/imu_device_linux.c \
+$(HAL_SRC)/memory_linux/memory_device_linux.c \
+$(HAL_SRC)/pty_linux/pty_device.c \
+$(HAL_SRC)/timer_linux/timer_device_linux.c \
+$(HAL_SRC)/usart_linux/usart_device_linux.c \
+$(HAL_SRC)/usb_linux/USB-CDC_device_linux.c \
+$(HAL_SRC)/watchdog_linux/watchdog_device_linux.c \
+$(HAL_SRC)/wifi_linux/wifi_device_linux.c \
+$(PLATFORM_DIR)/util/heap.c \
+$(MK2_HAL_SRC)/fat_sd_stm32/fatfs/drivers/stm32_fattime.c \
+$(MK2_HAL_SRC)/fat_sd_stm32/fatfs/ff.c \
+$(MK2_HAL_SRC)/fat_sd_stm32/fatfs/option/syscall.c \
+$(MK2_HAL_SRC)/fat_sd_stm32/fatfs/option/unicode.c \
+$(MK2_HAL_SRC)/serial/serial_device.c \
+$(RCP_SRC)/ADC/ADC.c \
+$(RCP_SRC)/CAN/CAN.c \
+$(RCP_SRC)/CAN/CAN_task.c \
+$(RCP_SRC)/CAN/CAN_dispatcher.c \
+$(RCP_SRC)/CAN/CAN_aux_queue.c \
+$(RCP_SRC)/CAN/can_mapping.c \
+$(RCP_SRC)/CAN/can_channels.c \
+$(RCP_SRC)/GPIO/GPIO.c \
+$(RCP_SRC)/GPIO/gpioTasks.c \
+$(RCP_SRC)/LED/led.c \
+$(RCP_SRC)/OBD2/OBD2.c \
+$(RCP_SRC)/PWM/PWM.c \
+$(RCP_SRC)/api/api.c \
+$(RCP_SRC)/auto_config/auto_track.c \
+$(RCP_SRC)/command/baseCommands.c \
+$(RCP_SRC)/command/command.c \
+$(RCP_SRC)/cpu/cpu.c \
+$(RCP_SRC)/devices/bluetooth.c \
+$(RCP_SRC)/devices/cellular.c \
+$(RCP_SRC)/devices/cellular_api_status_keys.c \
+$(RCP_SRC)/devices/device_cache.c \
+$(RCP_SRC)/devices/esp8266.c \
+$(RCP_SRC)/devices/null_device.c \
+$(RCP_SRC)/devices/sara_u280.c \
+$(RCP_SRC)/devices/sara_r4.c \
+$(RCP_SRC)/devices/sim900.c \
+$(RCP_SRC)/devices/skytraq_frame.c \
+$(RCP_SRC)/devices/gps_skytraq_s1216_sup500f8.c \
+$(RCP_SRC)/drivers/esp8266_drv.c \
+$(RCP_SRC)/drivers/shiftx_drv.c \
+$(RCP_SRC)/filter/filter.c \
+$(RCP_SRC)/gps/dateTime.c \
+$(RCP_SRC)/gps/geoCircle.c \
+$(RCP_SRC)/gps/geoTrigger.c \
+$(RCP_SRC)/gps/geopoint.c \
+$(RCP_SRC)/gps/gps.c \
+$(RCP_SRC)/gps/gpsTask.c \
+$(RCP_SRC)/gps/gps_fusion.c \
+$(RCP_SRC)/gps/track_frame.c \
+$(RCP_SRC)/gsm/gsm.c \
+$(RCP_SRC)/imu/imu.c \
+$(RCP_SRC)/jsmn/jsmn.c \
+$(RCP_SRC)/lap_stats/lap_stats.c \
+$(RCP_SRC)/lap_stats/sector_stats.c \
+$(RCP_SRC)/launch_control.c \
+$(RCP_SRC)/logger/auto_control.c \
+$(RCP_SRC)/logger/auto_logger.c \
+$(RCP_SRC)/logger/channel_config.c \
+$(RCP_SRC)/logger/connectivityTask.c \
+$(RCP_SRC)/logger/fileWriter.c \
+$(RCP_SRC)/logger/log_index.c \
+$(RCP_SRC)/logger/logger.c \
+$(RCP_SRC)/logger/analog_scaling.c \
+$(RCP_SRC)/logger/api_event.c \
+$(RCP_SRC)/logger/loggerApi.c \
+$(RCP_SRC)/logger/loggerCommands.c \
+$(RCP_SRC)/logger/loggerConfig.c \
+$(RCP_SRC)/logger/loggerData.c \
+$(RCP_SRC)/logger/loggerHardware.c \
+$(RCP_SRC)/logger/loggerSampleData.c \
+$(RCP_SRC)/logger/loggerTaskEx.c \
+$(RCP_SRC)/logger/math_channel.c \
+$(RCP_SRC)/logger/math_expr.c \
+$(RCP_SRC)/logger/sampleRecord.c \
+$(RCP_SRC)/logger/versionInfo.c \
+$(RCP_SRC)/logging/printk.c \
+$(RCP_SRC)/logging/printk_deferred.c \
+$(RCP_SRC)/lua/luaBaseBinding.c \
+$(RCP_SRC)/lua/luaBudget.c \
+$(RCP_SRC)/lua/luaCommands.c \
+$(RCP_SRC)/lua/luaLoggerBinding.c \
+$(RCP_SRC)/lua/luaScript.c \
+$(RCP_SRC)/lua/luaTask.c \
+$(RCP_SRC)/memory/memory.c \
+$(RCP_SRC)/messaging/messaging.c \
+$(RCP_SRC)/modem/at.c \
+$(RCP_SRC)/modem/at_basic.c \
+$(RCP_SRC)/predictive_timer/predictive_timer_2.c \
+$(RCP_SRC)/predictive_timer/reference_lap.c \
+$(RCP_SRC)/sdcard/sdcard.c \
+$(RCP_SRC)/serial/rx_buff.c \
+$(RCP_SRC)/serial/serial.c \
+$(RCP_SRC)/serial/serial_buffer.c \
+$(RCP_SRC)/system/boot_stats.c \
+$(RCP_SRC)/system/flags.c \
+$(RCP_SRC)/system/perf.c \
+$(RCP_SRC)/system/perf_region.c \
+$(RCP_SRC)/system/trace.c \
+$(RCP_SRC)/tasks/wifi.c \
+$(RCP_SRC)/timer/timer.c \
+$(RCP_SRC)/timer/timer_config.c \
+$(RCP_SRC)/tracks/tracks.c \
+$(RCP_SRC)/units/units.c \
+$(RCP_SRC)/units/units_conversion.c \
+$(RCP_SRC)/usart/usart.c \
+$(RCP_SRC)/usb_comm/usb_comm.c \
+$(RCP_SRC)/util/FreeRTOS-openocd.c \
+$(RCP_SRC)/util/block_pool.c \
+$(RCP_SRC)/util/byteswap.c \
+$(RCP_SRC)/util/convert.c \
+$(RCP_SRC)/util/crc32.c \
+$(RCP_SRC)/util/linear_interpolate.c \
+$(RCP_SRC)/util/modp_numtoa.c \
+$(RCP_SRC)/util/panic.c \
+$(RCP_SRC)/util/ring_buffer.c \
+$(RCP_SRC)/util/str_util.c \
+$(RCP_SRC)/util/taskUtil.c \
+$(RCP_SRC)/util/ts_ring_buff.c \
+$(RCP_SRC)/virtual_channel/virtual_channel.c \
+$(RCP_SRC)/watchdog/watchdog.c \
+
+
+# Adds this directory to the global application includes
+APP_INCLUDES += \
+-I$(APP_PATH) \
+-I$(HAL_SRC)/fat_sd_linux \
+-I$(HAL_SRC)/gps_linux \
+-I$(HAL_SRC)/pty_linux \
+-I$(MK2_HAL_SRC)/fat_sd_stm32/ \
+-I$(MK2_HAL_SRC)/fat_sd_stm32/fatfs \
+-I$(MK2_HAL_SRC)/fat_sd_stm32/fatfs/drivers \
+-I$(MK2_HAL_SRC)/fat_sd_stm32/fatfs/option \
+-I$(INCLUDE_DIR) \
+-I$(INCLUDE_DIR)/ADC \
+-I$(INCLUDE_DIR)/CAN \
+-I$(INCLUDE_DIR)/GPIO \
+-I$(INCLUDE_DIR)/LED \
+-I$(INCLUDE_DIR)/OBD2 \
+-I$(INCLUDE_DIR)/PWM \
+-I$(INCLUDE_DIR)/api \
+-I$(INCLUDE_DIR)/auto_config \
+-I$(INCLUDE_DIR)/channels \
+-I$(INCLUDE_DIR)/command \
+-I$(INCLUDE_DIR)/cpu \
+-I$(INCLUDE_DIR)/devices \
+-I$(INCLUDE_DIR)/drivers \
+-I$(INCLUDE_DIR)/filter \
+-I$(INCLUDE_DIR)/gps \
+-I$(INCLUDE_DIR)/gsm \
+-I$(INCLUDE_DIR)/imu \
+-I$(INCLUDE_DIR)/jsmn \
+-I$(INCLUDE_DIR)/lap_stats \
+-I$(INCLUDE_DIR)/logger \
+-I$(INCLUDE_DIR)/logging \
+-I$(INCLUDE_DIR)/lua \
+-I$(INCLUDE_DIR)/magic \
+-I$(INCLUDE_DIR)/memory \
+-I$(INCLUDE_DIR)/messaging \
+-I$(INCLUDE_DIR)/modem \
+-I$(INCLUDE_DIR)/predictive_timer \
+-I$(INCLUDE_DIR)/sdcard \
+-I$(INCLUDE_DIR)/serial \
+-I$(INCLUDE_DIR)/spi \
+-I$(INCLUDE_DIR)/system \
+-I$(INCLUDE_DIR)/tasks \
+-I$(INCLUDE_DIR)/timer \
+-I$(INCLUDE_DIR)/tracks \
+-I$(INCLUDE_DIR)/units \
+-I$(INCLUDE_DIR)/usart \
+-I$(INCLUDE_DIR)/usb_comm \
+-I$(INCLUDE_DIR)/util \
+-I$(INCLUDE_DIR)/virtual_channel \
+-I$(INCLUDE_DIR)/watchdog \
+-I$(PLATFORM_DIR) \
+-I$(MK2_DIR)/libs/FreeRTOSV7.6.0/FreeRTOS/Source/portable/MemMang \
+-I$(PLATFORM_DIR)/mem_mang \
+-I$(LUA_DIR)
+
+# Lua is built from source along with the rest of the firmware, using
+# the same options the MK2 library build uses.
+LUA_DIR := $(APP_PATH)/lib/lua/src
+LUA_SRC = $(addprefix $(LUA_DIR)/, \
+lapi.c lcode.c ldebug.c ldo.c ldump.c lfunc.c lgc.c llex.c lmem.c \
+lobject.c lopcodes.c lparser.c lstate.c lstring.c ltable.c ltm.c \
+lundump.c lvm.c lzio.c lrotable.c \
+lauxlib.c lbaselib.c ldblib.c lmathlib.c loslib.c ltablib.c \
+lstrlib.c loadlib.c linit.c bit.c)
+LUA_DEFINES = -DLUA_OPTIMIZE_MEMORY=0 -DLUA_USE_MKSTEMP=1
+
+APP_SRC += $(LUA_SRC)
+
+APP_DEFINES += -DHEAP_SIZE=$(HEAP_SIZE) $(VERSION_CFLAGS)
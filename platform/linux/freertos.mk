@@ -0,0 +1,31 @@
+# FreeRTOS configuration file for the Linux platform
+#
+# The kernel sources are shared with the MK2 so that the Linux build
+# runs exactly the scheduler the hardware does.  Only the port differs:
+# tasks are pthreads and the tick is SIGALRM (see port/port.c).
+
+ifneq ($(FREERTOS),)
+
+FREERTOS_SOURCE ?= $(APP_PATH)/platform/mk2/libs/$(FREERTOS)/FreeRTOS/Source
+rtos_srcs = croutine.c list.c queue.c tasks.c timers.c
+
+RTOS_PORT_SRC = port/port.c
+
+#If no heap implementation has been defined, choose heap 4
+ifeq ($(FREERTOS_HEAP),)
+FREERTOS_HEAP = heap_4
+endif
+
+FREERTOS_SRCS += $(FREERTOS_SOURCE)/portable/MemMang/$(FREERTOS_HEAP).c $(RTOS_PORT_SRC)
+
+#All of the standard sources
+FREERTOS_SRCS += $(addprefix $(FREERTOS_SOURCE)/,$(rtos_srcs))
+FREERTOS_OBJS = $(sort $(FREERTOS_SRCS:.c=.o))
+
+#FreeRTOS Includes
+LIB_INCLUDES += -I$(FREERTOS_SOURCE)/include \
+	-Iport
+
+BASE_LIBS += freertos
+
+endif
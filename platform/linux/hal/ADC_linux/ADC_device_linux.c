@@ -0,0 +1,67 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ADC_device.h"
+#include "capabilities.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define ADC_PORT_VOLTAGE_RANGE 		5.0f
+#define ADC_SYSTEM_VOLTAGE_RANGE	20.0f
+#define ADC_SYSTEM_VOLTAGE_CHANNEL	7
+#define SCALING_5V 	       		0.00122070312f
+#define SCALING_20V    			0.0048828125f
+
+/* 12.5V on the battery channel, mid scale on the rest */
+#define ADC_BATTERY_COUNTS		2560
+#define ADC_PORT_COUNTS			2048
+
+int ADC_device_init(void)
+{
+        return 1;
+}
+
+/**
+ * Analog inputs have nothing attached on the host, so each reads a
+ * fixed value with a little noise to keep the filters honest.
+ */
+int ADC_device_sample(const size_t channel)
+{
+        if (channel >= ANALOG_CHANNELS)
+                return -1;
+
+        const int counts = channel == ADC_SYSTEM_VOLTAGE_CHANNEL ?
+                ADC_BATTERY_COUNTS : ADC_PORT_COUNTS;
+        return counts + (rand() & 0x7) - 4;
+}
+
+float ADC_device_get_voltage_range(const size_t channel)
+{
+        return channel == ADC_SYSTEM_VOLTAGE_CHANNEL ?
+                ADC_SYSTEM_VOLTAGE_RANGE : ADC_PORT_VOLTAGE_RANGE;
+}
+
+float ADC_device_get_channel_scaling(const size_t channel)
+{
+        return channel == ADC_SYSTEM_VOLTAGE_CHANNEL ?
+                SCALING_20V : SCALING_5V;
+}
@@ -0,0 +1,285 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CAN_device.h"
+#include "FreeRTOS.h"
+#include "capabilities.h"
+#include "perf.h"
+#include "printk.h"
+#include "queue.h"
+#include "task.h"
+#include "taskUtil.h"
+#include "trace.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/*
+ * Each CAN channel is a SocketCAN raw socket, bound to the interface
+ * named by $RCP_CAN0 / $RCP_CAN1 (vcan0 / vcan1 by default).  Set the
+ * interfaces up before starting, e.g.
+ *
+ *   ip link add dev vcan0 type vcan && ip link set up vcan0
+ *
+ * The hardware filter banks map onto CAN_RAW_FILTER so the kernel drops
+ * what the STM32 would have, and a poll ISR plays the part of the rx
+ * interrupt.
+ */
+
+#define _LOG_PFX  "[CAN device] "
+
+static xQueueHandle can_rx_queue = NULL;
+
+#define CAN_FILTER_COUNT    13
+#define CAN_QUEUE_LENGTH    10
+
+static struct can_channel {
+        int fd;
+        struct can_filter filters[CAN_FILTER_COUNT];
+        bool enabled[CAN_FILTER_COUNT];
+} can_channels[CAN_CHANNELS] = {
+        [0 ... CAN_CHANNELS - 1] = { .fd = -1 },
+};
+
+static bool init_queue()
+{
+        if (!can_rx_queue)
+                can_rx_queue = xQueueCreate(CAN_QUEUE_LENGTH, sizeof(CAN_msg));
+        perf_register_queue("CAN", "rx", can_rx_queue, CAN_QUEUE_LENGTH);
+        return can_rx_queue != NULL;
+}
+
+static int open_socket(const uint8_t channel)
+{
+        char env[16];
+        char dflt[IFNAMSIZ];
+        snprintf(env, sizeof(env), "RCP_CAN%u", channel);
+        snprintf(dflt, sizeof(dflt), "vcan%u", channel);
+        const char *ifname = getenv(env) ? getenv(env) : dflt;
+
+        const int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+        if (fd < 0)
+                return -1;
+
+        struct ifreq ifr;
+        memset(&ifr, 0, sizeof(ifr));
+        strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+
+        struct sockaddr_can addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.can_family = AF_CAN;
+
+        if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0)
+                goto open_fail;
+
+        addr.can_ifindex = ifr.ifr_ifindex;
+        if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+            fcntl(fd, F_SETFL, O_NONBLOCK) < 0)
+                goto open_fail;
+
+        pr_info_str_msg(_LOG_PFX "Bound to ", ifname);
+        return fd;
+
+open_fail:
+        pr_error_str_msg(_LOG_PFX "Can't open ", ifname);
+        close(fd);
+        return -1;
+}
+
+static void apply_filters(struct can_channel *cc)
+{
+        struct can_filter active[CAN_FILTER_COUNT];
+        size_t count = 0;
+
+        for (size_t i = 0; i < CAN_FILTER_COUNT; ++i) {
+                if (cc->enabled[i])
+                        active[count++] = cc->filters[i];
+        }
+
+        /* No filters means no frames, as with every bank disabled */
+        setsockopt(cc->fd, SOL_CAN_RAW, CAN_RAW_FILTER, active,
+                   count * sizeof(*active));
+}
+
+static void process_can_rx(const uint8_t can_bus, const int fd)
+{
+        struct can_frame frame;
+
+        for (size_t i = 0; i < CAN_QUEUE_LENGTH; ++i) {
+                if (read(fd, &frame, sizeof(frame)) != sizeof(frame))
+                        return;
+
+                if (frame.can_id & (CAN_ERR_FLAG | CAN_RTR_FLAG))
+                        continue;
+
+                /* translate into a higher level CAN message */
+                TRACE_ISR_ENTER(TRACE_ISR_CAN, can_bus);
+                portBASE_TYPE task_woken_by_rx = pdFALSE;
+                CAN_msg can_msg;
+                can_msg.can_bus = can_bus;
+                can_msg.isExtendedAddress = !!(frame.can_id & CAN_EFF_FLAG);
+                can_msg.addressValue = frame.can_id &
+                        (can_msg.isExtendedAddress ? CAN_EFF_MASK : CAN_SFF_MASK);
+                memcpy(can_msg.data, frame.data, frame.can_dlc);
+                can_msg.dataLength = frame.can_dlc;
+
+                if (!xQueueSendFromISR(can_rx_queue, &can_msg, &task_woken_by_rx))
+                        perf_count(PERF_COUNTER_CAN_RX_DROP);
+                TRACE_ISR_EXIT(TRACE_ISR_CAN, can_bus);
+        }
+}
+
+static void can_poll_isr(void)
+{
+        for (size_t i = 0; i < CAN_CHANNELS; ++i) {
+                if (can_channels[i].fd >= 0)
+                        process_can_rx(i, can_channels[i].fd);
+        }
+}
+
+int CAN_device_init(const uint8_t channel, const uint32_t baud, const bool termination_enabled)
+{
+        pr_info(_LOG_PFX "Initializing CAN");
+        pr_info_int(channel);
+        pr_info_int_msg(" with baud rate ", baud);
+
+        if (!init_queue()) {
+            pr_info(_LOG_PFX "CAN init queue failed\r\n");
+            return 0;
+        }
+
+        /* Baud rate and termination mean nothing on a virtual bus */
+        const int fd = channel < CAN_CHANNELS ? open_socket(channel) : -1;
+        if (fd < 0) {
+            pr_info(_LOG_PFX "CAN init device failed\r\n");
+            return 0;
+        }
+
+        struct can_channel *cc = can_channels + channel;
+        taskENTER_CRITICAL();
+        const int old_fd = cc->fd;
+        cc->fd = fd;
+        taskEXIT_CRITICAL();
+        if (old_fd >= 0)
+                close(old_fd);
+
+        /* Clear out all filter values except 0.  It accepts all. */
+        CAN_device_set_filter(channel, 0, 1, 0, 0, true);
+        for (size_t i = 1; i < CAN_FILTER_COUNT; ++i)
+            CAN_device_set_filter(channel, i, 0, 0, 0, false);
+
+        xPortRegisterPollIsr(can_poll_isr);
+
+        pr_info(_LOG_PFX "CAN init success!\r\n");
+        return 1;
+}
+
+int CAN_device_set_filter(const uint8_t channel, const uint8_t id, const uint8_t extended,
+              const uint32_t filter, const uint32_t mask, const bool enabled)
+{
+        if (channel >= CAN_CHANNELS)
+            return 0;
+
+        if (id >= CAN_FILTER_COUNT)
+            return 0;
+
+        struct can_channel *cc = can_channels + channel;
+        struct can_filter *f = cc->filters + id;
+
+        /*
+         * A zero mask matches every frame, standard or extended, just
+         * like the STM32 filter banks.  Otherwise the frame format must
+         * match too.
+         */
+        f->can_id = filter;
+        f->can_mask = mask;
+        if (mask) {
+                f->can_mask |= CAN_EFF_FLAG;
+                if (extended)
+                        f->can_id |= CAN_EFF_FLAG;
+        }
+        cc->enabled[id] = enabled;
+
+        if (cc->fd >= 0)
+                apply_filters(cc);
+
+        return 1;
+}
+
+int CAN_device_tx_msg(const uint8_t channel, const CAN_msg * msg, const unsigned int timeout_ms)
+{
+        if (channel >= CAN_CHANNELS || can_channels[channel].fd < 0)
+                return 0;
+
+        struct can_frame frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.can_id = msg->addressValue;
+        if (msg->isExtendedAddress)
+                frame.can_id |= CAN_EFF_FLAG;
+        frame.can_dlc = msg->dataLength;
+        memcpy(frame.data, msg->data, msg->dataLength);
+
+        /* Using ticks avoids a race-condition */
+        size_t ticks = getCurrentTicks();
+        const size_t trigger = ticks + msToTicks(timeout_ms);
+
+        while (true) {
+                if (write(can_channels[channel].fd, &frame, sizeof(frame)) ==
+                    sizeof(frame))
+                        return 1;
+
+                /* A full tx queue is the closest thing to no mailbox */
+                if (errno != ENOBUFS && errno != EAGAIN)
+                        return 0;
+
+                if (ticks >= trigger)
+                        return 0;
+
+                /*
+                 * Not using yield here as it will cause lower priority tasks
+                 * to starve.  Yield only allows tasks of equal or greater
+                 * priority to run.
+                 */
+                delayTicks(1);
+
+                ticks = getCurrentTicks();
+        }
+}
+
+int CAN_device_rx_msg(CAN_msg * msg, const unsigned int timeout_ms)
+{
+        if (pdTRUE == xQueueReceive(can_rx_queue, msg, msToTicks(timeout_ms))) {
+            return 1;
+        } else {
+            pr_debug(_LOG_PFX "timeout rx CAN msg\r\n");
+            return 0;
+        }
+}
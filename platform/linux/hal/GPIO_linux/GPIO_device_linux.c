@@ -0,0 +1,47 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GPIO_device.h"
+#include "capabilities.h"
+
+static unsigned int gpio_state[GPIO_CHANNELS];
+
+int GPIO_device_init(LoggerConfig *loggerConfig)
+{
+        return 1;
+}
+
+/* Outputs read back what was last written; inputs read low */
+unsigned int GPIO_device_get(unsigned int port)
+{
+        return port < GPIO_CHANNELS ? gpio_state[port] : 0;
+}
+
+void GPIO_device_set(unsigned int port, unsigned int state)
+{
+        if (port < GPIO_CHANNELS)
+                gpio_state[port] = state;
+}
+
+int GPIO_device_is_button_pressed(void)
+{
+        return 0;
+}
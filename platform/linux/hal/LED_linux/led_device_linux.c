@@ -0,0 +1,71 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "led.h"
+#include "led_device.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define LED_COUNT	(LED_CAN + 1)
+
+static bool led_state[LED_COUNT];
+
+static bool led_in_bounds(const enum led l)
+{
+        return l >= 0 && l < LED_COUNT;
+}
+
+bool led_device_set_index(const size_t i, const bool on)
+{
+        return led_device_set((enum led) i, on);
+}
+
+bool led_device_available(const enum led l)
+{
+        return led_in_bounds(l);
+}
+
+bool led_device_set(const enum led l, const bool on)
+{
+        if (!led_in_bounds(l))
+                return false;
+
+        led_state[l] = on;
+        return true;
+}
+
+bool led_device_toggle(const enum led l)
+{
+        return led_in_bounds(l) && led_device_set(l, !led_state[l]);
+}
+
+void led_device_set_all(const bool on)
+{
+        for (size_t i = 0; i < LED_COUNT; ++i)
+                led_state[i] = on;
+}
+
+bool led_device_init(void)
+{
+        led_device_set_all(false);
+        return true;
+}
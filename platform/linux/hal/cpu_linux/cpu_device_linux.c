@@ -0,0 +1,81 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cpu_device.h"
+#include "printk.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SERIAL_ID_BUFFER_LEN	25
+
+static char cpu_id[SERIAL_ID_BUFFER_LEN];
+
+int cpu_device_init(void)
+{
+        /* The host id stands in for the STM32 unique id registers */
+        snprintf(cpu_id, sizeof(cpu_id), "LINUX%08lX%011u",
+                 (unsigned long) gethostid() & 0xFFFFFFFFul,
+                 (unsigned int) getpid());
+        return 1;
+}
+
+/**
+ * There is no bootloader on the host, so either kind of reset ends
+ * the process.  Exit code 2 tells a wrapper script to restart us.
+ */
+void cpu_device_reset(int bootloader)
+{
+        fflush(NULL);
+        exit(bootloader ? 0 : 2);
+}
+
+const char *cpu_device_get_serialnumber(void)
+{
+        return cpu_id;
+}
+
+void cpu_device_spin(uint32_t ms)
+{
+        struct timespec ts = {
+                .tv_sec = ms / 1000,
+                .tv_nsec = (ms % 1000) * 1000000l,
+        };
+
+        while (nanosleep(&ts, &ts));
+}
+
+void cpu_device_cycle_counter_init(void) {}
+
+/* The host has no cycle counter, so count nanoseconds instead */
+uint32_t cpu_device_cycle_count(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+uint32_t cpu_device_cycle_hz(void)
+{
+        return 1000000000;
+}
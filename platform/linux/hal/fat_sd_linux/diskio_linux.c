@@ -0,0 +1,141 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * FatFs disk I/O on a FAT image file.  Only drive 0, the SD card, is
+ * backed; the image is accessed with plain pread/pwrite so the file
+ * system code above runs exactly as it does on the card.  Create one
+ * with e.g.
+ *
+ *   truncate -s 512M sdcard.img && mkfs.vfat sdcard.img
+ */
+
+#include "diskio.h"
+#include "diskio_linux.h"
+#include "ff.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SD_DRIVE		0
+#define SD_SECTOR_SIZE		512
+/* Erase block size in sectors, as reported by a typical SD card */
+#define SD_BLOCK_SIZE		128
+
+static int image_fd = -1;
+
+static const char* image_path(void)
+{
+        const char *path = getenv("RCP_SD_IMAGE");
+        return path ? path : "sdcard.img";
+}
+
+bool diskio_linux_open_image(void)
+{
+        if (image_fd >= 0)
+                close(image_fd);
+
+        image_fd = open(image_path(), O_RDWR);
+        return image_fd >= 0;
+}
+
+bool diskio_linux_image_present(void)
+{
+        return access(image_path(), R_OK | W_OK) == 0;
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+        if (SD_DRIVE != pdrv)
+                return STA_NOINIT;
+
+        if (image_fd < 0 && !diskio_linux_open_image())
+                return STA_NOINIT | STA_NODISK;
+
+        return 0;
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+        if (SD_DRIVE != pdrv)
+                return STA_NOINIT;
+
+        return image_fd < 0 ? STA_NOINIT : 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+{
+        if (SD_DRIVE != pdrv || !count)
+                return RES_PARERR;
+
+        if (image_fd < 0)
+                return RES_NOTRDY;
+
+        const size_t len = (size_t) count * SD_SECTOR_SIZE;
+        const off_t offset = (off_t) sector * SD_SECTOR_SIZE;
+        return pread(image_fd, buff, len, offset) == (ssize_t) len ?
+                RES_OK : RES_ERROR;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+{
+        if (SD_DRIVE != pdrv || !count)
+                return RES_PARERR;
+
+        if (image_fd < 0)
+                return RES_NOTRDY;
+
+        const size_t len = (size_t) count * SD_SECTOR_SIZE;
+        const off_t offset = (off_t) sector * SD_SECTOR_SIZE;
+        return pwrite(image_fd, buff, len, offset) == (ssize_t) len ?
+                RES_OK : RES_ERROR;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
+{
+        if (SD_DRIVE != pdrv)
+                return RES_PARERR;
+
+        if (image_fd < 0)
+                return RES_NOTRDY;
+
+        struct stat st;
+        switch (cmd) {
+        case CTRL_SYNC:
+                return fdatasync(image_fd) ? RES_ERROR : RES_OK;
+        case GET_SECTOR_COUNT:
+                if (fstat(image_fd, &st))
+                        return RES_ERROR;
+
+                *(DWORD*) buff = st.st_size / SD_SECTOR_SIZE;
+                return RES_OK;
+        case GET_SECTOR_SIZE:
+                *(WORD*) buff = SD_SECTOR_SIZE;
+                return RES_OK;
+        case GET_BLOCK_SIZE:
+                *(DWORD*) buff = SD_BLOCK_SIZE;
+                return RES_OK;
+        default:
+                return RES_PARERR;
+        }
+}
@@ -0,0 +1,44 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DISKIO_LINUX_H_
+#define _DISKIO_LINUX_H_
+
+#include "cpp_guard.h"
+#include <stdbool.h>
+
+CPP_GUARD_BEGIN
+
+/**
+ * Opens the disk image that stands in for the SD card.  The image is
+ * $RCP_SD_IMAGE, or sdcard.img in the working directory.
+ * @return true if the image could be opened read/write.
+ */
+bool diskio_linux_open_image(void);
+
+/**
+ * @return true if the disk image exists.
+ */
+bool diskio_linux_image_present(void);
+
+CPP_GUARD_END
+
+#endif /* _DISKIO_LINUX_H_ */
@@ -0,0 +1,35 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "diskio_linux.h"
+#include "printk.h"
+#include "sdcard_device.h"
+
+void disk_init_hardware(void)
+{
+        if (!diskio_linux_open_image())
+                pr_warning("[sdcard] No disk image, see $RCP_SD_IMAGE\r\n");
+}
+
+bool sdcard_device_card_present(void)
+{
+        return diskio_linux_image_present();
+}
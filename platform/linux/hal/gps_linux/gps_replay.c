@@ -0,0 +1,522 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "gps_replay.h"
+#include "macros.h"
+#include "printk.h"
+#include "skytraq_frame.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_PFX			"[GPS replay] "
+#define DEFAULT_BAUD		115200
+#define FACTORY_BAUD		9600
+#define DEFAULT_UPDATE_RATE	1
+#define TX_BUFF_LEN		1024
+#define RX_PAYLOAD_LEN		64
+#define LINE_BUFF_LEN		4096
+#define KPH_PER_MPH		1.609344f
+#define GNSS_EPOCH_MS		315964800000ull
+#define GNSS_WEEK_MS		604800000ull
+
+#define MSG_ID_SET_FACTORY_DEFAULTS		0x04
+#define MSG_ID_CONFIGURE_SERIAL_PORT		0x05
+#define MSG_ID_CONFIGURE_MESSAGE_TYPE		0x09
+#define MSG_ID_CONFIGURE_POSITION_UPDATE_RATE	0x0E
+#define MSG_ID_QUERY_SW_VERSION			0x02
+#define MSG_ID_QUERY_POSITION_UPDATE_RATE	0x10
+#define MSG_ID_CONFIGURE_NAV_INTERVAL		0x11
+#define MSG_ID_CONFIGURE_NMEA_MESSAGE		0x08
+#define MSG_ID_CONFIGURE_GNSS_NAV_MODE		0x64
+#define MSG_ID_SW_VERSION			0x80
+#define MSG_ID_ACK				0x83
+#define MSG_ID_NACK				0x84
+#define MSG_ID_POSITION_UPDATE_RATE		0x86
+#define MSG_ID_NAVIGATION_DATA_MESSAGE		0xA8
+#define MESSAGE_TYPE_BINARY			2
+
+/* Index is the baud rate code of the Configure Serial Port message */
+static const size_t baud_rates[] = {
+        4800, 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600,
+};
+
+struct replay_fix {
+        uint64_t utc;
+        int32_t latitude;
+        int32_t longitude;
+        int32_t altitude_cm;
+        int32_t speed_cms;
+        uint16_t dop;
+        uint8_t satellites;
+        uint8_t quality;
+};
+
+static struct {
+        struct replay_fix *fixes;
+        size_t fix_count;
+        size_t fix_idx;
+        uint64_t start_utc;
+
+        size_t baud;
+        size_t pending_baud;
+        uint8_t update_rate;
+        uint8_t nav_interval;
+        bool binary;
+        uint32_t ms;
+        uint32_t ms_until_fix;
+        uint32_t fixes_until_nav;
+
+        struct skytraq_frame_parser parser;
+        uint8_t rx_payload[RX_PAYLOAD_LEN];
+
+        uint8_t tx_buff[TX_BUFF_LEN];
+        size_t tx_head;
+        size_t tx_tail;
+} module;
+
+/* *** Log loading *** */
+
+struct replay_columns {
+        int utc;
+        int latitude;
+        int longitude;
+        int speed;
+        int altitude;
+        int sats;
+        int quality;
+        int dop;
+        float speed_scale;
+};
+
+/**
+ * Splits a CSV line in place.  Empty cells become empty strings.
+ * @return The number of cells found.
+ */
+static size_t split_cells(char *line, char **cells, const size_t max)
+{
+        size_t count = 0;
+        line[strcspn(line, "\r\n")] = '\0';
+
+        while (count < max) {
+                cells[count++] = line;
+                char *comma = strchr(line, ',');
+                if (!comma)
+                        break;
+
+                *comma = '\0';
+                line = comma + 1;
+        }
+
+        return count;
+}
+
+static bool parse_header(char *line, struct replay_columns *cols)
+{
+        char *cells[256];
+        const size_t count = split_cells(line, cells, ARRAY_LEN(cells));
+
+        cols->utc = cols->latitude = cols->longitude = cols->speed = -1;
+        cols->altitude = cols->sats = cols->quality = cols->dop = -1;
+        cols->speed_scale = 1.0f;
+
+        for (size_t i = 0; i < count; ++i) {
+                /* Cells look like "Name"|"units"|min|max|sampleRate */
+                const char *name = cells[i];
+                const char *units = strchr(name, '|');
+                const size_t len = units ? (size_t) (units - name) :
+                        strlen(name);
+
+                if (!strncmp(name, "\"Utc\"", len)) {
+                        cols->utc = i;
+                } else if (!strncmp(name, "\"Latitude\"", len)) {
+                        cols->latitude = i;
+                } else if (!strncmp(name, "\"Longitude\"", len)) {
+                        cols->longitude = i;
+                } else if (!strncmp(name, "\"Speed\"", len)) {
+                        cols->speed = i;
+                        if (units && !strncmp(units, "|\"MPH\"", 6))
+                                cols->speed_scale = KPH_PER_MPH;
+                } else if (!strncmp(name, "\"Altitude\"", len)) {
+                        cols->altitude = i;
+                } else if (!strncmp(name, "\"GPSSats\"", len)) {
+                        cols->sats = i;
+                } else if (!strncmp(name, "\"GPSQual\"", len)) {
+                        cols->quality = i;
+                } else if (!strncmp(name, "\"GPSDOP\"", len)) {
+                        cols->dop = i;
+                }
+        }
+
+        return cols->utc >= 0 && cols->latitude >= 0 &&
+                cols->longitude >= 0 && cols->speed >= 0;
+}
+
+static const char* cell(char **cells, const size_t count, const int col)
+{
+        if (col < 0 || (size_t) col >= count || !*cells[col])
+                return NULL;
+
+        return cells[col];
+}
+
+static bool parse_fix(char *line, const struct replay_columns *cols,
+                      struct replay_fix *fix)
+{
+        char *cells[256];
+        const size_t count = split_cells(line, cells, ARRAY_LEN(cells));
+
+        const char *utc = cell(cells, count, cols->utc);
+        const char *lat = cell(cells, count, cols->latitude);
+        const char *lon = cell(cells, count, cols->longitude);
+        const char *speed = cell(cells, count, cols->speed);
+        if (!utc || !lat || !lon || !speed)
+                return false;
+
+        const char *alt = cell(cells, count, cols->altitude);
+        const char *sats = cell(cells, count, cols->sats);
+        const char *quality = cell(cells, count, cols->quality);
+        const char *dop = cell(cells, count, cols->dop);
+
+        fix->utc = strtoull(utc, NULL, 10);
+        fix->latitude = lround(atof(lat) * 1e7);
+        fix->longitude = lround(atof(lon) * 1e7);
+        /* km/h to cm/s */
+        fix->speed_cms = lround(atof(speed) * cols->speed_scale / 0.036);
+        fix->altitude_cm = alt ? lround(atof(alt) * 100) : 0;
+        fix->satellites = sats ? atoi(sats) : 8;
+        fix->quality = quality ? atoi(quality) : 2;
+        fix->dop = lround((dop ? atof(dop) : 1.0) * 100);
+
+        return true;
+}
+
+static bool load_fixes(const char *path)
+{
+        FILE *f = fopen(path, "r");
+        if (!f) {
+                pr_error_str_msg(LOG_PFX "Can't open ", path);
+                return false;
+        }
+
+        static char line[LINE_BUFF_LEN];
+        size_t cap = 0;
+        struct replay_columns cols;
+        bool ok = fgets(line, sizeof(line), f) && parse_header(line, &cols);
+        if (!ok)
+                pr_error_str_msg(LOG_PFX "No GPS channels in ", path);
+
+        while (ok && fgets(line, sizeof(line), f)) {
+                struct replay_fix fix;
+                if (line[0] == '#' || !parse_fix(line, &cols, &fix))
+                        continue;
+
+                if (module.fix_count == cap) {
+                        cap = cap ? cap * 2 : 256;
+                        struct replay_fix *fixes =
+                                realloc(module.fixes, cap * sizeof(fix));
+                        if (!fixes) {
+                                ok = false;
+                                break;
+                        }
+                        module.fixes = fixes;
+                }
+
+                module.fixes[module.fix_count++] = fix;
+        }
+
+        fclose(f);
+
+        if (ok && !module.fix_count) {
+                pr_error_str_msg(LOG_PFX "No fixes in ", path);
+                ok = false;
+        }
+
+        if (ok) {
+                pr_info_str_msg(LOG_PFX "Replaying ", path);
+                pr_info_int_msg(LOG_PFX "Fixes: ", module.fix_count);
+                module.start_utc = module.fixes[0].utc;
+        }
+
+        return ok;
+}
+
+/* *** Transmit side *** */
+
+static void tx_put(const uint8_t b)
+{
+        const size_t next = (module.tx_head + 1) % TX_BUFF_LEN;
+        if (next == module.tx_tail)
+                return;
+
+        module.tx_buff[module.tx_head] = b;
+        module.tx_head = next;
+}
+
+static void tx_frame(const uint8_t *payload, const uint16_t len)
+{
+        uint8_t checksum = 0;
+
+        tx_put(SKYTRAQ_FRAME_SYNC1);
+        tx_put(SKYTRAQ_FRAME_SYNC2);
+        tx_put(len >> 8);
+        tx_put(len & 0xFF);
+        for (uint16_t i = 0; i < len; ++i) {
+                tx_put(payload[i]);
+                checksum ^= payload[i];
+        }
+        tx_put(checksum);
+        tx_put('\r');
+        tx_put('\n');
+}
+
+static uint8_t* put_u16(uint8_t *p, const uint16_t v)
+{
+        *p++ = v >> 8;
+        *p++ = v;
+        return p;
+}
+
+static uint8_t* put_u32(uint8_t *p, const uint32_t v)
+{
+        p = put_u16(p, v >> 16);
+        return put_u16(p, v);
+}
+
+static void tx_ack(const uint8_t id, const bool ack)
+{
+        const uint8_t payload[] = { ack ? MSG_ID_ACK : MSG_ID_NACK, id };
+        tx_frame(payload, sizeof(payload));
+}
+
+static void tx_sw_version(void)
+{
+        uint8_t payload[14] = { MSG_ID_SW_VERSION, 1 };
+        uint8_t *p = payload + 2;
+        p = put_u32(p, 0x00010000);     /* Kernel version */
+        p = put_u32(p, 0x00010000);     /* ODM version */
+        put_u32(p, 0x00100101);         /* Revision yy.mm.dd */
+        tx_frame(payload, sizeof(payload));
+}
+
+static void tx_nav(const uint64_t utc, const struct replay_fix *fix)
+{
+        uint8_t payload[59];
+        uint8_t *p = payload;
+        const uint64_t gnss_ms = utc - GNSS_EPOCH_MS;
+        const int32_t alt_cm = fix ? fix->altitude_cm : 0;
+        const uint16_t dop = fix ? fix->dop : 9999;
+
+        *p++ = MSG_ID_NAVIGATION_DATA_MESSAGE;
+        *p++ = fix ? fix->quality : 0;
+        *p++ = fix ? fix->satellites : 0;
+        p = put_u16(p, gnss_ms / GNSS_WEEK_MS);
+        p = put_u32(p, (gnss_ms % GNSS_WEEK_MS) / 10);
+        p = put_u32(p, fix ? fix->latitude : 0);
+        p = put_u32(p, fix ? fix->longitude : 0);
+        p = put_u32(p, alt_cm);
+        p = put_u32(p, alt_cm);
+        for (int i = 0; i < 5; ++i)
+                p = put_u16(p, dop);
+
+        /* ECEF position is not used by the firmware */
+        for (int i = 0; i < 3; ++i)
+                p = put_u32(p, 0);
+
+        /* Speed is the magnitude of the velocity, so one axis will do */
+        p = put_u32(p, fix ? fix->speed_cms : 0);
+        p = put_u32(p, 0);
+        put_u32(p, 0);
+
+        tx_frame(payload, sizeof(payload));
+}
+
+/**
+ * Picks the fix for the current replay time.  The log loops forever;
+ * time keeps moving forward across the wrap.
+ */
+static const struct replay_fix* current_fix(uint64_t *utc)
+{
+        *utc = module.start_utc + module.ms;
+        if (!module.fix_count)
+                return NULL;
+
+        const uint64_t log_start = module.fixes[0].utc;
+        const uint64_t log_len =
+                module.fixes[module.fix_count - 1].utc - log_start + 1;
+        const uint64_t log_time = log_start + module.ms % log_len;
+
+        if (module.fixes[module.fix_idx].utc > log_time)
+                module.fix_idx = 0;
+
+        while (module.fix_idx + 1 < module.fix_count &&
+               module.fixes[module.fix_idx + 1].utc <= log_time)
+                ++module.fix_idx;
+
+        return module.fixes + module.fix_idx;
+}
+
+/* *** Receive side *** */
+
+static void handle_message(const uint8_t *payload, const uint16_t len)
+{
+        const uint8_t id = payload[0];
+
+        switch (id) {
+        case MSG_ID_QUERY_SW_VERSION:
+                tx_sw_version();
+                return;
+        case MSG_ID_QUERY_POSITION_UPDATE_RATE: {
+                const uint8_t reply[] = {
+                        MSG_ID_POSITION_UPDATE_RATE, module.update_rate,
+                };
+                tx_frame(reply, sizeof(reply));
+                return;
+        }
+        case MSG_ID_SET_FACTORY_DEFAULTS:
+                tx_ack(id, true);
+                module.pending_baud = FACTORY_BAUD;
+                gps_replay_reset();
+                return;
+        case MSG_ID_CONFIGURE_SERIAL_PORT:
+                if (len < 3 || payload[2] >= ARRAY_LEN(baud_rates))
+                        break;
+
+                /* The ACK goes out at the old rate */
+                tx_ack(id, true);
+                module.pending_baud = baud_rates[payload[2]];
+                return;
+        case MSG_ID_CONFIGURE_POSITION_UPDATE_RATE:
+                if (len < 2 || !payload[1] || payload[1] > 50)
+                        break;
+
+                module.update_rate = payload[1];
+                tx_ack(id, true);
+                return;
+        case MSG_ID_CONFIGURE_MESSAGE_TYPE:
+                if (len < 2)
+                        break;
+
+                module.binary = payload[1] == MESSAGE_TYPE_BINARY;
+                tx_ack(id, true);
+                return;
+        case MSG_ID_CONFIGURE_NAV_INTERVAL:
+                if (len < 2)
+                        break;
+
+                module.nav_interval = payload[1];
+                module.fixes_until_nav = 0;
+                tx_ack(id, true);
+                return;
+        case MSG_ID_CONFIGURE_NMEA_MESSAGE:
+        case MSG_ID_CONFIGURE_GNSS_NAV_MODE:
+                /* We never produce NMEA and the nav mode changes nothing */
+                tx_ack(id, true);
+                return;
+        default:
+                break;
+        }
+
+        tx_ack(id, false);
+}
+
+/* *** Public Methods *** */
+
+bool gps_replay_init(const char *path)
+{
+        module.baud = DEFAULT_BAUD;
+        module.pending_baud = 0;
+        skytraq_frame_init(&module.parser, module.rx_payload,
+                           sizeof(module.rx_payload));
+        gps_replay_reset();
+
+        /* Without a log we start the clock at the GNSS epoch */
+        module.start_utc = GNSS_EPOCH_MS;
+        return path ? load_fixes(path) : true;
+}
+
+void gps_replay_reset(void)
+{
+        module.update_rate = DEFAULT_UPDATE_RATE;
+        module.nav_interval = 1;
+        module.binary = false;
+        module.fixes_until_nav = 0;
+        module.ms_until_fix = 0;
+        skytraq_frame_reset(&module.parser);
+}
+
+size_t gps_replay_get_baud(void)
+{
+        return module.baud;
+}
+
+void gps_replay_rx(const uint8_t b)
+{
+        size_t consumed;
+        const enum skytraq_frame_result res =
+                skytraq_frame_parse(&module.parser, &b, 1, &consumed);
+
+        if (SKYTRAQ_FRAME_READY == res && module.parser.len)
+                handle_message(module.rx_payload, module.parser.len);
+}
+
+bool gps_replay_tx(uint8_t *b)
+{
+        if (module.tx_tail == module.tx_head) {
+                if (module.pending_baud) {
+                        module.baud = module.pending_baud;
+                        module.pending_baud = 0;
+                }
+                return false;
+        }
+
+        *b = module.tx_buff[module.tx_tail];
+        module.tx_tail = (module.tx_tail + 1) % TX_BUFF_LEN;
+        return true;
+}
+
+void gps_replay_tick(void)
+{
+        const uint32_t tick_ms = 1000 / configTICK_RATE_HZ;
+
+        module.ms += tick_ms;
+        if (module.ms_until_fix > tick_ms) {
+                module.ms_until_fix -= tick_ms;
+                return;
+        }
+        module.ms_until_fix = 1000 / module.update_rate;
+
+        if (!module.binary || !module.nav_interval)
+                return;
+
+        if (module.fixes_until_nav) {
+                --module.fixes_until_nav;
+                return;
+        }
+        module.fixes_until_nav = module.nav_interval - 1;
+
+        uint64_t utc;
+        const struct replay_fix *fix = current_fix(&utc);
+        tx_nav(utc, fix);
+}
@@ -0,0 +1,79 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GPS_REPLAY_H_
+#define _GPS_REPLAY_H_
+
+#include "cpp_guard.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/*
+ * Emulates the SkyTraq S1216 GPS module on the far end of the GPS UART.
+ * It answers the binary configuration protocol the way the real module
+ * does and, once binary output is enabled, emits navigation data
+ * messages at the configured update rate.  Fixes are replayed from a
+ * RaceCapture log file; without one the module reports no fix.
+ *
+ * gps_replay_rx, gps_replay_tx and gps_replay_tick are called from the
+ * UART poll ISR and never block or allocate.
+ */
+
+/**
+ * Powers up the module and loads the fixes to replay.
+ * @param path A RaceCapture log file, or NULL for no fix.
+ * @return true if the module is ready, false if the log was unusable.
+ */
+bool gps_replay_init(const char *path);
+
+/**
+ * Power cycles the module.  Volatile settings are lost.
+ */
+void gps_replay_reset(void);
+
+/**
+ * @return The baud rate the module is currently talking at.
+ */
+size_t gps_replay_get_baud(void);
+
+/**
+ * Hands the module a byte sent by the host.
+ */
+void gps_replay_rx(const uint8_t b);
+
+/**
+ * Takes the next byte the module has to send, if any.
+ * @return true if a byte was stored in b.
+ */
+bool gps_replay_tx(uint8_t *b);
+
+/**
+ * Advances the module clock by one RTOS tick.
+ */
+void gps_replay_tick(void);
+
+CPP_GUARD_END
+
+#endif /* _GPS_REPLAY_H_ */
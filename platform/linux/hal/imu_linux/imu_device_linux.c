@@ -0,0 +1,62 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "imu_device.h"
+#include "loggerConfig.h"
+
+#include <stdlib.h>
+
+#define IMU_DEVICE_COUNTS_PER_G				16384
+#define IMU_DEVICE_COUNTS_PER_DEGREE_PER_SEC		131.072
+
+void imu_device_init() {}
+
+enum imu_init_status imu_device_init_status()
+{
+        return IMU_INIT_STATUS_SUCCESS;
+}
+
+/**
+ * The unit sits level and still: 1G on Z plus a few counts of noise
+ * on every axis so the averaging filters have something to chew on.
+ */
+int imu_device_read(enum imu_channel channel)
+{
+        const int noise = (rand() & 0xF) - 8;
+        return channel == IMU_CHANNEL_Z ?
+                IMU_DEVICE_COUNTS_PER_G + noise : noise;
+}
+
+float imu_device_counts_per_unit(enum imu_channel channel)
+{
+        switch(channel) {
+        case IMU_CHANNEL_YAW:
+        case IMU_CHANNEL_PITCH:
+        case IMU_CHANNEL_ROLL:
+                return IMU_DEVICE_COUNTS_PER_DEGREE_PER_SEC;
+        case IMU_CHANNEL_X:
+        case IMU_CHANNEL_Y:
+        case IMU_CHANNEL_Z:
+                return IMU_DEVICE_COUNTS_PER_G;
+        default:
+                return 0.0;
+        }
+}
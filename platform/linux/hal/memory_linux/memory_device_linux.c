@@ -0,0 +1,36 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory_device.h"
+
+#include <string.h>
+
+/*
+ * The flash sections are placed in writable memory by link_sections.ld,
+ * so "programming" them is a copy.  Nothing persists across runs.
+ */
+enum memory_flash_result_t memory_device_flash_region(const void *vAddress,
+                                                      const void *vData,
+                                                      unsigned int length)
+{
+        memcpy((void *) vAddress, vData, length);
+        return MEMORY_FLASH_SUCCESS;
+}
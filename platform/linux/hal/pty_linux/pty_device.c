@@ -0,0 +1,115 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "serial.h"
+#include "pty_device.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define PTY_IO_CHUNK	256
+
+static void link_pty(const char *name, const char *slave)
+{
+        const char *dir = getenv("RCP_PTY_DIR");
+        if (!dir)
+                return;
+
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        unlink(path);
+        if (symlink(slave, path))
+                fprintf(stderr, "[pty] %s: %s\n", path, strerror(errno));
+}
+
+int pty_device_open(const char *name)
+{
+        const int fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (fd < 0)
+                return -1;
+
+        struct termios tio;
+        if (grantpt(fd) || unlockpt(fd) || tcgetattr(fd, &tio)) {
+                close(fd);
+                return -1;
+        }
+
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+
+        const char *slave = ptsname(fd);
+        printf("[pty] %s on %s\n", name, slave);
+        link_pty(name, slave);
+
+        return fd;
+}
+
+size_t pty_device_rx(const int fd, struct Serial *serial, const size_t max,
+                     size_t *dropped, const enum trace_isr isr,
+                     const uint16_t instance)
+{
+        uint8_t buff[PTY_IO_CHUNK];
+        const size_t len = max < sizeof(buff) ? max : sizeof(buff);
+        if (!len)
+                return 0;
+
+        /* EAGAIN when idle, EIO while nothing has the slave open */
+        const ssize_t rd = read(fd, buff, len);
+        if (rd <= 0)
+                return 0;
+
+        /* Only the reads that bring data count as an interrupt */
+        TRACE_ISR_ENTER(isr, instance);
+        xQueueHandle queue = serial_get_rx_queue(serial);
+        portBASE_TYPE woken = pdFALSE;
+        for (ssize_t i = 0; i < rd; ++i) {
+                if (!xQueueSendFromISR(queue, buff + i, &woken))
+                        ++*dropped;
+        }
+        TRACE_ISR_EXIT(isr, instance);
+
+        return rd;
+}
+
+void pty_device_tx(const int fd, struct Serial *serial, const size_t max)
+{
+        uint8_t buff[PTY_IO_CHUNK];
+        const size_t len = max < sizeof(buff) ? max : sizeof(buff);
+        xQueueHandle queue = serial_get_tx_queue(serial);
+        portBASE_TYPE woken = pdFALSE;
+        size_t count = 0;
+
+        while (count < len &&
+               xQueueReceiveFromISR(queue, buff + count, &woken))
+                ++count;
+
+        /* Nobody may be listening.  Bits on an open wire are lost too */
+        if (count && write(fd, buff, count) < 0)
+                return;
+}
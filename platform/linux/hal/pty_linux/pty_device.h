@@ -0,0 +1,63 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PTY_DEVICE_H_
+#define _PTY_DEVICE_H_
+
+#include "cpp_guard.h"
+#include "serial.h"
+#include "trace.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+/**
+ * Opens a non-blocking, raw pseudo terminal that stands in for a
+ * serial port.  Its slave path is announced on stdout and, when
+ * $RCP_PTY_DIR is set, linked to as $RCP_PTY_DIR/<name>.
+ * @param name The short name of the port.
+ * @return The master file descriptor, or -1 on failure.
+ */
+int pty_device_open(const char *name);
+
+/**
+ * Moves bytes from a pty into a serial rx queue.  Called from a poll ISR.
+ * @param dropped Incremented for each byte that did not fit in the queue.
+ * @param isr The interrupt this stands in for, as seen by the tracer.
+ * @param instance Which one of those it is.
+ * @return The number of bytes read from the pty.
+ */
+size_t pty_device_rx(const int fd, struct Serial *serial, const size_t max,
+                     size_t *dropped, const enum trace_isr isr,
+                     const uint16_t instance);
+
+/**
+ * Moves bytes from a serial tx queue out to a pty.  Like a real UART
+ * the bytes are gone whether or not anyone is listening.  Called from
+ * a poll ISR.
+ */
+void pty_device_tx(const int fd, struct Serial *serial, const size_t max);
+
+CPP_GUARD_END
+
+#endif /* _PTY_DEVICE_H_ */
@@ -0,0 +1,51 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "capabilities.h"
+#include "timer_config.h"
+#include "timer_device.h"
+
+#include <stdbool.h>
+
+/* Nothing drives the timer inputs on the host, so they read idle */
+bool timer_device_init(const size_t channel, const uint32_t speed,
+                       const uint32_t quiet_period_us,
+                       const enum timer_edge edge)
+{
+        return channel < TIMER_CHANNELS;
+}
+
+uint32_t timer_device_get_period(size_t channel)
+{
+        return 0;
+}
+
+uint32_t timer_device_get_usec(size_t channel)
+{
+        return 0;
+}
+
+uint32_t timer_device_get_count(size_t channel)
+{
+        return 0;
+}
+
+void timer_device_reset_count(size_t channel) {}
@@ -0,0 +1,218 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "gps_replay.h"
+#include "panic.h"
+#include "perf.h"
+#include "printk.h"
+#include "pty_device.h"
+#include "queue.h"
+#include "serial.h"
+#include "serial_device.h"
+#include "usart_device.h"
+
+#include <stdlib.h>
+
+/*
+ * The UARTs are pseudo terminals, except for the GPS UART which is wired
+ * to the emulated GPS module.  A poll ISR run from the tick moves bytes
+ * between the wire and the serial queues no faster than the configured
+ * baud rate allows, so the rest of the firmware sees realistic timing.
+ */
+
+#define DEFAULT_AUX_BAUD_RATE		115200
+#define DEFAULT_GPS_BAUD_RATE		921600
+#define DEFAULT_TELEMETRY_BAUD_RATE	115200
+#define DEFAULT_WIRELESS_BAUD_RATE	115200
+#define LOG_PFX				"[USART] "
+#define UART_QUEUE_LEN			1024
+#define UART_MAX_CHARS_PER_TICK		256
+#define BITS_PER_CHAR			10
+
+static volatile struct usart_info {
+        struct Serial *serial;
+        int fd;
+        size_t baud;
+        size_t rx_credit;
+        size_t tx_credit;
+} usart_data[__UART_COUNT];
+
+/**
+ * @return The number of characters the wire can carry this tick.
+ */
+static size_t take_credit(volatile size_t *credit, const size_t baud)
+{
+        const size_t max = UART_MAX_CHARS_PER_TICK * configTICK_RATE_HZ;
+
+        *credit += baud / BITS_PER_CHAR;
+        if (*credit > max)
+                *credit = max;
+
+        const size_t chars = *credit / configTICK_RATE_HZ;
+        *credit -= chars * configTICK_RATE_HZ;
+        return chars;
+}
+
+static void rx_char(volatile struct usart_info *ui, const uint8_t c)
+{
+        portBASE_TYPE woken = pdFALSE;
+        xQueueHandle rx_queue = serial_get_rx_queue(ui->serial);
+
+        if (!xQueueSendFromISR(rx_queue, &c, &woken)) {
+                perf_count(PERF_COUNTER_SERIAL_RX_DROP);
+        }
+}
+
+static void service_gps(volatile struct usart_info *ui)
+{
+        /* A baud mismatch garbles everything in both directions */
+        const bool wire_ok = ui->baud == gps_replay_get_baud();
+        xQueueHandle tx_queue = serial_get_tx_queue(ui->serial);
+        portBASE_TYPE woken = pdFALSE;
+        uint8_t c;
+
+        gps_replay_tick();
+
+        for (size_t n = take_credit(&ui->tx_credit, ui->baud); n; --n) {
+                if (!xQueueReceiveFromISR(tx_queue, &c, &woken))
+                        break;
+                if (wire_ok)
+                        gps_replay_rx(c);
+        }
+
+        for (size_t n = take_credit(&ui->rx_credit, ui->baud); n; --n) {
+                if (!gps_replay_tx(&c))
+                        break;
+                if (wire_ok)
+                        rx_char(ui, c);
+        }
+}
+
+static void service_pty(volatile struct usart_info *ui)
+{
+        pty_device_tx(ui->fd, ui->serial,
+                      take_credit(&ui->tx_credit, ui->baud));
+
+        size_t dropped = 0;
+        pty_device_rx(ui->fd, ui->serial,
+                      take_credit(&ui->rx_credit, ui->baud), &dropped,
+                      TRACE_ISR_USART, ui - usart_data);
+        for (size_t i = 0; i < dropped; ++i)
+                perf_count(PERF_COUNTER_SERIAL_RX_DROP);
+}
+
+static void usart_poll_isr(void)
+{
+        for (size_t i = 0; i < __UART_COUNT; ++i) {
+                volatile struct usart_info *ui = usart_data + i;
+                if (!ui->serial)
+                        continue;
+
+                if (UART_GPS == i) {
+                        service_gps(ui);
+                } else if (ui->fd >= 0) {
+                        service_pty(ui);
+                }
+        }
+}
+
+static bool _config_cb(void *cfg_cb_arg, const size_t bits,
+                       const size_t parity, const size_t stop_bits,
+                       const size_t baud)
+{
+        volatile struct usart_info *ui = cfg_cb_arg;
+        ui->baud = baud;
+        return true;
+}
+
+static bool init_usart_serial(const uart_id_t uart_id, const char *name,
+                              const char *pty_name, const size_t baud)
+{
+        volatile struct usart_info *ui = usart_data + uart_id;
+        struct Serial *s =
+                serial_create(name, UART_QUEUE_LEN, UART_QUEUE_LEN,
+                              _config_cb, (void*) ui, NULL, NULL);
+        if (!s) {
+                pr_error(LOG_PFX "Serial Malloc failure!\r\n");
+                return false;
+        }
+
+        ui->serial = s;
+        ui->baud = baud;
+        ui->fd = pty_name ? pty_device_open(pty_name) : -1;
+        if (pty_name && ui->fd < 0)
+                pr_error_str_msg(LOG_PFX "No pty for ", name);
+
+        return true;
+}
+
+static bool usart_id_in_bounds(const uart_id_t id)
+{
+        return ((size_t) id) < __UART_COUNT;
+}
+
+/* *** Public Methods *** */
+int usart_device_init()
+{
+        const char *replay = getenv("RCP_GPS_REPLAY");
+        if (!gps_replay_init(replay))
+                pr_error(LOG_PFX "GPS replay unavailable, no fix\r\n");
+
+        const bool mem_alloc_success =
+                init_usart_serial(UART_GPS, "GPS", NULL,
+                                  DEFAULT_GPS_BAUD_RATE) &&
+                init_usart_serial(UART_TELEMETRY, "Cell", "cell",
+                                  DEFAULT_TELEMETRY_BAUD_RATE) &&
+                init_usart_serial(UART_WIRELESS, "BT", "bt",
+                                  DEFAULT_WIRELESS_BAUD_RATE) &&
+                init_usart_serial(UART_AUX, "Aux/Wifi", "aux",
+                                  DEFAULT_AUX_BAUD_RATE);
+
+        if (!mem_alloc_success) {
+                pr_error(LOG_PFX "Failed to init\r\n");
+                panic(PANIC_CAUSE_MALLOC);
+        }
+
+        xPortRegisterPollIsr(usart_poll_isr);
+
+        return 1;
+}
+
+struct Serial* usart_device_get_serial(const uart_id_t id)
+{
+        if (!usart_id_in_bounds(id))
+                return NULL;
+
+        volatile struct usart_info *ui = usart_data + id;
+        return ui->serial;
+}
+
+void usart_device_config(const uart_id_t id, const size_t bits,
+                         const size_t parity, const size_t stop_bits,
+                         const size_t baud)
+{
+        if (!usart_id_in_bounds(id))
+                return;
+
+        volatile struct usart_info *ui = usart_data + id;
+        ui->baud = baud;
+}
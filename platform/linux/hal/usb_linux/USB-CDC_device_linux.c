@@ -0,0 +1,111 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "USB-CDC_device.h"
+#include "panic.h"
+#include "macros.h"
+#include "printk.h"
+#include "pty_device.h"
+#include "serial.h"
+#include "serial_device.h"
+
+#include <unistd.h>
+
+#define USB_TX_BUF_CAP		1
+#define USB_RX_BUF_CAP		512
+/* One full speed bulk packet per 1ms frame */
+#define USB_RX_CHARS_PER_TICK	64
+/* Time the host takes to enumerate us before data can flow */
+#define USB_ENUMERATION_TICKS	100
+
+static struct Serial *usb_serial;
+static usb_device_data_rx_isr_cb_t *usb_rx_cb;
+static int usb_fd = -1;
+static size_t enumeration_ticks;
+
+/**
+ * Called after the serial device queues characters.  Like the VCP on the
+ * MK2 we don't buffer tx; the characters go straight out to the pty.
+ */
+static void _post_tx(xQueueHandle q, void *arg)
+{
+        char c;
+
+        while (xQueueReceive(q, &c, 0)) {
+                if (write(usb_fd, &c, 1) < 0)
+                        continue;
+        }
+}
+
+static void usb_poll_isr(void)
+{
+        if (enumeration_ticks) {
+                --enumeration_ticks;
+                return;
+        }
+
+        /* The host is NAKed rather than overrunning our rx queue */
+        xQueueHandle rx_queue = serial_get_rx_queue(usb_serial);
+        const size_t space = USB_RX_BUF_CAP -
+                uxQueueMessagesWaitingFromISR(rx_queue);
+        size_t dropped = 0;
+        if (pty_device_rx(usb_fd, usb_serial,
+                          MIN(space, USB_RX_CHARS_PER_TICK), &dropped,
+                          TRACE_ISR_USB, 0))
+                usb_rx_cb();
+}
+
+int USB_CDC_device_init(const int priority, usb_device_data_rx_isr_cb_t* cb)
+{
+        if (usb_serial) {
+                pr_error("[USB] Re-initialized USB Serial!  No bueno\r\n");
+                panic(PANIC_CAUSE_MALLOC);
+        }
+
+        usb_serial = serial_create("USB", USB_TX_BUF_CAP, USB_RX_BUF_CAP,
+                                   NULL, NULL, _post_tx, NULL);
+        if (!usb_serial) {
+                pr_error("[USB] Serial Malloc failure!\r\n");
+                panic(PANIC_CAUSE_MALLOC);
+        }
+
+        usb_fd = pty_device_open("usb");
+        if (usb_fd < 0) {
+                pr_error("[USB] No pty\r\n");
+                return 0;
+        }
+
+        usb_rx_cb = cb;
+        enumeration_ticks = USB_ENUMERATION_TICKS;
+        xPortRegisterPollIsr(usb_poll_isr);
+
+        return 0;
+}
+
+int USB_CDC_is_initialized()
+{
+        return usb_serial != NULL;
+}
+
+struct Serial* USB_CDC_get_serial()
+{
+        return usb_serial;
+}
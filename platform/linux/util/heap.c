@@ -0,0 +1,63 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "mem_mang.h"
+
+#include <string.h>
+
+/*
+ * The heap_4 region.  On the MK2 the linker script places it at the
+ * start of RAM; here it is just a big array and the Makefile supplies
+ * _CONFIG_HEAP_SIZE to match.
+ */
+unsigned portCHAR _heap_address[HEAP_SIZE] __attribute__((aligned(portBYTE_ALIGNMENT)));
+
+/*
+ * The firmware's malloc family is linked with --wrap so that, as on the
+ * MK2, every allocation the firmware makes comes out of heap_4.  The C
+ * library keeps its own allocator for its internal needs, so memory
+ * handed out by libc must never be freed by firmware code.
+ */
+void* __wrap_malloc(size_t size)
+{
+        return portMalloc(size);
+}
+
+void __wrap_free(void *ptr)
+{
+        portFree(ptr);
+}
+
+void* __wrap_realloc(void *ptr, size_t new_size)
+{
+        return portRealloc(ptr, new_size);
+}
+
+void* __wrap_calloc(size_t count, size_t elmnt_size)
+{
+        const size_t size = count * elmnt_size;
+        void *val = portMalloc(size);
+        if (val)
+                memset(val, 0, size);
+
+        return val;
+}
@@ -16,6 +16,9 @@
 #define USB_SERIAL_SUPPORT	1
 #define VIRTUAL_CHANNEL_SUPPORT	1
 #define WIFI_SUPPORT		1
+#define PERF_REGION_SUPPORT	1
+#define PRINTK_DEFERRED_SUPPORT	1
+#define TRACE_SUPPORT	1
 #define CAMERA_CONTROL      0
 
 /* Wifi Specific Info */
@@ -29,13 +32,28 @@
 /* Configuration */
 #define MAX_TRACKS	50
 #define MAX_SECTORS	20
+#define LAP_HISTORY_SIZE	10
 #define MAX_VIRTUAL_CHANNELS	100
 #define LOGGER_MESSAGE_BUFFER_SIZE	10
 /*
- * What is the maximum number of samples available per predictive time
- * buffer.  More samples == better resolution. Each slot is 12 bytes.
+ * Bytes set aside at build time for sample buffers.  The logger's ring
+ * and one off API samples come from here while they fit, so config
+ * changes don't churn the heap.
  */
-#define PREDICTIVE_TIME_MAX_SAMPLES	96
+#define SAMPLE_POOL_SIZE	(1024 * 12)
+/* JSON token arrays pooled for API requests being parsed at once */
+#define JSON_TOKEN_ARRAYS	2
+/*
+ * Size in bytes of each predictive time buffer.  More samples == better
+ * resolution.  Samples are delta encoded and average a few bytes each.
+ */
+#define PREDICTIVE_TIME_BUFFER_SIZE	1152
+
+/*
+ * Number of per track reference laps kept in flash.  These seed the
+ * predictive timer so it works from the first lap of a session.
+ */
+#define REFERENCE_LAP_SLOTS	8
 
 /* LUA Configuration */
 
@@ -81,6 +99,7 @@
 #define CAN_SW_TERMINATION      false
 #define CAN_MAPPINGS            100
 #define OBD2_CHANNELS           20
+#define MATH_CHANNELS           10
 //Wireless Channels
 #define CONNECTIVITY_CHANNELS	2
 
@@ -92,6 +111,20 @@
 //logging
 #define LOG_BUFFER_SIZE			8192
 
+/*
+ * Deferred printk: number of per task record rings and the records
+ * in each (power of 2).  Rings are allocated the first time a task
+ * logs with deferral enabled.
+ */
+#define PRINTK_DEFERRED_RINGS		8
+#define PRINTK_DEFERRED_RING_SIZE	32
+
+/*
+ * Event trace recorder: records held in RAM (power of 2, 8 bytes each).
+ * The buffer is allocated when tracing is first started.
+ */
+#define TRACE_BUFFER_EVENTS		2048
+
 //system info
 #define DEVICE_NAME    "RCP_MK2"
 #define FRIENDLY_DEVICE_NAME "RaceCapture/Pro MK2"
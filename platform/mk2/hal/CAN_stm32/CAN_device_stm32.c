@@ -21,6 +21,7 @@
 
 #include "CAN_device.h"
 #include "FreeRTOS.h"
+#include "perf.h"
 #include "printk.h"
 #include "queue.h"
 #include "stm32f4xx_can.h"
@@ -29,6 +30,7 @@
 #include "stm32f4xx_rcc.h"
 #include "task.h"
 #include "taskUtil.h"
+#include "trace.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
@@ -67,6 +69,7 @@ static bool init_queue()
 {
         if (!can_rx_queue)
                 can_rx_queue = xQueueCreate(CAN_QUEUE_LENGTH, sizeof(CAN_msg));
+        perf_register_queue("CAN", "rx", can_rx_queue, CAN_QUEUE_LENGTH);
         return can_rx_queue != NULL;
 }
 
@@ -341,6 +344,7 @@ int CAN_device_rx_msg(CAN_msg * msg, const unsigned int timeout_ms)
 
 static void process_can_irq_rx(uint8_t can_bus, CAN_TypeDef* can_x, uint8_t fifo_number)
 {
+        TRACE_ISR_ENTER(TRACE_ISR_CAN, can_bus);
         portBASE_TYPE task_woken_by_rx = pdFALSE;
         CanRxMsg rx_msg;
         CAN_Receive(can_x, fifo_number, &rx_msg);
@@ -353,7 +357,9 @@ static void process_can_irq_rx(uint8_t can_bus, CAN_TypeDef* can_x, uint8_t fifo
         memcpy(can_msg.data, rx_msg.Data, rx_msg.DLC);
         can_msg.dataLength = rx_msg.DLC;
 
-        xQueueSendFromISR(can_rx_queue, &can_msg, &task_woken_by_rx);
+        if (!xQueueSendFromISR(can_rx_queue, &can_msg, &task_woken_by_rx))
+                perf_count(PERF_COUNTER_CAN_RX_DROP);
+        TRACE_ISR_EXIT(TRACE_ISR_CAN, can_bus);
         portEND_SWITCHING_ISR(task_woken_by_rx);
 }
 
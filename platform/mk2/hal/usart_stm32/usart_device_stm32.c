@@ -23,6 +23,7 @@
 #include "led.h"
 #include "mem_mang.h"
 #include "panic.h"
+#include "perf.h"
 #include "printk.h"
 #include "queue.h"
 #include "serial.h"
@@ -36,6 +37,7 @@
 #include "task.h"
 #include "taskUtil.h"
 #include "timers.h"
+#include "trace.h"
 #include "usart_device.h"
 
 /*
@@ -498,8 +500,10 @@ static void usart_generic_irq_handler(volatile struct usart_info *ui)
                  */
                 cChar = (uint8_t) USART_ReceiveData(usart);
                 xQueueHandle rx_queue = serial_get_rx_queue(ui->serial);
-                if (!xQueueSendFromISR(rx_queue, &cChar, &xTaskWoken))
+                if (!xQueueSendFromISR(rx_queue, &cChar, &xTaskWoken)) {
                         ui->char_dropped = true;
+                        perf_count(PERF_COUNTER_SERIAL_RX_DROP);
+                }
         } else if (ore_set) {
                 /*
                  * We will likely never get in here, but this is to
@@ -554,16 +558,23 @@ static bool dma_rx_isr(volatile struct usart_info *ui)
         xQueueHandle queue = serial_get_rx_queue(ui->serial);
         portBASE_TYPE task_awoke = pdFALSE;
 
+        if (tail == head)
+                return false;
+
+        TRACE_ISR_ENTER(TRACE_ISR_USART, ui - usart_data);
         while (tail != head) {
                 uint8_t val = *tail;
-                if (!xQueueSendFromISR(queue, &val, &task_awoke))
+                if (!xQueueSendFromISR(queue, &val, &task_awoke)) {
                         ui->char_dropped = true;
+                        perf_count(PERF_COUNTER_SERIAL_RX_DROP);
+                }
 
                 if (++tail >= edge)
                         tail = buff;
         }
 
         ui->dma_rx.ptr = head;
+        TRACE_ISR_EXIT(TRACE_ISR_USART, ui - usart_data);
         return task_awoke;
 }
 
@@ -80,6 +80,7 @@ task.h is included from an application file. */
 
 #include "FreeRTOS.h"
 #include "task.h"
+#include "heap.h"
 #include <string.h>
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
@@ -139,6 +140,13 @@ static xBlockLink xStart, *pxEnd = NULL;
 fragmentation. */
 static size_t xFreeBytesRemaining = 0;
 
+/* Low water mark of xFreeBytesRemaining and running totals, reported by
+vPortGetHeapStats(). */
+static size_t xMinimumEverFreeBytesRemaining = 0;
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+static size_t xNumberOfFailedAllocations = 0;
+
 /* Gets set to the top bit of an size_t type.  When this bit in the xBlockSize
 member of an xBlockLink structure is set then the block belongs to the
 application.  When the bit is free the block is still part of the free heap
@@ -218,6 +226,10 @@ void *pvPortMalloc( size_t xWantedSize )
                     }
 
                     xFreeBytesRemaining -= pxBlock->xBlockSize;
+                    if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining ) {
+                        xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+                    }
+                    xNumberOfSuccessfulAllocations++;
 
                     /* The block is being returned - it is allocated and owned
                     by the application and has no "next" block. */
@@ -227,6 +239,10 @@ void *pvPortMalloc( size_t xWantedSize )
             }
         }
 
+        if( ( pvReturn == NULL ) && ( xWantedSize > 0 ) ) {
+            xNumberOfFailedAllocations++;
+        }
+
         traceMALLOC( pvReturn, xWantedSize );
     }
     xTaskResumeAll();
@@ -256,11 +272,15 @@ void * pvPortRealloc( void *pv, size_t xWantedSize)
         puc -= heapSTRUCT_SIZE;
 
         pxLink = (void *)puc;
-        size_t origSize = pxLink->xBlockSize;
+        /* The block size includes the header and the allocated flag */
+        size_t origSize = ( pxLink->xBlockSize & ~xBlockAllocatedBit ) - heapSTRUCT_SIZE;
         if (origSize == xWantedSize) {
             return pv;
         } else {
             void *newPv = pvPortMalloc(xWantedSize);
+            if (! newPv)
+                return NULL;
+
             memcpy(newPv, pv, xWantedSize < origSize ? xWantedSize : origSize);
             vPortFree(pv);
             return newPv;
@@ -296,6 +316,7 @@ void vPortFree( void *pv )
                     /* Add this block to the list of free blocks. */
                     xFreeBytesRemaining += pxLink->xBlockSize;
                     prvInsertBlockIntoFreeList( ( ( xBlockLink * ) pxLink ) );
+                    xNumberOfSuccessfulFrees++;
                     traceFREE( pv, pxLink->xBlockSize );
                 }
                 xTaskResumeAll();
@@ -311,6 +332,42 @@ size_t xPortGetFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
+void vPortGetHeapStats( xHeapStats *pxHeapStats )
+{
+    xBlockLink *pxBlock;
+    size_t xBlocks = 0, xMaxSize = 0, xMinSize = 0;
+
+    vTaskSuspendAll();
+    {
+        /* pxEnd is NULL until the first allocation sets the heap up. */
+        if( pxEnd != NULL ) {
+            for( pxBlock = xStart.pxNextFreeBlock; pxBlock != pxEnd; pxBlock = pxBlock->pxNextFreeBlock ) {
+                xBlocks++;
+
+                if( pxBlock->xBlockSize > xMaxSize ) {
+                    xMaxSize = pxBlock->xBlockSize;
+                }
+
+                if( ( xMinSize == 0 ) || ( pxBlock->xBlockSize < xMinSize ) ) {
+                    xMinSize = pxBlock->xBlockSize;
+                }
+            }
+        }
+
+        pxHeapStats->xTotalHeapSize = xTotalHeapSize;
+        pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+        pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+        pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+        pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+        pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+        pxHeapStats->xNumberOfFailedAllocations = xNumberOfFailedAllocations;
+    }
+    xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
 void vPortInitialiseBlocks( void )
 {
     /* This just exists to keep the linker quiet. */
@@ -350,6 +407,7 @@ static void prvHeapInit( void )
 
     /* The heap now contains pxEnd. */
     xFreeBytesRemaining -= heapSTRUCT_SIZE;
+    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
 
     /* Work out the position of the top bit in a size_t variable. */
     xBlockAllocatedBit = ( ( size_t ) 1 ) << ( ( sizeof( size_t ) * heapBITS_PER_BYTE ) - 1 );
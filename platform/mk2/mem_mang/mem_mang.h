@@ -13,5 +13,6 @@
 #define portFree vPortFree
 #define portRealloc pvPortRealloc
 #define portGetFreeHeapSize xPortGetFreeHeapSize
+#define portGetHeapStats vPortGetHeapStats
 
 #endif /* MEM_MANG_H_ */
@@ -38,8 +38,8 @@
 
 #define configUSE_PREEMPTION		1
 #define configUSE_IDLE_HOOK		0
-#define configUSE_TICKLESS_IDLE		0
-#define configUSE_TICK_HOOK		1
+#define configUSE_TICKLESS_IDLE		1
+#define configUSE_TICK_HOOK		0
 #define configCPU_CLOCK_HZ		( SystemCoreClock )
 #define configTICK_RATE_HZ		1000
 #define configMAX_PRIORITIES		((unsigned portBASE_TYPE) 5)
@@ -50,7 +50,7 @@
 #define configIDLE_SHOULD_YIELD		1
 #define configUSE_MUTEXES		1
 #define configQUEUE_REGISTRY_SIZE	10
-#define configGENERATE_RUN_TIME_STATS	0
+#define configGENERATE_RUN_TIME_STATS	1
 #define configUSE_STATS_FORMATTING_FUNCTIONS 1
 #define configUSE_RECURSIVE_MUTEXES	1
 #define configUSE_APPLICATION_TASK_TAG	0
@@ -78,6 +78,8 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay			1
 #define INCLUDE_xTaskGetCurrentTaskHandle	1
+#define INCLUDE_xTaskGetIdleTaskHandle		1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle	1
 #define INCLUDE_xSemaphoreGetMutexHolder	1
 
 /* Software timer configuration. */
@@ -103,6 +105,68 @@ to exclude the API function. */
 See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY 	( configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) )
 
+/*
+ * Run time stats and queue tracing feed the perf module (see perf.h).
+ * The run time clock is derived from the core cycle counter, and only
+ * queues registered with perf_register_queue have a queue number.
+ * Task switches and the same queue traffic also go to the event trace
+ * recorder (see trace.h), which ignores them unless it is running.
+ */
+extern void perf_runtime_init(void);
+extern unsigned long perf_runtime_counter(void);
+extern void perf_trace_queue_send(unsigned char queue, unsigned long depth);
+extern void perf_trace_queue_drop(unsigned char queue);
+extern void trace_task_in(const unsigned long task);
+extern void trace_task_out(const unsigned long task);
+extern void trace_queue_send(const unsigned char queue,
+			     const unsigned long depth);
+extern void trace_queue_receive(const unsigned char queue,
+				const unsigned long depth);
+extern void trace_queue_drop(const unsigned char queue);
+
+/*
+ * The idle task stops the tick and sleeps only while the logger allows
+ * it; see logger_suppress_ticks_and_sleep.
+ */
+extern void logger_suppress_ticks_and_sleep(const unsigned long idle_ticks);
+#define portSUPPRESS_TICKS_AND_SLEEP(idle_ticks)	logger_suppress_ticks_and_sleep(idle_ticks)
+
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	perf_runtime_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()		perf_runtime_counter()
+
+#define PERF_TRACE_QUEUE_SEND(pxQueue)					\
+	do {								\
+		if ((pxQueue)->ucQueueNumber) {				\
+			perf_trace_queue_send((pxQueue)->ucQueueNumber,	\
+					      (pxQueue)->uxMessagesWaiting + 1); \
+			trace_queue_send((pxQueue)->ucQueueNumber,	\
+					 (pxQueue)->uxMessagesWaiting + 1); \
+		}							\
+	} while (0)
+#define PERF_TRACE_QUEUE_DROP(pxQueue)					\
+	do {								\
+		if ((pxQueue)->ucQueueNumber) {				\
+			perf_trace_queue_drop((pxQueue)->ucQueueNumber); \
+			trace_queue_drop((pxQueue)->ucQueueNumber);	\
+		}							\
+	} while (0)
+#define PERF_TRACE_QUEUE_RECEIVE(pxQueue)				\
+	do {								\
+		if ((pxQueue)->ucQueueNumber)				\
+			trace_queue_receive((pxQueue)->ucQueueNumber,	\
+					    (pxQueue)->uxMessagesWaiting - 1); \
+	} while (0)
+
+#define traceQUEUE_SEND(pxQueue)		PERF_TRACE_QUEUE_SEND(pxQueue)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)	PERF_TRACE_QUEUE_SEND(pxQueue)
+#define traceQUEUE_SEND_FAILED(pxQueue)		PERF_TRACE_QUEUE_DROP(pxQueue)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue) PERF_TRACE_QUEUE_DROP(pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue)		PERF_TRACE_QUEUE_RECEIVE(pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)	PERF_TRACE_QUEUE_RECEIVE(pxQueue)
+
+#define traceTASK_SWITCHED_IN()		trace_task_in(pxCurrentTCB->uxTCBNumber)
+#define traceTASK_SWITCHED_OUT()	trace_task_out(pxCurrentTCB->uxTCBNumber)
+
 #define vPortSVCHandler SVC_Handler
 #define xPortPendSVHandler PendSV_Handler
 #define xPortSysTickHandler SysTick_Handler
@@ -8,6 +8,7 @@
 #include "loggerConfig.h"
 #include "printk.h"
 #include "modp_numtoa.h"
+#include "perf.h"
 #include <i2c_device_stm32.h>
 #include <invensense_9150.h>
 
@@ -62,6 +63,7 @@ void imu_device_init()
 {
         /* Create a lock around the sensor buffers */
         static const signed portCHAR task_name[] = "IMU Reader Task";
+        perf_register_task(task_name, configMINIMAL_STACK_SIZE);
         xTaskCreate(imu_update_task, task_name, configMINIMAL_STACK_SIZE,
                     NULL, IMU_TASK_PRIORITY, NULL);
 }
@@ -34,6 +34,7 @@
 #include "USB-CDC_device.h"
 #include "usb_conf.h"
 #include "usbd_cdc_vcp.h"
+#include "trace.h"
 #include <portmacro.h>
 #include <queue.h>
 #include <semphr.h>
@@ -248,12 +249,14 @@ static uint16_t VCP_DataRx (uint8_t* Buf, uint32_t Len)
 {
         portBASE_TYPE hptw = false;
 
+        TRACE_ISR_ENTER(TRACE_ISR_USB, 0);
         reinit_if_needed();
         while(Len--)
                 xQueueSendFromISR(rx_queue, Buf++, &hptw);
 
         if (rx_isr_cb)
                 hptw |= rx_isr_cb();
+        TRACE_ISR_EXIT(TRACE_ISR_USB, 0);
 
         portEND_SWITCHING_ISR(hptw);
         return USBD_OK;
@@ -101,7 +101,7 @@ extern uint32_t SystemCoreClock;
 #define configUSE_RECURSIVE_MUTEXES			1
 #define configUSE_APPLICATION_TASK_TAG			0
 #define configUSE_COUNTING_SEMAPHORES			1
-#define configGENERATE_RUN_TIME_STATS			0
+#define configGENERATE_RUN_TIME_STATS			1
 
 #ifdef ASL_DEBUG
 #define configCHECK_FOR_STACK_OVERFLOW			2
@@ -160,6 +160,36 @@ See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 header file. */
 #define configASSERT(x) if ((x) == 0) { taskDISABLE_INTERRUPTS(); for(;;); }
 
+/*
+ * Run time stats and queue tracing feed the perf module (see perf.h).
+ * The run time clock is derived from the core cycle counter, and only
+ * queues registered with perf_register_queue have a queue number.
+ */
+extern void perf_runtime_init(void);
+extern unsigned long perf_runtime_counter(void);
+extern void perf_trace_queue_send(unsigned char queue, unsigned long depth);
+extern void perf_trace_queue_drop(unsigned char queue);
+
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	perf_runtime_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()		perf_runtime_counter()
+
+#define PERF_TRACE_QUEUE_SEND(pxQueue)					\
+	do {								\
+		if ((pxQueue)->ucQueueNumber)				\
+			perf_trace_queue_send((pxQueue)->ucQueueNumber,	\
+					      (pxQueue)->uxMessagesWaiting + 1); \
+	} while (0)
+#define PERF_TRACE_QUEUE_DROP(pxQueue)					\
+	do {								\
+		if ((pxQueue)->ucQueueNumber)				\
+			perf_trace_queue_drop((pxQueue)->ucQueueNumber); \
+	} while (0)
+
+#define traceQUEUE_SEND(pxQueue)		PERF_TRACE_QUEUE_SEND(pxQueue)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)	PERF_TRACE_QUEUE_SEND(pxQueue)
+#define traceQUEUE_SEND_FAILED(pxQueue)		PERF_TRACE_QUEUE_DROP(pxQueue)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue) PERF_TRACE_QUEUE_DROP(pxQueue)
+
 /* Definitions that map the FreeRTOS port interrupt handlers to their CMSIS
 standard names. */
 #define vPortSVCHandler SVC_Handler
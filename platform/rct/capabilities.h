@@ -17,6 +17,9 @@
 #define USB_SERIAL_SUPPORT	        1
 #define VIRTUAL_CHANNEL_SUPPORT	    0
 #define WIFI_SUPPORT		        1
+#define PERF_REGION_SUPPORT	0
+#define PRINTK_DEFERRED_SUPPORT	0
+#define TRACE_SUPPORT	0
 #define CAMERA_CONTROL              1
 
 /* Wifi Specific Info */
@@ -27,12 +30,20 @@
 /* Configuration */
 #define MAX_TRACKS	                0
 #define MAX_SECTORS	                20
+#define LAP_HISTORY_SIZE	4
 #define MAX_VIRTUAL_CHANNELS	    30
 /*
- * What is the maximum number of samples available per predictive time
- * buffer.  More samples == better resolution. Each slot is 12 bytes.
+ * Size in bytes of each predictive time buffer.  More samples == better
+ * resolution.  Samples are delta encoded and average a few bytes each.
  */
-#define PREDICTIVE_TIME_MAX_SAMPLES	72
+#define PREDICTIVE_TIME_BUFFER_SIZE	864
+
+/*
+ * Number of per track reference laps kept in flash.  These seed the
+ * predictive timer so it works from the first lap of a session.  This
+ * board's flash layout sets no sector aside for them.
+ */
+#define REFERENCE_LAP_SLOTS	0
 
 
 //Sensor Channels
@@ -45,6 +56,7 @@
 #define CAN_SW_TERMINATION          false
 #define CAN_MAPPINGS                10
 #define OBD2_CHANNELS               10
+#define MATH_CHANNELS               5
 
 //Wireless connections
 #define CONNECTIVITY_CHANNELS	    2
@@ -57,6 +69,10 @@
 //logger message buffering
 #define LOGGER_MESSAGE_BUFFER_SIZE  5
 
+/* Short on RAM, so sample buffers and JSON tokens come from the heap */
+#define SAMPLE_POOL_SIZE	    0
+#define JSON_TOKEN_ARRAYS	    0
+
 /* Logging Buffer Size (in 1K Blocks) */
 #define LOG_BUFFER_SIZE	            (1024 * 3)
 
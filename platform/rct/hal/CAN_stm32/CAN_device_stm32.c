@@ -23,6 +23,7 @@
 #include "FreeRTOS.h"
 #include "led.h"
 #include "mod_string.h"
+#include "perf.h"
 #include "printk.h"
 #include "queue.h"
 #include "stm32f30x.h"
@@ -70,6 +71,7 @@ static bool init_queue()
                 can_rx_queue = xQueueCreate(CAN_QUEUE_LENGTH,
                                        (unsigned portBASE_TYPE)
                                        sizeof(CAN_msg));
+        perf_register_queue("CAN", "rx", can_rx_queue, CAN_QUEUE_LENGTH);
         return can_rx_queue != NULL;
 }
 
@@ -306,7 +308,8 @@ void CAN_device_isr(void)
                 memcpy(can_msg.data, rx_msg.Data, rx_msg.DLC);
                 can_msg.dataLength = rx_msg.DLC;
 
-                xQueueSendFromISR(can_rx_queue, &can_msg, &task_woken_by_rx);
+                if (!xQueueSendFromISR(can_rx_queue, &can_msg, &task_woken_by_rx))
+                        perf_count(PERF_COUNTER_CAN_RX_DROP);
                 portEND_SWITCHING_ISR(task_woken_by_rx);
         }
 }
@@ -94,3 +94,23 @@ void cpu_device_spin(uint32_t ms)
 	while(ms-- > 0)
 		for (volatile size_t i = 0; i < iterations; ++i);
 }
+
+/**
+ * Enables the DWT cycle counter, which clocks the task run time stats.
+ */
+void cpu_device_cycle_counter_init(void)
+{
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t cpu_device_cycle_count(void)
+{
+        return DWT->CYCCNT;
+}
+
+uint32_t cpu_device_cycle_hz(void)
+{
+        return SystemCoreClock;
+}
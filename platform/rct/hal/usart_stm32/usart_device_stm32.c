@@ -23,6 +23,7 @@
 #include "led.h"
 #include "mem_mang.h"
 #include "panic.h"
+#include "perf.h"
 #include "printk.h"
 #include "queue.h"
 #include "serial.h"
@@ -431,8 +432,10 @@ static void usart_generic_irq_handler(volatile struct usart_info *ui)
                  */
                 cChar = (uint8_t) USART_ReceiveData(usart);
                 xQueueHandle rx_queue = serial_get_rx_queue(ui->serial);
-                if (!xQueueSendFromISR(rx_queue, &cChar, &xTaskWokenByPost))
+                if (!xQueueSendFromISR(rx_queue, &cChar, &xTaskWokenByPost)) {
                         ui->char_dropped = true;
+                        perf_count(PERF_COUNTER_SERIAL_RX_DROP);
+                }
         }
 
         /*
@@ -485,8 +488,10 @@ static bool dma_rx_isr(volatile struct usart_info *ui)
 
         while (tail != head) {
                 uint8_t val = *tail;
-                if (!xQueueSendFromISR(queue, &val, &task_awoke))
+                if (!xQueueSendFromISR(queue, &val, &task_awoke)) {
                         ui->char_dropped = true;
+                        perf_count(PERF_COUNTER_SERIAL_RX_DROP);
+                }
 
                 if (++tail >= edge)
                         tail = buff;
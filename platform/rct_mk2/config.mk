@@ -93,10 +93,12 @@ $(RCP_SRC)/cpu/cpu.c \
 $(RCP_SRC)/devices/bluetooth.c \
 $(RCP_SRC)/devices/cellular.c \
 $(RCP_SRC)/devices/cellular_api_status_keys.c \
+$(RCP_SRC)/devices/device_cache.c \
 $(RCP_SRC)/devices/esp8266.c \
 $(RCP_SRC)/devices/null_device.c \
 $(RCP_SRC)/devices/sara_u280.c \
 $(RCP_SRC)/devices/sim900.c \
+$(RCP_SRC)/devices/skytraq_frame.c \
 $(RCP_SRC)/devices/gps_skytraq_s1216_sup500f8.c \
 $(RCP_SRC)/drivers/esp8266_drv.c \
 $(RCP_SRC)/drivers/shiftx_drv.c \
@@ -107,10 +109,13 @@ $(RCP_SRC)/gps/geoTrigger.c \
 $(RCP_SRC)/gps/geopoint.c \
 $(RCP_SRC)/gps/gps.c \
 $(RCP_SRC)/gps/gpsTask.c \
+$(RCP_SRC)/gps/gps_fusion.c \
+$(RCP_SRC)/gps/track_frame.c \
 $(RCP_SRC)/gsm/gsm.c \
 $(RCP_SRC)/imu/imu.c \
 $(RCP_SRC)/jsmn/jsmn.c \
 $(RCP_SRC)/lap_stats/lap_stats.c \
+$(RCP_SRC)/lap_stats/sector_stats.c \
 $(RCP_SRC)/launch_control.c \
 $(RCP_SRC)/logger/auto_control.c \
 $(RCP_SRC)/logger/auto_logger.c \
@@ -118,7 +123,9 @@ $(RCP_SRC)/logger/camera_control.c \
 $(RCP_SRC)/logger/channel_config.c \
 $(RCP_SRC)/logger/connectivityTask.c \
 $(RCP_SRC)/logger/fileWriter.c \
+$(RCP_SRC)/logger/log_index.c \
 $(RCP_SRC)/logger/logger.c \
+$(RCP_SRC)/logger/analog_scaling.c \
 $(RCP_SRC)/logger/api_event.c \
 $(RCP_SRC)/logger/loggerApi.c \
 $(RCP_SRC)/logger/loggerCommands.c \
@@ -127,10 +134,14 @@ $(RCP_SRC)/logger/loggerData.c \
 $(RCP_SRC)/logger/loggerHardware.c \
 $(RCP_SRC)/logger/loggerSampleData.c \
 $(RCP_SRC)/logger/loggerTaskEx.c \
+$(RCP_SRC)/logger/math_channel.c \
+$(RCP_SRC)/logger/math_expr.c \
 $(RCP_SRC)/logger/sampleRecord.c \
 $(RCP_SRC)/logger/versionInfo.c \
 $(RCP_SRC)/logging/printk.c \
+$(RCP_SRC)/logging/printk_deferred.c \
 $(RCP_SRC)/lua/luaBaseBinding.c \
+$(RCP_SRC)/lua/luaBudget.c \
 $(RCP_SRC)/lua/luaCommands.c \
 $(RCP_SRC)/lua/luaLoggerBinding.c \
 $(RCP_SRC)/lua/luaScript.c \
@@ -140,11 +151,16 @@ $(RCP_SRC)/messaging/messaging.c \
 $(RCP_SRC)/modem/at.c \
 $(RCP_SRC)/modem/at_basic.c \
 $(RCP_SRC)/predictive_timer/predictive_timer_2.c \
+$(RCP_SRC)/predictive_timer/reference_lap.c \
 $(RCP_SRC)/sdcard/sdcard.c \
 $(RCP_SRC)/serial/rx_buff.c \
 $(RCP_SRC)/serial/serial.c \
 $(RCP_SRC)/serial/serial_buffer.c \
+$(RCP_SRC)/system/boot_stats.c \
 $(RCP_SRC)/system/flags.c \
+$(RCP_SRC)/system/perf.c \
+$(RCP_SRC)/system/perf_region.c \
+$(RCP_SRC)/system/trace.c \
 $(RCP_SRC)/tasks/wifi.c \
 $(RCP_SRC)/tracks/tracks.c \
 $(RCP_SRC)/units/units.c \
@@ -152,8 +168,10 @@ $(RCP_SRC)/units/units_conversion.c \
 $(RCP_SRC)/usart/usart.c \
 $(RCP_SRC)/usb_comm/usb_comm.c \
 $(RCP_SRC)/util/FreeRTOS-openocd.c \
+$(RCP_SRC)/util/block_pool.c \
 $(RCP_SRC)/util/byteswap.c \
 $(RCP_SRC)/util/convert.c \
+$(RCP_SRC)/util/crc32.c \
 $(RCP_SRC)/util/linear_interpolate.c \
 $(RCP_SRC)/util/modp_numtoa.c \
 $(RCP_SRC)/util/panic.c \
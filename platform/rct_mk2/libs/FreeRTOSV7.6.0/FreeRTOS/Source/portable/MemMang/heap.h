@@ -2,9 +2,23 @@
 #define HEAP_H_
 #include <stdlib.h>
 
+/* Snapshot of the heap, for judging how fragmented it has become */
+typedef struct xHEAP_STATS {
+    size_t xTotalHeapSize;
+    size_t xAvailableHeapSpaceInBytes;
+    size_t xSizeOfLargestFreeBlockInBytes;
+    size_t xSizeOfSmallestFreeBlockInBytes;
+    size_t xNumberOfFreeBlocks;
+    size_t xMinimumEverFreeBytesRemaining;
+    size_t xNumberOfSuccessfulAllocations;
+    size_t xNumberOfSuccessfulFrees;
+    size_t xNumberOfFailedAllocations;
+} xHeapStats;
+
 void *pvPortMalloc( size_t xWantedSize );
 void vPortFree( void *pv );
 void * pvPortRealloc( void *pv, size_t xWantedSize );
 size_t xPortGetFreeHeapSize( void );
+void vPortGetHeapStats( xHeapStats *pxHeapStats );
 
 #endif
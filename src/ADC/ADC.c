@@ -26,6 +26,7 @@
 #include "printk.h"
 
 static Filter g_adc_filter[CONFIG_ADC_CHANNELS];
+static struct channel_filter g_adc_channel_filter[CONFIG_ADC_CHANNELS];
 static float g_adc_calibrations[CONFIG_ADC_CHANNELS];
 
 int ADC_init(LoggerConfig *loggerConfig)
@@ -39,6 +40,15 @@ int ADC_init(LoggerConfig *loggerConfig)
         return ADC_device_init();
 }
 
+void ADC_init_filters(LoggerConfig *loggerConfig, const unsigned int rate_hz)
+{
+        for (size_t i = 0; i < CONFIG_ADC_CHANNELS; i++) {
+                ADCConfig *config = loggerConfig->ADCConfigs + i;
+                channel_filter_init(g_adc_channel_filter + i, &config->filter,
+                                    rate_hz);
+        }
+}
+
 void ADC_sample_all(void)
 {
         for (int i = 0; i < CONFIG_ADC_CHANNELS; ++i) {
@@ -54,9 +64,21 @@ void ADC_sample_all(void)
         }
 }
 
+void ADC_filter_all(void)
+{
+        for (size_t i = 0; i < CONFIG_ADC_CHANNELS; ++i) {
+                struct channel_filter *f = g_adc_channel_filter + i;
+                if (channel_filter_enabled(f))
+                        channel_filter_update(f, g_adc_filter[i].current_value);
+        }
+}
+
 float ADC_read(const size_t channel)
 {
-        return g_adc_filter[channel].current_value *
-               ADC_device_get_channel_scaling(channel) *
+        const struct channel_filter *cf = g_adc_channel_filter + channel;
+        const int32_t value = channel_filter_enabled(cf) ? cf->value :
+                g_adc_filter[channel].current_value;
+
+        return value * ADC_device_get_channel_scaling(channel) *
                g_adc_calibrations[channel];
 }
@@ -26,6 +26,7 @@
 #include "stddef.h"
 #include "CAN.h"
 #include "OBD2.h"
+#include "perf.h"
 #include "printk.h"
 #include "FreeRTOS.h"
 #include "task.h"
@@ -99,5 +100,6 @@ void start_CAN_task(int priority)
 {
         /* Make all task names 16 chars including NULL char*/
         static const signed portCHAR task_name[] = "CAN Task       ";
+        perf_register_task(task_name, CAN_TASK_STACK);
         xTaskCreate(CAN_task, task_name, CAN_TASK_STACK, NULL, priority, NULL );
 }
@@ -22,10 +22,25 @@
 #include "loggerConfig.h"
 #include "can_mapping.h"
 #include "mem_mang.h"
+#include "perf_region.h"
 #include "stdutil.h"
 #include "printk.h"
+#include <math.h>
 #include <string.h>
 
+/*
+ * Filter stage of a single CAN channel.  Values are filtered as
+ * integers scaled by the precision of the channel, so the fixed point
+ * kernels lose nothing that would survive logging anyway.  The scale is
+ * reduced when needed to keep the channel's min/max range within the
+ * filter's input limit.
+ */
+struct CANFilter {
+        uint16_t index;
+        float scale;
+        struct channel_filter filter;
+};
+
 
 /* manages the running state of the CAN channels*/
 struct CANState {
@@ -34,6 +49,14 @@ struct CANState {
 
         /* flag to indicate if state is stale */
         bool stale;
+
+        /* filters of the channels that have one configured */
+        struct CANFilter * filters;
+        size_t filter_count;
+
+        /* per channel: 1 + its index in filters, or 0 if unfiltered */
+        uint8_t * filter_slots;
+        size_t filter_slot_count;
 };
 
 static struct CANState can_state = {0};
@@ -64,13 +87,95 @@ bool CAN_init_current_values(size_t values)
         return can_state.CAN_current_values != NULL;
 }
 
-float CAN_get_current_channel_value(int index)
+static float get_raw_channel_value(int index)
 {
         if (can_state.CAN_current_values == NULL)
                 return 0;
         return can_state.CAN_current_values[index];
 }
 
+float CAN_get_current_channel_value(int index)
+{
+        const size_t slot = (size_t) index < can_state.filter_slot_count ?
+                can_state.filter_slots[index] : 0;
+
+        if (slot) {
+                const struct CANFilter *f = can_state.filters + slot - 1;
+                return f->filter.value / f->scale;
+        }
+        return get_raw_channel_value(index);
+}
+
+bool CAN_init_filters(CANChannelConfig *cfg, const unsigned int rate_hz)
+{
+        portFree(can_state.filters);
+        portFree(can_state.filter_slots);
+
+        can_state.filters = NULL;
+        can_state.filter_count = 0;
+        can_state.filter_slots = NULL;
+        can_state.filter_slot_count = 0;
+
+        const size_t enabled_mappings = cfg->enabled ?
+                MIN(cfg->enabled_mappings, CONFIG_CAN_MAPPINGS) : 0;
+
+        size_t count = 0;
+        for (size_t i = 0; i < enabled_mappings; i++)
+                if (cfg->can_channels[i].filter.type != CHANNEL_FILTER_NONE)
+                        count++;
+
+        if (count == 0)
+                return true;
+
+        struct CANFilter *filters = portMalloc(sizeof(struct CANFilter[count]));
+        uint8_t *slots = portMalloc(enabled_mappings);
+        if (filters == NULL || slots == NULL) {
+                pr_error("[CAN] Failed to allocate channel filters\r\n");
+                portFree(filters);
+                portFree(slots);
+                return false;
+        }
+
+        struct CANFilter *f = filters;
+        for (size_t i = 0; i < enabled_mappings; i++) {
+                CANChannel *channel = cfg->can_channels + i;
+                slots[i] = 0;
+                if (channel->filter.type == CHANNEL_FILTER_NONE)
+                        continue;
+
+                slots[i] = f - filters + 1;
+
+                const ChannelConfig *cc = &channel->mapping.channel_cfg;
+                const float range = MAX(fabsf(cc->min), fabsf(cc->max));
+                const float limit = CHANNEL_FILTER_INPUT_LIMIT / 2;
+
+                f->index = i;
+                f->scale = powf(10, cc->precision);
+                if (range * f->scale > limit)
+                        f->scale = limit / range;
+
+                channel_filter_init(&f->filter, &channel->filter, rate_hz);
+                f++;
+        }
+
+        can_state.filters = filters;
+        can_state.filter_count = count;
+        can_state.filter_slots = slots;
+        can_state.filter_slot_count = enabled_mappings;
+        return true;
+}
+
+void CAN_sample_all(void)
+{
+        for (size_t i = 0; i < can_state.filter_count; i++) {
+                struct CANFilter *f = can_state.filters + i;
+                float value = get_raw_channel_value(f->index) * f->scale;
+                value = MAX(MIN(value, CHANNEL_FILTER_INPUT_LIMIT),
+                            -CHANNEL_FILTER_INPUT_LIMIT);
+                channel_filter_update(&f->filter, lroundf(value));
+        }
+}
+
 void CAN_set_current_channel_value(int index, float value)
 {
         if (can_state.CAN_current_values == NULL)
@@ -80,6 +185,8 @@ void CAN_set_current_channel_value(int index, float value)
 
 void update_can_channels(CAN_msg *msg, CANChannelConfig *cfg, uint16_t enabled_mapping_count)
 {
+        PERF_REGION_BEGIN("update_can_channels");
+
         for (size_t i = 0; i < enabled_mapping_count; i++) {
                 CANMapping *mapping = &cfg->can_channels[i].mapping;
 
@@ -95,4 +202,6 @@ void update_can_channels(CAN_msg *msg, CANChannelConfig *cfg, uint16_t enabled_m
 
                 CAN_set_current_channel_value(i, value);
         }
+
+        PERF_REGION_END("update_can_channels");
 }
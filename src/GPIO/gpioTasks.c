@@ -27,6 +27,7 @@
 #include "semphr.h"
 #include "loggerTaskEx.h"
 #include "logger.h"
+#include "perf.h"
 #include "taskUtil.h"
 #include "printk.h"
 #include "GPIO.h"
@@ -42,6 +43,7 @@ void startGPIOTasks(int priority)
 
         /* Make all task names 16 chars including NULL char */
         static const signed portCHAR task_name[] = "Button Task    ";
+        perf_register_task(task_name, GPIO_TASK_STACK_SIZE);
         xTaskCreate(onPushbuttonTask, task_name, GPIO_TASK_STACK_SIZE,
                     NULL, priority, NULL);
 }
@@ -78,7 +78,7 @@ void PWM_channel_set_period(unsigned int channel, unsigned short period)
 
 unsigned short PWM_channel_get_period(unsigned int channel)
 {
-        return PWM_channel_get_period(channel);
+        return PWM_device_channel_get_period(channel);
 }
 
 void PWM_channel_start(unsigned int channel)
@@ -21,27 +21,27 @@
 
 
 #include "api.h"
+#include "block_pool.h"
+#include "capabilities.h"
 #include "constants.h"
 #include "loggerApi.h"
-#include "panic.h"
 #include "printk.h"
 #include <string.h>
 
 #define JSON_TOKENS 200
 
-static jsmn_parser g_jsonParser;
-static jsmntok_t* g_json_tok;
+/*
+ * Each request being parsed gets its own token array, so the USB, WiFi
+ * and telemetry connections can take requests at the same time.
+ */
+BLOCK_POOL_DEFINE(g_json_tok_pool, "jsonTokens", jsmntok_t[JSON_TOKENS],
+                  JSON_TOKEN_ARRAYS);
 static const api_t apis[] = {API_METHODS NULL_API};
 
 void initApi()
 {
-        if (NULL == g_json_tok)
-                g_json_tok = calloc(sizeof(jsmntok_t), JSON_TOKENS);
-
-        if (NULL == g_json_tok)
-                panic(PANIC_CAUSE_MALLOC);
-
-        jsmn_init(&g_jsonParser);
+        /* Sets the pool up now so it is reported from boot */
+        block_pool_format(&g_json_tok_pool, sizeof(jsmntok_t[JSON_TOKENS]));
 }
 
 static void putQuotedStr(struct Serial *serial, const char *str)
@@ -238,17 +238,27 @@ static int execute_api(struct Serial * serial, const jsmntok_t *json)
 
 int process_api(struct Serial *serial, char *buffer, size_t bufferSize)
 {
-        jsmn_init(&g_jsonParser);
-        memset(g_json_tok, 0, sizeof(jsmntok_t) * JSON_TOKENS);
-
-        const int r = jsmn_parse(&g_jsonParser, buffer, g_json_tok, JSON_TOKENS);
-        if (JSMN_SUCCESS == r)
-                return execute_api(serial, g_json_tok);
+        const size_t size = sizeof(jsmntok_t[JSON_TOKENS]);
+        jsmntok_t *tokens = block_pool_alloc_fallback(&g_json_tok_pool, size);
+        if (NULL == tokens)
+                return API_ERROR_SEVERE;
+
+        jsmn_parser parser;
+        jsmn_init(&parser);
+        memset(tokens, 0, size);
+
+        const int r = jsmn_parse(&parser, buffer, tokens, JSON_TOKENS);
+        int res = API_ERROR_MALFORMED;
+        if (JSMN_SUCCESS == r) {
+                res = execute_api(serial, tokens);
+        } else {
+                pr_warning("API Parsing Error: \"");
+                pr_warning(buffer);
+                pr_warning_int_msg("\"\r\n failed with code ", r);
+        }
 
-        pr_warning("API Parsing Error: \"");
-        pr_warning(buffer);
-        pr_warning_int_msg("\"\r\n failed with code ", r);
-        return API_ERROR_MALFORMED;
+        block_pool_free_fallback(&g_json_tok_pool, tokens);
+        return res;
 }
 
 const char* unknown_api_key()
@@ -45,11 +45,18 @@
 #include "geopoint.h"
 #include "loggerConfig.h"
 #include "printk.h"
+#include "track_frame.h"
 #include "tracks.h"
 
 static const Track* findClosestTrack(const Tracks *tracks, const GeoPoint *location)
 {
-        float dist = MAX_DIST_FROM_SF;
+        /* Compare squared distances in a frame centered on where we are */
+        struct track_frame frame;
+        track_frame_init(&frame, location);
+        const struct track_point here = {0, 0};
+
+        const int64_t max_cm = MAX_DIST_FROM_SF * 100;
+        int64_t dist = max_cm * max_cm;
         const Track *best = NULL;
 
         for (unsigned i = 0; i < tracks->count; ++i) {
@@ -57,7 +64,9 @@ static const Track* findClosestTrack(const Tracks *tracks, const GeoPoint *locat
 
                 // XXX: inaccurate but fast.  Good enough for now.
                 GeoPoint startPoint = getStartPoint(track);
-                float track_distance = distPythag(&startPoint, location);
+                const struct track_point sp =
+                        track_frame_project(&frame, &startPoint);
+                const int64_t track_distance = track_point_dist_sq(&sp, &here);
 
                 if (track_distance >= dist)
                         continue;
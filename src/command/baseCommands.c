@@ -22,15 +22,23 @@
 
 #include "FreeRTOS.h"
 #include "baseCommands.h"
+#include "block_pool.h"
+#include "boot_stats.h"
 #include "cpu.h"
+#include "device_cache.h"
 #include "loggerConfig.h"
 #include "lua.h"
 #include "luaScript.h"
 #include "luaTask.h"
 #include "mem_mang.h"
 #include "memory.h"
+#include "perf.h"
+#include "perf_region.h"
 #include "task.h"
+#include "trace.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 
 extern unsigned int _CONFIG_HEAP_SIZE;
 
@@ -55,13 +63,54 @@ void ShowStats(struct Serial *serial, unsigned int argc, char **argv)
         putHeader(serial, "Memory Info");
 
         putDataRowHeader(serial, "Total Memory");
-        put_uint(serial, (unsigned int) &_CONFIG_HEAP_SIZE);
+        put_uint(serial, (unsigned int) (uintptr_t) &_CONFIG_HEAP_SIZE);
         put_crlf(serial);
 
         putDataRowHeader(serial, "Free Memory");
         put_uint(serial, portGetFreeHeapSize());
         put_crlf(serial);
 
+        xHeapStats hs;
+        portGetHeapStats(&hs);
+
+        putDataRowHeader(serial, "Min Free Memory");
+        put_uint(serial, hs.xMinimumEverFreeBytesRemaining);
+        put_crlf(serial);
+
+        putDataRowHeader(serial, "Largest Free Block");
+        put_uint(serial, hs.xSizeOfLargestFreeBlockInBytes);
+        put_crlf(serial);
+
+        putDataRowHeader(serial, "Free Blocks");
+        put_uint(serial, hs.xNumberOfFreeBlocks);
+        put_crlf(serial);
+
+        putDataRowHeader(serial, "Failed Allocations");
+        put_uint(serial, hs.xNumberOfFailedAllocations);
+        put_crlf(serial);
+
+        struct block_pool_stats pools[BLOCK_POOL_MAX_POOLS];
+        const size_t pool_count = block_pool_get_stats(pools,
+                                                       BLOCK_POOL_MAX_POOLS);
+
+        putHeader(serial, "Block Pools");
+        serial_write_s(serial, "Pool\t\tSize\tCap\tUsed\tPeak\tFails");
+        put_crlf(serial);
+        for (size_t i = 0; i < pool_count; ++i) {
+                serial_write_s(serial, pools[i].name);
+                serial_write_s(serial, "\t\t");
+                put_uint(serial, pools[i].block_size);
+                serial_write_s(serial, "\t");
+                put_uint(serial, pools[i].capacity);
+                serial_write_s(serial, "\t");
+                put_uint(serial, pools[i].used);
+                serial_write_s(serial, "\t");
+                put_uint(serial, pools[i].peak);
+                serial_write_s(serial, "\t");
+                put_uint(serial, pools[i].failures);
+                put_crlf(serial);
+        }
+
 #if LUA_SUPPORT
         struct lua_runtime_info ri = lua_task_get_runtime_info();
         putHeader(serial, "Lua Info");
@@ -73,6 +122,10 @@ void ShowStats(struct Serial *serial, unsigned int argc, char **argv)
         putDataRowHeader(serial, "Lua Memory Usage (KB)");
         put_int(serial, ri.mem_usage_kb);
         put_crlf(serial);
+
+        putDataRowHeader(serial, "Lua Budget Overruns");
+        put_uint(serial, ri.budget_overruns);
+        put_crlf(serial);
 #endif /* LUA_SUPPORT */
 
         // Misc Info
@@ -124,6 +177,184 @@ void ShowTaskInfo(struct Serial *serial, unsigned int argc, char **argv)
         put_crlf(serial);
 }
 
+void ShowPerf(struct Serial *serial, unsigned int argc, char **argv)
+{
+        struct perf_task *tasks = portMalloc(sizeof(struct perf_task) *
+                                             PERF_MAX_TASKS);
+        if (NULL == tasks) {
+                serial_write_s(serial, "Out of Memory!");
+                put_crlf(serial);
+                return;
+        }
+
+        size_t count;
+        const uint32_t window = perf_get_tasks(tasks, PERF_MAX_TASKS, &count);
+
+        putHeader(serial, "Task Perf");
+        putDataRowHeader(serial, "Window (ms)");
+        put_uint(serial, window);
+        put_crlf(serial);
+
+        serial_write_s(serial, "Name\t\t\tCPU%\tStack\tFree");
+        put_crlf(serial);
+        for (size_t i = 0; i < count; ++i) {
+                serial_write_s(serial, tasks[i].name);
+                serial_write_s(serial, "\t\t");
+                put_float(serial, tasks[i].cpu / 10.0f, 1);
+                serial_write_s(serial, "\t");
+                put_uint(serial, tasks[i].stack_size);
+                serial_write_s(serial, "\t");
+                put_uint(serial, tasks[i].stack_free);
+                put_crlf(serial);
+        }
+        portFree(tasks);
+
+        struct perf_queue queues[PERF_MAX_QUEUES];
+        count = perf_get_queues(queues, PERF_MAX_QUEUES);
+
+        putHeader(serial, "Queue Perf");
+        serial_write_s(serial, "Queue\t\t\tLen\tDepth\tPeak\tDrops");
+        put_crlf(serial);
+        for (size_t i = 0; i < count; ++i) {
+                serial_write_s(serial, queues[i].owner);
+                serial_write_s(serial, " ");
+                serial_write_s(serial, queues[i].name);
+                serial_write_s(serial, "\t\t");
+                put_uint(serial, queues[i].length);
+                serial_write_s(serial, "\t");
+                put_uint(serial, queues[i].depth);
+                serial_write_s(serial, "\t");
+                put_uint(serial, queues[i].peak);
+                serial_write_s(serial, "\t");
+                put_uint(serial, queues[i].drops);
+                put_crlf(serial);
+        }
+
+#if PERF_REGION_SUPPORT
+        putHeader(serial, "Regions");
+        putDataRowHeader(serial, "Cycles per second");
+        put_uint(serial, perf_region_hz());
+        put_crlf(serial);
+
+        serial_write_s(serial, "Name\t\t\tCount\tMin\tMax\tMean");
+        put_crlf(serial);
+        struct perf_region r;
+        for (size_t i = 0; perf_region_get(i, &r); ++i) {
+                serial_write_s(serial, r.name);
+                serial_write_s(serial, "\t");
+                put_uint(serial, r.count);
+                serial_write_s(serial, "\t");
+                put_uint(serial, r.min);
+                serial_write_s(serial, "\t");
+                put_uint(serial, r.max);
+                serial_write_s(serial, "\t");
+                put_uint(serial, r.count ? r.total / r.count : 0);
+                put_crlf(serial);
+        }
+#endif /* PERF_REGION_SUPPORT */
+
+        putHeader(serial, "Pipeline Drops");
+        for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+                putDataRowHeader(serial, perf_counter_name(i));
+                put_uint(serial, perf_counter_value(i));
+                put_crlf(serial);
+        }
+}
+
+void ShowBoot(struct Serial *serial, unsigned int argc, char **argv)
+{
+        putHeader(serial, "Boot Phases (ms)");
+        serial_write_s(serial, "Phase\t\tStart\tEnd\tTook");
+        put_crlf(serial);
+        for (size_t i = 0; i < BOOT_PHASE_COUNT; ++i) {
+                struct boot_phase_time t;
+                const bool done = boot_stats_get(i, &t);
+
+                serial_write_s(serial, boot_stats_phase_name(i));
+                serial_write_s(serial, "\t\t");
+                put_uint(serial, t.start);
+                serial_write_s(serial, "\t");
+                if (done) {
+                        put_uint(serial, t.end);
+                        serial_write_s(serial, "\t");
+                        put_uint(serial, t.end - t.start);
+                } else {
+                        serial_write_s(serial, "-\t-");
+                }
+                put_crlf(serial);
+        }
+
+        putHeader(serial, "Device Cache");
+        for (size_t i = 0; i < DEVICE_CACHE_COUNT; ++i) {
+                putDataRowHeader(serial, device_cache_name(i));
+                put_uint(serial, device_cache_get(i));
+                put_crlf(serial);
+        }
+}
+
+#if TRACE_SUPPORT
+#define TRACE_FILE_NAME	"trace.bin"
+
+static bool write_serial(void *arg, const void *data, const size_t len)
+{
+        return serial_write_buff((struct Serial *) arg, data, len) ==
+                (int) len;
+}
+
+void Trace(struct Serial *serial, unsigned int argc, char **argv)
+{
+        if (argc < 2) {
+                put_commandError(serial, ERROR_CODE_MISSING_PARAMS);
+                return;
+        }
+
+        const char *cmd = argv[1];
+        if (0 == strcmp(cmd, "start")) {
+                const bool once = argc > 2 && 0 == strcmp(argv[2], "once");
+                if (!trace_start(once ? TRACE_MODE_ONCE : TRACE_MODE_RING)) {
+                        serial_write_s(serial, "Out of Memory!");
+                        put_crlf(serial);
+                        return;
+                }
+        } else if (0 == strcmp(cmd, "stop")) {
+                trace_stop();
+        } else if (0 == strcmp(cmd, "status")) {
+                uint32_t lost;
+                const size_t count = trace_count(&lost);
+                putDataRowHeader(serial, "Running");
+                put_int(serial, trace_is_running());
+                put_crlf(serial);
+                putDataRowHeader(serial, "Events");
+                put_uint(serial, count);
+                serial_write_s(serial, " / ");
+                put_uint(serial, TRACE_BUFFER_EVENTS);
+                put_crlf(serial);
+                putDataRowHeader(serial, "Lost");
+                put_uint(serial, lost);
+                put_crlf(serial);
+        } else if (0 == strcmp(cmd, "dump")) {
+                /*
+                 * Raw binary from here on.  The host finds the start by
+                 * the magic and the end by the size in the header.
+                 */
+                trace_dump(write_serial, serial);
+                return;
+        } else if (0 == strcmp(cmd, "save")) {
+                const int res = trace_save(argc > 2 ? argv[2] :
+                                           TRACE_FILE_NAME);
+                if (res) {
+                        put_commandError(serial, res);
+                        return;
+                }
+        } else {
+                put_commandError(serial, ERROR_CODE_INVALID_PARAM);
+                return;
+        }
+
+        put_commandOK(serial);
+}
+#endif /* TRACE_SUPPORT */
+
 void GetVersion(struct Serial *serial, unsigned int argc, char **argv)
 {
         putHeader(serial, "Version Info");
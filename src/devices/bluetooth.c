@@ -21,7 +21,10 @@
 
 #include "FreeRTOS.h"
 #include "bluetooth.h"
+#include "boot_stats.h"
+#include "device_cache.h"
 #include "loggerConfig.h"
+#include "macros.h"
 #include "printk.h"
 #include "task.h"
 #include "taskUtil.h"
@@ -167,18 +170,23 @@ static int bt_find_working_baud(DeviceConfig *config,
 {
         pr_info("BT: Detecting baud rate...\r\n");
         const int rates[] = BT_BAUD_RATES;
-        int rate = 0;
-
-        if (set_check_bt_serial_baud(config, targetBaud))
-                rate = targetBaud;
+        int bauds[ARRAY_LEN(rates) + 1] = {targetBaud};
+        size_t count = 1;
+        for (size_t i = 0; i < ARRAY_LEN(rates); ++i) {
+                /* Skip the target rate, it goes first */
+                if (rates[i] != targetBaud)
+                        bauds[count++] = rates[i];
+        }
 
-        for (size_t i = 0; rate == 0 && i < sizeof(rates)/sizeof(*rates); ++i) {
-                /* Skip the baud rate if we have already tried it */
-                if (rates[i] == targetBaud)
-                        continue;
+        /* The rate the module was left at last time goes before them all */
+        int order[ARRAY_LEN(bauds) + 1];
+        count = device_cache_probe_order(DEVICE_CACHE_BT_BAUD, bauds, count,
+                                         order);
 
-                if (set_check_bt_serial_baud(config, rates[i]))
-                        rate = rates[i];
+        int rate = 0;
+        for (size_t i = 0; rate == 0 && i < count; ++i) {
+                if (set_check_bt_serial_baud(config, order[i]))
+                        rate = order[i];
         }
 
         /* Check that we didn't fail to find a workable rate */
@@ -225,6 +233,8 @@ int bt_init_connection(DeviceConfig *config,  millis_t * connected_at, bool hard
         const char *new_name = btConfig->new_name;
         const char *new_pin = btConfig->new_pin;
 
+        boot_stats_begin(BOOT_PHASE_BLUETOOTH);
+
         /*
          * The HC-O6 seems to sometimes have trouble dealing with long AT
          * commands. Namely at high speed it seems that the device can't
@@ -262,12 +272,18 @@ int bt_init_connection(DeviceConfig *config,  millis_t * connected_at, bool hard
                 pr_info("BT: Init complete\r\n");
                 bt_clear_new_vals(btConfig);
                 g_bluetooth_status = BT_STATUS_PROVISIONED;
+                boot_stats_end(BOOT_PHASE_BLUETOOTH);
         } else {
                 pr_info("BT: Failed to provision module. A client may "
                         "already be connected.\r\n");
                 g_bluetooth_status = BT_STATUS_ERROR;
         }
 
+        /* Where the module answers now, if it answered at all */
+        if (baud)
+                device_cache_set(DEVICE_CACHE_BT_BAUD,
+                                 status ? targetBaud : baud);
+
         return DEVICE_INIT_SUCCESS;
 }
 
@@ -21,12 +21,14 @@
 
 #include "led.h"
 #include "api.h"
+#include "boot_stats.h"
 #include "capabilities.h"
 #include "cellular.h"
 #include "cell_pwr_btn.h"
 #include "constants.h"
 #include "cpu.h"
 #include "dateTime.h"
+#include "device_cache.h"
 #include "gsm.h"
 #include "loggerConfig.h"
 #include "macros.h"
@@ -443,6 +445,8 @@ int cellular_init_connection(DeviceConfig *config, millis_t * connected_at, bool
         /* This is sane since DeviceConfig is typedef'd as a serial_buffer */
         struct serial_buffer *sb = (struct serial_buffer*) config;
 
+        boot_stats_begin(BOOT_PHASE_CELLULAR);
+
         if (hard_init) {
                 gsm_power_off(sb);
                 pr_info("[cell] Power cycling modem\r\n");
@@ -451,18 +455,32 @@ int cellular_init_connection(DeviceConfig *config, millis_t * connected_at, bool
                         return DEVICE_INIT_FAIL;
         }
 
-        /* If here, there is a modem attached.  Figure out what modem it is */
-        enum cellular_modem modem_type = probe_cellular_manuf(sb);
+        /*
+         * If here, there is a modem attached.  Unless it let us down last
+         * time, assume it is the one we found before rather than asking.
+         */
+        static bool cached_modem_failed;
+        enum cellular_modem modem_type = cached_modem_failed ?
+                CELLULAR_MODEM_UNKNOWN :
+                (enum cellular_modem) device_cache_get(DEVICE_CACHE_CELL_MODEM);
+        const bool modem_cached = CELLULAR_MODEM_UNKNOWN != modem_type;
+        if (!modem_cached)
+                modem_type = probe_cellular_manuf(sb);
+
         if (!get_methods(modem_type, &methods)) {
                 pr_error_int_msg("Unable to load methods for modem_type ",
                                  modem_type);
+                cached_modem_failed |= modem_cached;
                 return DEVICE_INIT_FAIL;
         }
 
         if (!methods->init_modem(sb, &cell_info, cellCfg)) {
                 telemetry_info.status = TELEMETRY_STATUS_MODEM_INIT_FAILED;
+                cached_modem_failed |= modem_cached;
                 return DEVICE_INIT_FAIL;
         }
+        device_cache_set(DEVICE_CACHE_CELL_MODEM, modem_type);
+        cached_modem_failed = false;
 
         /* Read SIM data.  Don't care if these fail */
         methods->get_sim_info(sb, &cell_info);
@@ -503,6 +521,7 @@ int cellular_init_connection(DeviceConfig *config, millis_t * connected_at, bool
 
         telemetry_info.status = TELEMETRY_STATUS_CONNECTED;
         telemetry_info.active_since = getUptime();
+        boot_stats_end(BOOT_PHASE_CELLULAR);
 
         return DEVICE_INIT_SUCCESS;
 }
@@ -0,0 +1,141 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "device_cache.h"
+#include "logger.h"
+#include "loggerConfig.h"
+#include "printk.h"
+#include "task.h"
+#include "taskUtil.h"
+#include "timers.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define LOG_PFX	"[device cache] "
+
+void device_cache_reset(struct device_cache *cache)
+{
+        memset(cache, 0, sizeof(*cache));
+}
+
+uint32_t device_cache_get(const enum device_cache_item item)
+{
+        return getWorkingLoggerConfig()->device_cache.values[item];
+}
+
+/*
+ * Drivers settle one after another during boot, so saves are held
+ * until the cache has been quiet this long and then done once.
+ */
+#define SAVE_DELAY_MS	5000
+
+static xTimerHandle g_save_timer;
+static volatile bool g_dirty;
+
+static void save(void)
+{
+        LoggerConfig *lc = getWorkingLoggerConfig();
+
+        /* Decide under the lock, flash outside it */
+        vTaskSuspendAll();
+        const bool unsaved = 0 != memcmp(lc, getSavedLoggerConfig(),
+                                         offsetof(LoggerConfig,
+                                                  device_cache));
+        const bool flash = g_dirty && !unsaved && !logging_is_active();
+        if (flash)
+                g_dirty = false;
+        xTaskResumeAll();
+
+        if (unsaved) {
+                pr_info(LOG_PFX "unsaved config, deferring\r\n");
+                return;
+        }
+
+        /*
+         * A value set while this runs marks the cache dirty again and
+         * restarts the timer, so it is never lost.
+         */
+        if (flash && flashLoggerConfig()) {
+                pr_warning(LOG_PFX "flash failed\r\n");
+                g_dirty = true;
+        }
+}
+
+static void save_timer_cb(xTimerHandle timer)
+{
+        save();
+}
+
+void device_cache_set(const enum device_cache_item item,
+                      const uint32_t value)
+{
+        LoggerConfig *lc = getWorkingLoggerConfig();
+
+        vTaskSuspendAll();
+        const bool changed = lc->device_cache.values[item] != value;
+        if (changed) {
+                lc->device_cache.values[item] = value;
+                g_dirty = true;
+        }
+
+        if (changed && !g_save_timer)
+                g_save_timer = xTimerCreate((signed char*) "Device Cache",
+                                            msToTicks(SAVE_DELAY_MS),
+                                            false, NULL, save_timer_cb);
+        xTaskResumeAll();
+
+        if (!changed)
+                return;
+
+        /* Without a timer, save right away */
+        if (!g_save_timer || pdPASS != xTimerReset(g_save_timer, 0))
+                save();
+}
+
+size_t device_cache_probe_order(const enum device_cache_item item,
+                                const int bauds[], const size_t count,
+                                int order[])
+{
+        size_t len = 0;
+        const int cached = device_cache_get(item);
+        if (cached)
+                order[len++] = cached;
+
+        for (size_t i = 0; i < count; ++i) {
+                if (bauds[i] != cached)
+                        order[len++] = bauds[i];
+        }
+
+        return len;
+}
+
+const char* device_cache_name(const enum device_cache_item item)
+{
+        static const char* const names[DEVICE_CACHE_COUNT] = {
+                [DEVICE_CACHE_GPS_BAUD] = "gpsBaud",
+                [DEVICE_CACHE_BT_BAUD] = "btBaud",
+                [DEVICE_CACHE_WIFI_BAUD] = "wifiBaud",
+                [DEVICE_CACHE_CELL_MODEM] = "cellModem",
+        };
+
+        return names[item];
+}
@@ -21,9 +21,9 @@
 
 #include "at.h"
 #include "at_basic.h"
+#include "block_pool.h"
 #include "esp8266.h"
 #include "macros.h"
-#include "mem_mang.h"
 #include "net/protocol.h"
 #include "printk.h"
 #include "serial.h"
@@ -969,6 +969,9 @@ struct tx_info {
         esp8266_send_data_cb_t* cb;
 };
 
+/* One per command that can be queued, so a send never waits on memory */
+BLOCK_POOL_DEFINE(tx_info_pool, "wifiTx", struct tx_info, AT_CMD_MAX_CMDS);
+
 /**
  * This call back is special in that it handle two types of response.
  * Since the send_data command for the esp8266 is a two step command,
@@ -1038,7 +1041,7 @@ fini:
         if (ti->cb)
                 ti->cb(status, ti->sent, ti->chan_id);
 
-        portFree(ti);
+        block_pool_free(&tx_info_pool, ti);
         return false;
 }
 
@@ -1065,13 +1068,14 @@ bool esp8266_send_data(const unsigned int chan_id, struct Serial *serial,
          * end of the command in the send_data_cb above when the command
          * is done.
          */
-        struct tx_info *ti = calloc(sizeof(struct tx_info), 1);
+        struct tx_info *ti = block_pool_alloc(&tx_info_pool,
+                                              sizeof(struct tx_info));
         if (!ti) {
-                /* Malloc failure.  Le-sigh */
-                cmd_failure(cmd_name, "Malloc failed for send procedure.");
+                cmd_failure(cmd_name, "No tx_info free for send procedure.");
                 return false;
         }
 
+        memset(ti, 0, sizeof(struct tx_info));
         ti->serial = serial;
         ti->len = len;
         ti->cb = cb;
@@ -1080,8 +1084,11 @@ bool esp8266_send_data(const unsigned int chan_id, struct Serial *serial,
         char cmd[32];
         snprintf(cmd, ARRAY_LEN(cmd),"AT+CIPSEND=%d,%d", chan_id, (int) len);
 
-        return NULL != at_put_cmd(state.ati, cmd, _TIMEOUT_SUPER_MS,
-                                  send_data_cb, ti);
+        if (at_put_cmd(state.ati, cmd, _TIMEOUT_SUPER_MS, send_data_cb, ti))
+                return true;
+
+        block_pool_free(&tx_info_pool, ti);
+        return false;
 }
 
 
@@ -1175,10 +1182,10 @@ bool esp8266_set_uart_config_raw(const size_t baud, const size_t bits,
         return done;
 }
 
-bool esp8266_probe_device(struct Serial* serial, const int fast_baud)
+int esp8266_probe_device(struct Serial* serial, const int bauds[],
+                         const size_t count)
 {
-        const int bauds[] = {fast_baud, ESP8266_SERIAL_DEF_BAUD};
-        return at_basic_probe(serial, bauds, ARRAY_LEN(bauds),
+        return at_basic_probe(serial, bauds, count,
                               AT_PROBE_TRIES, AT_PROBE_DELAY_MS,
                               ESP8266_SERIAL_DEF_BITS,
                               ESP8266_SERIAL_DEF_PARITY,
@@ -21,8 +21,10 @@
 #include "FreeRTOS.h"
 #include "at_basic.h"
 #include "byteswap.h"
+#include "device_cache.h"
 #include "mem_mang.h"
 #include "printk.h"
+#include "skytraq_frame.h"
 #include "task.h"
 #include "taskUtil.h"
 #include <math.h>
@@ -47,6 +49,7 @@
 #define GPS_INIT_DELAY_MS		1000
 #define GPS_MSG_RX_WAIT_MS		2000
 #define GPS_MESSAGE_BUFFER_LEN		1024
+#define GPS_RX_BLOCK_LEN		64
 #define TARGET_BAUD_RATE 		115200
 #define MESSAGE_TYPE_NMEA		1
 #define MESSAGE_TYPE_BINARY		2
@@ -264,76 +267,68 @@ static void txGpsMessage(GpsMessage * msg, struct Serial * serial)
         serial_write_c(serial, 0x0A);
 }
 
+/*
+ * Receive side state.  Bytes are pulled from the serial port a block at
+ * a time and fed through the frame parser; anything left over after a
+ * frame completes stays here for the next call.
+ */
+static struct {
+        uint8_t buff[GPS_RX_BLOCK_LEN];
+        size_t len;
+        size_t pos;
+        struct skytraq_frame_parser parser;
+} gps_rx;
+
+static void rxReset(void)
+{
+        gps_rx.len = 0;
+        gps_rx.pos = 0;
+        skytraq_frame_reset(&gps_rx.parser);
+}
+
 static gps_msg_result_t rxGpsMessage(GpsMessage* msg, struct Serial* serial,
                                      uint8_t expectedMessageId)
 {
+        struct skytraq_frame_parser *parser = &gps_rx.parser;
         const size_t timeoutLen = msToTicks(GPS_MSG_RX_WAIT_MS);
         const size_t timeoutStart = xTaskGetTickCount();
 
+        if (parser->payload != msg->payload)
+                skytraq_frame_init(parser, msg->payload, MAX_PAYLOAD_LEN);
+
         while (true) {
                 if (isTimeoutMs(timeoutStart, GPS_MSG_RX_WAIT_MS))
                         return GPS_MSG_TIMEOUT;
 
-                uint8_t tmp;
-                if (!serial_read_byte(serial, &tmp, timeoutLen) ||
-                    0xA0 != tmp)
-                        continue;
-
-                if (!serial_read_byte(serial, &tmp, timeoutLen) ||
-                    0xA1 != tmp)
-                        continue;
-
-                /*
-                 * If here, we have found our start of message. All errors
-                 * from here until we check expectedMessageId are fatal.
-                 */
-                uint8_t len8[2];
-                if (!serial_read_byte(serial, len8 + 0, timeoutLen) ||
-                    !serial_read_byte(serial, len8 + 1, timeoutLen)) {
-                        pr_debug("GPS: Failed to read msg length\r\n");
-                        return GPS_MSG_READERR;
-                }
+                if (gps_rx.pos == gps_rx.len) {
+                        const int read = serial_read_buff_wait(serial,
+                                                               gps_rx.buff,
+                                                               GPS_RX_BLOCK_LEN,
+                                                               timeoutLen);
+                        if (read <= 0)
+                                continue;
 
-                uint16_t msg_len = (len8[0] << 8) + len8[1];
-                if (msg_len > MAX_PAYLOAD_LEN) {
-                        pr_debug("GPS: Msg payload too big\r\n");
-                        return GPS_MSG_READERR;
+                        gps_rx.len = read;
+                        gps_rx.pos = 0;
                 }
 
-                for (size_t i = 0; i < msg_len; ++i) {
-                        if (!serial_read_byte(serial, msg->payload + i,
-                                              timeoutLen)) {
-                                pr_debug("GPS: Payload read timeout\r\n");
-                                return GPS_MSG_READERR;
-                        }
-                }
+                size_t consumed;
+                const enum skytraq_frame_result res =
+                        skytraq_frame_parse(parser, gps_rx.buff + gps_rx.pos,
+                                            gps_rx.len - gps_rx.pos,
+                                            &consumed);
+                gps_rx.pos += consumed;
 
-                uint8_t checksum = 0;
-                if (!serial_read_byte(serial, &checksum, timeoutLen)) {
-                        pr_debug("GPS: Failed to read checksum\r\n");
-                        return GPS_MSG_READERR;
-                }
+                if (SKYTRAQ_FRAME_NONE == res)
+                        continue;
 
-                msg->payloadLength = msg_len;
-                const uint8_t calculatedChecksum = calculateChecksum(msg);
-                if (calculatedChecksum != checksum) {
-                        pr_debug("GPS: Msg checksum mismatch\r\n");
-                        pr_trace_int_msg("GPS: Checksum expected: ",
-                                         (int) calculatedChecksum);
-                        pr_trace_int_msg("GPS: Checksum actual: ",
-                                         (int) checksum);
+                if (SKYTRAQ_FRAME_ERROR == res) {
+                        pr_debug("GPS: Malformed msg\r\n");
                         return GPS_MSG_READERR;
                 }
 
-                const bool read_eos =
-                        serial_read_byte(serial, &tmp, timeoutLen) &&
-                        tmp == 0x0D &&
-                        serial_read_byte(serial, &tmp, timeoutLen) &&
-                        tmp == 0x0A;
-                if (!read_eos) {
-                        pr_debug("GPS: Invalid EOS\r\n");
-                        return GPS_MSG_READERR;
-                }
+                msg->payloadLength = parser->len;
+                msg->checksum = parser->checksum;
 
                 /*
                  * If here then we have a good message. Check to see that its
@@ -475,16 +470,32 @@ static void print_gps_msg_result(const gps_msg_result_t result)
         }
 }
 
+/*
+ * Each wrong guess costs a full message timeout, so start with the
+ * rate the module came up at on an earlier boot, then the rate we run
+ * it at, where it still is if we set it before a reset of our own.
+ */
 static uint32_t detectGpsBaudRate(GpsMessage *gpsMsg,
                                   struct Serial *serial)
 {
-        BaudRateCodes baud_rates[BAUD_RATE_COUNT] = BAUD_RATES;
-
+        const BaudRateCodes baud_rates[BAUD_RATE_COUNT] = BAUD_RATES;
+        int bauds[BAUD_RATE_COUNT] = {TARGET_BAUD_RATE};
+        size_t count = 1;
         for (size_t i = 0; i < BAUD_RATE_COUNT; i++) {
-                uint32_t baudRate = baud_rates[i].baud;
+                if (baud_rates[i].baud != TARGET_BAUD_RATE)
+                        bauds[count++] = baud_rates[i].baud;
+        }
+
+        int order[BAUD_RATE_COUNT + 1];
+        count = device_cache_probe_order(DEVICE_CACHE_GPS_BAUD, bauds,
+                                         count, order);
+
+        for (size_t i = 0; i < count; i++) {
+                const uint32_t baudRate = order[i];
                 pr_info_int_msg("GPS: probing baud rate: ", baudRate);
                 serial_config(serial, 8, 0, 1, baudRate);
                 serial_clear(serial);
+                rxReset();
                 sendQuerySwVersion(gpsMsg, serial);
                 if (rxGpsMessage(gpsMsg, serial, MSG_ID_SW_VERSION) ==
                     GPS_MSG_SUCCESS) {
@@ -505,6 +516,7 @@ static gps_cmd_result_t attemptFactoryDefaults(GpsMessage * gpsMsg,
                 pr_info_int_msg("GPS: attempting factory defaults at: ", baudRate);
                 serial_config(serial, 8, 0, 1, baudRate);
                 serial_flush(serial);
+                rxReset();
                 sendSetFactoryDefaults(gpsMsg, serial);
                 if ((rxGpsMessage(gpsMsg, serial, MSG_ID_ACK) == GPS_MSG_SUCCESS) &&
                     (gpsMsg->ackMsg.messageId == MSG_ID_SET_FACTORY_DEFAULTS)) {
@@ -676,6 +688,7 @@ gps_status_t GPS_device_init(uint8_t sampleRate, struct Serial *serial)
 {
         pr_info("GPS: Initializing...\r\n");
         serial_flush(serial);
+        rxReset();
 
         /*
          * Delay a bit to let GPS chip come online.  To do this without
@@ -697,6 +710,16 @@ gps_status_t GPS_device_init(uint8_t sampleRate, struct Serial *serial)
                         uint32_t baudRate = detectGpsBaudRate(&gpsMsg, serial);
                         if (baudRate) {
                                 pr_info_int_msg("GPS: module detected at: ", baudRate);
+
+                                /*
+                                 * Finding it at our own rate says nothing
+                                 * about where it starts, as we may have
+                                 * put it there before a reset of ours.
+                                 */
+                                if (baudRate != TARGET_BAUD_RATE)
+                                        device_cache_set(DEVICE_CACHE_GPS_BAUD,
+                                                         baudRate);
+
                                 if (baudRate != TARGET_BAUD_RATE && configureBaudRate(&gpsMsg, serial, TARGET_BAUD_RATE) == GPS_COMMAND_FAIL) {
                                         pr_error("GPS: Error: could not configure baud rate\r\n");
                                         break;
@@ -704,6 +727,7 @@ gps_status_t GPS_device_init(uint8_t sampleRate, struct Serial *serial)
 
                                 serial_config(serial, 8, 0, 1, TARGET_BAUD_RATE);
                                 serial_flush(serial);
+                                rxReset();
 
                                 uint8_t targetUpdateRate = getTargetUpdateRate(sampleRate);
                                 uint8_t currentUpdateRate = queryPositionUpdateRate(&gpsMsg, serial);
@@ -0,0 +1,158 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "skytraq_frame.h"
+
+#include <string.h>
+
+enum parse_state {
+        STATE_SYNC1 = 0,
+        STATE_SYNC2,
+        STATE_LEN_HI,
+        STATE_LEN_LO,
+        STATE_PAYLOAD,
+        STATE_CHECKSUM,
+        STATE_EOS_CR,
+        STATE_EOS_LF,
+};
+
+void skytraq_frame_init(struct skytraq_frame_parser *p, uint8_t *payload,
+                        const uint16_t size)
+{
+        memset(p, 0, sizeof(*p));
+        p->payload = payload;
+        p->payload_size = size;
+}
+
+void skytraq_frame_reset(struct skytraq_frame_parser *p)
+{
+        p->state = STATE_SYNC1;
+}
+
+static enum skytraq_frame_result frame_error(struct skytraq_frame_parser *p)
+{
+        p->state = STATE_SYNC1;
+        ++p->errors;
+        return SKYTRAQ_FRAME_ERROR;
+}
+
+static size_t consume_payload(struct skytraq_frame_parser *p,
+                              const uint8_t *buf, const size_t len)
+{
+        size_t n = p->len - p->pos;
+        if (n > len)
+                n = len;
+
+        uint8_t *dst = p->payload + p->pos;
+        uint8_t checksum = p->checksum;
+        for (size_t i = 0; i < n; ++i) {
+                dst[i] = buf[i];
+                checksum ^= buf[i];
+        }
+
+        p->checksum = checksum;
+        p->pos += n;
+        if (p->pos == p->len)
+                p->state = STATE_CHECKSUM;
+
+        return n;
+}
+
+enum skytraq_frame_result skytraq_frame_parse(struct skytraq_frame_parser *p,
+                                              const uint8_t *buf,
+                                              const size_t len,
+                                              size_t *consumed)
+{
+        size_t i = 0;
+
+        while (i < len) {
+                if (STATE_SYNC1 == p->state) {
+                        const uint8_t *sync =
+                                memchr(buf + i, SKYTRAQ_FRAME_SYNC1, len - i);
+                        if (!sync) {
+                                i = len;
+                                break;
+                        }
+
+                        i = sync - buf + 1;
+                        p->state = STATE_SYNC2;
+                        continue;
+                }
+
+                if (STATE_PAYLOAD == p->state) {
+                        i += consume_payload(p, buf + i, len - i);
+                        continue;
+                }
+
+                const uint8_t b = buf[i++];
+                switch (p->state) {
+                case STATE_SYNC2:
+                        if (SKYTRAQ_FRAME_SYNC2 == b)
+                                p->state = STATE_LEN_HI;
+                        else if (SKYTRAQ_FRAME_SYNC1 != b)
+                                p->state = STATE_SYNC1;
+                        break;
+                case STATE_LEN_HI:
+                        p->len = b << 8;
+                        p->state = STATE_LEN_LO;
+                        break;
+                case STATE_LEN_LO:
+                        p->len |= b;
+                        if (p->len > p->payload_size) {
+                                *consumed = i;
+                                return frame_error(p);
+                        }
+
+                        p->pos = 0;
+                        p->checksum = 0;
+                        p->state = STATE_PAYLOAD;
+                        break;
+                case STATE_CHECKSUM:
+                        if (b != p->checksum) {
+                                *consumed = i;
+                                return frame_error(p);
+                        }
+                        p->state = STATE_EOS_CR;
+                        break;
+                case STATE_EOS_CR:
+                        if (0x0D != b) {
+                                *consumed = i;
+                                return frame_error(p);
+                        }
+                        p->state = STATE_EOS_LF;
+                        break;
+                case STATE_EOS_LF:
+                        *consumed = i;
+                        if (0x0A != b)
+                                return frame_error(p);
+
+                        p->state = STATE_SYNC1;
+                        ++p->frames;
+                        return SKYTRAQ_FRAME_READY;
+                default:
+                        p->state = STATE_SYNC1;
+                        break;
+                }
+        }
+
+        *consumed = i;
+        return SKYTRAQ_FRAME_NONE;
+}
@@ -21,9 +21,11 @@
 
 #include "FreeRTOS.h"
 #include "at_basic.h"
+#include "boot_stats.h"
 #include "capabilities.h"
 #include "constants.h"
 #include "dateTime.h"
+#include "device_cache.h"
 #include "esp8266.h"
 #include "esp8266_drv.h"
 #include "net/ipv4.h"
@@ -31,6 +33,7 @@
 #include "led.h"
 #include "loggerConfig.h"
 #include "panic.h"
+#include "perf.h"
 #include "printk.h"
 #include "queue.h"
 #include "semphr.h"
@@ -610,6 +613,7 @@ static void init_wifi_cb(const bool status)
         }
 
         pr_info(LOG_PFX "Initialization successful\r\n");
+        boot_stats_end(BOOT_PHASE_WIFI);
 
         /*
          * Clear out the timestamps and set the checks on all the
@@ -1346,6 +1350,8 @@ static bool init_channel_sync_op(struct channel_sync_op* op)
 bool esp8266_drv_init(struct Serial *s, const int priority,
                       new_conn_func_t new_conn_cb)
 {
+        boot_stats_begin(BOOT_PHASE_WIFI);
+
         /* Initialize the esp8266 hardware */
         if (!wifi_device_init()) {
                 pr_error(LOG_PFX "Failed to init WiFi device\r\n");
@@ -1361,12 +1367,22 @@ bool esp8266_drv_init(struct Serial *s, const int priority,
         }
         esp8266_state.device.serial = s;
 
-        /* Probe for our serial device and adjust baud. */
+        /*
+         * Probe for our serial device and adjust baud.  A reset puts it
+         * back at its own rate, so try the one it was found at last.
+         */
         esp8266_wait_for_ready(s);
-        if (!esp8266_probe_device(s, WIFI_MAX_BAUD)) {
+        const int bauds[] = {WIFI_MAX_BAUD, ESP8266_SERIAL_DEF_BAUD};
+        int order[ARRAY_LEN(bauds) + 1];
+        const size_t count = device_cache_probe_order(DEVICE_CACHE_WIFI_BAUD,
+                                                      bauds, ARRAY_LEN(bauds),
+                                                      order);
+        const int baud = esp8266_probe_device(s, order, count);
+        if (!baud) {
                 pr_warning(LOG_PFX "Failed to probe WiFi device\r\n");
                 goto init_failed;
         }
+        device_cache_set(DEVICE_CACHE_WIFI_BAUD, baud);
 
         /* Create and setup semaphores for connections */
         const bool init_sync_ops =
@@ -1403,6 +1419,7 @@ bool esp8266_drv_init(struct Serial *s, const int priority,
 
         static const signed char task_name[] = TASK_THREAD_NAME;
         const size_t stack_size = TASK_STACK_SIZE;
+        perf_register_task(task_name, stack_size);
         xTaskCreate(task, task_name, stack_size, NULL, priority, NULL);
 
         const signed char* timer_name = (signed char*) "Wifi LED Timer";
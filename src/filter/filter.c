@@ -21,7 +21,9 @@
 
 
 #include "filter.h"
+#include "macros.h"
 #include "math.h"
+#include <string.h>
 
 //Implements a fast Exponential Moving Average filter
 #define MIN_ALPHA 0.0001
@@ -41,6 +43,255 @@ int32_t update_filter(Filter *filter, const int32_t value)
         } else {
                 filter->count++;
         }
-        filter->current_value = filter->total / filter->count;
+        filter->current_value = (int32_t) (filter->total / filter->count);
         return filter->current_value;
 }
+
+/*
+ * Fixed point layout of the channel filters.  Samples are carried with
+ * 8 fractional bits inside the EMA and biquad kernels so that slow
+ * filters do not stall on rounding, and biquad coefficients are Q30.
+ * Inputs are railed so the 64 bit biquad accumulator cannot overflow.
+ */
+#define SAMPLE_FRAC_BITS        8
+#define COEFF_FRAC_BITS         30
+#define EMA_FRAC_BITS           16
+/* Smallest alpha that doesn't round to 0 and freeze the filter */
+#define EMA_MIN_ALPHA           (1.0f / (1 << EMA_FRAC_BITS))
+#define BIQUAD_Q                0.70710678f
+#define BIQUAD_MAX_CUTOFF       0.45f
+
+static int32_t rail_input(const int32_t value)
+{
+        return MAX(MIN(value, CHANNEL_FILTER_INPUT_LIMIT),
+                   -CHANNEL_FILTER_INPUT_LIMIT);
+}
+
+static int32_t to_sample(const int32_t value)
+{
+        return value * (1 << SAMPLE_FRAC_BITS);
+}
+
+static int32_t from_sample(const int32_t sample)
+{
+        return (sample + (1 << (SAMPLE_FRAC_BITS - 1))) >> SAMPLE_FRAC_BITS;
+}
+
+static int32_t to_coeff(const float value)
+{
+        return (int32_t) lroundf(value * (1 << COEFF_FRAC_BITS));
+}
+
+/* Power of two windows let us shift instead of divide */
+static uint8_t window_shift(const size_t size)
+{
+        uint8_t shift = 0;
+        while ((2u << shift) <= size)
+                ++shift;
+
+        return shift;
+}
+
+void channel_filter_reset_config(struct channel_filter_config *cfg)
+{
+        cfg->type = CHANNEL_FILTER_NONE;
+        cfg->size = 1;
+        cfg->param = 1.0f;
+}
+
+void channel_filter_sanitize_config(struct channel_filter_config *cfg)
+{
+        if (cfg->type >= CHANNEL_FILTER_ENUM_COUNT)
+                cfg->type = CHANNEL_FILTER_NONE;
+
+        cfg->size = MAX(MIN(cfg->size, CHANNEL_FILTER_MAX_SIZE), 1);
+
+        if (!(cfg->param > 0))
+                cfg->param = 1.0f;
+
+        /* Report the values the filters will actually run with */
+        switch (cfg->type) {
+        case CHANNEL_FILTER_EMA:
+                cfg->param = MAX(MIN(cfg->param, 1.0f), EMA_MIN_ALPHA);
+                break;
+        case CHANNEL_FILTER_MOVING_AVERAGE:
+                cfg->size = 1 << window_shift(cfg->size);
+                break;
+        default:
+                break;
+        }
+}
+
+static void init_ema(struct channel_filter *f, const float alpha)
+{
+        f->ema.alpha = lroundf(alpha * (1 << EMA_FRAC_BITS));
+}
+
+static void init_moving_average(struct channel_filter *f)
+{
+        f->window.shift = window_shift(f->size);
+}
+
+static bool init_biquad(struct channel_filter *f, const float cutoff_hz,
+                        const unsigned int rate_hz)
+{
+        if (0 == rate_hz)
+                return false;
+
+        /* RBJ cookbook low-pass, Butterworth Q */
+        const float fc = MIN(cutoff_hz / rate_hz, BIQUAD_MAX_CUTOFF);
+        const float w0 = 2 * M_PI * fc;
+        const float cos_w0 = cosf(w0);
+        const float alpha = sinf(w0) / (2 * BIQUAD_Q);
+        const float a0 = 1 + alpha;
+
+        f->biquad.b0 = to_coeff((1 - cos_w0) / 2 / a0);
+        f->biquad.b1 = to_coeff((1 - cos_w0) / a0);
+        f->biquad.b2 = f->biquad.b0;
+        f->biquad.a1 = to_coeff(-2 * cos_w0 / a0);
+        f->biquad.a2 = to_coeff((1 - alpha) / a0);
+        return true;
+}
+
+void channel_filter_init(struct channel_filter *f,
+                         const struct channel_filter_config *cfg,
+                         const unsigned int rate_hz)
+{
+        struct channel_filter_config c = *cfg;
+        channel_filter_sanitize_config(&c);
+
+        memset(f, 0, sizeof(struct channel_filter));
+        f->type = c.type;
+        f->size = c.size;
+
+        switch (f->type) {
+        case CHANNEL_FILTER_EMA:
+                init_ema(f, c.param);
+                break;
+        case CHANNEL_FILTER_MOVING_AVERAGE:
+                init_moving_average(f);
+                break;
+        case CHANNEL_FILTER_BIQUAD_LOWPASS:
+                if (!init_biquad(f, c.param, rate_hz))
+                        f->type = CHANNEL_FILTER_NONE;
+                break;
+        default:
+                break;
+        }
+}
+
+bool channel_filter_enabled(const struct channel_filter *f)
+{
+        return CHANNEL_FILTER_NONE != f->type;
+}
+
+static int32_t update_ema(struct channel_filter *f, const int32_t value)
+{
+        const int32_t x = to_sample(value);
+
+        if (!f->count) {
+                f->count = 1;
+                f->ema.state = x;
+        }
+
+        const int64_t delta = f->ema.alpha * ((int64_t) x - f->ema.state);
+        f->ema.state += (int32_t) (delta >> EMA_FRAC_BITS);
+        return from_sample(f->ema.state);
+}
+
+static int32_t update_moving_average(struct channel_filter *f,
+                                     const int32_t value)
+{
+        int32_t *window = f->window.window;
+
+        /* Prime the whole window with the first sample */
+        if (!f->count) {
+                f->count = f->size;
+                for (size_t i = 0; i < f->size; ++i)
+                        window[i] = value;
+                f->window.sum = value * f->size;
+        }
+
+        f->window.sum += value - window[f->index];
+        window[f->index] = value;
+        f->index = (f->index + 1) & (f->size - 1);
+
+        const int32_t round = (1 << f->window.shift) >> 1;
+        return (f->window.sum + round) >> f->window.shift;
+}
+
+static int32_t update_median(struct channel_filter *f, const int32_t value)
+{
+        int32_t sorted[CHANNEL_FILTER_MAX_SIZE];
+
+        f->window.window[f->index] = value;
+        f->index = (f->index + 1) % f->size;
+        if (f->count < f->size)
+                ++f->count;
+
+        /* Insertion sort; the window is tiny */
+        for (size_t i = 0; i < f->count; ++i) {
+                const int32_t v = f->window.window[i];
+                size_t j = i;
+
+                for (; j > 0 && sorted[j - 1] > v; --j)
+                        sorted[j] = sorted[j - 1];
+
+                sorted[j] = v;
+        }
+
+        return sorted[f->count / 2];
+}
+
+static int32_t update_biquad(struct channel_filter *f, const int32_t value)
+{
+        const int32_t x = to_sample(value);
+
+        /* Start from steady state to avoid a step response at startup */
+        if (!f->count) {
+                f->count = 1;
+                f->biquad.x1 = f->biquad.x2 = x;
+                f->biquad.y1 = f->biquad.y2 = x;
+        }
+
+        const int64_t acc =
+                (int64_t) f->biquad.b0 * x +
+                (int64_t) f->biquad.b1 * f->biquad.x1 +
+                (int64_t) f->biquad.b2 * f->biquad.x2 -
+                (int64_t) f->biquad.a1 * f->biquad.y1 -
+                (int64_t) f->biquad.a2 * f->biquad.y2;
+        const int32_t y = (int32_t) ((acc + (1LL << (COEFF_FRAC_BITS - 1)))
+                                     >> COEFF_FRAC_BITS);
+
+        f->biquad.x2 = f->biquad.x1;
+        f->biquad.x1 = x;
+        f->biquad.y2 = f->biquad.y1;
+        f->biquad.y1 = y;
+
+        return from_sample(y);
+}
+
+int32_t channel_filter_update(struct channel_filter *f, const int32_t value)
+{
+        const int32_t x = rail_input(value);
+
+        switch (f->type) {
+        case CHANNEL_FILTER_EMA:
+                f->value = update_ema(f, x);
+                break;
+        case CHANNEL_FILTER_MOVING_AVERAGE:
+                f->value = update_moving_average(f, x);
+                break;
+        case CHANNEL_FILTER_MEDIAN:
+                f->value = update_median(f, x);
+                break;
+        case CHANNEL_FILTER_BIQUAD_LOWPASS:
+                f->value = update_biquad(f, x);
+                break;
+        default:
+                f->value = value;
+                break;
+        }
+
+        return f->value;
+}
@@ -24,6 +24,11 @@
 #include "geopoint.h"
 #include "tracks.h"
 #include "printk.h"
+#include "track_frame.h"
+
+#include <math.h>
+#include <stdint.h>
+
 struct GeoCircle gc_createGeoCircle(const GeoPoint gp, const float r)
 {
         struct GeoCircle gc;
@@ -36,8 +41,63 @@ struct GeoCircle gc_createGeoCircle(const GeoPoint gp, const float r)
 
 bool gc_isPointInGeoCircle(const GeoPoint * point, const struct GeoCircle gc)
 {
-        float dist = distPythag(point, &(gc.point));
-        return  dist <= gc.radius;
+        const struct track_frame *frame = track_frame_get_active();
+        if (!frame) {
+                float dist = distPythag(point, &(gc.point));
+                return  dist <= gc.radius;
+        }
+
+        const struct track_point p = track_frame_project(frame, point);
+        const struct track_point c = track_frame_project(frame, &gc.point);
+        const int64_t r_cm = gc.radius * 100;
+        return track_point_dist_sq(&p, &c) <= r_cm * r_cm;
+}
+
+bool gc_isSegmentInGeoCircle(const GeoPoint *a, const GeoPoint *b,
+                             const struct GeoCircle gc, float *enter,
+                             float *leave)
+{
+        /* Work in the active track frame, else one centered on the circle */
+        const struct track_frame *frame = track_frame_get_active();
+        struct track_frame local;
+        if (!frame) {
+                track_frame_init(&local, &gc.point);
+                frame = &local;
+        }
+
+        const struct track_point tc = track_frame_project(frame, &gc.point);
+        const struct track_point ta = track_frame_project(frame, a);
+        const struct track_point tb = track_frame_project(frame, b);
+        const float ax = (ta.x - tc.x) / 100.0f;
+        const float ay = (ta.y - tc.y) / 100.0f;
+        const float bx = (tb.x - tc.x) / 100.0f;
+        const float by = (tb.y - tc.y) / 100.0f;
+
+        /* Solve |a + t(b - a)|^2 = r^2 for t */
+        const float dx = bx - ax;
+        const float dy = by - ay;
+        const float qa = dx * dx + dy * dy;
+        const float qc = ax * ax + ay * ay - gc.radius * gc.radius;
+        if (qa == 0) {
+                *enter = 0;
+                *leave = 1;
+                return qc <= 0;
+        }
+
+        const float qb = 2 * (ax * dx + ay * dy);
+        const float disc = qb * qb - 4 * qa * qc;
+        if (disc < 0)
+                return false;
+
+        const float root = sqrt(disc);
+        const float t1 = (-qb - root) / (2 * qa);
+        const float t2 = (-qb + root) / (2 * qa);
+        if (t2 < 0 || t1 > 1)
+                return false;
+
+        *enter = t1 < 0 ? 0 : t1;
+        *leave = t2 > 1 ? 1 : t2;
+        return true;
 }
 
 bool gc_isValidGeoCircle(const struct GeoCircle gc)
@@ -19,9 +19,12 @@
  * this code. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "FreeRTOS.h"
+#include "boot_stats.h"
 #include "convert.h"
 #include "gps.h"
 #include "gps_device.h"
+#include "task.h"
 #include <string.h>
 
 #define GPS_LOCK_FLASH_COUNT 5
@@ -44,7 +47,12 @@ gps_status_t GPS_init(uint8_t targetSampleRate, struct Serial *serial)
         g_timeFirstFix = 0;
         g_flashCount = 0;
         g_uptimeAtSample = 0;
+
+        boot_stats_begin(BOOT_PHASE_GPS);
         gps_status = GPS_device_init(targetSampleRate, serial);
+        if (GPS_STATUS_PROVISIONED == gps_status)
+                boot_stats_end(BOOT_PHASE_GPS);
+
         return gps_status;
 }
 
@@ -91,7 +99,12 @@ millis_t getMillisSinceEpoch()
         if (isGpsDataCold()) return 0;
 
         //interpolate milliseconds from system clock
-        return g_gpsSnapshot.sample.time + getDeltaSinceSample();
+        taskENTER_CRITICAL();
+        const millis_t time = g_gpsSnapshot.sample.time +
+                getDeltaSinceSample();
+        taskEXIT_CRITICAL();
+
+        return time;
 }
 
 /**
@@ -177,21 +190,36 @@ GeoPoint getPreviousGeoPoint()
         return g_gpsSnapshot.previousPoint;
 }
 
+/*
+ * The GPS task writes the snapshot while the logger reads it, so whole
+ * copies are taken with the scheduler held off to avoid tearing.
+ */
 GpsSample getGpsSample()
 {
-        return g_gpsSnapshot.sample;
+        taskENTER_CRITICAL();
+        const GpsSample sample = g_gpsSnapshot.sample;
+        taskEXIT_CRITICAL();
+
+        return sample;
 }
 
 GpsSnapshot getGpsSnapshot()
 {
-        return g_gpsSnapshot;
+        taskENTER_CRITICAL();
+        const GpsSnapshot snap = g_gpsSnapshot;
+        taskEXIT_CRITICAL();
+
+        return snap;
 }
 
 static void updateFullDateTime(GpsSample *gpsSample)
 {
         g_uptimeAtSample = getUptime();
 
-        if (g_timeFirstFix == 0) g_timeFirstFix = gpsSample->time;
+        if (g_timeFirstFix == 0) {
+                g_timeFirstFix = gpsSample->time;
+                boot_stats_end(BOOT_PHASE_GPS_FIX);
+        }
 }
 
 void GPS_sample_update(GpsSample *newSample)
@@ -207,6 +235,7 @@ void GPS_sample_update(GpsSample *newSample)
          * Deep copy stuff and call updateFullDateTime before we update
          * everything else.
          */
+        taskENTER_CRITICAL();
         g_gpsSnapshot.sample = *newSample;
         updateFullDateTime(newSample);
 
@@ -215,5 +244,6 @@ void GPS_sample_update(GpsSample *newSample)
         g_gpsSnapshot.previous_speed = prev_speed;
         g_gpsSnapshot.delta_last_sample =
                 g_gpsSnapshot.deltaFirstFix - prev_deltaff;
+        taskEXIT_CRITICAL();
 }
 
@@ -24,8 +24,10 @@
 #include "gps.h"
 #include "gpsTask.h"
 #include "gps_device.h"
+#include "gps_fusion.h"
 #include "lap_stats.h"
 #include "loggerConfig.h"
+#include "perf.h"
 #include "printk.h"
 #include "serial.h"
 #include "task.h"
@@ -62,8 +64,11 @@ void GPSTask(void *pvParameters)
                                 lapstats_process_incremental(&s);
                                 GPS_sample_update(&s);
 
-                                GpsSnapshot snap = getGpsSnapshot();
-                                lapstats_processUpdate(&snap);
+                                /* Otherwise the logger feeds it fused fixes */
+                                if (!gps_fusion_drives_lap_timing()) {
+                                        GpsSnapshot snap = getGpsSnapshot();
+                                        lapstats_processUpdate(&snap);
+                                }
 
                                 if (failures > 0)
                                         --failures;
@@ -83,6 +88,7 @@ void startGPSTask(int priority)
 {
         /* Make all task names 16 chars including NULL char*/
         static const signed portCHAR task_name[] = "GPS Comm Task  ";
+        perf_register_task(task_name, GPS_TASK_STACK_SIZE);
         xTaskCreate(GPSTask, task_name, GPS_TASK_STACK_SIZE, NULL,
                     priority, NULL );
 }
@@ -0,0 +1,459 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "api.h"
+#include "convert.h"
+#include "gps_fusion.h"
+#include "imu.h"
+#include "lap_stats.h"
+#include "loggerConfig.h"
+#include "taskUtil.h"
+#include "units.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define HDG_ONE		(1 << GPS_FUSION_HDG_SHIFT)
+
+/* 1mg of acceleration is 0.980665 cm/s^2, here in Q10 */
+#define MG_TO_CMS2_Q10	1004
+/* mdeg/s * ms to radians in Q14, scaled by 2^32 */
+#define MDEG_MS_TO_RAD_Q14	((int64_t) (M_PI / 180 * HDG_ONE / 1e6 * 4294967296.0))
+/* Radians in Q14 per ms to mdeg/s */
+#define RAD_Q14_MS_TO_MDPS	((int64_t) (180 / M_PI * 1e6 / HDG_ONE))
+
+/*
+ * Filter gains in Q8.  Position and speed lean heavily on the fix,
+ * heading is split with the gyro and the yaw bias adapts slowly.
+ */
+#define POS_GAIN	192
+#define SPEED_GAIN	128
+#define HDG_GAIN	128
+#define BIAS_GAIN	8
+
+/* Fixes must move this far before their course is trusted */
+#define MIN_COURSE_CM	100
+/* Errors or gaps beyond these re-seed the filter from the fix */
+#define SNAP_DIST_CM	5000
+#define MAX_FIX_GAP_MS	2000
+
+static uint32_t isqrt64(uint64_t v)
+{
+        uint64_t res = 0;
+        uint64_t bit = (uint64_t) 1 << 62;
+
+        while (bit > v)
+                bit >>= 2;
+
+        while (bit) {
+                if (v >= res + bit) {
+                        v -= res + bit;
+                        res = (res >> 1) + bit;
+                } else {
+                        res >>= 1;
+                }
+                bit >>= 2;
+        }
+
+        return (uint32_t) res;
+}
+
+static void normalize(int32_t *e, int32_t *n)
+{
+        /* One Newton step towards unit length; drift per step is tiny */
+        const int64_t mag_sq = (int64_t) *e * *e + (int64_t) *n * *n;
+        const int64_t k = ((3LL << (2 * GPS_FUSION_HDG_SHIFT)) - mag_sq) >>
+                (GPS_FUSION_HDG_SHIFT + 1);
+
+        *e = (int32_t) ((*e * k) >> GPS_FUSION_HDG_SHIFT);
+        *n = (int32_t) ((*n * k) >> GPS_FUSION_HDG_SHIFT);
+}
+
+/**
+ * Rotates a heading clockwise by a small angle.
+ * @param dtheta The angle in radians, Q14.
+ */
+static void rotate(int32_t *e, int32_t *n, const int32_t dtheta)
+{
+        const int32_t e0 = *e;
+        const int32_t n0 = *n;
+
+        *e = e0 + (int32_t) (((int64_t) n0 * dtheta) >> GPS_FUSION_HDG_SHIFT);
+        *n = n0 - (int32_t) (((int64_t) e0 * dtheta) >> GPS_FUSION_HDG_SHIFT);
+        normalize(e, n);
+}
+
+static int32_t kph_to_speed(const float kph)
+{
+        return (int32_t) lrintf(kph * (100.0f / 3.6f) *
+                                (1 << GPS_FUSION_SPEED_SHIFT));
+}
+
+static void seed(struct gps_fusion *f, const struct track_point *p,
+                 const GpsSample *s)
+{
+        f->x = (int64_t) p->x << GPS_FUSION_POS_SHIFT;
+        f->y = (int64_t) p->y << GPS_FUSION_POS_SHIFT;
+        f->speed = kph_to_speed(s->speed);
+}
+
+void gps_fusion_init(struct gps_fusion *f)
+{
+        memset(f, 0, sizeof(struct gps_fusion));
+        f->hdg_n = HDG_ONE;
+        f->fix_hdg_n = HDG_ONE;
+}
+
+void gps_fusion_predict(struct gps_fusion *f, const float accel_g,
+                        const float yaw_dps, const uint32_t dt_ms)
+{
+        if (!f->initialized || dt_ms == 0)
+                return;
+
+        const int32_t accel_mg = (int32_t) lrintf(accel_g * 1000);
+        const int32_t yaw_mdps = (int32_t) lrintf(yaw_dps * 1000) - f->yaw_bias;
+
+        f->speed += (int32_t) ((int64_t) accel_mg * MG_TO_CMS2_Q10 *
+                               dt_ms / 1000);
+        if (f->speed < 0)
+                f->speed = 0;
+
+        if (!f->heading_valid)
+                return;
+
+        const int32_t dtheta = (int32_t)
+                (((int64_t) yaw_mdps * dt_ms * MDEG_MS_TO_RAD_Q14) >> 32);
+        rotate(&f->hdg_e, &f->hdg_n, dtheta);
+
+        const int64_t v_e = ((int64_t) f->hdg_e * f->speed) >> GPS_FUSION_HDG_SHIFT;
+        const int64_t v_n = ((int64_t) f->hdg_n * f->speed) >> GPS_FUSION_HDG_SHIFT;
+        f->x += v_e * dt_ms / 1000;
+        f->y += v_n * dt_ms / 1000;
+}
+
+static void correct_heading(struct gps_fusion *f, const int32_t dx,
+                            const int32_t dy, const int32_t dt_ms)
+{
+        const uint32_t len = isqrt64((int64_t) dx * dx + (int64_t) dy * dy);
+        const int32_t ce = (int32_t) (((int64_t) dx << GPS_FUSION_HDG_SHIFT) / len);
+        const int32_t cn = (int32_t) (((int64_t) dy << GPS_FUSION_HDG_SHIFT) / len);
+
+        if (!f->heading_valid) {
+                f->hdg_e = ce;
+                f->hdg_n = cn;
+                f->heading_valid = true;
+                return;
+        }
+
+        /*
+         * The course is the mean heading over the interval, so compare
+         * it against the midpoint of our heading at either end.
+         */
+        int32_t me = f->fix_hdg_e + f->hdg_e;
+        int32_t mn = f->fix_hdg_n + f->hdg_n;
+        const uint32_t mlen = isqrt64((int64_t) me * me + (int64_t) mn * mn);
+        if (mlen == 0)
+                return;
+        me = (int32_t) (((int64_t) me << GPS_FUSION_HDG_SHIFT) / mlen);
+        mn = (int32_t) (((int64_t) mn << GPS_FUSION_HDG_SHIFT) / mlen);
+
+        /* Sine of the clockwise angle from the midpoint to the course */
+        const int32_t err = (int32_t) (((int64_t) mn * ce - (int64_t) me * cn) >>
+                                       GPS_FUSION_HDG_SHIFT);
+
+        rotate(&f->hdg_e, &f->hdg_n, (err * HDG_GAIN) >> 8);
+
+        /* A course clockwise of ours means the gyro read low */
+        const int64_t rate_err = (int64_t) err * RAD_Q14_MS_TO_MDPS / dt_ms;
+        f->yaw_bias -= (int32_t) ((rate_err * BIAS_GAIN) >> 8);
+}
+
+void gps_fusion_correct(struct gps_fusion *f, const GpsSample *s)
+{
+        if (!f->initialized) {
+                track_frame_init(&f->frame, &s->point);
+                f->fix_point = track_frame_project(&f->frame, &s->point);
+                f->fix_time = s->time;
+                seed(f, &f->fix_point, s);
+                f->heading_valid = false;
+                f->initialized = true;
+                return;
+        }
+
+        const int32_t dt_ms = (int32_t) (s->time - f->fix_time);
+        if (dt_ms <= 0)
+                return;
+
+        const struct track_point p = track_frame_project(&f->frame, &s->point);
+        const int32_t dx = p.x - f->fix_point.x;
+        const int32_t dy = p.y - f->fix_point.y;
+        const int64_t ex = ((int64_t) p.x << GPS_FUSION_POS_SHIFT) - f->x;
+        const int64_t ey = ((int64_t) p.y << GPS_FUSION_POS_SHIFT) - f->y;
+        const int64_t snap = (int64_t) SNAP_DIST_CM << GPS_FUSION_POS_SHIFT;
+
+        f->fix_point = p;
+        f->fix_time = s->time;
+
+        if (dt_ms > MAX_FIX_GAP_MS || llabs(ex) > snap || llabs(ey) > snap) {
+                seed(f, &p, s);
+                f->heading_valid = false;
+                return;
+        }
+
+        const bool had_heading = f->heading_valid;
+        if ((int64_t) dx * dx + (int64_t) dy * dy >=
+            (int64_t) MIN_COURSE_CM * MIN_COURSE_CM)
+                correct_heading(f, dx, dy, dt_ms);
+
+        f->fix_hdg_e = f->hdg_e;
+        f->fix_hdg_n = f->hdg_n;
+
+        /* Position is only dead reckoned once the heading is known */
+        if (!had_heading) {
+                seed(f, &p, s);
+                return;
+        }
+
+        f->x += (ex * POS_GAIN) >> 8;
+        f->y += (ey * POS_GAIN) >> 8;
+        f->speed += (int32_t) (((int64_t) (kph_to_speed(s->speed) - f->speed) *
+                                SPEED_GAIN) >> 8);
+}
+
+GeoPoint gps_fusion_get_point(const struct gps_fusion *f)
+{
+        const struct track_point p = {
+                .x = (int32_t) (f->x >> GPS_FUSION_POS_SHIFT),
+                .y = (int32_t) (f->y >> GPS_FUSION_POS_SHIFT),
+        };
+        return track_frame_unproject(&f->frame, &p);
+}
+
+float gps_fusion_get_speed(const struct gps_fusion *f)
+{
+        return (float) f->speed * (3.6f / 100.0f) /
+                (1 << GPS_FUSION_SPEED_SHIFT);
+}
+
+float gps_fusion_get_heading(const struct gps_fusion *f)
+{
+        const float deg = atan2f(f->hdg_e, f->hdg_n) * (float) (180 / M_PI);
+        return deg < 0 ? deg + 360 : deg;
+}
+
+void gps_fusion_reset_config(struct gps_fusion_config *cfg)
+{
+        const ChannelConfig latitude = DEFAULT_FUSION_LATITUDE_CONFIG;
+        const ChannelConfig longitude = DEFAULT_FUSION_LONGITUDE_CONFIG;
+        const ChannelConfig speed = DEFAULT_FUSION_SPEED_CONFIG;
+        const ChannelConfig heading = DEFAULT_FUSION_HEADING_CONFIG;
+
+        cfg->latitude = latitude;
+        cfg->longitude = longitude;
+        cfg->speed = speed;
+        cfg->heading = heading;
+        cfg->lap_timing = false;
+        strcpy(cfg->speed.units, units_get_label(UNIT_SPEED_MILES_HOUR));
+}
+
+void gps_fusion_get_config(const struct gps_fusion_config *cfg,
+                           struct Serial *serial, const bool more)
+{
+        unsigned short rate = SAMPLE_DISABLED;
+        rate = getHigherSampleRate(rate, cfg->latitude.sampleRate);
+        rate = getHigherSampleRate(rate, cfg->longitude.sampleRate);
+        rate = getHigherSampleRate(rate, cfg->speed.sampleRate);
+        rate = getHigherSampleRate(rate, cfg->heading.sampleRate);
+
+        json_objStartString(serial, "fusionCfg");
+        json_int(serial, "sr", decodeSampleRate(rate), 1);
+        json_int(serial, "pos", cfg->latitude.sampleRate != SAMPLE_DISABLED, 1);
+        json_int(serial, "speed", cfg->speed.sampleRate != SAMPLE_DISABLED, 1);
+        json_int(serial, "heading", cfg->heading.sampleRate != SAMPLE_DISABLED, 1);
+        json_bool(serial, "lap", cfg->lap_timing, 1);
+
+        json_objStartString(serial, "units");
+        json_string(serial, "speed", cfg->speed.units, 0);
+        json_objEnd(serial, 0);
+
+        json_objEnd(serial, more);
+}
+
+static void set_channel_rate(const jsmntok_t *json, ChannelConfig *cfg,
+                             const char *name, const unsigned short sr)
+{
+        unsigned char test = 0;
+        jsmn_exists_set_val_uint8(json, name, &test, NULL);
+        cfg->sampleRate = test == 0 ? SAMPLE_DISABLED : sr;
+}
+
+bool gps_fusion_set_config(struct gps_fusion_config *cfg,
+                           const jsmntok_t *json)
+{
+        unsigned short sr = SAMPLE_DISABLED;
+        int tmp = 0;
+        if (jsmn_exists_set_val_int(json, "sr", &tmp))
+                sr = encodeSampleRate(tmp);
+
+        set_channel_rate(json, &cfg->latitude, "pos", sr);
+        set_channel_rate(json, &cfg->longitude, "pos", sr);
+        set_channel_rate(json, &cfg->speed, "speed", sr);
+        set_channel_rate(json, &cfg->heading, "heading", sr);
+        jsmn_exists_set_val_bool(json, "lap", &cfg->lap_timing);
+
+        const jsmntok_t *units_tok = jsmn_find_node(json, "units");
+        if (units_tok) {
+                jsmn_exists_set_val_string(units_tok, "speed",
+                                           &cfg->speed.units,
+                                           DEFAULT_UNITS_LENGTH, true);
+                /* Speed supports only Kilometers/Hr or Miles/Hr */
+                if (UNIT_SPEED_KILOMETERS_HOUR != units_get_unit(cfg->speed.units))
+                        strcpy(cfg->speed.units,
+                               units_get_label(UNIT_SPEED_MILES_HOUR));
+        }
+
+        return true;
+}
+
+bool gps_fusion_is_enabled(const struct gps_fusion_config *cfg)
+{
+        return cfg->lap_timing ||
+                cfg->latitude.sampleRate != SAMPLE_DISABLED ||
+                cfg->longitude.sampleRate != SAMPLE_DISABLED ||
+                cfg->speed.sampleRate != SAMPLE_DISABLED ||
+                cfg->heading.sampleRate != SAMPLE_DISABLED;
+}
+
+static struct {
+        const struct gps_fusion_config *cfg;
+        struct gps_fusion filter;
+        size_t last_ticks;
+        bool enabled;
+        /* The last snapshot handed to the lap timer */
+        bool lap_fed;
+        GeoPoint lap_point;
+        float lap_speed;
+        tiny_millis_t lap_delta_first_fix;
+} g_fusion;
+
+bool gps_fusion_drives_lap_timing(void)
+{
+        return g_fusion.enabled && g_fusion.cfg->lap_timing;
+}
+
+void gps_fusion_init_sampling(const struct gps_fusion_config *cfg)
+{
+        /* Stop the lap timer from being fed while we reset */
+        g_fusion.enabled = false;
+        g_fusion.cfg = cfg;
+        gps_fusion_init(&g_fusion.filter);
+        g_fusion.last_ticks = 0;
+        g_fusion.lap_fed = false;
+        g_fusion.enabled = gps_fusion_is_enabled(cfg);
+}
+
+static void feed_lap_timer(void)
+{
+        GpsSnapshot snap;
+        snap.sample = getGpsSample();
+        snap.sample.point = gps_fusion_get_point(&g_fusion.filter);
+        snap.sample.speed = gps_fusion_get_speed(&g_fusion.filter);
+        snap.sample.time = getMillisSinceEpoch();
+        snap.deltaFirstFix = getMillisSinceFirstFix();
+
+        if (!g_fusion.lap_fed) {
+                g_fusion.lap_point = snap.sample.point;
+                g_fusion.lap_speed = snap.sample.speed;
+                g_fusion.lap_delta_first_fix = snap.deltaFirstFix;
+                g_fusion.lap_fed = true;
+        } else if (snap.deltaFirstFix == g_fusion.lap_delta_first_fix) {
+                return;
+        }
+
+        snap.previousPoint = g_fusion.lap_point;
+        snap.previous_speed = g_fusion.lap_speed;
+        snap.delta_last_sample =
+                snap.deltaFirstFix - g_fusion.lap_delta_first_fix;
+
+        g_fusion.lap_point = snap.sample.point;
+        g_fusion.lap_speed = snap.sample.speed;
+        g_fusion.lap_delta_first_fix = snap.deltaFirstFix;
+
+        lapstats_processUpdate(&snap);
+}
+
+void gps_fusion_sample(void)
+{
+        if (!g_fusion.enabled)
+                return;
+
+        if (!isGpsDataCold() && getLastFix() != g_fusion.filter.fix_time) {
+                const GpsSample s = getGpsSample();
+                gps_fusion_correct(&g_fusion.filter, &s);
+        }
+
+        const size_t ticks = getCurrentTicks();
+        const uint32_t dt_ms = g_fusion.last_ticks == 0 ? 0 :
+                ticksToMs(ticks - g_fusion.last_ticks);
+        g_fusion.last_ticks = ticks;
+
+        float accel = 0;
+        float yaw = 0;
+#if IMU_CHANNELS > 0
+        LoggerConfig *config = getWorkingLoggerConfig();
+        accel = imu_read_value(IMU_CHANNEL_Y, &config->ImuConfigs[IMU_CHANNEL_Y]);
+        yaw = imu_read_value(IMU_CHANNEL_YAW, &config->ImuConfigs[IMU_CHANNEL_YAW]);
+#endif
+        gps_fusion_predict(&g_fusion.filter, accel, yaw, dt_ms);
+
+        if (g_fusion.cfg->lap_timing && g_fusion.filter.initialized)
+                feed_lap_timer();
+}
+
+float gps_fusion_get_latitude(void)
+{
+        return gps_fusion_get_point(&g_fusion.filter).latitude;
+}
+
+float gps_fusion_get_longitude(void)
+{
+        return gps_fusion_get_point(&g_fusion.filter).longitude;
+}
+
+float gps_fusion_get_speed_kph(void)
+{
+        return gps_fusion_get_speed(&g_fusion.filter);
+}
+
+float gps_fusion_get_speed_mph(void)
+{
+        return convert_kph_mph(gps_fusion_get_speed(&g_fusion.filter));
+}
+
+float gps_fusion_get_heading_deg(void)
+{
+        return gps_fusion_get_heading(&g_fusion.filter);
+}
@@ -0,0 +1,103 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "track_frame.h"
+
+#include <math.h>
+#include <stddef.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define CM_PER_DEG	(GP_EARTH_RADIUS_M * 100.0 * M_PI / 180.0)
+
+static struct track_frame g_active_frame;
+static bool g_active;
+
+void track_frame_init(struct track_frame *f, const GeoPoint *origin)
+{
+        f->origin = *origin;
+        f->cm_per_deg_lat = CM_PER_DEG;
+        f->cm_per_deg_lon = CM_PER_DEG * cos(origin->latitude * (M_PI / 180.0));
+}
+
+static int32_t to_cm(const float v)
+{
+        if (v > TRACK_FRAME_MAX_CM)
+                return TRACK_FRAME_MAX_CM;
+        if (v < -TRACK_FRAME_MAX_CM)
+                return -TRACK_FRAME_MAX_CM;
+
+        return (int32_t) lrintf(v);
+}
+
+struct track_point track_frame_project(const struct track_frame *f,
+                                       const GeoPoint *p)
+{
+        /* Take the deltas first; they are exact for nearby points */
+        const float dlat = p->latitude - f->origin.latitude;
+        const float dlon = p->longitude - f->origin.longitude;
+
+        struct track_point tp;
+        tp.x = to_cm(dlon * f->cm_per_deg_lon);
+        tp.y = to_cm(dlat * f->cm_per_deg_lat);
+        return tp;
+}
+
+GeoPoint track_frame_unproject(const struct track_frame *f,
+                               const struct track_point *tp)
+{
+        GeoPoint p;
+        p.latitude = f->origin.latitude + tp->y / f->cm_per_deg_lat;
+        p.longitude = f->origin.longitude + tp->x / f->cm_per_deg_lon;
+        return p;
+}
+
+int64_t track_point_dist_sq(const struct track_point *a,
+                            const struct track_point *b)
+{
+        const int64_t dx = (int64_t) a->x - b->x;
+        const int64_t dy = (int64_t) a->y - b->y;
+        return dx * dx + dy * dy;
+}
+
+float track_point_dist(const struct track_point *a,
+                       const struct track_point *b)
+{
+        return sqrtf((float) track_point_dist_sq(a, b)) / 100;
+}
+
+void track_frame_set_active(const GeoPoint *origin)
+{
+        track_frame_init(&g_active_frame, origin);
+        g_active = true;
+}
+
+void track_frame_clear_active(void)
+{
+        g_active = false;
+}
+
+const struct track_frame* track_frame_get_active(void)
+{
+        return g_active ? &g_active_frame : NULL;
+}
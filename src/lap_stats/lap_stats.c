@@ -19,6 +19,7 @@
  * this code. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "FreeRTOS.h"
 #include "auto_track.h"
 #include "convert.h"
 #include "dateTime.h"
@@ -31,11 +32,17 @@
 #include "math.h"
 #include "lap_stats.h"
 #include "launch_control.h"
+#include "logger.h"
 #include "loggerConfig.h"
 #include "loggerHardware.h"
 #include "modp_numtoa.h"
+#include "perf_region.h"
 #include "predictive_timer_2.h"
 #include "printk.h"
+#include "reference_lap.h"
+#include "sector_stats.h"
+#include "semphr.h"
+#include "track_frame.h"
 #include "tracks.h"
 #include <stdint.h>
 #include <string.h>
@@ -52,8 +59,13 @@
 #define FINISH_TRIGGER_MINIMUM_DISTANCE_KM 0.1
 #define TIME_NULL -1
 
-/* Threshold where we start interpolating between GPS samples. 10Hz */
-#define INTERPOLATION_THRESHOLD_MS 100
+/* Fixes further apart than this are not treated as a continuous path */
+#define MAX_SEGMENT_DURATION_MS 10000
+/*
+ * Saving a reference lap erases flash, which stalls the CPU.  Wait until
+ * we are about stopped to do it.
+ */
+#define REFERENCE_LAP_SAVE_SPEED_KPH	10
 
 static Track g_active_track;
 static float g_geo_circle_radius;
@@ -95,22 +107,61 @@ static float last_speed = 0;
 static float current_speed = 0;
 static size_t last_distance_sample_at = 0;
 
+/* Set when the fast lap beats the track's stored reference lap */
+static bool g_reference_lap_pending;
+
+/*
+ * The GPS task, the logger (when the fused position drives lap timing)
+ * and the API all update the lap stats.  Every public entry point that
+ * changes state holds this lock; the static helpers assume it is held.
+ * Host tools that never call lapstats_init run unlocked.
+ */
+static xSemaphoreHandle g_lapstats_lock;
+
+static void lock(void)
+{
+        if (g_lapstats_lock)
+                xSemaphoreTake(g_lapstats_lock, portMAX_DELAY);
+}
+
+static void unlock(void)
+{
+        if (g_lapstats_lock)
+                xSemaphoreGive(g_lapstats_lock);
+}
+
+bool lapstats_init(void)
+{
+        if (!g_lapstats_lock)
+                g_lapstats_lock = xSemaphoreCreateMutex();
+
+        return NULL != g_lapstats_lock;
+}
+
 static void reset_elapsed_time()
 {
         g_elapsed_lap_time = 0;
 }
 
-void resetLapCount()
+static void reset_lap_count(void)
 {
         g_lapCount = 0;
         g_lap = 0;
 }
 
-/**
- * This less invasive reset will cause all the stats to reset to their
- * default values. This DOES_NOT alter the track settings in any way.
- */
-void lapstats_reset(bool reset_session)
+void resetLapCount()
+{
+        lock();
+        reset_lap_count();
+        unlock();
+}
+
+static void set_distance(const float distance)
+{
+        g_distance = distance;
+}
+
+static void reset_stats(const bool reset_session)
 {
         if (reset_session)
                 g_session_time = getUptime();
@@ -126,13 +177,26 @@ void lapstats_reset(bool reset_session)
         g_lastSectorTime = 0;
         g_lastSectorTimestamp = 0;
         g_sector = -1;     // Indicates we haven't crossed start/finish yet.
-        lapstats_reset_distance();
+        g_reference_lap_pending = false;
+        set_distance(0);
         resetPredictiveTimer();
-        resetLapCount();
+        sector_stats_reset();
+        reset_lap_count();
         reset_elapsed_time();
         lc_reset();
 }
 
+/**
+ * This less invasive reset will cause all the stats to reset to their
+ * default values. This DOES_NOT alter the track settings in any way.
+ */
+void lapstats_reset(bool reset_session)
+{
+        lock();
+        reset_stats(reset_session);
+        unlock();
+}
+
 /**
  * Resets all the track information. This will cause us to become
  * unconfigured which may prompt an automatic reconfiguration.
@@ -151,6 +215,7 @@ static void reset_track()
         g_geo_circle_radius = 0;
         g_start_finish_enabled = false;
         g_sector_enabled = false;
+        track_frame_clear_active();
 }
 
 /**
@@ -252,7 +317,7 @@ static bool set_active_track(const Track *track, const float radius,
                              const track_status_t track_status)
 {
         /* We are changing our track, so we need to reset stats */
-        lapstats_reset(false);
+        reset_stats(false);
         reset_track();
         g_track_status = track_status;
         g_configured = 1;
@@ -266,16 +331,31 @@ static bool set_active_track(const Track *track, const float radius,
         g_start_finish_enabled = isStartFinishEnabled(track);
         g_sector_enabled = isSectorTrackingEnabled(track);
 
+        /* All geo circle math for this track happens in a frame local to it */
+        const GeoPoint origin = getStartPoint(track);
+        if (isValidPoint(&origin))
+                track_frame_set_active(&origin);
+
         setup_geo_triggers(track, radius * GEO_TRIGGER_RADIUS_MULTIPLIER);
         setup_geo_circles(track, radius);
         lc_setup(track, radius);
 
+        /* Predict against the best lap driven here from the first lap */
+        const struct reference_lap *ref = reference_lap_find(track->trackId);
+        if (ref && setReferenceLap(ref))
+                pr_info_int_msg(_LOG_PFX "Loaded reference lap for track ",
+                                track->trackId);
+
         return true;
 }
 
 bool lapstats_set_active_track(const Track *track, const float radius)
 {
-        return set_active_track(track, radius, TRACK_STATUS_EXTERNALLY_SET);
+        lock();
+        const bool set = set_active_track(track, radius,
+                                          TRACK_STATUS_EXTERNALLY_SET);
+        unlock();
+        return set;
 }
 
 /**
@@ -339,7 +419,7 @@ static void end_lap_timing(const GpsSnapshot *gpsSnapshot)
         g_lapStartTimestamp = -1;
 }
 
-void lapstats_update_distance(void)
+static void update_distance(void)
 {
         const float speed_avg =
                 (current_speed + last_speed) / 2;
@@ -365,14 +445,18 @@ void lapstats_update_distance(void)
         last_speed = current_speed;
 }
 
-static void set_distance(const float distance)
+void lapstats_update_distance(void)
 {
-        g_distance = distance;
+        lock();
+        update_distance();
+        unlock();
 }
 
 void lapstats_reset_distance()
 {
+        lock();
         set_distance(0);
+        unlock();
 }
 
 /* This distance is in km */
@@ -469,6 +553,81 @@ int getAtSector()
         return g_at_sector;
 }
 
+/*
+ * The path travelled between the previous fix and the current one.  Gate
+ * logic looks for where along this path a geo circle is first entered,
+ * starting from where the last event happened so that several events
+ * may occur, in order, within a single fix.
+ */
+struct gps_segment {
+        const GpsSnapshot *snap;
+        GeoPoint start;
+        /* Fraction of the path already consumed by events */
+        float cursor;
+};
+
+static GeoPoint interpolate_point(const GeoPoint *a, const GeoPoint *b,
+                                  const float f)
+{
+        GeoPoint p;
+        p.latitude = a->latitude + (b->latitude - a->latitude) * f;
+        p.longitude = a->longitude + (b->longitude - a->longitude) * f;
+        return p;
+}
+
+static void init_gps_segment(struct gps_segment *seg,
+                             const GpsSnapshot *snap)
+{
+        seg->snap = snap;
+        seg->cursor = 0;
+
+        /* Without a usable previous fix the path is just the current point */
+        const bool continuous = snap->delta_last_sample > 0 &&
+                isValidPoint(&snap->previousPoint);
+        seg->start = continuous ? snap->previousPoint : snap->sample.point;
+}
+
+/**
+ * Finds where the unconsumed part of the segment first lies within the
+ * given geo circle and builds the snapshot we would have had then.
+ * @param seg The segment being processed.
+ * @param gc The geo circle to test against.
+ * @param crossing Populated with the interpolated snapshot on success.
+ * @param at Set to the fraction of the segment at which the crossing is.
+ * @return true if the circle is reached, false otherwise.
+ */
+static bool find_gate_crossing(const struct gps_segment *seg,
+                               const struct GeoCircle gc,
+                               GpsSnapshot *crossing, float *at)
+{
+        const GpsSnapshot *snap = seg->snap;
+        const GeoPoint *end = &snap->sample.point;
+
+        /*
+         * Always intersect the whole segment so that events sharing a
+         * circle (say sector, finish and start) land on the exact same
+         * fraction rather than one computed from the other's result.
+         */
+        float enter, leave;
+        if (!gc_isSegmentInGeoCircle(&seg->start, end, gc, &enter, &leave) ||
+            leave < seg->cursor)
+                return false;
+
+        const float f = MAX(enter, seg->cursor);
+        const tiny_millis_t behind = (1 - f) * snap->delta_last_sample;
+
+        *crossing = *snap;
+        crossing->sample.point = interpolate_point(&seg->start, end, f);
+        crossing->sample.speed = snap->previous_speed +
+                (snap->sample.speed - snap->previous_speed) * f;
+        crossing->sample.time -= behind;
+        crossing->deltaFirstFix -= behind;
+        crossing->delta_last_sample -= behind;
+        *at = f;
+
+        return true;
+}
+
 /**
  * Called whenever we finish a lap.
  */
@@ -478,7 +637,17 @@ static void lap_finished_event(const GpsSnapshot *gpsSnapshot)
 
         end_lap_timing(gpsSnapshot);
         finishLap(gpsSnapshot);
+
+        /* Without sectors the whole lap is the one sector */
+        if (!g_sector_enabled)
+                sector_stats_sector_finished(0, g_lastLapTime);
+        sector_stats_lap_finished(g_lastLapTime);
         g_at_sf = true;
+
+        const int32_t track_id = g_active_track.trackId;
+        const struct reference_lap *ref = reference_lap_find(track_id);
+        if (track_id != 0 && (!ref || getFastLapTime() < ref->lap_time))
+                g_reference_lap_pending = true;
         lc_reset();
 
         /*
@@ -503,6 +672,7 @@ static void lap_started_event(const tiny_millis_t time, const GeoPoint *sp,
         // Timing and predictive timing
         start_lap_timing(time);
         startLap(sp, time);
+        sector_stats_lap_started(g_lap);
         reset_elapsed_time();
 
         // Reset the sector logic
@@ -533,13 +703,14 @@ static void sector_boundary_event(const GpsSnapshot *gpsSnapshot)
         g_lastSectorTimestamp = millis;
         g_lastSector = g_sector;
         g_at_sector = true;
+        sector_stats_sector_finished(g_lastSector, g_lastSectorTime);
         update_sector_geo_circle(++g_sector);
 }
 
 /**
  * All logic associated with determining if we are at the finish line.
  */
-static void process_finish_logic(const GpsSnapshot *gpsSnapshot)
+static void process_finish_logic(struct gps_segment *seg)
 {
         if (!lapstats_lap_in_progress())
                 return;
@@ -547,24 +718,34 @@ static void process_finish_logic(const GpsSnapshot *gpsSnapshot)
         if (!isGeoTriggerTripped(&g_finish_geo_trigger))
                 return;
 
-        const GeoPoint point = gpsSnapshot->sample.point;
-        if (!gc_isPointInGeoCircle(&point, g_geo_circles.finish))
+        GpsSnapshot crossing;
+        float at;
+        if (!find_gate_crossing(seg, g_geo_circles.finish, &crossing, &at))
                 return;
 
         if (g_distance > FINISH_TRIGGER_MINIMUM_DISTANCE_KM) {
                 // If we get here, then we have completed a lap.
-                lap_finished_event(gpsSnapshot);
+                seg->cursor = at;
+                lap_finished_event(&crossing);
         }
 }
 
-static void process_start_logic_no_lc(const GpsSnapshot *gpsSnapshot)
+static void process_start_logic_no_lc(struct gps_segment *seg)
 {
-        const GeoPoint point = gpsSnapshot->sample.point;
-        if (!gc_isPointInGeoCircle(&point, g_geo_circles.start))
+        GpsSnapshot crossing;
+        float at;
+        if (!find_gate_crossing(seg, g_geo_circles.start, &crossing, &at))
                 return;
 
-        const tiny_millis_t time = gpsSnapshot->deltaFirstFix;
-        lap_started_event(time, &point, 0);
+        /*
+         * Credit the distance covered between the crossing and this fix
+         * since distance accounting only picks up from here.
+         */
+        const GeoPoint point = crossing.sample.point;
+        const float distance =
+                distPythag(&point, &seg->snap->sample.point) / 1000;
+        seg->cursor = at;
+        lap_started_event(crossing.deltaFirstFix, &point, distance);
 }
 
 static void process_start_logic_with_lc(const GpsSnapshot *gpsSnapshot)
@@ -591,7 +772,7 @@ static void process_start_logic_with_lc(const GpsSnapshot *gpsSnapshot)
 /**
  * All logic associated with determining if we are at the start line.
  */
-static void process_start_logic(const GpsSnapshot *gps_ss)
+static void process_start_logic(struct gps_segment *seg)
 {
         if (lapstats_lap_in_progress())
                 return;
@@ -606,13 +787,13 @@ static void process_start_logic(const GpsSnapshot *gps_ss)
          */
         if (g_lapCount > 0 &&
             g_active_track.track_type == TRACK_TYPE_CIRCUIT) {
-                process_start_logic_no_lc(gps_ss);
+                process_start_logic_no_lc(seg);
         } else {
-                process_start_logic_with_lc(gps_ss);
+                process_start_logic_with_lc(seg->snap);
         }
 }
 
-static void process_sector_logic(const GpsSnapshot *gpsSnapshot)
+static void process_sector_logic(struct gps_segment *seg)
 {
         if (!g_sector_enabled)
                 return;
@@ -620,19 +801,24 @@ static void process_sector_logic(const GpsSnapshot *gpsSnapshot)
         if (!lapstats_lap_in_progress())
                 return;
 
-        const GeoPoint point = gpsSnapshot->sample.point;
-        g_at_sector = gc_isPointInGeoCircle(&point, g_geo_circles.sector);
+        GpsSnapshot crossing;
+        float at;
+        g_at_sector = find_gate_crossing(seg, g_geo_circles.sector,
+                                         &crossing, &at);
         if (!g_at_sector)
                 return;
 
         // If we are here, then we are at a Sector boundary.
-        sector_boundary_event(gpsSnapshot);
+        seg->cursor = at;
+        sector_boundary_event(&crossing);
 }
 
 void lapstats_config_changed(void)
 {
-        lapstats_reset(false);
+        lock();
+        reset_stats(false);
         reset_track();
+        unlock();
 }
 
 static void lapstats_location_updated(const GpsSnapshot *gps_snapshot)
@@ -654,11 +840,14 @@ static void lapstats_location_updated(const GpsSnapshot *gps_snapshot)
         /*
          * Now process the sector, finish and start logic in that order.
          * Each processing can invoke their respective event if the logic
-         * agrees its time.
+         * agrees its time.  Events are timed at the point along the path
+         * from the previous fix where their geo circle was entered.
          */
-        process_sector_logic(gps_snapshot);
-        process_finish_logic(gps_snapshot);
-        process_start_logic(gps_snapshot);
+        struct gps_segment seg;
+        init_gps_segment(&seg, gps_snapshot);
+        process_sector_logic(&seg);
+        process_finish_logic(&seg);
+        process_start_logic(&seg);
 }
 
 static void lapstats_setup(const GpsSnapshot *gps_snapshot)
@@ -738,12 +927,37 @@ static void debug_print_gps_snapshot(const GpsSnapshot *gps_snapshot)
         pr_debug("\r\n\r\n");
 }
 
+/**
+ * Saves a pending reference lap once we have slowed down and aren't
+ * logging.  The lap is copied under the lock, but the flash sector is
+ * erased outside it so lap stats readers aren't held up for the stall.
+ */
+static void save_reference_lap(const GpsSnapshot *gps_snapshot)
+{
+        lock();
+        const int32_t track_id = g_active_track.trackId;
+        const bool save = g_reference_lap_pending &&
+                gps_snapshot->sample.speed <= REFERENCE_LAP_SAVE_SPEED_KPH &&
+                !logging_is_active();
+        if (save)
+                g_reference_lap_pending = false;
+
+        const bool copied = save && reference_lap_copy_fast_lap(track_id);
+        unlock();
+
+        if (copied && reference_lap_flash_copy())
+                pr_info_int_msg(_LOG_PFX "Saved reference lap for track ",
+                                track_id);
+}
+
 void lapstats_process_incremental(const GpsSample *sample)
 {
+        lock();
         current_speed = sample->speed;
+        unlock();
 }
 
-void lapstats_processUpdate(GpsSnapshot *gps_snapshot)
+static void process_update(GpsSnapshot *gps_snapshot)
 {
         if (!g_configured)
                 lapstats_setup(gps_snapshot);
@@ -754,108 +968,24 @@ void lapstats_processUpdate(GpsSnapshot *gps_snapshot)
         if (! g_configured)
                 return;
 
-        /**
-         * Split samples into even intervals, with a minimum of 1 sample as a bozo filter
-         * This allows us to up-sample slow GPS sources to 10Hz as neccessary
-         */
-        int32_t delta_since_last = gps_snapshot->delta_last_sample;
-
-        /* dont run samples if way over the threshold either */
-        if (delta_since_last > INTERPOLATION_THRESHOLD_MS * 100)
+        /* Don't treat fixes separated by a long outage as a path */
+        if (gps_snapshot->delta_last_sample > MAX_SEGMENT_DURATION_MS)
                 return;
 
-        uint32_t interval_count = MAX(1, delta_since_last / INTERPOLATION_THRESHOLD_MS);
-
-        if (interval_count == 1) {
-                /* GPS data is arriving fast enough; no interpolation needed */
-                lapstats_location_updated(gps_snapshot);
-                return;
-        }
+        if (DEBUG_LEVEL)
+                debug_print_gps_snapshot(gps_snapshot);
 
-        /**
-         * ============================================
-         * Set up interpolation for GPS Point
-         * ============================================
-         */
-        float lat1 = gps_snapshot->previousPoint.latitude;
-        float lon1 = gps_snapshot->previousPoint.longitude;
-        float lat2 = gps_snapshot->sample.point.latitude;
-        float lon2 = gps_snapshot->sample.point.longitude;
-
-        /**
-         * Evenly split up difference in latitiude into intervals
-         * longitude is linearly interpolated based on changing latitude
-         */
-        float lat_interval = fabs(lat2 - lat1) / (float)interval_count;
-        if (lat1 > lat2)
-                /* Account for reverse direction */
-                lat_interval = -lat_interval;
-
-        /* Set the starting interpolated latitude */
-        float interp_lat = lat1;
-
-        /**
-         * ============================================
-         * Set up interpolation for Speed
-         * ============================================
-         */
-        float speed1 = gps_snapshot->previous_speed;
-        float speed2 = gps_snapshot->sample.speed;
-
-        /* evenly split up changes in speed based on the interval */
-        float speed_interval = fabs(speed2 - speed1)/ (float)interval_count;
-        if (speed1 > speed2)
-                /* Account for reverse direction */
-                speed_interval = -speed_interval;
-
-        /* Set the starting speed */
-        float interp_speed = speed1;
-
-        /**
-         * ============================================
-         * Set up interpolation for Time
-         * ============================================
-         */
-        millis_t interp_time = gps_snapshot->sample.time - delta_since_last;
-        tiny_millis_t interp_delta_ff = gps_snapshot->deltaFirstFix - delta_since_last;
-
-        /* Evenly split up time between current and last sample */
-        tiny_millis_t time_interval = delta_since_last / interval_count;
-
-        if (DEBUG_LEVEL) {
-                pr_debug("---------------\r\n");
-                pr_debug_float_msg("Interval count: ", interval_count);
-                pr_debug_float_msg("Speed interval: ", speed_interval);
-                pr_debug_float_msg("Lat. interval:  ", lat_interval);
-                pr_debug_int_msg  ("Time interval:  ", time_interval);
-        }
-
-        for (size_t i = 0; i < interval_count; i++) {
-                /* Linearly interpolate longitude from latitude */
-                float interp_lon = lon1 + (interp_lat - lat1) * ((lon2 - lon1) / (lat2 - lat1));
-
-                /* Update current GPS snapshot with interpolated values */
-                gps_snapshot->sample.point.latitude = interp_lat;
-                gps_snapshot->sample.point.longitude = interp_lon;
-                gps_snapshot->sample.time = interp_time;
-                gps_snapshot->sample.speed = interp_speed;
-                gps_snapshot->delta_last_sample = time_interval;
-                gps_snapshot->deltaFirstFix = interp_delta_ff;
-
-                if (DEBUG_LEVEL)
-                        debug_print_gps_snapshot(gps_snapshot);
-
-                lapstats_location_updated(gps_snapshot);
-
-                /* update interpolated intervals */
-                gps_snapshot->previousPoint = gps_snapshot->sample.point;
+        /* Only time the fixes that actually run the lap logic */
+        PERF_REGION_BEGIN("lapstats_processUpdate");
+        lapstats_location_updated(gps_snapshot);
+        PERF_REGION_END("lapstats_processUpdate");
+}
 
-                interp_lat += lat_interval;
-                interp_time += time_interval;
-                interp_delta_ff += time_interval;
+void lapstats_processUpdate(GpsSnapshot *gps_snapshot)
+{
+        lock();
+        process_update(gps_snapshot);
+        unlock();
 
-                gps_snapshot->previous_speed = interp_speed;
-                interp_speed += speed_interval;
-        }
-        pr_debug("---------------\r\n");
+        save_reference_lap(gps_snapshot);
 }
@@ -0,0 +1,148 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dateTime.h"
+#include "macros.h"
+#include "sector_stats.h"
+#include <string.h>
+
+static tiny_millis_t g_best[SECTOR_COUNT];
+static tiny_millis_t g_delta[SECTOR_COUNT];
+static tiny_millis_t g_last_delta;
+
+/* Running sum of g_best and how many of its entries are set */
+static tiny_millis_t g_optimal;
+static int g_best_count;
+static int g_sector_count;
+
+static struct lap_history_entry g_current;
+
+/* Ring of completed laps, g_history_head is where the next one goes */
+static struct lap_history_entry g_history[LAP_HISTORY_SIZE];
+static size_t g_history_head;
+static size_t g_history_size;
+
+void sector_stats_reset(void)
+{
+        memset(g_best, 0, sizeof(g_best));
+        memset(g_delta, 0, sizeof(g_delta));
+        memset(&g_current, 0, sizeof(g_current));
+        g_last_delta = 0;
+        g_optimal = 0;
+        g_best_count = 0;
+        g_sector_count = 0;
+        g_history_head = 0;
+        g_history_size = 0;
+}
+
+void sector_stats_lap_started(const int lap)
+{
+        memset(g_delta, 0, sizeof(g_delta));
+        memset(&g_current, 0, sizeof(g_current));
+        g_current.lap = lap;
+        g_last_delta = 0;
+}
+
+void sector_stats_sector_finished(const int sector, const tiny_millis_t time)
+{
+        if (sector < 0 || sector >= SECTOR_COUNT || time <= 0)
+                return;
+
+        const tiny_millis_t best = g_best[sector];
+        g_last_delta = g_delta[sector] = best ? time - best : 0;
+
+        if (!best) {
+                ++g_best_count;
+                g_optimal += time;
+                g_best[sector] = time;
+        } else if (time < best) {
+                g_optimal -= best - time;
+                g_best[sector] = time;
+        }
+
+        g_current.sectors[sector] = time;
+        g_current.sector_count = sector + 1;
+}
+
+void sector_stats_lap_finished(const tiny_millis_t lap_time)
+{
+        /* Only full laps tell us how many sectors there are */
+        g_sector_count = MAX(g_sector_count, g_current.sector_count);
+
+        g_current.lap_time = lap_time;
+        g_history[g_history_head] = g_current;
+        g_history_head = (g_history_head + 1) % LAP_HISTORY_SIZE;
+        if (g_history_size < LAP_HISTORY_SIZE)
+                ++g_history_size;
+}
+
+tiny_millis_t sector_stats_best_sector(const int sector)
+{
+        return sector < 0 || sector >= SECTOR_COUNT ? 0 : g_best[sector];
+}
+
+tiny_millis_t sector_stats_sector_delta(const int sector)
+{
+        return sector < 0 || sector >= SECTOR_COUNT ? 0 : g_delta[sector];
+}
+
+tiny_millis_t sector_stats_last_delta(void)
+{
+        return g_last_delta;
+}
+
+float sector_stats_last_delta_seconds(void)
+{
+        return sector_stats_last_delta() / 1000.0f;
+}
+
+tiny_millis_t sector_stats_optimal_lap(void)
+{
+        if (g_sector_count == 0 || g_best_count < g_sector_count)
+                return 0;
+
+        return g_optimal;
+}
+
+float sector_stats_optimal_lap_minutes(void)
+{
+        return tinyMillisToMinutes(sector_stats_optimal_lap());
+}
+
+int sector_stats_sector_count(void)
+{
+        return g_sector_count;
+}
+
+size_t sector_stats_history_size(void)
+{
+        return g_history_size;
+}
+
+const struct lap_history_entry* sector_stats_history_lap(const size_t index)
+{
+        if (index >= g_history_size)
+                return NULL;
+
+        const size_t i = (g_history_head + LAP_HISTORY_SIZE - 1 - index) %
+                LAP_HISTORY_SIZE;
+        return g_history + i;
+}
@@ -0,0 +1,120 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "analog_scaling.h"
+
+#include <stddef.h>
+
+static float scale_raw(const struct analog_scaling *s, const float value)
+{
+        return value;
+}
+
+static float scale_linear(const struct analog_scaling *s, const float value)
+{
+        return s->slope * value + s->offset;
+}
+
+static float scale_map(const struct analog_scaling *s, const float value)
+{
+        if (value < s->raw[0])
+                return s->low;
+
+        if (value >= s->raw[s->bins - 1])
+                return s->high;
+
+        /*
+         * Find the last bin whose raw value is <= value.  The clamps
+         * above guarantee it lies within [0, bins - 2].
+         */
+        size_t lo = 0;
+        size_t hi = s->bins - 1;
+        while (hi - lo > 1) {
+                const size_t mid = (lo + hi) / 2;
+                if (value < s->raw[mid])
+                        hi = mid;
+                else
+                        lo = mid;
+        }
+
+        return s->base[lo] + s->seg_slope[lo] * (value - s->raw[lo]);
+}
+
+static float scale_invalid(const struct analog_scaling *s, const float value)
+{
+        return -1;
+}
+
+void analog_scaling_compile_map(struct analog_scaling *s,
+                                const ScalingMap *map)
+{
+        /*
+         * The map ends at the first bin that does not ascend.  This
+         * lets ANALOG_SCALING_BINS grow without breaking maps that only
+         * populate the leading bins.
+         */
+        size_t bins = 1;
+        while (bins < ANALOG_SCALING_BINS &&
+               map->rawValues[bins] > map->rawValues[bins - 1])
+                ++bins;
+
+        for (size_t i = 0; i < bins; ++i) {
+                s->raw[i] = map->rawValues[i];
+                s->base[i] = map->scaledValues[i];
+        }
+
+        for (size_t i = 0; i + 1 < bins; ++i) {
+                const float dx = map->rawValues[i + 1] - map->rawValues[i];
+                const float dy = map->scaledValues[i + 1] -
+                        map->scaledValues[i];
+                s->seg_slope[i] = dy / dx;
+        }
+
+        s->bins = bins;
+        s->low = map->scaledValues[0];
+        s->high = map->scaledValues[bins - 1];
+        s->scale = scale_map;
+}
+
+void analog_scaling_compile(struct analog_scaling *s, const ADCConfig *cfg)
+{
+        switch (cfg->scalingMode) {
+        case SCALING_MODE_RAW:
+                s->scale = scale_raw;
+                break;
+        case SCALING_MODE_LINEAR:
+                s->slope = cfg->linearScaling;
+                s->offset = cfg->linearOffset;
+                s->scale = scale_linear;
+                break;
+        case SCALING_MODE_MAP:
+                analog_scaling_compile_map(s, &cfg->scalingMap);
+                break;
+        default:
+                s->scale = scale_invalid;
+                break;
+        }
+}
+
+float analog_scaling_apply(const struct analog_scaling *s, const float value)
+{
+        return s->scale(s, value);
+}
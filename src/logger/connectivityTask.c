@@ -24,6 +24,7 @@
 #include "led.h"
 #include "api.h"
 #include "bluetooth.h"
+#include "boot_stats.h"
 #include "capabilities.h"
 #include "connectivityTask.h"
 #include "devices_common.h"
@@ -34,6 +35,7 @@
 #include <string.h>
 #include "modp_numtoa.h"
 #include "null_device.h"
+#include "perf.h"
 #include "printk.h"
 #include "queue.h"
 #include "sampleRecord.h"
@@ -140,6 +142,9 @@ static void createWirelessConnectionTask(int16_t priority,
 
         /* Make all task names 16 chars including NULL char */
         static const signed portCHAR task_name[] = "Bluetooth Task ";
+        perf_register_queue(params->connectionName, "samples", sampleQueue,
+                            LOGGER_MESSAGE_BUFFER_SIZE);
+        perf_register_task(task_name, TELEMETRY_STACK_SIZE);
         xTaskCreate(connectivityTask, task_name, TELEMETRY_STACK_SIZE,
                     params, priority, NULL );
 #endif
@@ -166,6 +171,9 @@ static void createTelemetryConnectionTask(int16_t priority,
         /* Make all task names 16 chars including NULL char */
         static const signed portCHAR task_name[] = "Cell Telem Task";
 
+        perf_register_queue(params->connectionName, "samples", sampleQueue,
+                            LOGGER_MESSAGE_BUFFER_SIZE);
+        perf_register_task(task_name, TELEMETRY_STACK_SIZE);
         xTaskCreate(connectivityTask, task_name, TELEMETRY_STACK_SIZE,
                     params, priority, NULL );
 #endif
@@ -233,6 +241,7 @@ static void queue_api_event(const struct api_event * api_event, void * data)
                 pr_trace(_LOG_PFX "queued api event\r\n");
         } else {
                 pr_warning(_LOG_PFX "api event queue overflow\r\n");
+                perf_count(PERF_COUNTER_API_EVENT_DROP);
         }
 }
 
@@ -261,6 +270,8 @@ void connectivityTask(void *params)
         bool logging_enabled = false;
 
         xQueueHandle api_event_queue = xQueueCreate(API_EVENT_QUEUE_DEPTH, sizeof(struct api_event));
+        perf_register_queue(connParams->connectionName, "api events",
+                            api_event_queue, API_EVENT_QUEUE_DEPTH);
         api_event_create_callback(queue_api_event, api_event_queue);
 
         bool hard_init = true;
@@ -281,6 +292,9 @@ void connectivityTask(void *params)
                                 connect_retries = 0;
                         }
                 }
+                if (should_stream)
+                        boot_stats_end(BOOT_PHASE_CONNECTION);
+
                 if (connected_at > 0)
                         GPS_set_UTC_time(connected_at);
 
@@ -20,32 +20,96 @@
  */
 
 
+#include "dateTime.h"
 #include "fileWriter.h"
+#include "gps.h"
 #include "led.h"
+#include "log_index.h"
 #include "loggerHardware.h"
 #include "macros.h"
 #include "mem_mang.h"
 #include "modp_numtoa.h"
+#include "perf.h"
+#include "perf_region.h"
 #include "printk.h"
 #include "ring_buffer.h"
 #include "sampleRecord.h"
 #include "sdcard.h"
+#include "semphr.h"
 #include "task.h"
 #include "taskUtil.h"
 #include "test.h"
+#include "trace.h"
 #include "logger.h"
+#include <ctype.h>
 #include <stdbool.h>
 #include <string.h>
-#include <string.h>
+#include <strings.h>
 
 #define ERROR_SLEEP_DELAY_MS	500
 #define FILE_BUFFER_SIZE	1024
 #define FILE_WRITER_STACK_SIZE	512
+#define LOG_DIR_LEN	9
 #define LOG_PFX	"[fileWriter] "
+#define LOG_PREPARE_INTERVAL_MS	1000
 #define MAX_LOG_FILE_INDEX	99999
 #define WRITE_FAIL	EOF
 
 static FIL *g_logfile;
+static DWORD g_write_pos;
+static bool g_fs_mounted;
+
+/* Sidecar index of the current log, opened on its first flush */
+static FIL *g_indexfile;
+static bool g_index_open;
+static bool g_index_append;
+/* Where a re-opened log picks up; index entries past it are cut */
+static uint32_t g_index_resume;
+static struct log_index g_index;
+
+/* The next log file, created while we are idle */
+static FIL *g_next_logfile;
+static struct {
+        bool ready;
+        char dir[LOG_DIR_LEN];
+        char name[FILENAME_LEN];
+} g_next;
+
+/*
+ * File access requested by other tasks, see log_file_list, log_file_read
+ * and log_file_write
+ */
+enum file_request_type {
+        FILE_REQUEST_LIST,
+        FILE_REQUEST_READ,
+        FILE_REQUEST_WRITE,
+};
+
+static struct {
+        xSemaphoreHandle mutex;
+        xSemaphoreHandle done;
+        enum file_request_type type;
+        const char *path;
+        uint32_t offset;
+        void *buf;
+        size_t len;
+        size_t count;
+        uint32_t size;
+        log_file_producer_t *produce;
+        /* Received, but held back until the samples are written */
+        bool waiting;
+        int result;
+} g_request;
+
+/* Downloads keep their file open from one chunk to the next */
+static FIL *g_readfile;
+static bool g_read_open;
+static char g_read_name[FILENAME_LEN];
+
+/* Directory we last scanned for log files and the next free index in it */
+static char g_index_dir[LOG_DIR_LEN];
+static int g_next_index = -1;
+
 static xQueueHandle g_LoggerMessage_queue;
 static struct ring_buff *file_buff;
 
@@ -70,6 +134,7 @@ static FRESULT flush_file_buffer(void)
                         f_write(g_logfile, buff, available, &written);
 
                 ring_buffer_dma_read_fini(file_buff, written);
+                g_write_pos += written;
                 if (FR_OK != res) {
                         pr_debug_int_msg("[FileWriter] f_write failed "
                                          "with status: ", (int) res);
@@ -217,6 +282,213 @@ static int write_samples_data(const LoggerMessage *msg)
         return flush_file_buffer();
 }
 
+/**
+ * @return the index of an rc_<index>.log file name, or -1 if the name
+ * isn't one of ours.
+ */
+TESTABLE_STATIC int log_file_index(const char *name)
+{
+        if (strncasecmp(name, "rc_", 3) || !isdigit((unsigned char) name[3]))
+                return -1;
+
+        int index = 0;
+        for (name += 3; isdigit((unsigned char) *name); name++) {
+                index = index * 10 + *name - '0';
+                if (index > MAX_LOG_FILE_INDEX)
+                        return -1;
+        }
+
+        return strcasecmp(name, ".log") ? -1 : index;
+}
+
+/**
+ * Names the per-day directory (YYYYMMDD) logs for the given time go in.
+ * Without a GPS date the directory is empty, meaning the root of the card.
+ */
+TESTABLE_STATIC void log_dir_name(char *dir, const millis_t utc)
+{
+        dir[0] = '\0';
+        if (!utc)
+                return;
+
+        DateTime dt;
+        getDateTimeFromEpochMillis(&dt, utc);
+        modp_itoa10(dt.year * 10000 + dt.month * 100 + dt.day, dir);
+}
+
+TESTABLE_STATIC void log_file_path(char *path, const char *dir,
+                                   const int index)
+{
+        char buf[12];
+        modp_itoa10(index, buf);
+
+        path[0] = '\0';
+        if (dir[0]) {
+                strcpy(path, dir);
+                strcat(path, "/");
+        }
+        strcat(path, "rc_");
+        strcat(path, buf);
+        strcat(path, ".log");
+}
+
+/**
+ * One pass over the directory to find the index after the highest
+ * existing log, instead of probing rc_0.log, rc_1.log, ... in turn.
+ */
+static int find_next_log_index(const char *dir)
+{
+        DIR dp;
+        FILINFO info;
+        memset(&info, 0, sizeof(info));
+
+        if (FR_OK != f_opendir(&dp, dir))
+                return 0;
+
+        int next = 0;
+        while (FR_OK == f_readdir(&dp, &info) && info.fname[0]) {
+                /* Empty logs are unused prepared files; we take them over */
+                const int index = log_file_index(info.fname);
+                if (index >= next && info.fsize)
+                        next = index + 1;
+        }
+
+        f_closedir(&dp);
+        return next;
+}
+
+static FRESULT create_log_file(FIL *fp, char *name, const char *dir)
+{
+        if (dir[0]) {
+                const FRESULT res = f_mkdir(dir);
+                if (FR_OK != res && FR_EXIST != res)
+                        return res;
+        }
+
+        if (g_next_index < 0 || strcmp(dir, g_index_dir)) {
+                g_next_index = find_next_log_index(dir);
+                strcpy(g_index_dir, dir);
+        }
+
+        for (; g_next_index <= MAX_LOG_FILE_INDEX; g_next_index++) {
+                log_file_path(name, dir, g_next_index);
+
+                FRESULT res = f_open(fp, name, FA_WRITE | FA_CREATE_NEW);
+                if (FR_EXIST == res) {
+                        /*
+                         * A prepared file left behind by a reset is
+                         * empty.  Take it over instead of skipping it.
+                         */
+                        FILINFO info;
+                        memset(&info, 0, sizeof(info));
+                        if (FR_OK != f_stat(name, &info) || info.fsize)
+                                continue;
+
+                        res = f_open(fp, name, FA_WRITE | FA_CREATE_ALWAYS);
+                }
+
+                if (FR_OK == res)
+                        g_next_index++;
+
+                return res;
+        }
+
+        /* We fail if here. Be sure to clean up name buffer.*/
+        name[0] = '\0';
+        return FR_DENIED;
+}
+
+static int mount_fs(void)
+{
+        if (g_fs_mounted)
+                return 0;
+
+        const int rc = InitFS();
+        g_fs_mounted = 0 == rc;
+        return rc;
+}
+
+/**
+ * Drops everything we know about the mounted volume without touching the
+ * card, for when it has gone away underneath us.
+ */
+static void forget_fs(void)
+{
+        g_fs_mounted = false;
+        g_next.ready = false;
+        g_next_index = -1;
+        g_read_open = false;
+}
+
+static void unmount_fs(void)
+{
+        if (g_next.ready) {
+                f_close(g_next_logfile);
+                f_unlink(g_next.name);
+        }
+        if (g_read_open)
+                f_close(g_readfile);
+
+        forget_fs();
+        UnmountFS();
+}
+
+/**
+ * Creates the file the next session will log to, so
+ * that starting to log costs no filesystem work at all.  Runs whenever
+ * the writer is idle; it is a no-op once a file is ready unless the date
+ * has moved on since.
+ */
+TESTABLE_STATIC void prepare_next_log_file(void)
+{
+        if (!sdcard_present()) {
+                forget_fs();
+                return;
+        }
+
+        char dir[LOG_DIR_LEN];
+        log_dir_name(dir, getMillisSinceEpoch());
+
+        if (g_next.ready) {
+                if (!strcmp(dir, g_next.dir))
+                        return;
+
+                /* Date arrived or rolled over.  Move to the right directory */
+                f_close(g_next_logfile);
+                f_unlink(g_next.name);
+                g_next.ready = false;
+        }
+
+        if (0 != mount_fs())
+                return;
+
+        const FRESULT res = create_log_file(g_next_logfile, g_next.name, dir);
+        if (FR_OK != res) {
+                pr_debug_int_msg(LOG_PFX "Failed to prepare log file: ", res);
+                return;
+        }
+
+        f_sync(g_next_logfile);
+
+        strcpy(g_next.dir, dir);
+        g_next.ready = true;
+        pr_info_str_msg(LOG_PFX "Prepared ", g_next.name);
+}
+
+static bool use_prepared_log_file(struct logging_status *ls)
+{
+        if (!g_next.ready)
+                return false;
+
+        FIL *fp = g_logfile;
+        g_logfile = g_next_logfile;
+        g_next_logfile = fp;
+
+        strcpy(ls->name, g_next.name);
+        g_next.ready = false;
+        return true;
+}
+
 static enum writing_status open_existing_log_file(struct logging_status *ls)
 {
         pr_debug_str_msg(_RCP_BASE_FILE_ "Opening log file ", ls->name);
@@ -226,8 +498,13 @@ static enum writing_status open_existing_log_file(struct logging_status *ls)
         if (FR_OK != rc)
                 return WRITING_INACTIVE;
 
-        // Seek to the end so we append instead of overwriting
-        rc = f_lseek(g_logfile, f_size(g_logfile));
+        /*
+         * Pick up after the last data we know made it to the card and
+         * drop any partial row written after it.
+         */
+        rc = f_lseek(g_logfile, ls->synced_size);
+        if (FR_OK == rc)
+                rc = f_truncate(g_logfile);
 
         return rc == FR_OK ? WRITING_ACTIVE : WRITING_INACTIVE;
 }
@@ -236,34 +513,126 @@ static enum writing_status open_new_log_file(struct logging_status *ls)
 {
         pr_debug(_RCP_BASE_FILE_ "Opening new log file\r\n");
 
-        int i;
+        char dir[LOG_DIR_LEN];
+        log_dir_name(dir, getMillisSinceEpoch());
 
-        for (i = 0; i < MAX_LOG_FILE_INDEX; i++) {
-                char buf[12];
-                modp_itoa10(i, buf);
+        return FR_OK == create_log_file(g_logfile, ls->name, dir) ?
+                WRITING_ACTIVE : WRITING_INACTIVE;
+}
 
-                strcpy(ls->name, "rc_");
-                strcat(ls->name, buf);
-                strcat(ls->name, ".log");
+static void index_file_path(char *path, const char *log_name)
+{
+        strcpy(path, log_name);
+        const size_t len = strlen(path);
+        if (len > 3)
+                strcpy(path + len - 3, "idx");
+}
 
-                const FRESULT res = f_open(g_logfile, ls->name,
-                                           FA_WRITE | FA_CREATE_NEW);
-                if ( FR_OK == res )
-                        return WRITING_ACTIVE;
+/**
+ * Cuts the index of a re-opened log back to the entries for rows that
+ * made it to the card, leaving the file pointer at the end.  Offsets
+ * only ever grow, so a binary search finds the first entry to go.
+ */
+static FRESULT trim_index_file(const uint32_t synced_size)
+{
+        const DWORD start = sizeof(struct log_index_header);
+        const DWORD size = f_size(g_indexfile);
+        struct log_index_entry e;
+        size_t keep = 0;
+        size_t end = size > start ? (size - start) / sizeof(e) : 0;
+
+        while (keep < end) {
+                const size_t mid = keep + (end - keep) / 2;
+                unsigned int read = 0;
+                FRESULT res = f_lseek(g_indexfile, start + mid * sizeof(e));
+                if (FR_OK == res)
+                        res = f_read(g_indexfile, &e, sizeof(e), &read);
+                if (FR_OK != res)
+                        return res;
+                if (read != sizeof(e))
+                        return FR_INT_ERR;
 
-                f_close(g_logfile);
+                if (e.offset <= synced_size) {
+                        keep = mid + 1;
+                } else {
+                        end = mid;
+                }
         }
 
-        /* We fail if here. Be sure to clean up name buffer.*/
-        ls->name[0] = '\0';
-        return WRITING_INACTIVE;
+        /* No room for even the header means no header; start over */
+        const FRESULT res = f_lseek(g_indexfile, size < start ? 0 :
+                                    start + keep * sizeof(e));
+        return FR_OK == res ? f_truncate(g_indexfile) : res;
+}
+
+static FRESULT open_index_file(const struct logging_status *ls)
+{
+        char path[FILENAME_LEN];
+        index_file_path(path, ls->name);
+
+        /* A fresh log gets a fresh index; a re-opened one carries on */
+        const BYTE mode = g_index_append ?
+                FA_READ | FA_WRITE | FA_OPEN_ALWAYS :
+                FA_WRITE | FA_CREATE_ALWAYS;
+        FRESULT res = f_open(g_indexfile, path, mode);
+        if (FR_OK != res)
+                return res;
+
+        if (g_index_append)
+                res = trim_index_file(g_index_resume);
+
+        if (FR_OK == res && 0 == f_size(g_indexfile)) {
+                struct log_index_header hdr;
+                unsigned int written;
+                log_index_header(&hdr);
+                res = f_write(g_indexfile, &hdr, sizeof(hdr), &written);
+        }
+
+        if (FR_OK != res) {
+                f_close(g_indexfile);
+                return res;
+        }
+
+        g_index_open = true;
+        return FR_OK;
+}
+
+/**
+ * Appends the pending index entries to the index file.  The index is a
+ * convenience, so failures here never stop the log itself.
+ */
+static void write_index(const struct logging_status *ls)
+{
+        if (!g_index.count)
+                return;
+
+        if (!g_index_open && FR_OK != open_index_file(ls)) {
+                pr_debug(LOG_PFX "Failed to open index\r\n");
+                return;
+        }
+
+        unsigned int written;
+        const FRESULT res = f_write(g_indexfile, g_index.pending,
+                                    g_index.count * sizeof(struct log_index_entry),
+                                    &written);
+        if (FR_OK != res)
+                pr_debug_int_msg(LOG_PFX "Index write failed: ", res);
+
+        log_index_consumed(&g_index);
+        f_sync(g_indexfile);
 }
 
 static void close_log_file(struct logging_status *ls)
 {
+        if (g_index_open) {
+                f_close(g_indexfile);
+                g_index_open = false;
+        }
+
+        if (WRITING_ACTIVE == ls->writing_status)
+                f_close(g_logfile);
+
         ls->writing_status = WRITING_INACTIVE;
-        f_close(g_logfile);
-        UnmountFS();
 }
 
 static void logging_led_toggle(void)
@@ -282,21 +651,30 @@ static void open_log_file(struct logging_status *ls)
         ls->writing_status = WRITING_INACTIVE;
 
         if (!sdcard_present()) {
+                forget_fs();
                 ls->writing_status = SD_CARD_NOT_PRESENT;
                 pr_error(_RCP_BASE_FILE_ "SD card not present\r\n");
                 return;
         }
 
-        const int rc = InitFS();
-        if (0 != rc) {
-                pr_error_int_msg(_RCP_BASE_FILE_ "FS init error: ", rc);
-                return;
-        }
+        g_index_append = ls->name[0];
+        if (!ls->name[0] && use_prepared_log_file(ls)) {
+                ls->synced_size = 0;
+                ls->writing_status = WRITING_ACTIVE;
+        } else {
+                const int rc = mount_fs();
+                if (0 != rc) {
+                        pr_error_int_msg(_RCP_BASE_FILE_ "FS init error: ", rc);
+                        return;
+                }
 
-        pr_debug(_RCP_BASE_FILE_ "FS init success.  Opening file...\r\n");
-        // Open a file if one is set, else create a new one.
-        ls->writing_status = ls->name[0] ? open_existing_log_file(ls) :
-                             open_new_log_file(ls);
+                pr_debug(_RCP_BASE_FILE_ "FS mounted.  Opening file...\r\n");
+                // Open a file if one is set, else create a new one.
+                if (!ls->name[0])
+                        ls->synced_size = 0;
+                ls->writing_status = ls->name[0] ? open_existing_log_file(ls) :
+                                     open_new_log_file(ls);
+        }
 
         if (WRITING_INACTIVE == ls->writing_status) {
                 pr_warning_str_msg(_RCP_BASE_FILE_ "Failed to open: ", ls->name);
@@ -304,6 +682,16 @@ static void open_log_file(struct logging_status *ls)
         }
 
         pr_info_str_msg(_RCP_BASE_FILE_ "Opened " , ls->name);
+        g_write_pos = ls->synced_size;
+        /* Anything still buffered is from a write that failed; drop it */
+        ring_buffer_clear(file_buff);
+        if (g_index_append) {
+                /* Rows past the last sync were lost; so are their entries */
+                g_index_resume = ls->synced_size;
+                log_index_discard(&g_index, g_index_resume);
+        } else {
+                log_index_init(&g_index);
+        }
         ls->flush_tick = xTaskGetTickCount();
         ls->last_sample_tick = 0;
 }
@@ -315,6 +703,11 @@ TESTABLE_STATIC int logging_start(struct logging_status *ls)
 
         /* Set this here because this is the start of the log stream */
         ls->rows_written = 0;
+        ls->start_tick = 0;
+
+        /* Attach the pre-opened file now so the first sample goes straight in */
+        if (g_next.ready && WRITING_ACTIVE != ls->writing_status)
+                open_log_file(ls);
 
         logging_led_toggle();
         return 0;
@@ -325,6 +718,10 @@ TESTABLE_STATIC int logging_stop(struct logging_status *ls)
         pr_debug(_RCP_BASE_FILE_ "End\r\n");
         ls->logging = false;
 
+        if (WRITING_ACTIVE == ls->writing_status) {
+                log_index_stop(&g_index, g_write_pos);
+                write_index(ls);
+        }
         close_log_file(ls);
 
         /* Prevent log file from being re-opened */
@@ -364,7 +761,24 @@ static int write_samples(struct logging_status *ls, const LoggerMessage *msg)
         if (0 != rc)
                 return rc;
 
+        /*
+         * Rows are flushed whole, so the write position is this row's
+         * start.  The entry describes the sample, not when we got to it.
+         */
+        const struct sample *s = msg->sample;
+        if (1 == ls->rows_written) {
+                ls->start_tick = msg->ticks;
+                log_index_start(&g_index, g_write_pos, s->lap, s->sector);
+        } else {
+                const uint32_t time = ticksToMs(msg->ticks - ls->start_tick);
+                log_index_row(&g_index, g_write_pos, time, s->lap, s->sector);
+        }
+
+        TRACE_BEGIN(TRACE_EVENT_FILE_WRITE, ls->rows_written);
+        PERF_REGION_BEGIN("write_samples_data");
         rc = write_samples_data(msg);
+        PERF_REGION_END("write_samples_data");
+        TRACE_END(TRACE_EVENT_FILE_WRITE, ls->rows_written);
 
         if (0 == rc)
                 ls->rows_written++;
@@ -404,6 +818,7 @@ TESTABLE_STATIC int logging_sample(struct logging_status *ls,
                 pr_error(_RCP_BASE_FILE_ "Remounting FS due to write "
                          "error.\r\n");
                 close_log_file(ls);
+                unmount_fs();
 
                 /*
                  * We yield here because init/f_open/f_close all involve
@@ -427,14 +842,267 @@ TESTABLE_STATIC int flush_logfile(struct logging_status *ls)
                 return -2;
 
         pr_debug(_RCP_BASE_FILE_ "flush\r\n");
+        TRACE_BEGIN(TRACE_EVENT_FILE_FLUSH, 0);
         const int res = f_sync(g_logfile);
-        if (0 != res)
+        TRACE_END(TRACE_EVENT_FILE_FLUSH, res);
+        if (0 == res)
+                ls->synced_size = g_write_pos;
+        else
                 pr_debug_int_msg(_RCP_BASE_FILE_ "flush err ", res);
 
+        write_index(ls);
+
         ls->flush_tick = xTaskGetTickCount();
         return res;
 }
 
+static bool is_active_log(const struct logging_status *ls, const char *path)
+{
+        return WRITING_ACTIVE == ls->writing_status &&
+                !strcasecmp(path, ls->name);
+}
+
+static FRESULT list_files(const struct logging_status *ls)
+{
+        DIR dp;
+        FILINFO info;
+        memset(&info, 0, sizeof(info));
+
+        FRESULT res = f_opendir(&dp, g_request.path);
+        if (FR_OK != res)
+                return res;
+
+        struct log_file_info *files = g_request.buf;
+        size_t skip = g_request.offset;
+        size_t count = 0;
+        while (count < g_request.len) {
+                res = f_readdir(&dp, &info);
+                if (FR_OK != res || !info.fname[0])
+                        break;
+
+                if (skip) {
+                        skip--;
+                        continue;
+                }
+
+                struct log_file_info *file = files + count++;
+                strcpy(file->name, info.fname);
+                file->size = info.fsize;
+                file->dir = info.fattrib & AM_DIR;
+
+                /* Don't offer rows of the live log that aren't synced yet */
+                char path[FILENAME_LEN];
+                if (g_request.path[0] &&
+                    strlen(g_request.path) + strlen(info.fname) + 1 < FILENAME_LEN) {
+                        strcpy(path, g_request.path);
+                        strcat(path, "/");
+                        strcat(path, info.fname);
+                } else {
+                        strcpy(path, info.fname);
+                }
+                if (is_active_log(ls, path))
+                        file->size = ls->synced_size;
+        }
+
+        f_closedir(&dp);
+        g_request.count = count;
+        return res;
+}
+
+static FRESULT read_file(const struct logging_status *ls)
+{
+        const char *path = g_request.path;
+        if (strlen(path) >= FILENAME_LEN)
+                return FR_INVALID_NAME;
+
+        if (g_read_open && strcasecmp(path, g_read_name)) {
+                f_close(g_readfile);
+                g_read_open = false;
+        }
+
+        FRESULT res;
+        if (!g_read_open) {
+                res = f_open(g_readfile, path, FA_READ);
+                if (FR_OK != res)
+                        return res;
+
+                strcpy(g_read_name, path);
+                g_read_open = true;
+        }
+
+        const bool active = is_active_log(ls, path);
+        g_request.size = active ? ls->synced_size : f_size(g_readfile);
+        g_request.count = 0;
+
+        if (g_request.offset < g_request.size) {
+                const size_t max = ls->logging ?
+                        MIN(g_request.len, LOG_FILE_READ_LOGGING_MAX) :
+                        g_request.len;
+                const size_t len = MIN(max, g_request.size - g_request.offset);
+                unsigned int read = 0;
+                res = f_lseek(g_readfile, g_request.offset);
+                if (FR_OK == res)
+                        res = f_read(g_readfile, g_request.buf, len, &read);
+                g_request.count = read;
+        } else {
+                res = FR_OK;
+        }
+
+        /*
+         * Our handle caches a sector of its own, which goes stale as the
+         * live log is written.  Only finished files stay open.
+         */
+        if (active || FR_OK != res) {
+                f_close(g_readfile);
+                g_read_open = false;
+        }
+
+        return res;
+}
+
+static bool write_sink(void *sink, const void *data, const size_t len)
+{
+        UINT bw;
+        return FR_OK == f_write((FIL *) sink, data, len, &bw) && bw == len;
+}
+
+static int write_file(const struct logging_status *ls)
+{
+        const char *path = g_request.path;
+        if (ls->logging)
+                return FR_DENIED;
+
+        if (strlen(path) >= FILENAME_LEN)
+                return FR_INVALID_NAME;
+
+        if (g_read_open && !strcasecmp(path, g_read_name)) {
+                f_close(g_readfile);
+                g_read_open = false;
+        }
+
+        /* The log file handle is free while we aren't logging */
+        int res = f_open(g_logfile, path, FA_WRITE | FA_CREATE_ALWAYS);
+        if (FR_OK != res)
+                return res;
+
+        if (!g_request.produce(write_sink, g_logfile, g_request.buf))
+                res = -1;
+
+        const FRESULT close_res = f_close(g_logfile);
+        return FR_OK == res ? close_res : res;
+}
+
+static void service_file_request(const struct logging_status *ls)
+{
+        int res = FR_NOT_READY;
+        if (!sdcard_present()) {
+                forget_fs();
+        } else if (0 == mount_fs()) {
+                switch (g_request.type) {
+                case FILE_REQUEST_LIST:
+                        res = list_files(ls);
+                        break;
+                case FILE_REQUEST_READ:
+                        res = read_file(ls);
+                        break;
+                case FILE_REQUEST_WRITE:
+                        res = write_file(ls);
+                        break;
+                }
+        }
+
+        g_request.result = res;
+        xSemaphoreGive(g_request.done);
+}
+
+/**
+ * Carries out a received file request once it no longer holds up any
+ * samples: straight away when idle, and only with the sample queue empty
+ * while logging.
+ */
+static void service_waiting_file_request(const struct logging_status *ls)
+{
+        if (!g_request.waiting)
+                return;
+
+        if (ls->logging && uxQueueMessagesWaiting(g_LoggerMessage_queue))
+                return;
+
+        g_request.waiting = false;
+        service_file_request(ls);
+}
+
+static int submit_file_request(void)
+{
+        const LoggerMessage msg =
+                create_logger_message(LoggerMessageType_File, 0, NULL);
+        if (pdTRUE != queue_logfile_record(&msg))
+                return -1;
+
+        xSemaphoreTake(g_request.done, portMAX_DELAY);
+        return g_request.result;
+}
+
+int log_file_list(const char *dir, const size_t start,
+                  struct log_file_info *files, const size_t max,
+                  size_t *count)
+{
+        if (!g_request.mutex)
+                return -1;
+
+        xSemaphoreTake(g_request.mutex, portMAX_DELAY);
+        g_request.type = FILE_REQUEST_LIST;
+        g_request.path = dir;
+        g_request.offset = start;
+        g_request.buf = files;
+        g_request.len = max;
+
+        const int res = submit_file_request();
+        *count = 0 == res ? g_request.count : 0;
+        xSemaphoreGive(g_request.mutex);
+
+        return res;
+}
+
+int log_file_read(const char *path, const uint32_t offset, void *buf,
+                  const size_t len, size_t *read, uint32_t *size)
+{
+        if (!g_request.mutex)
+                return -1;
+
+        xSemaphoreTake(g_request.mutex, portMAX_DELAY);
+        g_request.type = FILE_REQUEST_READ;
+        g_request.path = path;
+        g_request.offset = offset;
+        g_request.buf = buf;
+        g_request.len = len;
+
+        const int res = submit_file_request();
+        *read = 0 == res ? g_request.count : 0;
+        *size = g_request.size;
+        xSemaphoreGive(g_request.mutex);
+
+        return res;
+}
+
+int log_file_write(const char *path, log_file_producer_t *produce,
+                   void *arg)
+{
+        if (!g_request.mutex)
+                return -1;
+
+        xSemaphoreTake(g_request.mutex, portMAX_DELAY);
+        g_request.type = FILE_REQUEST_WRITE;
+        g_request.path = path;
+        g_request.produce = produce;
+        g_request.buf = arg;
+
+        const int res = submit_file_request();
+        xSemaphoreGive(g_request.mutex);
+
+        return res;
+}
+
 static void update_logger_status(struct logging_status *ls)
 {
         switch(ls->writing_status) {
@@ -463,11 +1131,14 @@ static void fileWriterTask(void *params)
 
                 /* Get a sample. */
                 const char status = receive_logger_message(g_LoggerMessage_queue,
-                                    &msg, portMAX_DELAY);
+                                    &msg, msToTicks(LOG_PREPARE_INTERVAL_MS));
 
-                /* If we fail to receive for any reason, keep trying */
-                if (pdPASS != status)
+                /* Nothing to write.  Use the time to line up the next file */
+                if (pdPASS != status) {
+                        if (!ls.logging)
+                                prepare_next_log_file();
                         continue;
+                }
 
                 switch (msg.type) {
                 case LoggerMessageType_Sample:
@@ -479,6 +1150,10 @@ static void fileWriterTask(void *params)
                 case LoggerMessageType_Stop:
                         rc = logging_stop(&ls);
                         break;
+                case LoggerMessageType_File:
+                        g_request.waiting = true;
+                        rc = 0;
+                        break;
                 default:
                         pr_warning(_RCP_BASE_FILE_ "Unsupported message "
                                    "type\r\n");
@@ -494,6 +1169,7 @@ static void fileWriterTask(void *params)
 
                 flush_logfile(&ls);
                 update_logger_status(&ls);
+                service_waiting_file_request(&ls);
         }
 }
 
@@ -505,6 +1181,8 @@ void startFileWriterTask(int priority)
                 pr_error(_RCP_BASE_FILE_ "LoggerMessage Queue is null!\r\n");
                 return;
         }
+        perf_register_queue("File Writer", "samples", g_LoggerMessage_queue,
+                            LOGGER_MESSAGE_BUFFER_SIZE);
 
         g_logfile = (FIL *) portMalloc(sizeof(FIL));
         if (NULL == g_logfile) {
@@ -513,14 +1191,45 @@ void startFileWriterTask(int priority)
         }
         memset(g_logfile, 0, sizeof(FIL));
 
+        g_next_logfile = (FIL *) portMalloc(sizeof(FIL));
+        if (NULL == g_next_logfile) {
+                pr_error(_RCP_BASE_FILE_ "logfile sruct alloc err\r\n");
+                return;
+        }
+        memset(g_next_logfile, 0, sizeof(FIL));
+
+        g_readfile = (FIL *) portMalloc(sizeof(FIL));
+        if (NULL == g_readfile) {
+                pr_error(_RCP_BASE_FILE_ "logfile sruct alloc err\r\n");
+                return;
+        }
+        memset(g_readfile, 0, sizeof(FIL));
+
+        g_indexfile = (FIL *) portMalloc(sizeof(FIL));
+        if (NULL == g_indexfile) {
+                pr_error(_RCP_BASE_FILE_ "logfile sruct alloc err\r\n");
+                return;
+        }
+        memset(g_indexfile, 0, sizeof(FIL));
+
         file_buff = ring_buffer_create(FILE_BUFFER_SIZE);
         if (!file_buff) {
                 pr_error(_RCP_BASE_FILE_ "Failed to alloc ring buffer.\r\n");
                 return;
         }
 
+        /* The mutex goes last; it is what tells callers we are serving */
+        g_request.done = xSemaphoreCreateBinary();
+        if (g_request.done)
+                g_request.mutex = xSemaphoreCreateMutex();
+        if (!g_request.mutex) {
+                pr_error(_RCP_BASE_FILE_ "Failed to alloc semaphores\r\n");
+                return;
+        }
+
         /* Make all task names 16 chars including NULL char */
         static const signed portCHAR task_name[] = "File Task       ";
+        perf_register_task(task_name, FILE_WRITER_STACK_SIZE);
         xTaskCreate(fileWriterTask, task_name, FILE_WRITER_STACK_SIZE,
                     NULL, priority, NULL );
 }
@@ -0,0 +1,124 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "log_index.h"
+#include "printk.h"
+
+#include <string.h>
+
+#define _LOG_PFX "[log_index] "
+
+void log_index_init(struct log_index *li)
+{
+        memset(li, 0, sizeof(*li));
+}
+
+void log_index_header(struct log_index_header *hdr)
+{
+        memcpy(hdr->magic, LOG_INDEX_MAGIC, sizeof(hdr->magic));
+        hdr->version = LOG_INDEX_VERSION;
+        hdr->interval_ms = LOG_INDEX_INTERVAL_MS;
+}
+
+bool log_index_add(struct log_index *li, const enum log_index_type type,
+                   const uint32_t offset, const uint32_t time,
+                   const int lap, const int sector)
+{
+        if (li->count >= LOG_INDEX_PENDING) {
+                if (!li->overflow)
+                        pr_warning(_LOG_PFX "Pending entries full\r\n");
+
+                li->overflow = true;
+                return false;
+        }
+
+        struct log_index_entry *e = li->pending + li->count++;
+        e->offset = offset;
+        e->time = time;
+        e->lap = lap;
+        e->sector = sector;
+        e->type = type;
+        return true;
+}
+
+void log_index_start(struct log_index *li, const uint32_t offset,
+                     const int lap, const int sector)
+{
+        li->time = 0;
+        li->lap = lap;
+        li->sector = sector;
+        li->next_time = LOG_INDEX_INTERVAL_MS;
+        log_index_add(li, LOG_INDEX_START, offset, 0, lap, sector);
+}
+
+void log_index_row(struct log_index *li, const uint32_t offset,
+                   const uint32_t time, const int lap, const int sector)
+{
+        if (lap != li->lap) {
+                log_index_add(li, LOG_INDEX_LAP, offset, time, lap, sector);
+        } else if (sector != li->sector) {
+                log_index_add(li, LOG_INDEX_SECTOR, offset, time, lap, sector);
+        }
+        li->time = time;
+        li->lap = lap;
+        li->sector = sector;
+
+        if (time < li->next_time)
+                return;
+
+        log_index_add(li, LOG_INDEX_TIME, offset, time, lap, sector);
+        li->next_time = time - time % LOG_INDEX_INTERVAL_MS +
+                LOG_INDEX_INTERVAL_MS;
+}
+
+void log_index_stop(struct log_index *li, const uint32_t offset)
+{
+        log_index_add(li, LOG_INDEX_STOP, offset, li->time, li->lap,
+                      li->sector);
+}
+
+void log_index_discard(struct log_index *li, const uint32_t offset)
+{
+        while (li->count && li->pending[li->count - 1].offset > offset) {
+                const struct log_index_entry *e = li->pending + --li->count;
+
+                /* Have the rows that take the place of the lost ones marked */
+                switch (e->type) {
+                case LOG_INDEX_LAP:
+                        li->lap = -1;
+                        break;
+                case LOG_INDEX_SECTOR:
+                        li->sector = -1;
+                        break;
+                case LOG_INDEX_TIME:
+                        li->next_time = e->time;
+                        break;
+                default:
+                        break;
+                }
+        }
+}
+
+void log_index_consumed(struct log_index *li)
+{
+        li->count = 0;
+        li->overflow = false;
+}
@@ -22,7 +22,9 @@
 #include "FreeRTOS.h"
 #include "GPIO.h"
 #include "PWM.h"
+#include "block_pool.h"
 #include "bluetooth.h"
+#include "boot_stats.h"
 #include "capabilities.h"
 #include "cellular.h"
 #include "CAN.h"
@@ -33,10 +35,14 @@
 #include "OBD2.h"
 #include "cpu.h"
 #include "dateTime.h"
+#include "device_cache.h"
+#include "fileWriter.h"
+#include "crc32.h"
 #include "esp8266_drv.h"
 #include "flags.h"
 #include "geopoint.h"
 #include "gps.h"
+#include "gps_fusion.h"
 #include "imu.h"
 #include "imu_device.h"
 #include "jsmn.h"
@@ -53,9 +59,15 @@
 #include "luaScript.h"
 #include "luaTask.h"
 #include "macros.h"
+#include "math_channel.h"
 #include "mem_mang.h"
+#include "perf.h"
+#include "perf_region.h"
 #include "printk.h"
+#include "printk_deferred.h"
+#include "reference_lap.h"
 #include "sampleRecord.h"
+#include "sector_stats.h"
 #include "serial.h"
 #include "str_util.h"
 #include "task.h"
@@ -166,7 +178,9 @@ int api_getCapabilities(struct Serial *serial, const jsmntok_t *json)
 
         json_int(serial, "obd2", CONFIG_OBD2_CHANNELS, 1);
 
-        json_int(serial, "canChan", CONFIG_CAN_MAPPINGS, 0);
+        json_int(serial, "canChan", CONFIG_CAN_MAPPINGS, 1);
+
+        json_int(serial, "math", MATH_CHANNELS, 0);
 
         json_objEnd(serial, 1);
 
@@ -511,6 +525,17 @@ static void json_channelConfig(struct Serial *serial, const ChannelConfig *cfg,
         json_int(serial, "sr", decodeSampleRate(cfg->sampleRate), more);
 }
 
+static void json_channelFilterConfig(struct Serial *serial,
+                                    const struct channel_filter_config *cfg,
+                                    int more)
+{
+        json_objStartString(serial, "filt");
+        json_int(serial, "type", cfg->type, 1);
+        json_int(serial, "size", cfg->size, 1);
+        json_float(serial, "param", cfg->param, CHANNEL_FILTER_PARAM_PRECISION, 0);
+        json_objEnd(serial, more);
+}
+
 static void write_sample_meta(struct Serial *serial, const struct sample *sample,
                               int sampleRateLimit, int more)
 {
@@ -559,6 +584,8 @@ void api_send_sample_record(struct Serial *serial,
                             const struct sample *sample,
                             const unsigned int tick, const int sendMeta)
 {
+        PERF_REGION_BEGIN("api_send_sample_record");
+
         json_objStart(serial);
         json_objStartString(serial, "s");
         json_uint(serial,"t", tick, 1);
@@ -627,6 +654,8 @@ void api_send_sample_record(struct Serial *serial,
         json_arrayEnd(serial, 0);
         json_objEnd(serial, 0);
         json_objEnd(serial, 0);
+
+        PERF_REGION_END("api_send_sample_record");
 }
 
 static const jsmntok_t * setChannelConfig(struct Serial *serial, const jsmntok_t *cfg,
@@ -702,6 +731,35 @@ static int setMultiChannelConfigGeneric(struct Serial *serial, const jsmntok_t *
         return (initRes ? API_SUCCESS : API_ERROR_SEVERE);
 }
 
+/*
+ * Parses a {"type":..,"size":..,"param":..} filter object and returns the
+ * token following it.
+ */
+static const jsmntok_t * setChannelFilterConfig(const jsmntok_t *valueTok,
+                struct channel_filter_config *cfg)
+{
+        if (valueTok->type != JSMN_OBJECT || valueTok->size % 2 != 0)
+                return valueTok + 1;
+
+        const int size = valueTok->size;
+        const jsmntok_t *tok = valueTok + 1;
+
+        for (int i = 0; i < size; i += 2, tok += 2) {
+                const char *name = jsmn_trimData(tok)->data;
+                const char *value = jsmn_trimData(tok + 1)->data;
+
+                if (STR_EQ("type", name))
+                        cfg->type = atoi(value);
+                else if (STR_EQ("size", name))
+                        cfg->size = atoi(value);
+                else if (STR_EQ("param", name))
+                        cfg->param = atof(value);
+        }
+
+        channel_filter_sanitize_config(cfg);
+        return tok;
+}
+
 static const jsmntok_t * setScalingMapRaw(ADCConfig *adcCfg, const jsmntok_t *mapArrayTok)
 {
         if (mapArrayTok->type == JSMN_ARRAY) {
@@ -763,6 +821,8 @@ static const jsmntok_t * setAnalogExtendedField(const jsmntok_t *valueTok, const
                 adcCfg->filterAlpha = atof(value);
         else if (STR_EQ("cal", name))
                 adcCfg->calibration = atof(value);
+        else if (STR_EQ("filt", name))
+                return setChannelFilterConfig(valueTok, &adcCfg->filter);
         else if (STR_EQ("map", name)) {
                 if (valueTok->type == JSMN_OBJECT) {
                         valueTok++;
@@ -804,6 +864,7 @@ static void sendAnalogConfig(struct Serial *serial, size_t startIndex, size_t en
                 json_float(serial, "offset", adcCfg->linearOffset, LINEAR_SCALING_PRECISION, 1);
                 json_float(serial, "alpha", adcCfg->filterAlpha, FILTER_ALPHA_PRECISION, 1);
                 json_float(serial, "cal", adcCfg->calibration, LINEAR_SCALING_PRECISION, 1);
+                json_channelFilterConfig(serial, &adcCfg->filter, 1);
 
                 json_objStartString(serial, "map");
                 json_arrayStart(serial, "raw");
@@ -955,6 +1016,11 @@ int api_setLogfileLevel(struct Serial *serial, const jsmntok_t *json)
         int level;
         if (jsmn_exists_set_val_int(json, "level", &level)) {
                 set_log_level((enum log_level) level);
+
+                bool deferred;
+                if (jsmn_exists_set_val_bool(json, "deferred", &deferred))
+                        printk_deferred_enable(deferred);
+
                 return API_SUCCESS;
         } else {
                 return API_ERROR_PARAMETER;
@@ -1214,6 +1280,8 @@ static const jsmntok_t * setTimerExtendedField(const jsmntok_t *valueTok,
                 timerCfg->filter_period_us = atoi(value);
         if (STR_EQ("edge", name))
                 timerCfg->edge = get_timer_edge_enum(value);
+        if (STR_EQ("filt", name))
+                return setChannelFilterConfig(valueTok, &timerCfg->filter);
 
         return valueTok + 1;
 }
@@ -1233,6 +1301,7 @@ static void sendTimerConfig(struct Serial *serial, size_t startIndex, size_t end
                 json_float(serial, "ppr", cfg->pulsePerRevolution, 6, 1);
                 json_uint(serial, "speed", cfg->timerSpeed, 1);
                 json_int(serial, "filter_period", cfg->filter_period_us, 1);
+                json_channelFilterConfig(serial, &cfg->filter, 1);
                 json_string(serial, "edge", get_timer_edge_api_key(cfg->edge), 0);
                 json_objEnd(serial, i != endIndex);
         }
@@ -1369,6 +1438,30 @@ int api_setGpsConfig(struct Serial *serial, const jsmntok_t *json)
         configChanged();
         return API_SUCCESS;
 }
+
+int api_get_fusion_cfg(struct Serial *serial, const jsmntok_t *json)
+{
+        const struct gps_fusion_config *cfg =
+                &getWorkingLoggerConfig()->fusion_cfg;
+
+        json_objStart(serial);
+        gps_fusion_get_config(cfg, serial, false);
+        json_objEnd(serial, false);
+
+        return API_SUCCESS_NO_RETURN;
+}
+
+int api_set_fusion_cfg(struct Serial *serial, const jsmntok_t *json)
+{
+        struct gps_fusion_config *cfg =
+                &getWorkingLoggerConfig()->fusion_cfg;
+
+        if (!gps_fusion_set_config(cfg, json))
+                return API_ERROR_UNSPECIFIED;
+
+        configChanged();
+        return API_SUCCESS;
+}
 #endif
 
 int api_getCanConfig(struct Serial *serial, const jsmntok_t *json)
@@ -1464,6 +1557,7 @@ int api_get_can_channel_config(struct Serial *serial, const jsmntok_t *json)
 
                 json_objStart(serial);
                 json_channelConfig(serial, &(can_channel->mapping.channel_cfg), 1);
+                json_channelFilterConfig(serial, &(can_channel->filter), 1);
                 json_put_can_mapping(serial, &(can_channel->mapping), 0);
                 json_objEnd(serial, i < enabled_mappings - 1);
         }
@@ -1501,6 +1595,14 @@ static void set_can_mapping(const jsmntok_t *json_mapping, CANMapping *mapping)
         }
 }
 
+static const jsmntok_t * setCanChannelExtendedField(const jsmntok_t *valueTok, const char *name, const char *value, void *cfg)
+{
+        CANChannel *chan = (CANChannel *)cfg;
+        if (STR_EQ("filt", name))
+                return setChannelFilterConfig(valueTok, &chan->filter);
+        return valueTok + 1;
+}
+
 int api_set_can_channel_config(struct Serial *serial, const jsmntok_t *json)
 {
         CANChannelConfig * can_channel_cfg = &(getWorkingLoggerConfig()->can_channel_cfg);
@@ -1537,7 +1639,8 @@ int api_set_can_channel_config(struct Serial *serial, const jsmntok_t *json)
                         ChannelConfig *chCfg = &(chan->mapping.channel_cfg);
 
                         set_can_mapping(chans_tok, &(chan->mapping));
-                        chans_tok = setChannelConfig(serial, chans_tok, chCfg, NULL, NULL);
+                        chans_tok = setChannelConfig(serial, chans_tok, chCfg,
+                                                     setCanChannelExtendedField, chan);
                 }
 
                 if (index > can_channel_cfg->enabled_mappings || last || index == CONFIG_CAN_MAPPINGS) {
@@ -1552,6 +1655,113 @@ int api_set_can_channel_config(struct Serial *serial, const jsmntok_t *json)
         return API_SUCCESS;
 }
 
+int api_get_math_channel_config(struct Serial *serial, const jsmntok_t *json)
+{
+        const struct math_channel_config *mcc = &(getWorkingLoggerConfig()->math_channel_cfg);
+        const size_t enabled_channels = MIN(mcc->enabled_channels, MATH_CHANNELS);
+
+        json_objStart(serial);
+        json_objStartString(serial, "mathCfg");
+        json_arrayStart(serial, "chans");
+        for (size_t i = 0; i < enabled_channels; i++) {
+                const struct math_channel *mc = mcc->channels + i;
+
+                json_objStart(serial);
+                json_channelConfig(serial, &(mc->cfg), 1);
+                json_escapedString(serial, "expr", mc->expr, 0);
+                json_objEnd(serial, i < enabled_channels - 1);
+        }
+        json_arrayEnd(serial, 0);
+        json_objEnd(serial, 0);
+        json_objEnd(serial, 0);
+        return API_SUCCESS_NO_RETURN;
+}
+
+struct math_channel_update {
+        struct math_channel *channel;
+        bool valid;
+};
+
+static const jsmntok_t * setMathExtendedField(const jsmntok_t *valueTok, const char *name, const char *value, void *cfg)
+{
+        struct math_channel_update *update = (struct math_channel_update *)cfg;
+        if (STR_EQ("expr", name)) {
+                /* One spare char so an overlong expression shows up */
+                char expr[MATH_CHANNEL_EXPR_LENGTH + 1];
+                jsmn_decode_string(expr, value, MATH_CHANNEL_EXPR_LENGTH);
+
+                /* reject expressions that don't fit or will never compile */
+                if (strlen(expr) < MATH_CHANNEL_EXPR_LENGTH &&
+                    math_channel_validate_expr(expr))
+                        strcpy(update->channel->expr, expr);
+                else
+                        update->valid = false;
+        }
+        return valueTok + 1;
+}
+
+int api_set_math_channel_config(struct Serial *serial, const jsmntok_t *json)
+{
+        struct math_channel_config *mcc = &(getWorkingLoggerConfig()->math_channel_cfg);
+
+        /* flag to indicate if this channel is the last in a series */
+        bool last = false;
+        jsmn_exists_set_val_bool(json, "last", &last);
+
+        /* optional starting index. start at beginning by default */
+        uint32_t index = 0;
+        jsmn_exists_set_val_int(json, "index", &index);
+
+        /* we can only start updating up to the item right after the last */
+        if (index >= MATH_CHANNELS || index > mcc->enabled_channels)
+                return API_ERROR_PARAMETER;
+
+        /* find the beginning of the channels json array */
+        const jsmntok_t *chans_tok = jsmn_find_node(json, "chans");
+        chans_tok = jsmn_find_node_type(chans_tok, JSMN_ARRAY);
+
+        if (chans_tok) {
+                const uint32_t channel_max = index + chans_tok->size;
+                if (channel_max > MATH_CHANNELS)
+                        return API_ERROR_PARAMETER;
+
+                /*
+                 * Apply every entry to a scratch copy first so that a bad
+                 * entry rejects the whole update instead of leaving it
+                 * half applied.
+                 */
+                const jsmntok_t *tok = chans_tok + 1;
+                for (uint32_t i = index; i < channel_max; i++) {
+                        struct math_channel scratch = mcc->channels[i];
+                        struct math_channel_update update = {
+                                .channel = &scratch,
+                                .valid = true,
+                        };
+
+                        tok = setChannelConfig(serial, tok, &scratch.cfg,
+                                               setMathExtendedField, &update);
+                        if (!update.valid)
+                                return API_ERROR_PARAMETER;
+                }
+
+                for (chans_tok++; index < channel_max; index++) {
+                        struct math_channel_update update = {
+                                .channel = mcc->channels + index,
+                                .valid = true,
+                        };
+
+                        chans_tok = setChannelConfig(serial, chans_tok, &(update.channel->cfg),
+                                                     setMathExtendedField, &update);
+                }
+
+                if (index > mcc->enabled_channels || last || index == MATH_CHANNELS)
+                        mcc->enabled_channels = index;
+        }
+
+        configChanged();
+        return API_SUCCESS;
+}
+
 int api_getObd2Config(struct Serial *serial, const jsmntok_t *json)
 {
         json_objStart(serial);
@@ -1708,11 +1918,68 @@ int api_setLapConfig(struct Serial *serial, const jsmntok_t *json)
                                  &lapCfg->session_time_cfg,
                                  NULL, NULL);
 
+        const jsmntok_t *sector_delta = jsmn_find_node(json, "sectorDelta");
+        if (sector_delta != NULL)
+                setChannelConfig(serial, sector_delta + 1,
+                                 &lapCfg->sector_delta_cfg,
+                                 NULL, NULL);
+
+        const jsmntok_t *optimal_time = jsmn_find_node(json, "optimalTime");
+        if (optimal_time != NULL)
+                setChannelConfig(serial, optimal_time + 1,
+                                 &lapCfg->optimal_time_cfg,
+                                 NULL, NULL);
+
         set_consistent_sample_rates(lapCfg);
         configChanged();
         return API_SUCCESS;
 }
 
+static void json_sector_times(struct Serial *serial, const char *name,
+                              tiny_millis_t (*getter)(const int),
+                              const int count, const int more)
+{
+        json_arrayStart(serial, name);
+        for (int i = 0; i < count; ++i)
+                json_arrayElementInt(serial, getter(i), i < count - 1);
+        json_arrayEnd(serial, more);
+}
+
+int api_get_lap_history(struct Serial *serial, const jsmntok_t *json)
+{
+        const int sectors = sector_stats_sector_count();
+
+        json_objStart(serial);
+        json_objStartString(serial, "lapHist");
+        json_int(serial, "optimal", sector_stats_optimal_lap(), 1);
+        json_sector_times(serial, "best", sector_stats_best_sector,
+                          sectors, 1);
+        json_sector_times(serial, "delta", sector_stats_sector_delta,
+                          sectors, 1);
+
+        json_arrayStart(serial, "laps");
+        const size_t laps = sector_stats_history_size();
+        for (size_t i = 0; i < laps; ++i) {
+                const struct lap_history_entry *lap =
+                        sector_stats_history_lap(i);
+
+                json_objStart(serial);
+                json_int(serial, "lap", lap->lap, 1);
+                json_int(serial, "time", lap->lap_time, 1);
+                json_arrayStart(serial, "sectors");
+                for (int s = 0; s < lap->sector_count; ++s)
+                        json_arrayElementInt(serial, lap->sectors[s],
+                                             s < lap->sector_count - 1);
+                json_arrayEnd(serial, 0);
+                json_objEnd(serial, i < laps - 1);
+        }
+        json_arrayEnd(serial, 0);
+
+        json_objEnd(serial, 0);
+        json_objEnd(serial, 0);
+        return API_SUCCESS_NO_RETURN;
+}
+
 int api_getLapConfig(struct Serial *serial, const jsmntok_t *json)
 {
         LapConfig *lapCfg = &(getWorkingLoggerConfig()->LapConfigs);
@@ -1754,6 +2021,14 @@ int api_getLapConfig(struct Serial *serial, const jsmntok_t *json)
 
         json_objStartString(serial, "sessionTime");
         json_channelConfig(serial, &lapCfg->session_time_cfg, 0);
+        json_objEnd(serial, 1);
+
+        json_objStartString(serial, "sectorDelta");
+        json_channelConfig(serial, &lapCfg->sector_delta_cfg, 0);
+        json_objEnd(serial, 1);
+
+        json_objStartString(serial, "optimalTime");
+        json_channelConfig(serial, &lapCfg->optimal_time_cfg, 0);
         json_objEnd(serial, 0);
 
         json_objEnd(serial, 0);
@@ -1901,6 +2176,177 @@ int api_reset_lap_stats(struct Serial *serial, const jsmntok_t *json)
         return API_SUCCESS;
 }
 
+int api_get_boot(struct Serial *serial, const jsmntok_t *json)
+{
+        json_objStart(serial);
+        json_objStartString(serial, "boot");
+
+        for (size_t i = 0; i < BOOT_PHASE_COUNT; ++i) {
+                struct boot_phase_time t;
+                const bool done = boot_stats_get(i, &t);
+
+                json_objStartString(serial, boot_stats_phase_name(i));
+                json_uint(serial, "start", t.start, 1);
+                if (done)
+                        json_uint(serial, "end", t.end, 0);
+                else
+                        json_null(serial, "end", 0);
+                json_objEnd(serial, 1);
+        }
+
+        json_objStartString(serial, "cache");
+        for (size_t i = 0; i < DEVICE_CACHE_COUNT; ++i)
+                json_uint(serial, device_cache_name(i), device_cache_get(i),
+                          i < DEVICE_CACHE_COUNT - 1);
+        json_objEnd(serial, 0);
+
+        json_objEnd(serial, 0);
+        json_objEnd(serial, 0);
+
+        return API_SUCCESS_NO_RETURN;
+}
+
+#if PERF_REGION_SUPPORT
+static void put_perf_regions(struct Serial *serial)
+{
+        json_uint(serial, "hz", perf_region_hz(), 1);
+        json_arrayStart(serial, "regions");
+
+        struct perf_region r;
+        for (size_t i = 0; perf_region_get(i, &r); ++i) {
+                if (i)
+                        serial_write_c(serial, ',');
+
+                json_objStart(serial);
+                json_string(serial, "name", r.name, 1);
+                json_uint(serial, "count", r.count, 1);
+                json_uint(serial, "min", r.min, 1);
+                json_uint(serial, "max", r.max, 1);
+                json_uint(serial, "mean", r.count ? r.total / r.count : 0, 1);
+
+                /* Drop the empty tail of the histogram */
+                size_t buckets = PERF_REGION_BUCKETS;
+                while (buckets && !r.hist[buckets - 1])
+                        --buckets;
+
+                json_arrayStart(serial, "hist");
+                for (size_t b = 0; b < buckets; ++b)
+                        json_arrayElementInt(serial, r.hist[b], b < buckets - 1);
+                json_arrayEnd(serial, 0);
+                json_objEnd(serial, 0);
+        }
+
+        json_arrayEnd(serial, 1);
+}
+#endif /* PERF_REGION_SUPPORT */
+
+static void put_memory_stats(struct Serial *serial)
+{
+        xHeapStats hs;
+        portGetHeapStats(&hs);
+
+        json_objStartString(serial, "heap");
+        json_uint(serial, "size", hs.xTotalHeapSize, 1);
+        json_uint(serial, "free", hs.xAvailableHeapSpaceInBytes, 1);
+        json_uint(serial, "minFree", hs.xMinimumEverFreeBytesRemaining, 1);
+        json_uint(serial, "largest", hs.xSizeOfLargestFreeBlockInBytes, 1);
+        json_uint(serial, "smallest", hs.xSizeOfSmallestFreeBlockInBytes, 1);
+        json_uint(serial, "blocks", hs.xNumberOfFreeBlocks, 1);
+        json_uint(serial, "allocs", hs.xNumberOfSuccessfulAllocations, 1);
+        json_uint(serial, "frees", hs.xNumberOfSuccessfulFrees, 1);
+        json_uint(serial, "fails", hs.xNumberOfFailedAllocations, 0);
+        json_objEnd(serial, 1);
+
+        struct block_pool_stats pools[BLOCK_POOL_MAX_POOLS];
+        const size_t count = block_pool_get_stats(pools, BLOCK_POOL_MAX_POOLS);
+
+        json_arrayStart(serial, "pools");
+        for (size_t i = 0; i < count; ++i) {
+                const struct block_pool_stats *bps = pools + i;
+                json_objStart(serial);
+                json_string(serial, "name", bps->name, 1);
+                json_uint(serial, "size", bps->block_size, 1);
+                json_uint(serial, "cap", bps->capacity, 1);
+                json_uint(serial, "used", bps->used, 1);
+                json_uint(serial, "peak", bps->peak, 1);
+                json_uint(serial, "fails", bps->failures, 0);
+                json_objEnd(serial, i < count - 1);
+        }
+        json_arrayEnd(serial, 1);
+}
+
+int api_get_perf(struct Serial *serial, const jsmntok_t *json)
+{
+        bool reset = false;
+        jsmn_exists_set_val_bool(json, "reset", &reset);
+
+        struct perf_task *tasks = portMalloc(sizeof(struct perf_task) *
+                                             PERF_MAX_TASKS);
+        if (!tasks)
+                return API_ERROR_SEVERE;
+
+        size_t task_count;
+        const uint32_t window = perf_get_tasks(tasks, PERF_MAX_TASKS,
+                                               &task_count);
+
+        struct perf_queue queues[PERF_MAX_QUEUES];
+        const size_t queue_count = perf_get_queues(queues, PERF_MAX_QUEUES);
+
+        json_objStart(serial);
+        json_objStartString(serial, "perf");
+        json_uint(serial, "window", window, 1);
+
+        json_arrayStart(serial, "tasks");
+        for (size_t i = 0; i < task_count; ++i) {
+                const struct perf_task *pt = tasks + i;
+                json_objStart(serial);
+                json_string(serial, "name", pt->name, 1);
+                json_float(serial, "cpu", pt->cpu / 10.0f, 1, 1);
+                json_uint(serial, "stack", pt->stack_size, 1);
+                json_uint(serial, "free", pt->stack_free, 0);
+                json_objEnd(serial, i < task_count - 1);
+        }
+        json_arrayEnd(serial, 1);
+
+        json_arrayStart(serial, "queues");
+        for (size_t i = 0; i < queue_count; ++i) {
+                const struct perf_queue *pq = queues + i;
+                json_objStart(serial);
+                json_string(serial, "owner", pq->owner, 1);
+                json_string(serial, "name", pq->name, 1);
+                json_uint(serial, "len", pq->length, 1);
+                json_uint(serial, "depth", pq->depth, 1);
+                json_uint(serial, "peak", pq->peak, 1);
+                json_uint(serial, "drops", pq->drops, 0);
+                json_objEnd(serial, i < queue_count - 1);
+        }
+        json_arrayEnd(serial, 1);
+
+#if PERF_REGION_SUPPORT
+        put_perf_regions(serial);
+#endif
+        put_memory_stats(serial);
+
+        json_objStartString(serial, "drops");
+        for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+                json_uint(serial, perf_counter_name(i), perf_counter_value(i),
+                          i < PERF_COUNTER_COUNT - 1);
+        json_objEnd(serial, 0);
+
+        json_objEnd(serial, 0);
+        json_objEnd(serial, 0);
+
+        portFree(tasks);
+        if (reset) {
+                perf_reset();
+#if PERF_REGION_SUPPORT
+                perf_region_reset();
+#endif
+        }
+
+        return API_SUCCESS_NO_RETURN;
+}
+
 int api_calibrateImu(struct Serial *serial, const jsmntok_t *json)
 {
         imu_calibrate_zero();
@@ -1938,6 +2384,57 @@ int api_addTrackDb(struct Serial *serial, const jsmntok_t *json)
         return API_ERROR_MALFORMED;
 }
 
+/* Most samples accepted in one setRefLap message */
+#define REF_LAP_MAX_CHUNK	32
+
+int api_set_ref_lap(struct Serial *serial, const jsmntok_t *json)
+{
+        int track_id = 0;
+        int lap_time = 0;
+        int index = 0;
+        unsigned char mode = 0;
+
+        if (!jsmn_exists_set_val_int(json, "id", &track_id) ||
+            !jsmn_exists_set_val_int(json, "time", &lap_time) ||
+            !jsmn_exists_set_val_int(json, "index", &index) ||
+            !jsmn_exists_set_val_uint8(json, "mode", &mode, NULL) ||
+            index < 0)
+                return API_ERROR_MALFORMED;
+
+        const jsmntok_t *tok = jsmn_find_node(json, "pts");
+        if (tok == NULL || (++tok)->type != JSMN_ARRAY ||
+            tok->size > REF_LAP_MAX_CHUNK)
+                return API_ERROR_PARAMETER;
+
+        /* Each sample is [lat, lon, millis into the lap] */
+        GeoPoint points[REF_LAP_MAX_CHUNK];
+        tiny_millis_t times[REF_LAP_MAX_CHUNK];
+        const size_t count = tok->size;
+        for (size_t i = 0; i < count; ++i) {
+                if ((++tok)->type != JSMN_ARRAY || tok->size != 3)
+                        return API_ERROR_PARAMETER;
+
+                jsmn_trimData(++tok);
+                points[i].latitude = atof(tok->data);
+                jsmn_trimData(++tok);
+                points[i].longitude = atof(tok->data);
+                jsmn_trimData(++tok);
+                times[i] = atoi(tok->data);
+        }
+
+        const enum reference_lap_add_mode add_mode =
+                (enum reference_lap_add_mode) mode;
+        if (!reference_lap_add_samples(track_id, lap_time, index, points,
+                                       times, count, add_mode))
+                return API_ERROR_SEVERE;
+
+        /* Picks up the new reference if we are at that track */
+        if (add_mode == REFERENCE_LAP_ADD_MODE_COMPLETE)
+                lapstats_config_changed();
+
+        return API_SUCCESS;
+}
+
 int api_getTrackDb(struct Serial *serial, const jsmntok_t *json)
 {
         const Tracks * tracks = get_tracks();
@@ -2206,6 +2703,102 @@ int api_set_auto_logger_cfg(struct Serial *serial, const jsmntok_t *json)
         return auto_logger_set_config(cfg, json) ?
                API_SUCCESS : API_ERROR_UNSPECIFIED;
 }
+
+/* Directory entries returned per getLogList request */
+#define LOG_LIST_MAX		8
+/* Largest chunk a readLog request returns */
+#define LOG_READ_MAX_CHUNK	4096
+
+static int file_result_to_api(const int res)
+{
+        switch (res) {
+        case FR_NO_FILE:
+        case FR_NO_PATH:
+        case FR_INVALID_NAME:
+                return API_ERROR_PARAMETER;
+        default:
+                return API_ERROR_SEVERE;
+        }
+}
+
+int api_get_log_list(struct Serial *serial, const jsmntok_t *json)
+{
+        char dir[FILENAME_LEN] = "";
+        int start = 0;
+
+        jsmn_exists_set_val_string(json, "dir", dir, sizeof(dir), true);
+        jsmn_exists_set_val_int(json, "start", &start);
+        if (start < 0)
+                return API_ERROR_PARAMETER;
+
+        struct log_file_info files[LOG_LIST_MAX];
+        size_t count;
+        const int res = log_file_list(dir, start, files, LOG_LIST_MAX, &count);
+        if (res)
+                return file_result_to_api(res);
+
+        json_objStart(serial);
+        json_objStartString(serial, "logList");
+        json_string(serial, "dir", dir, 1);
+        json_int(serial, "start", start, 1);
+        json_bool(serial, "more", count == LOG_LIST_MAX, 1);
+        json_arrayStart(serial, "files");
+        for (size_t i = 0; i < count; i++) {
+                json_objStart(serial);
+                json_string(serial, "name", files[i].name, 1);
+                json_uint(serial, "size", files[i].size, 1);
+                json_bool(serial, "dir", files[i].dir, 0);
+                json_objEnd(serial, i < count - 1);
+        }
+        json_arrayEnd(serial, 0);
+        json_objEnd(serial, 0);
+        json_objEnd(serial, 0);
+
+        return API_SUCCESS_NO_RETURN;
+}
+
+int api_read_log(struct Serial *serial, const jsmntok_t *json)
+{
+        char name[FILENAME_LEN];
+        uint32_t offset;
+        int len = LOG_READ_MAX_CHUNK;
+
+        if (!jsmn_exists_set_val_string(json, "name", name, sizeof(name), true) ||
+            !jsmn_exists_set_val_uint32(json, "off", &offset))
+                return API_ERROR_MALFORMED;
+
+        jsmn_exists_set_val_int(json, "len", &len);
+        if (!name[0] || len <= 0)
+                return API_ERROR_PARAMETER;
+        len = MIN(len, LOG_READ_MAX_CHUNK);
+
+        char *buf = portMalloc(len);
+        if (!buf)
+                return API_ERROR_SEVERE;
+
+        size_t read;
+        uint32_t size;
+        const int res = log_file_read(name, offset, buf, len, &read, &size);
+        if (res) {
+                portFree(buf);
+                return file_result_to_api(res);
+        }
+
+        json_objStart(serial);
+        json_objStartString(serial, "readLog");
+        json_string(serial, "name", name, 1);
+        json_uint(serial, "off", offset, 1);
+        json_uint(serial, "len", read, 1);
+        json_uint(serial, "size", size, 1);
+        json_uint(serial, "crc", crc32_update(0, buf, read), 0);
+        json_objEnd(serial, 0);
+        json_objEnd(serial, 0);
+        put_crlf(serial);
+        serial_write_buff(serial, buf, read);
+
+        portFree(buf);
+        return API_SUCCESS_NO_RETURN;
+}
 #endif
 
 #if CAMERA_CONTROL
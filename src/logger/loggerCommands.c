@@ -30,6 +30,7 @@
 #include "luaScript.h"
 #include "mem_mang.h"
 #include "printk.h"
+#include "printk_deferred.h"
 #include "sampleRecord.h"
 #include "sdcard.h"
 #include "serial.h"
@@ -194,6 +195,9 @@ void SetLogLevel(struct Serial *serial, unsigned int argc, char **argv)
 
         enum log_level level = (enum log_level) atoi(argv[1]);
         set_log_level(level);
+        if (argc > 2)
+                printk_deferred_enable(atoi(argv[2]) != 0);
+
         put_commandOK(serial);
 }
 
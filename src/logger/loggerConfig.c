@@ -217,6 +217,8 @@ enum CANMappingType filter_can_mapping_type(enum CANMappingType mapping_type)
 static void _reset_can_mapping_config(CANChannelConfig *cfg)
 {
         memset(cfg, 0, sizeof(CANChannelConfig));
+        for (size_t i = 0; i < CONFIG_CAN_MAPPINGS; i++)
+                channel_filter_reset_config(&cfg->can_channels[i].filter);
         return;
 }
 
@@ -332,6 +334,12 @@ int getHigherSampleRate(const int a, const int b)
         return isHigherSampleRate(a, b) ? a : b;
 }
 
+/* SAMPLE_DISABLED is 0, so it drops out of the GCD by itself */
+int getCommonSampleRate(const int a, const int b)
+{
+        return b ? getCommonSampleRate(b, a % b) : a;
+}
+
 int getConnectivitySampleRateLimit()
 {
         ConnectivityConfig *connConfig = &getWorkingLoggerConfig()->ConnectivityConfigs;
@@ -468,10 +476,12 @@ static void resetAdcConfig(ADCConfig cfg[])
                 *c = (ADCConfig) DEFAULT_ADC_CONFIG;
                 sPrintStrInt(c->cfg.label, "Analog", i + 1);
                 strcpy(c->cfg.units, "Volts");
+                channel_filter_reset_config(&c->filter);
         }
 
         // Now update the battery config
         cfg[CONFIG_ADC_CHANNELS - 1] = (ADCConfig) BATTERY_ADC_CONFIG;
+        channel_filter_reset_config(&cfg[CONFIG_ADC_CHANNELS - 1].filter);
 }
 
 ADCConfig * getADCConfigChannel(int channel)
@@ -497,48 +507,56 @@ unsigned char filterAnalogScalingMode(unsigned char mode)
 }
 #endif
 
-unsigned int getHighestSampleRate(LoggerConfig *config)
+typedef int sample_rate_reduce_t(const int a, const int b);
+
+/*
+ * Folds the sample rates of all the channels the logger may sample with
+ * the given function.  Disabled channels have rate SAMPLE_DISABLED, which
+ * the function must treat as no contribution.
+ */
+static int reduce_sample_rates(LoggerConfig *config,
+                               sample_rate_reduce_t *reduce)
 {
         int s = SAMPLE_DISABLED;
         int sr;
 
         for (int i = 0; i < CONFIG_TIME_CHANNELS; i++) {
                 sr = config->TimeConfigs[i].cfg.sampleRate;
-                s = getHigherSampleRate(sr, s);
+                s = reduce(sr, s);
         }
 
 #if ANALOG_CHANNELS > 0
         for (int i = 0; i < CONFIG_ADC_CHANNELS; i++) {
                 sr = config->ADCConfigs[i].cfg.sampleRate;
-                s = getHigherSampleRate(sr, s);
+                s = reduce(sr, s);
         }
 #endif
 
 #if PWM_CHANNELS > 0
         for (int i = 0; i < CONFIG_PWM_CHANNELS; i++) {
                 sr = config->PWMConfigs[i].cfg.sampleRate;
-                s = getHigherSampleRate(sr, s);
+                s = reduce(sr, s);
         }
 #endif
 
 #if GPIO_CHANNELS > 1
         for (int i = 0; i < CONFIG_GPIO_CHANNELS; i++) {
                 sr = config->GPIOConfigs[i].cfg.sampleRate;
-                s = getHigherSampleRate(sr, s);
+                s = reduce(sr, s);
         }
 #endif
 
 #if TIMER_CHANNELS > 0
         for (int i = 0; i < CONFIG_TIMER_CHANNELS; i++) {
                 sr = config->TimerConfigs[i].cfg.sampleRate;
-                s = getHigherSampleRate(sr, s);
+                s = reduce(sr, s);
         }
 #endif
 
 #if IMU_CHANNELS > 0
         for (int i = 0; i < CONFIG_IMU_CHANNELS; i++) {
                 sr = config->ImuConfigs[i].cfg.sampleRate;
-                s = getHigherSampleRate(sr, s);
+                s = reduce(sr, s);
         }
 #endif
 
@@ -548,7 +566,7 @@ unsigned int getHighestSampleRate(LoggerConfig *config)
                 bool enabled = obd2_config->enabled;
                 for (size_t i = 0; i < enabled_channels && enabled; i++) {
                         sr = config->OBD2Configs.pids[i].mapping.channel_cfg.sampleRate;
-                        s = getHigherSampleRate(sr, s);
+                        s = reduce(sr, s);
                 }
         }
         {
@@ -557,69 +575,108 @@ unsigned int getHighestSampleRate(LoggerConfig *config)
                 bool enabled = ccc->enabled;
                 for (size_t i = 0; i < enabled_can_channels && enabled; i++) {
                         sr = config->can_channel_cfg.can_channels[i].mapping.channel_cfg.sampleRate;
-                        s = getHigherSampleRate(sr, s);
+                        s = reduce(sr, s);
+                }
+        }
+        {
+                struct math_channel_config *mcc = &(config->math_channel_cfg);
+                const size_t enabled_math_channels = MIN(mcc->enabled_channels, MATH_CHANNELS);
+                for (size_t i = 0; i < enabled_math_channels; i++) {
+                        sr = mcc->channels[i].cfg.sampleRate;
+                        s = reduce(sr, s);
                 }
         }
 
 #if GPS_HARDWARE_SUPPORT
         GPSConfig *gpsConfig = &(config->GPSConfigs);
         sr = gpsConfig->latitude.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = gpsConfig->longitude.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = gpsConfig->speed.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = gpsConfig->altitude.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = gpsConfig->satellites.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = gpsConfig->quality.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = gpsConfig->DOP.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
+
+        struct gps_fusion_config *fusion_cfg = &(config->fusion_cfg);
+        sr = fusion_cfg->latitude.sampleRate;
+        s = reduce(sr, s);
+
+        sr = fusion_cfg->longitude.sampleRate;
+        s = reduce(sr, s);
+
+        sr = fusion_cfg->speed.sampleRate;
+        s = reduce(sr, s);
+
+        sr = fusion_cfg->heading.sampleRate;
+        s = reduce(sr, s);
 #endif
         LapConfig *trackCfg = &(config->LapConfigs);
         sr = trackCfg->lapCountCfg.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = trackCfg->lapTimeCfg.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = trackCfg->sectorCfg.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = trackCfg->sectorTimeCfg.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = trackCfg->predTimeCfg.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = trackCfg->elapsed_time_cfg.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = trackCfg->current_lap_cfg.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = trackCfg->distance.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
 
         sr = trackCfg->session_time_cfg.sampleRate;
-        s = getHigherSampleRate(sr, s);
+        s = reduce(sr, s);
+
+        sr = trackCfg->sector_delta_cfg.sampleRate;
+        s = reduce(sr, s);
+
+        sr = trackCfg->optimal_time_cfg.sampleRate;
+        s = reduce(sr, s);
 
         /* Now check our Virtual Channels */
 #if VIRTUAL_CHANNEL_SUPPORT
-        sr = get_virtual_channel_high_sample_rate();
-        s = getHigherSampleRate(s, sr);
+        for (size_t i = 0; i < get_virtual_channel_count(); ++i) {
+                sr = get_virtual_channel(i)->config.sampleRate;
+                s = reduce(sr, s);
+        }
 #endif /* VIRTUAL_CHANNEL_SUPPORT */
         return s;
 }
 
+unsigned int getHighestSampleRate(LoggerConfig *config)
+{
+        return reduce_sample_rates(config, getHigherSampleRate);
+}
+
+unsigned int getSampleRateGcd(LoggerConfig *config)
+{
+        return reduce_sample_rates(config, getCommonSampleRate);
+}
+
 size_t get_enabled_channel_count(LoggerConfig *loggerConfig)
 {
         size_t channels = 0;
@@ -676,6 +733,14 @@ size_t get_enabled_channel_count(LoggerConfig *loggerConfig)
                                 ++channels;
                 }
         }
+        {
+                struct math_channel_config *mcc = &(loggerConfig->math_channel_cfg);
+                const size_t enabled_math_channels = MIN(mcc->enabled_channels, MATH_CHANNELS);
+                for (size_t i=0; i < enabled_math_channels; i++) {
+                        if (mcc->channels[i].cfg.sampleRate != SAMPLE_DISABLED)
+                                ++channels;
+                }
+        }
 
 #if GPS_HARDWARE_SUPPORT
         GPSConfig *gpsConfigs = &loggerConfig->GPSConfigs;
@@ -686,6 +751,12 @@ size_t get_enabled_channel_count(LoggerConfig *loggerConfig)
         if (gpsConfigs->satellites.sampleRate != SAMPLE_DISABLED) channels++;
         if (gpsConfigs->quality.sampleRate != SAMPLE_DISABLED) channels++;
         if (gpsConfigs->DOP.sampleRate != SAMPLE_DISABLED) channels++;
+
+        struct gps_fusion_config *fusion_cfg = &loggerConfig->fusion_cfg;
+        if (fusion_cfg->latitude.sampleRate != SAMPLE_DISABLED) channels++;
+        if (fusion_cfg->longitude.sampleRate != SAMPLE_DISABLED) channels++;
+        if (fusion_cfg->speed.sampleRate != SAMPLE_DISABLED) channels++;
+        if (fusion_cfg->heading.sampleRate != SAMPLE_DISABLED) channels++;
 #endif
 
         LapConfig *lapConfig = &loggerConfig->LapConfigs;
@@ -698,6 +769,8 @@ size_t get_enabled_channel_count(LoggerConfig *loggerConfig)
         if (lapConfig->current_lap_cfg.sampleRate != SAMPLE_DISABLED) channels++;
         if (lapConfig->distance.sampleRate != SAMPLE_DISABLED) channels++;
         if (lapConfig->session_time_cfg.sampleRate != SAMPLE_DISABLED) channels++;
+        if (lapConfig->sector_delta_cfg.sampleRate != SAMPLE_DISABLED) channels++;
+        if (lapConfig->optimal_time_cfg.sampleRate != SAMPLE_DISABLED) channels++;
 
 #if VIRTUAL_CHANNEL_SUPPORT
         channels += get_virtual_channel_count();
@@ -742,8 +815,12 @@ void reset_logger_config(void)
         resetCanConfig(&lc->CanConfig);
         _reset_can_mapping_config(&lc->can_channel_cfg);
         resetOBD2Config(&lc->OBD2Configs);
+        math_channel_reset_config(&lc->math_channel_cfg);
 
         logger_config_reset_gps_config(&lc->GPSConfigs);
+#if GPS_HARDWARE_SUPPORT
+        gps_fusion_reset_config(&lc->fusion_cfg);
+#endif
 
         resetLapConfig(&lc->LapConfigs);
         resetTrackConfig(&lc->TrackConfigs);
@@ -757,6 +834,7 @@ void reset_logger_config(void)
 #if CAMERA_CONTROL
         camera_control_reset_config(&lc->camera_control_cfg);
 #endif
+        device_cache_reset(&lc->device_cache);
         strcpy(lc->padding_data, "");
 }
 
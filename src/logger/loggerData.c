@@ -25,17 +25,47 @@
 #include "imu.h"
 #include "ADC.h"
 #include "gps.h"
+#include "gps_fusion.h"
 #include "linear_interpolate.h"
 #include "predictive_timer_2.h"
 #include "filter.h"
 #include "lap_stats.h"
+#include "can_channels.h"
+#include "timer.h"
+
 void init_logger_data()
 {
 }
 
+void init_background_sampling(LoggerConfig *config, const int filterRate)
+{
+        const unsigned int rate_hz = decodeSampleRate(filterRate);
+
+        ADC_init_filters(config, rate_hz);
+#if TIMER_CHANNELS > 0
+        timer_init_filters(config, rate_hz);
+#endif
+        CAN_init_filters(&config->can_channel_cfg, rate_hz);
+#if GPS_HARDWARE_SUPPORT
+        gps_fusion_init_sampling(&config->fusion_cfg);
+#endif
+}
+
 void doBackgroundSampling()
 {
         imu_sample_all();
+#if GPS_HARDWARE_SUPPORT
+        gps_fusion_sample();
+#endif
         ADC_sample_all();
         lapstats_update_distance();
 }
+
+void doFilterSampling()
+{
+        ADC_filter_all();
+#if TIMER_CHANNELS > 0
+        timer_sample_all();
+#endif
+        CAN_sample_all();
+}
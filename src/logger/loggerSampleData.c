@@ -20,6 +20,7 @@
  */
 
 #include "ADC.h"
+#include "analog_scaling.h"
 #include "FreeRTOS.h"
 #include "GPIO.h"
 #include "OBD2.h"
@@ -30,17 +31,19 @@
 #include "geopoint.h"
 #include "gps.h"
 #include "gps_device.h"
+#include "gps_fusion.h"
 #include "imu.h"
 #include "lap_stats.h"
-#include "linear_interpolate.h"
 #include "loggerConfig.h"
 #include "loggerData.h"
 #include "loggerHardware.h"
 #include "loggerSampleData.h"
 #include "macros.h"
+#include "math_channel.h"
 #include "predictive_timer_2.h"
 #include "printk.h"
 #include "sampleRecord.h"
+#include "sector_stats.h"
 #include "taskUtil.h"
 #include "timer.h"
 #include "units.h"
@@ -136,56 +139,23 @@ static ChannelSample* processChannelSampleWithLongLongGetterNoarg(ChannelSample
 
 float get_mapped_value(float value, ScalingMap *scalingMap)
 {
-        float *bins;
-        unsigned int bin, nextBin;
+        struct analog_scaling s;
 
-        bins = scalingMap->rawValues + ANALOG_SCALING_BINS - 1;
-        bin = nextBin = ANALOG_SCALING_BINS - 1;
-
-        while (value < *bins && bin > 0) {
-                bins--;
-                bin--;
-        }
-        if (bin == 0 && value < *bins) {
-                return scalingMap->scaledValues[0];
-        } else {
-                nextBin = bin;
-                if (bin < ANALOG_SCALING_BINS - 1) {
-                        nextBin++;
-                } else {
-                        return scalingMap->scaledValues[ANALOG_SCALING_BINS - 1];
-                }
-        }
-        float x1 = scalingMap->rawValues[bin];
-        float y1 = scalingMap->scaledValues[bin];
-        float x2 = scalingMap->rawValues[nextBin];
-        float y2 = scalingMap->scaledValues[nextBin];
-        float scaled = LinearInterpolate(value,x1,y1,x2,y2);
-        return scaled;
+        analog_scaling_compile_map(&s, scalingMap);
+        return analog_scaling_apply(&s, value);
 }
 
 #if ANALOG_CHANNELS > 0
+/*
+ * Compiled by init_channel_sample_buffer so the sample getter need
+ * not consult the config.
+ */
+static struct analog_scaling g_analog_scaling[CONFIG_ADC_CHANNELS];
+
 float get_analog_sample(int channelId)
 {
-        LoggerConfig * loggerConfig = getWorkingLoggerConfig();
-        ADCConfig *ac = &(loggerConfig->ADCConfigs[channelId]);
-        float value = ADC_read(channelId);
-        float analogValue = 0;
-        switch(ac->scalingMode) {
-        case SCALING_MODE_RAW:
-                analogValue = value;
-                break;
-        case SCALING_MODE_LINEAR:
-                analogValue = (ac->linearScaling * (float)value) + ac->linearOffset;
-                break;
-        case SCALING_MODE_MAP:
-                analogValue = get_mapped_value((float)value,&(ac->scalingMap));
-                break;
-        default:
-                analogValue = -1;
-                break;
-        }
-        return analogValue;
+        return analog_scaling_apply(g_analog_scaling + channelId,
+                                    ADC_read(channelId));
 }
 #endif
 
@@ -243,6 +213,12 @@ static void* get_speed_getter(const ChannelConfig *cc)
         return UNIT_SPEED_KILOMETERS_HOUR == units_get_unit(cc->units) ?
                getGPSSpeed : getGpsSpeedInMph;
 }
+
+static void* get_fused_speed_getter(const ChannelConfig *cc)
+{
+        return UNIT_SPEED_KILOMETERS_HOUR == units_get_unit(cc->units) ?
+               gps_fusion_get_speed_kph : gps_fusion_get_speed_mph;
+}
 #endif
 
 static void* get_distance_getter(const ChannelConfig *cc)
@@ -281,6 +257,7 @@ void init_channel_sample_buffer(LoggerConfig *loggerConfig, struct sample *buff)
 #if ANALOG_CHANNELS > 0
         for (int i=0; i < CONFIG_ADC_CHANNELS; i++) {
                 ADCConfig *config = &(loggerConfig->ADCConfigs[i]);
+                analog_scaling_compile(g_analog_scaling + i, config);
                 chanCfg = &(config->cfg);
                 sample = processChannelSampleWithFloatGetter(sample, chanCfg, i, get_analog_sample);
         }
@@ -361,6 +338,20 @@ void init_channel_sample_buffer(LoggerConfig *loggerConfig, struct sample *buff)
         sample = processChannelSampleWithIntGetterNoarg(sample, chanCfg, GPS_getQuality);
         chanCfg = &(gpsConfig->DOP);
         sample = processChannelSampleWithFloatGetterNoarg(sample, chanCfg, GPS_getDOP);
+
+        struct gps_fusion_config *fusion_cfg = &(loggerConfig->fusion_cfg);
+        chanCfg = &(fusion_cfg->latitude);
+        sample = processChannelSampleWithFloatGetterNoarg(sample, chanCfg,
+                        gps_fusion_get_latitude);
+        chanCfg = &(fusion_cfg->longitude);
+        sample = processChannelSampleWithFloatGetterNoarg(sample, chanCfg,
+                        gps_fusion_get_longitude);
+        chanCfg = &(fusion_cfg->speed);
+        sample = processChannelSampleWithFloatGetterNoarg(sample, chanCfg,
+                        get_fused_speed_getter(chanCfg));
+        chanCfg = &(fusion_cfg->heading);
+        sample = processChannelSampleWithFloatGetterNoarg(sample, chanCfg,
+                        gps_fusion_get_heading_deg);
 #endif
 
         LapConfig *trackConfig = &(loggerConfig->LapConfigs);
@@ -386,6 +377,23 @@ void init_channel_sample_buffer(LoggerConfig *loggerConfig, struct sample *buff)
                         get_distance_getter(chanCfg));
         chanCfg = &(trackConfig->session_time_cfg);
         sample = processChannelSampleWithFloatGetterNoarg(sample, chanCfg, lapstats_session_time_minutes);
+        chanCfg = &(trackConfig->sector_delta_cfg);
+        sample = processChannelSampleWithFloatGetterNoarg(sample, chanCfg,
+                        sector_stats_last_delta_seconds);
+        chanCfg = &(trackConfig->optimal_time_cfg);
+        sample = processChannelSampleWithFloatGetterNoarg(sample, chanCfg,
+                        sector_stats_optimal_lap_minutes);
+
+        /*
+         * Math channels go last.  Their expressions are compiled against
+         * this buffer by math_channel_compile_all once it is set up.
+         */
+        struct math_channel_config *mcc = &(loggerConfig->math_channel_cfg);
+        for (size_t i = 0; i < MIN(mcc->enabled_channels, MATH_CHANNELS); i++) {
+                chanCfg = &(mcc->channels[i].cfg);
+                sample = processChannelSampleWithFloatGetter(sample, chanCfg, i,
+                                math_channel_get_value);
+        }
 }
 
 static void populate_channel_sample(ChannelSample *sample)
@@ -430,6 +438,8 @@ int populate_sample_buffer(struct sample *s, size_t logTick)
         ChannelSample *samples = s->channel_samples;
         const size_t count = s->channel_count;
         s->ticks = logTick;
+        s->lap = lapstats_current_lap();
+        s->sector = getSector();
 
         for (size_t i = 0; i < count; i++, samples++) {
                 const unsigned short sampleRate = samples->cfg->sampleRate;
@@ -21,6 +21,7 @@
 
 #include "FreeRTOS.h"
 #include "led.h"
+#include "boot_stats.h"
 #include "capabilities.h"
 #include "connectivityTask.h"
 #include "fileWriter.h"
@@ -34,14 +35,17 @@
 #include "loggerSampleData.h"
 #include "loggerTaskEx.h"
 #include "macros.h"
+#include "math_channel.h"
 #include <string.h>
 #include "panic.h"
+#include "perf.h"
+#include "perf_region.h"
 #include "printk.h"
 #include "sampleRecord.h"
-#include "semphr.h"
 #include "serial.h"
 #include "task.h"
 #include "taskUtil.h"
+#include "trace.h"
 #include "watchdog.h"
 #include "camera_control.h"
 
@@ -55,8 +59,6 @@ int g_configChanged;
 int g_telemetryBackgroundStreaming;
 struct sample * current_sample = NULL;
 
-xSemaphoreHandle onTick;
-
 /* This should be 0'd out accroding to C standards */
 static struct sample g_sample_buffer[LOGGER_MESSAGE_BUFFER_SIZE] = {0};
 
@@ -76,13 +78,44 @@ static LoggerMessage getLogStopMessage()
 }
 
 /**
- * Called into by FreeRTOS during the ISR that handles the tick timer.
+ * Blocks until the next logger tick, one timer period after the last.
+ * A tick that is already due fires straight away, but after a stall of
+ * more than a period the missed ones are dropped rather than run back to
+ * back, as a burst of samples would only overflow the queues downstream.
  */
-void vApplicationTickHook(void)
+static void wait_for_logger_tick(portTickType *last_wake,
+                                 const portTickType period)
 {
-        if (onTick)
-                xSemaphoreGiveFromISR(onTick, pdFALSE);
+        const portTickType late = xTaskGetTickCount() - *last_wake;
+        if (late >= 2 * period) {
+                const portTickType missed = late / period - 1;
+                for (portTickType i = 0; i < missed; ++i)
+                        perf_count(PERF_COUNTER_LOGGER_TICK_MISS);
+
+                *last_wake += missed * period;
+        }
+
+        vTaskDelayUntil(last_wake, period);
+}
+
+#if configUSE_TICKLESS_IDLE
+extern void vPortSuppressTicksAndSleep(portTickType xExpectedIdleTime);
+
+/**
+ * Called by the idle task, through portSUPPRESS_TICKS_AND_SLEEP, when
+ * nothing is due for a few ticks.  Stopping the tick lets the CPU sleep
+ * between logger ticks, but every sleep costs the tick count a little
+ * drift and stops the cycle counter, so keep the tick running while
+ * logging, where sample times matter, and while tracing.
+ */
+void logger_suppress_ticks_and_sleep(const unsigned long idle_ticks)
+{
+        if (logging_is_active() || trace_is_running())
+                return;
+
+        vPortSuppressTicksAndSleep(idle_ticks);
 }
+#endif /* configUSE_TICKLESS_IDLE */
 
 void configChanged()
 {
@@ -117,6 +150,7 @@ void startLoggerTaskEx(int priority)
 {
         /* Make all task names 16 chars including NULL char */
         static const signed portCHAR task_name[] = "Logger Task    ";
+        perf_register_task(task_name, LOGGER_STACK_SIZE);
         const bool status = xTaskCreate(loggerTaskEx, task_name,
                                         LOGGER_STACK_SIZE, NULL,
                                         priority, NULL );
@@ -131,7 +165,14 @@ static int init_sample_ring_buffer(LoggerConfig *loggerConfig)
         const struct sample * const end = s + LOGGER_MESSAGE_BUFFER_SIZE;
         int i;
 
-        for (i = 0; s < end; ++s, ++i) {
+        /* Give back the old buffers so the pool can be re-carved */
+        for (; s < end; ++s)
+                free_sample_buffer(s);
+
+        if (!format_sample_pool(channel_count))
+                pr_warning("Sample pool in use, not re-carved\r\n");
+
+        for (s = g_sample_buffer, i = 0; s < end; ++s, ++i) {
                 const size_t bytes = init_sample_buffer(s, channel_count);
                 if (0 == bytes) {
                         /* If here, then can't alloc memory for buffers */
@@ -150,13 +191,27 @@ static int calcTelemetrySampleRate(LoggerConfig *config, int desiredSampleRate)
         return isHigherSampleRate(desiredSampleRate, maxRate) ? maxRate : desiredSampleRate;
 }
 
+/*
+ * The logger only has work on ticks where some channel or the background
+ * sampling is due.  Every sample interval is a multiple of their GCD, so
+ * waking at that period visits all of those ticks and skips the rest.
+ */
+static int calcTimerPeriod(LoggerConfig *config,
+                           const int timebaseSampleRate)
+{
+        return getCommonSampleRate(getSampleRateGcd(config),
+                                   timebaseSampleRate);
+}
+
 void updateSampleRates(LoggerConfig *loggerConfig, int *loggingSampleRate,
-                       int *telemetrySampleRate, int *timebaseSampleRate)
+                       int *telemetrySampleRate, int *timebaseSampleRate,
+                       int *timerPeriod)
 {
         *loggingSampleRate = getHighestSampleRate(loggerConfig);
         *timebaseSampleRate = *loggingSampleRate;
         *timebaseSampleRate = getHigherSampleRate(BACKGROUND_SAMPLE_RATE, *timebaseSampleRate);
         *telemetrySampleRate = calcTelemetrySampleRate(loggerConfig, *loggingSampleRate);
+        *timerPeriod = calcTimerPeriod(loggerConfig, *timebaseSampleRate);
 
         pr_info("timebase/logging/telemetry sample rate: ");
         pr_info_int(decodeSampleRate(*timebaseSampleRate));
@@ -165,6 +220,7 @@ void updateSampleRates(LoggerConfig *loggerConfig, int *loggingSampleRate,
         pr_info("/");
         pr_info_int(decodeSampleRate(*telemetrySampleRate));
         pr_info("\r\n");
+        pr_info_int_msg("logger timer period (ticks): ", *timerPeriod);
 }
 
 void loggerTaskEx(void *params)
@@ -176,9 +232,10 @@ void loggerTaskEx(void *params)
         int loggingSampleRate = SAMPLE_DISABLED;
         int sampleRateTimebase = SAMPLE_DISABLED;
         int telemetrySampleRate = SAMPLE_DISABLED;
+        int timerPeriod = SAMPLE_1000Hz;
+        portTickType lastWake = xTaskGetTickCount();
 
         g_loggingShouldRun = 0;
-        vSemaphoreCreateBinary(onTick);
         logging_set_status(LOGGING_STATUS_IDLE);
         logging_set_logging_start(0);
         g_configChanged = 1;
@@ -192,8 +249,11 @@ void loggerTaskEx(void *params)
 #endif
 
         while (1) {
-                xSemaphoreTake(onTick, portMAX_DELAY);
-                ++currentTicks;
+                /* Every path through the loop ends up back here */
+                TRACE_END(TRACE_EVENT_LOGGER_TICK, currentTicks);
+                wait_for_logger_tick(&lastWake, timerPeriod);
+                currentTicks += timerPeriod;
+                TRACE_BEGIN(TRACE_EVENT_LOGGER_TICK, currentTicks);
 
                 if (g_configChanged) {
                         buffer_size = init_sample_ring_buffer(loggerConfig);
@@ -210,13 +270,19 @@ void loggerTaskEx(void *params)
                         }
 
                         led_disable(LED_ERROR);
+                        math_channel_compile_all(&loggerConfig->math_channel_cfg,
+                                                 g_sample_buffer);
 
                         updateSampleRates(loggerConfig, &loggingSampleRate,
                                           &telemetrySampleRate,
-                                          &sampleRateTimebase);
+                                          &sampleRateTimebase,
+                                          &timerPeriod);
+                        init_background_sampling(loggerConfig,
+                                                 sampleRateTimebase);
                         resetLapCount();
                         lapstats_reset_distance();
                         currentTicks = 0;
+                        lastWake = xTaskGetTickCount();
                         g_configChanged = 0;
                 }
 
@@ -233,6 +299,14 @@ void loggerTaskEx(void *params)
                     (currentTicks % BACKGROUND_SAMPLE_RATE == 0))
                         doBackgroundSampling();
 
+                /*
+                 * The channel filters step at the timebase rate whether
+                 * logging or not, so their time constants don't change
+                 * with the rate the inputs above are refreshed at.
+                 */
+                if (currentTicks % sampleRateTimebase == 0)
+                        doFilterSampling();
+
                 if (g_loggingShouldRun && !is_logging) {
                         logging_started();
                         const LoggerMessage logStartMsg = getLogStartMessage();
@@ -256,11 +330,15 @@ void loggerTaskEx(void *params)
                 struct sample *sample = g_sample_buffer + bufferIndex;
 
                 /* Check if we need to actually populate the buffer. */
+                PERF_REGION_BEGIN("populate_sample_buffer");
                 const int sampledRate = populate_sample_buffer(sample,
                                         currentTicks);
+                PERF_REGION_END("populate_sample_buffer");
                 if (sampledRate == SAMPLE_DISABLED)
                         continue;
 
+                boot_stats_end(BOOT_PHASE_FIRST_SAMPLE);
+
                 /* If here, create the LoggerMessage to send with the sample */
                 const LoggerMessage msg = create_logger_message(
                                                   LoggerMessageType_Sample, currentTicks, sample);
@@ -275,6 +353,12 @@ void loggerTaskEx(void *params)
                         const portBASE_TYPE res = queue_logfile_record(&msg);
                         if (pdTRUE != res) {
                                 logging_set_status(LOGGING_STATUS_OVERFLOW);
+                                perf_count(PERF_COUNTER_LOG_OVERFLOW);
+                                TRACE_MARK(TRACE_EVENT_SAMPLE_DROPPED,
+                                           currentTicks);
+                        } else {
+                                TRACE_MARK(TRACE_EVENT_SAMPLE_QUEUED,
+                                           currentTicks);
                         }
                 }
 #endif
@@ -0,0 +1,124 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "loggerConfig.h"
+#include "macros.h"
+#include "math_channel.h"
+#include "math_expr.h"
+#include "printk.h"
+#include "sampleRecord.h"
+#include <string.h>
+
+#define LOG_PFX "[math_channel] "
+
+static struct math_expr programs[MATH_CHANNELS];
+
+/* Kept off the stack; API handlers run on small task stacks */
+static struct math_expr validate_scratch;
+
+struct resolve_context {
+        const struct sample *sample;
+        size_t id;
+};
+
+void math_channel_reset_config(struct math_channel_config *cfg)
+{
+        memset(cfg, 0, sizeof(struct math_channel_config));
+}
+
+static bool is_math_channel(const ChannelSample *cs)
+{
+        return SampleData_Float == cs->sampleData &&
+                math_channel_get_value == cs->get_float_sample;
+}
+
+static bool resolve_sample_channel(const char *name, const size_t len,
+                                   ChannelSample *input, void *ctx)
+{
+        const struct resolve_context *rc = ctx;
+        const struct sample *s = rc->sample;
+
+        for (size_t i = 0; i < s->channel_count; ++i) {
+                const ChannelSample *cs = s->channel_samples + i;
+                const char *label = cs->cfg->label;
+
+                if (strlen(label) != len || strncmp(label, name, len))
+                        continue;
+
+                /* Only earlier math channels may be referenced */
+                if (is_math_channel(cs) && cs->channelIndex >= rc->id)
+                        return false;
+
+                input->sampleData = cs->sampleData;
+                input->channelIndex = cs->channelIndex;
+                /* All getters share the union, so this copies any type */
+                input->get_double_sample = cs->get_double_sample;
+                return true;
+        }
+
+        return false;
+}
+
+static bool resolve_any_channel(const char *name, const size_t len,
+                                ChannelSample *input, void *ctx)
+{
+        return true;
+}
+
+bool math_channel_validate_expr(const char *expr)
+{
+        return MATH_EXPR_OK == math_expr_compile(&validate_scratch, expr,
+                        resolve_any_channel, NULL);
+}
+
+void math_channel_compile_all(const struct math_channel_config *cfg,
+                              const struct sample *s)
+{
+        const size_t count = MIN(cfg->enabled_channels, MATH_CHANNELS);
+
+        for (size_t i = 0; i < count; ++i) {
+                const struct math_channel *mc = cfg->channels + i;
+                struct resolve_context rc = {
+                        .sample = s,
+                        .id = i,
+                };
+
+                if (SAMPLE_DISABLED == mc->cfg.sampleRate)
+                        continue;
+
+                const enum math_expr_status status =
+                        math_expr_compile(programs + i, mc->expr,
+                                          resolve_sample_channel, &rc);
+                if (MATH_EXPR_OK != status) {
+                        pr_warning_str_msg(LOG_PFX "Failed to compile: ",
+                                           mc->cfg.label);
+                        pr_warning_int_msg(LOG_PFX "Status: ", status);
+                }
+        }
+}
+
+float math_channel_get_value(int id)
+{
+        if ((size_t) id >= MATH_CHANNELS)
+                return 0;
+
+        return math_expr_eval(programs + id);
+}
@@ -0,0 +1,524 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "macros.h"
+#include "math_expr.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum math_expr_op {
+        OP_CONST,
+        OP_INPUT,
+        OP_ADD,
+        OP_SUB,
+        OP_MUL,
+        OP_DIV,
+        OP_MOD,
+        OP_NEG,
+        OP_NOT,
+        OP_LT,
+        OP_LE,
+        OP_GT,
+        OP_GE,
+        OP_EQ,
+        OP_NE,
+        OP_AND,
+        OP_OR,
+        OP_MIN,
+        OP_MAX,
+        OP_ABS,
+        OP_SQRT,
+        OP_SELECT,
+};
+
+struct math_expr_function {
+        const char *name;
+        uint8_t args;
+        enum math_expr_op op;
+};
+
+static const struct math_expr_function functions[] = {
+        {"min", 2, OP_MIN},
+        {"max", 2, OP_MAX},
+        {"abs", 1, OP_ABS},
+        {"sqrt", 1, OP_SQRT},
+        {"if", 3, OP_SELECT},
+};
+
+struct parser {
+        const char *pos;
+        struct math_expr *prog;
+        math_expr_resolve_t *resolve;
+        void *ctx;
+        size_t depth;
+        /* Recursion depth of the parser itself */
+        size_t nesting;
+        enum math_expr_status status;
+};
+
+static bool fail(struct parser *ps, const enum math_expr_status status)
+{
+        /* Only the first failure is of interest */
+        if (MATH_EXPR_OK == ps->status)
+                ps->status = status;
+
+        return false;
+}
+
+static void skip_whitespace(struct parser *ps)
+{
+        while (isspace((unsigned char) *ps->pos))
+                ++ps->pos;
+}
+
+static bool accept(struct parser *ps, const char *token)
+{
+        skip_whitespace(ps);
+
+        const size_t len = strlen(token);
+        if (strncmp(ps->pos, token, len))
+                return false;
+
+        ps->pos += len;
+        return true;
+}
+
+static bool expect(struct parser *ps, const char *token)
+{
+        return accept(ps, token) || fail(ps, MATH_EXPR_SYNTAX_ERROR);
+}
+
+static bool emit(struct parser *ps, const uint8_t byte)
+{
+        struct math_expr *prog = ps->prog;
+
+        if (prog->code_len >= MATH_EXPR_MAX_CODE)
+                return fail(ps, MATH_EXPR_TOO_COMPLEX);
+
+        prog->code[prog->code_len++] = byte;
+        return true;
+}
+
+/*
+ * Tracks the depth of the evaluation stack at compile time so that
+ * math_expr_eval never has to check for overflow.
+ */
+static bool push(struct parser *ps)
+{
+        if (++ps->depth > MATH_EXPR_STACK_SIZE)
+                return fail(ps, MATH_EXPR_TOO_COMPLEX);
+
+        return true;
+}
+
+static bool emit_op(struct parser *ps, const enum math_expr_op op,
+                    const size_t args)
+{
+        /* An operation consumes its arguments and pushes its result */
+        ps->depth -= args - 1;
+        return emit(ps, op);
+}
+
+static bool emit_const(struct parser *ps, const float value)
+{
+        struct math_expr *prog = ps->prog;
+        size_t i;
+
+        for (i = 0; i < prog->const_count; ++i)
+                if (prog->consts[i] == value)
+                        break;
+
+        if (i == prog->const_count) {
+                if (prog->const_count >= MATH_EXPR_MAX_CONSTS)
+                        return fail(ps, MATH_EXPR_TOO_COMPLEX);
+
+                prog->consts[prog->const_count++] = value;
+        }
+
+        return emit(ps, OP_CONST) && emit(ps, i) && push(ps);
+}
+
+static bool emit_input(struct parser *ps, const char *name, const size_t len)
+{
+        struct math_expr *prog = ps->prog;
+        ChannelSample input;
+
+        memset(&input, 0, sizeof(input));
+        if (!ps->resolve(name, len, &input, ps->ctx))
+                return fail(ps, MATH_EXPR_UNKNOWN_CHANNEL);
+
+        size_t i;
+        for (i = 0; i < prog->input_count; ++i)
+                if (!memcmp(prog->inputs + i, &input, sizeof(input)))
+                        break;
+
+        if (i == prog->input_count) {
+                if (prog->input_count >= MATH_EXPR_MAX_INPUTS)
+                        return fail(ps, MATH_EXPR_TOO_COMPLEX);
+
+                prog->inputs[prog->input_count++] = input;
+        }
+
+        return emit(ps, OP_INPUT) && emit(ps, i) && push(ps);
+}
+
+static bool parse_expression(struct parser *ps);
+
+static bool parse_call(struct parser *ps, const char *name, const size_t len)
+{
+        const struct math_expr_function *fn = NULL;
+
+        for (size_t i = 0; i < ARRAY_LEN(functions); ++i) {
+                if (strlen(functions[i].name) == len &&
+                    !strncmp(functions[i].name, name, len)) {
+                        fn = functions + i;
+                        break;
+                }
+        }
+
+        if (!fn)
+                return fail(ps, MATH_EXPR_UNKNOWN_FUNCTION);
+
+        for (size_t i = 0; i < fn->args; ++i) {
+                if (i && !expect(ps, ","))
+                        return false;
+
+                if (!parse_expression(ps))
+                        return false;
+        }
+
+        return expect(ps, ")") && emit_op(ps, fn->op, fn->args);
+}
+
+static bool parse_primary(struct parser *ps)
+{
+        if (accept(ps, "("))
+                return parse_expression(ps) && expect(ps, ")");
+
+        const char *start = ps->pos;
+
+        if (isdigit((unsigned char) *start) || '.' == *start) {
+                char *end;
+                const float value = strtod(start, &end);
+                if (end == start)
+                        return fail(ps, MATH_EXPR_SYNTAX_ERROR);
+
+                ps->pos = end;
+                return emit_const(ps, value);
+        }
+
+        if (isalpha((unsigned char) *start) || '_' == *start) {
+                while (isalnum((unsigned char) *ps->pos) || '_' == *ps->pos)
+                        ++ps->pos;
+
+                const size_t len = ps->pos - start;
+                if (accept(ps, "("))
+                        return parse_call(ps, start, len);
+
+                return emit_input(ps, start, len);
+        }
+
+        return fail(ps, MATH_EXPR_SYNTAX_ERROR);
+}
+
+static bool parse_unary(struct parser *ps)
+{
+        /*
+         * Every parenthesis, call argument and unary operator recurses
+         * through here.  Bound it so input can't exhaust the task stack.
+         */
+        if (MATH_EXPR_MAX_NESTING < ++ps->nesting)
+                return fail(ps, MATH_EXPR_TOO_COMPLEX);
+
+        bool ok;
+        if (accept(ps, "-"))
+                ok = parse_unary(ps) && emit_op(ps, OP_NEG, 1);
+        else if (accept(ps, "!"))
+                ok = parse_unary(ps) && emit_op(ps, OP_NOT, 1);
+        else
+                ok = parse_primary(ps);
+
+        --ps->nesting;
+        return ok;
+}
+
+static bool parse_term(struct parser *ps)
+{
+        if (!parse_unary(ps))
+                return false;
+
+        for (;;) {
+                enum math_expr_op op;
+
+                if (accept(ps, "*"))
+                        op = OP_MUL;
+                else if (accept(ps, "/"))
+                        op = OP_DIV;
+                else if (accept(ps, "%"))
+                        op = OP_MOD;
+                else
+                        return true;
+
+                if (!parse_unary(ps) || !emit_op(ps, op, 2))
+                        return false;
+        }
+}
+
+static bool parse_sum(struct parser *ps)
+{
+        if (!parse_term(ps))
+                return false;
+
+        for (;;) {
+                enum math_expr_op op;
+
+                if (accept(ps, "+"))
+                        op = OP_ADD;
+                else if (accept(ps, "-"))
+                        op = OP_SUB;
+                else
+                        return true;
+
+                if (!parse_term(ps) || !emit_op(ps, op, 2))
+                        return false;
+        }
+}
+
+static bool parse_comparison(struct parser *ps)
+{
+        if (!parse_sum(ps))
+                return false;
+
+        for (;;) {
+                enum math_expr_op op;
+
+                /* Two character operators must be tried first */
+                if (accept(ps, "<="))
+                        op = OP_LE;
+                else if (accept(ps, ">="))
+                        op = OP_GE;
+                else if (accept(ps, "=="))
+                        op = OP_EQ;
+                else if (accept(ps, "!="))
+                        op = OP_NE;
+                else if (accept(ps, "<"))
+                        op = OP_LT;
+                else if (accept(ps, ">"))
+                        op = OP_GT;
+                else
+                        return true;
+
+                if (!parse_sum(ps) || !emit_op(ps, op, 2))
+                        return false;
+        }
+}
+
+static bool parse_and(struct parser *ps)
+{
+        if (!parse_comparison(ps))
+                return false;
+
+        while (accept(ps, "&&"))
+                if (!parse_comparison(ps) || !emit_op(ps, OP_AND, 2))
+                        return false;
+
+        return true;
+}
+
+static bool parse_or(struct parser *ps)
+{
+        if (!parse_and(ps))
+                return false;
+
+        while (accept(ps, "||"))
+                if (!parse_and(ps) || !emit_op(ps, OP_OR, 2))
+                        return false;
+
+        return true;
+}
+
+/*
+ * Conditionals are compiled into a single select operation rather than
+ * jumps.  Expressions have no side effects so evaluating both branches
+ * is harmless and keeps the interpreter loop trivial.
+ */
+static bool parse_expression(struct parser *ps)
+{
+        if (!parse_or(ps))
+                return false;
+
+        if (!accept(ps, "?"))
+                return true;
+
+        return parse_expression(ps) && expect(ps, ":") &&
+                parse_expression(ps) && emit_op(ps, OP_SELECT, 3);
+}
+
+enum math_expr_status math_expr_compile(struct math_expr *prog,
+                                        const char *expr,
+                                        math_expr_resolve_t *resolve,
+                                        void *ctx)
+{
+        struct parser ps = {
+                .pos = expr,
+                .prog = prog,
+                .resolve = resolve,
+                .ctx = ctx,
+                .depth = 0,
+                .nesting = 0,
+                .status = MATH_EXPR_OK,
+        };
+
+        memset(prog, 0, sizeof(struct math_expr));
+
+        if (parse_expression(&ps)) {
+                skip_whitespace(&ps);
+                if (*ps.pos)
+                        fail(&ps, MATH_EXPR_SYNTAX_ERROR);
+        }
+
+        /* A failed program evaluates to 0 */
+        if (MATH_EXPR_OK != ps.status)
+                prog->code_len = 0;
+
+        return ps.status;
+}
+
+static float read_input(const ChannelSample *cs)
+{
+        const int idx = cs->channelIndex;
+
+        switch(cs->sampleData) {
+        case SampleData_Int_Noarg:
+                return cs->get_int_sample_noarg();
+        case SampleData_Int:
+                return cs->get_int_sample(idx);
+        case SampleData_LongLong_Noarg:
+                return cs->get_longlong_sample_noarg();
+        case SampleData_LongLong:
+                return cs->get_longlong_sample(idx);
+        case SampleData_Float_Noarg:
+                return cs->get_float_sample_noarg();
+        case SampleData_Float:
+                return cs->get_float_sample(idx);
+        case SampleData_Double_Noarg:
+                return cs->get_double_sample_noarg();
+        case SampleData_Double:
+                return cs->get_double_sample(idx);
+        default:
+                return 0;
+        }
+}
+
+float math_expr_eval(const struct math_expr *prog)
+{
+        float stack[MATH_EXPR_STACK_SIZE];
+        float *sp = stack;
+        const uint8_t *pc = prog->code;
+        const uint8_t *end = pc + prog->code_len;
+
+        while (pc < end) {
+                float a, b;
+
+                switch(*pc++) {
+                case OP_CONST:
+                        *sp++ = prog->consts[*pc++];
+                        continue;
+                case OP_INPUT:
+                        *sp++ = read_input(prog->inputs + *pc++);
+                        continue;
+                case OP_NEG:
+                        sp[-1] = -sp[-1];
+                        continue;
+                case OP_NOT:
+                        sp[-1] = sp[-1] == 0;
+                        continue;
+                case OP_ABS:
+                        sp[-1] = fabsf(sp[-1]);
+                        continue;
+                case OP_SQRT:
+                        sp[-1] = sp[-1] > 0 ? sqrtf(sp[-1]) : 0;
+                        continue;
+                case OP_SELECT:
+                        sp -= 2;
+                        sp[-1] = sp[-1] != 0 ? sp[0] : sp[1];
+                        continue;
+                }
+
+                /* Everything else is a binary operation */
+                b = *--sp;
+                a = sp[-1];
+
+                switch(pc[-1]) {
+                case OP_ADD:
+                        a = a + b;
+                        break;
+                case OP_SUB:
+                        a = a - b;
+                        break;
+                case OP_MUL:
+                        a = a * b;
+                        break;
+                case OP_DIV:
+                        a = b != 0 ? a / b : 0;
+                        break;
+                case OP_MOD:
+                        a = b != 0 ? fmodf(a, b) : 0;
+                        break;
+                case OP_LT:
+                        a = a < b;
+                        break;
+                case OP_LE:
+                        a = a <= b;
+                        break;
+                case OP_GT:
+                        a = a > b;
+                        break;
+                case OP_GE:
+                        a = a >= b;
+                        break;
+                case OP_EQ:
+                        a = a == b;
+                        break;
+                case OP_NE:
+                        a = a != b;
+                        break;
+                case OP_AND:
+                        a = a != 0 && b != 0;
+                        break;
+                case OP_OR:
+                        a = a != 0 || b != 0;
+                        break;
+                case OP_MIN:
+                        a = MIN(a, b);
+                        break;
+                case OP_MAX:
+                        a = MAX(a, b);
+                        break;
+                }
+
+                sp[-1] = a;
+        }
+
+        return sp > stack ? sp[-1] : 0;
+}
@@ -21,6 +21,7 @@
 
 
 #include "FreeRTOS.h"
+#include "block_pool.h"
 #include "capabilities.h"
 #include "loggerConfig.h"
 #include "loggerSampleData.h"
@@ -32,18 +33,29 @@
 #include "printk.h"
 
 #define LOG_PFX "[sampleRecord] "
+
+BLOCK_POOL_DEFINE_ARENA(sample_pool, "samples", SAMPLE_POOL_SIZE);
+
+bool format_sample_pool(const size_t count)
+{
+        return block_pool_format(&sample_pool, sizeof(ChannelSample[count]));
+}
+
 size_t init_sample_buffer(struct sample *s, const size_t count)
 {
         if (s->channel_samples)
                 free_sample_buffer(s);
 
         const size_t size = sizeof(ChannelSample[count]);
-        s->channel_samples = (ChannelSample *) portMalloc(size);
+        s->channel_samples = (ChannelSample *)
+                block_pool_alloc_fallback(&sample_pool, size);
 
         if (NULL == s->channel_samples)
                 return 0;
 
         s->ticks = 0;
+        s->lap = 0;
+        s->sector = 0;
         s->channel_count = count;
         init_channel_sample_buffer(getWorkingLoggerConfig(), s);
 
@@ -52,7 +64,7 @@ size_t init_sample_buffer(struct sample *s, const size_t count)
 
 void free_sample_buffer(struct sample *s)
 {
-        portFree(s->channel_samples);
+        block_pool_free_fallback(&sample_pool, s->channel_samples);
         s->channel_samples = NULL;
 }
 
@@ -19,13 +19,16 @@
  * this code. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "FreeRTOS.h"
 #include "capabilities.h"
 #include "macros.h"
 #include <string.h>
 #include "modp_numtoa.h"
 #include "printk.h"
-#include "ts_ring_buff.h"
+#include "printk_deferred.h"
+#include "semphr.h"
 #include "serial.h"
+#include "ts_ring_buff.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -34,13 +37,128 @@
 
 static enum log_level curr_level = INFO;
 static struct ts_ring_buff *log_buff;
+static xSemaphoreHandle log_lock;
+
+static bool init_log(void)
+{
+        if (!log_buff)
+                log_buff = ts_ring_buff_create(LOG_BUFFER_SIZE);
+
+        if (!log_lock)
+                log_lock = xSemaphoreCreateMutex();
+
+        return log_buff && log_lock;
+}
+
+static int log_put_text(const char *msg)
+{
+        if (NULL == msg)
+                return 0;
+
+        return ts_ring_buff_put(log_buff, msg, strlen(msg));
+}
+
+static int log_put_char(char c)
+{
+        return ts_ring_buff_put(log_buff, &c, 1);
+}
+
+static int log_put_int(int value)
+{
+        char buf[12];
+        modp_itoa10(value, buf);
+        return log_put_text(buf);
+}
+
+static int log_put_float(float value)
+{
+        char buf[20];
+        modp_ftoa(value, buf, 6);
+        return log_put_text(buf);
+}
+
+static int log_put_record(const struct printk_record *rec)
+{
+        int len = log_put_text(rec->msg);
+
+        switch (rec->type) {
+        case PRINTK_RECORD_CHAR:
+                len += log_put_char(rec->value.c);
+                break;
+        case PRINTK_RECORD_INT:
+                len += log_put_int(rec->value.i);
+                break;
+        case PRINTK_RECORD_INT_MSG:
+                len += log_put_int(rec->value.i);
+                len += log_put_text("\r\n");
+                break;
+        case PRINTK_RECORD_FLOAT:
+                len += log_put_float(rec->value.f);
+                break;
+        case PRINTK_RECORD_FLOAT_MSG:
+                len += log_put_float(rec->value.f);
+                len += log_put_text("\r\n");
+                break;
+        case PRINTK_RECORD_BOOL_MSG:
+                len += log_put_text(rec->value.b ? "true\r\n" : "false\r\n");
+                break;
+        case PRINTK_RECORD_CRLF:
+                len += log_put_text("\r\n");
+                break;
+        default:
+                break;
+        }
+
+        return len;
+}
+
+/* Call with log_lock held */
+static void flush_deferred(void)
+{
+        struct printk_record rec;
+
+        while (printk_deferred_get(&rec))
+                log_put_record(&rec);
+
+        const uint32_t dropped = printk_deferred_dropped();
+        if (dropped) {
+                log_put_text("[printk] dropped ");
+                log_put_int(dropped);
+                log_put_text(" records\r\n");
+        }
+}
+
+/**
+ * Takes the log for a write.  Deferred records are formatted into the
+ * log buffer first, so text written in place lands after every record
+ * logged before it and the log stays one ordered stream.
+ * @return true if the log is ready, false if it could not be created.
+ */
+static bool lock_log(void)
+{
+        if (!init_log())
+                return false;
+
+        xSemaphoreTake(log_lock, portMAX_DELAY);
+        flush_deferred();
+        return true;
+}
+
+static void unlock_log(void)
+{
+        xSemaphoreGive(log_lock);
+}
 
 size_t read_log_to_serial(struct Serial *s, int escape)
 {
         char buff[16];
         size_t read = 0;
 
-        while(true) {
+        if (!lock_log())
+                return 0;
+        unlock_log();
+
+        for (;;) {
                 size_t bytes = ts_ring_buff_get(log_buff, &buff,
                                                 ARRAY_LEN(buff) - 1);
                 if (0 == bytes)
@@ -58,94 +176,152 @@ size_t read_log_to_serial(struct Serial *s, int escape)
         return read;
 }
 
-int writek(const char *msg)
+/**
+ * Formats the record in place, behind anything already deferred.
+ */
+static int write_record(const struct printk_record *rec)
 {
-        if (!log_buff)
-                log_buff = ts_ring_buff_create(LOG_BUFFER_SIZE);
-
-        if (NULL == msg)
+        if (!lock_log())
                 return 0;
 
-        return ts_ring_buff_put(log_buff, msg, strlen(msg));
+        const int len = log_put_record(rec);
+        unlock_log();
+
+        return len;
+}
+
+int writek(const char *msg)
+{
+        const struct printk_record rec = {
+                .msg = msg,
+                .type = PRINTK_RECORD_MSG,
+        };
+        return write_record(&rec);
 }
 
 int writek_crlf()
 {
-        return writek("\r\n");
+        const struct printk_record rec = { .type = PRINTK_RECORD_CRLF };
+        return write_record(&rec);
 }
 
 int writek_char(char c)
 {
-        return ts_ring_buff_put(log_buff, &c, 1);
+        const struct printk_record rec = {
+                .type = PRINTK_RECORD_CHAR,
+                .value.c = c,
+        };
+        return write_record(&rec);
 }
 
 int writek_int(int value)
 {
-        char buf[12];
-        modp_itoa10(value, buf);
-        return writek(buf);
+        const struct printk_record rec = {
+                .type = PRINTK_RECORD_INT,
+                .value.i = value,
+        };
+        return write_record(&rec);
 }
 
 int writek_float(float value)
 {
-        char buf[20];
-        modp_ftoa(value, buf, 6);
-        return writek(buf);
+        const struct printk_record rec = {
+                .type = PRINTK_RECORD_FLOAT,
+                .value.f = value,
+        };
+        return write_record(&rec);
 }
 
-int printk(enum log_level level, const char *msg)
+/**
+ * Hands a record to the deferred log if it is on and the message is a
+ * literal, otherwise formats it in place.
+ */
+static int log_record(enum log_level level, enum printk_record_type type,
+                      const char *msg, struct printk_record *rec,
+                      const bool literal)
+{
+        rec->msg = msg;
+        rec->level = level;
+        rec->type = type;
+        if (literal && printk_deferred_put(rec))
+                return sizeof(*rec);
+
+        return write_record(rec);
+}
+
+int printk_ex(enum log_level level, const char *msg, const bool literal)
 {
         IF_LEVEL_GT_CURR_LEVEL_RET_ZERO(level);
-        return writek(msg);
+        struct printk_record rec;
+        return log_record(level, PRINTK_RECORD_MSG, msg, &rec, literal);
 }
 
 int printk_char(enum log_level level, const char c)
 {
         IF_LEVEL_GT_CURR_LEVEL_RET_ZERO(level);
-        return writek_char(c);
+        struct printk_record rec = { .value.c = c };
+        return log_record(level, PRINTK_RECORD_CHAR, NULL, &rec, true);
 }
 
 int printk_crlf(enum log_level level)
 {
         IF_LEVEL_GT_CURR_LEVEL_RET_ZERO(level);
-        return writek_crlf();
+        struct printk_record rec;
+        return log_record(level, PRINTK_RECORD_CRLF, NULL, &rec, true);
 }
 
 int printk_int(enum log_level level, int value)
 {
         IF_LEVEL_GT_CURR_LEVEL_RET_ZERO(level);
-        return writek_int(value);
+        struct printk_record rec = { .value.i = value };
+        return log_record(level, PRINTK_RECORD_INT, NULL, &rec, true);
 }
 
-int printk_int_msg(enum log_level level, const char *msg, int value)
+int printk_int_msg_ex(enum log_level level, const char *msg, int value,
+                      const bool literal)
 {
         IF_LEVEL_GT_CURR_LEVEL_RET_ZERO(level);
-        return writek(msg) + writek_int(value) + writek_crlf();
+        struct printk_record rec = { .value.i = value };
+        return log_record(level, PRINTK_RECORD_INT_MSG, msg, &rec, literal);
 }
 
 int printk_float(enum log_level level, float value)
 {
         IF_LEVEL_GT_CURR_LEVEL_RET_ZERO(level);
-        return writek_float(value);
+        struct printk_record rec = { .value.f = value };
+        return log_record(level, PRINTK_RECORD_FLOAT, NULL, &rec, true);
 }
 
-int printk_float_msg(enum log_level level, const char *msg, float value)
+int printk_float_msg_ex(enum log_level level, const char *msg, float value,
+                        const bool literal)
 {
         IF_LEVEL_GT_CURR_LEVEL_RET_ZERO(level);
-        return writek(msg) + writek_float(value) + writek_crlf();
+        struct printk_record rec = { .value.f = value };
+        return log_record(level, PRINTK_RECORD_FLOAT_MSG, msg, &rec,
+                          literal);
 }
 
 int printk_str_msg(enum log_level level, const char *msg, const char *value)
 {
         IF_LEVEL_GT_CURR_LEVEL_RET_ZERO(level);
-        return writek(msg) + writek(value) + writek_crlf();
+
+        /* value may live on the caller's stack, so never deferred */
+        if (!lock_log())
+                return 0;
+
+        const int len = log_put_text(msg) + log_put_text(value) +
+                log_put_text("\r\n");
+        unlock_log();
+
+        return len;
 }
 
-int printk_bool_msg(enum log_level level, const char *msg, const bool value)
+int printk_bool_msg_ex(enum log_level level, const char *msg,
+                       const bool value, const bool literal)
 {
         IF_LEVEL_GT_CURR_LEVEL_RET_ZERO(level);
-        const char* bool_value = value ? "true" : "false";
-        return writek(msg) + writek(bool_value) + writek_crlf();
+        struct printk_record rec = { .value.b = value };
+        return log_record(level, PRINTK_RECORD_BOOL_MSG, msg, &rec, literal);
 }
 
 enum log_level get_log_level()
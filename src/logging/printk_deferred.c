@@ -0,0 +1,198 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "mem_mang.h"
+#include "printk_deferred.h"
+#include "task.h"
+
+#if PRINTK_DEFERRED_SUPPORT
+
+#define RING_MASK	(PRINTK_DEFERRED_RING_SIZE - 1)
+
+#if PRINTK_DEFERRED_RING_SIZE & RING_MASK
+#error "PRINTK_DEFERRED_RING_SIZE must be a power of 2"
+#endif
+
+/*
+ * head is only written by the owning task and tail only by the reader,
+ * so neither side needs a lock.  Both run free and wrap naturally.
+ */
+struct printk_ring {
+        xTaskHandle owner;
+        struct printk_record *records;
+        volatile uint32_t head;
+        volatile uint32_t tail;
+        volatile uint32_t dropped;
+        uint32_t dropped_reported;
+};
+
+static struct printk_ring g_rings[PRINTK_DEFERRED_RINGS];
+static volatile bool g_enabled;
+
+bool printk_deferred_enable(const bool enable)
+{
+        g_enabled = enable;
+        return g_enabled;
+}
+
+bool printk_deferred_enabled(void)
+{
+        return g_enabled;
+}
+
+static struct printk_ring* claim_ring(const xTaskHandle task)
+{
+        struct printk_ring *ring = NULL;
+
+        taskENTER_CRITICAL();
+        for (size_t i = 0; i < PRINTK_DEFERRED_RINGS; ++i) {
+                if (NULL == g_rings[i].owner) {
+                        ring = g_rings + i;
+                        ring->owner = task;
+                        break;
+                }
+        }
+        taskEXIT_CRITICAL();
+
+        return ring;
+}
+
+static struct printk_ring* get_ring(const xTaskHandle task)
+{
+        for (size_t i = 0; i < PRINTK_DEFERRED_RINGS; ++i)
+                if (task == g_rings[i].owner)
+                        return g_rings + i;
+
+        return claim_ring(task);
+}
+
+bool printk_deferred_put(struct printk_record *rec)
+{
+        if (!g_enabled)
+                return false;
+
+        const xTaskHandle task = xTaskGetCurrentTaskHandle();
+        if (NULL == task)
+                return false;
+
+        struct printk_ring *ring = get_ring(task);
+        if (NULL == ring)
+                return false;
+
+        if (NULL == ring->records) {
+                struct printk_record *records =
+                        portMalloc(sizeof(struct printk_record) *
+                                   PRINTK_DEFERRED_RING_SIZE);
+                if (NULL == records)
+                        return false;
+
+                ring->records = records;
+                __sync_synchronize();
+        }
+
+        const uint32_t head = ring->head;
+        if (head - ring->tail >= PRINTK_DEFERRED_RING_SIZE) {
+                ++ring->dropped;
+                return true;
+        }
+
+        rec->ticks = xTaskGetTickCount();
+        ring->records[head & RING_MASK] = *rec;
+
+        /* Record must be visible before the reader sees the new head */
+        __sync_synchronize();
+        ring->head = head + 1;
+        return true;
+}
+
+bool printk_deferred_get(struct printk_record *rec)
+{
+        struct printk_ring *oldest = NULL;
+
+        /* Readers are rare; serialize them against each other */
+        taskENTER_CRITICAL();
+        for (size_t i = 0; i < PRINTK_DEFERRED_RINGS; ++i) {
+                struct printk_ring *ring = g_rings + i;
+                if (NULL == ring->records || ring->head == ring->tail)
+                        continue;
+
+                const uint32_t ticks =
+                        ring->records[ring->tail & RING_MASK].ticks;
+                if (NULL == oldest || (int32_t) (ticks -
+                    oldest->records[oldest->tail & RING_MASK].ticks) < 0)
+                        oldest = ring;
+        }
+
+        if (oldest) {
+                *rec = oldest->records[oldest->tail & RING_MASK];
+                __sync_synchronize();
+                ++oldest->tail;
+        }
+        taskEXIT_CRITICAL();
+
+        return NULL != oldest;
+}
+
+uint32_t printk_deferred_dropped(void)
+{
+        uint32_t dropped = 0;
+
+        taskENTER_CRITICAL();
+        for (size_t i = 0; i < PRINTK_DEFERRED_RINGS; ++i) {
+                struct printk_ring *ring = g_rings + i;
+                const uint32_t total = ring->dropped;
+                dropped += total - ring->dropped_reported;
+                ring->dropped_reported = total;
+        }
+        taskEXIT_CRITICAL();
+
+        return dropped;
+}
+
+#else
+
+bool printk_deferred_enable(const bool enable)
+{
+        return false;
+}
+
+bool printk_deferred_enabled(void)
+{
+        return false;
+}
+
+bool printk_deferred_put(struct printk_record *rec)
+{
+        return false;
+}
+
+bool printk_deferred_get(struct printk_record *rec)
+{
+        return false;
+}
+
+uint32_t printk_deferred_dropped(void)
+{
+        return 0;
+}
+
+#endif /* PRINTK_DEFERRED_SUPPORT */
@@ -210,6 +210,31 @@ static int lua_get_tick_rate(lua_State *L)
         return 1;
 }
 
+static int lua_set_tick_budget(lua_State *L)
+{
+        lua_validate_args_count(L, 1, 2);
+        lua_validate_arg_number(L, 1);
+
+        struct lua_budget budget = lua_task_get_budget();
+        budget.max_insns = lua_tointeger(L, 1);
+        if (2 == lua_gettop(L)) {
+                lua_validate_arg_number(L, 2);
+                budget.max_ms = lua_tointeger(L, 2);
+        }
+
+        lua_task_set_budget(budget.max_insns, budget.max_ms);
+        return 0;
+}
+
+static int lua_get_tick_budget(lua_State *L)
+{
+        const struct lua_budget budget = lua_task_get_budget();
+
+        lua_pushinteger(L, budget.max_insns);
+        lua_pushinteger(L, budget.max_ms);
+        return 2;
+}
+
 static int log_print(lua_State *L, bool addNewline)
 {
         lua_validate_args_count(L, 0, 2);
@@ -285,6 +310,8 @@ void registerBaseLuaFunctions(lua_State *L)
         lua_registerlight(L, "getStackSize", lua_get_stack_size);
         lua_registerlight(L, "setTickRate", lua_set_tick_rate);
         lua_registerlight(L, "getTickRate", lua_get_tick_rate);
+        lua_registerlight(L, "setTickBudget", lua_set_tick_budget);
+        lua_registerlight(L, "getTickBudget", lua_get_tick_budget);
         lua_registerlight(L, "print", lua_log_print);
         lua_registerlight(L, "println", lua_log_println);
         lua_registerlight(L, "setLogLevel", lua_log_set_level);
@@ -0,0 +1,105 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "lauxlib.h"
+#include "luaBudget.h"
+#include "task.h"
+#include "taskUtil.h"
+#include <stdbool.h>
+
+static struct {
+        /* Tick window limits.  0 means no limit */
+        size_t tick_max_insns;
+        size_t tick_max_ticks;
+        /* Limits of the running window */
+        size_t max_insns;
+        size_t max_ticks;
+        size_t insns_used;
+        portTickType start_tick;
+        size_t overruns;
+} budget;
+
+/**
+ * Count hook that fires every LUA_BUDGET_HOOK_INTERVAL VM instructions.
+ * If the running invocation has exceeded its instruction or time budget
+ * we raise a Lua error, which unwinds the script back to our resume/pcall
+ * and releases the Lua lock.  Note that time spent blocked inside a C
+ * function (like sleep) counts against the time budget but can only be
+ * caught once control returns to the VM.
+ */
+static void budget_hook(lua_State *ls, lua_Debug *ar)
+{
+        budget.insns_used += LUA_BUDGET_HOOK_INTERVAL;
+
+        const bool insns_over = budget.max_insns &&
+                budget.insns_used > budget.max_insns;
+        const bool time_over = budget.max_ticks &&
+                xTaskGetTickCount() - budget.start_tick > budget.max_ticks;
+
+        if (!insns_over && !time_over)
+                return;
+
+        ++budget.overruns;
+        luaL_error(ls, insns_over ? "Instruction budget exceeded" :
+                   "Time budget exceeded");
+}
+
+void lua_budget_install(lua_State *ls)
+{
+        lua_sethook(ls, budget_hook, LUA_MASKCOUNT, LUA_BUDGET_HOOK_INTERVAL);
+}
+
+void lua_budget_start(const enum lua_budget_window window)
+{
+        switch (window) {
+        case LUA_BUDGET_LOAD:
+                budget.max_insns = LUA_BUDGET_LOAD_MAX_INSNS;
+                budget.max_ticks = msToTicks(LUA_BUDGET_LOAD_MAX_MS);
+                break;
+        case LUA_BUDGET_TICK:
+                budget.max_insns = budget.tick_max_insns;
+                budget.max_ticks = budget.tick_max_ticks;
+                break;
+        }
+
+        budget.insns_used = 0;
+        budget.start_tick = xTaskGetTickCount();
+}
+
+void lua_budget_set(const size_t max_insns, const size_t max_ms)
+{
+        budget.tick_max_insns = max_insns;
+        budget.tick_max_ticks = max_ms ? msToTicks(max_ms) : 0;
+}
+
+struct lua_budget lua_budget_get()
+{
+        return (struct lua_budget) {
+                .max_insns = budget.tick_max_insns,
+                .max_ms = ticksToMs(budget.tick_max_ticks),
+        };
+}
+
+size_t lua_budget_get_overruns()
+{
+        return budget.overruns;
+}
@@ -26,12 +26,15 @@
 #include "led.h"
 #include "lua.h"
 #include "luaBaseBinding.h"
+#include "luaBudget.h"
 #include "luaLoggerBinding.h"
 #include "luaScript.h"
 #include "luaTask.h"
 #include "lualib.h"
 #include "mem_mang.h"
 #include "panic.h"
+#include "perf.h"
+#include "perf_region.h"
 #include "portable.h"
 #include "printk.h"
 #include "queue.h"
@@ -47,7 +50,9 @@
 /* Keep Stack value high as the parser can get very stack hungry.  Issue #411 */
 #define LUA_BYPASS_DELAY_SEC		5
 #define LUA_CONSECUTIVE_FAILURES_LIMIT	3
+#define LUA_DEFAULT_INSN_BUDGET		0
 #define LUA_DEFAULT_ONTICK_HZ		1
+#define LUA_DEFAULT_TIME_BUDGET_MS	0
 #define LUA_ERR_NONE			0
 #define LUA_ERR_BUG			-1
 #define LUA_NO_PERIODIC_FUNCTION	-2
@@ -62,6 +67,10 @@
 struct lua_run_state {
         lua_State *lua_state;
         bool script_loaded;
+        /* Thread onTick runs in.  Anchored in the registry by thread_ref */
+        lua_State *thread;
+        int thread_ref;
+        bool thread_yielded;
 };
 
 enum run_status {
@@ -163,10 +172,59 @@ static bool load_script(lua_State *ls)
         return true;
 }
 
+static void drop_thread(struct lua_run_state *rs)
+{
+        luaL_unref(rs->lua_state, LUA_REGISTRYINDEX, rs->thread_ref);
+        rs->thread_ref = LUA_NOREF;
+        rs->thread = NULL;
+        rs->thread_yielded = false;
+}
+
+/**
+ * Runs the periodic function inside a dedicated Lua thread.  This allows
+ * scripts to call coroutine.yield() from onTick to spread long running
+ * work across ticks; a yielded thread is resumed on the next tick instead
+ * of starting a fresh onTick call.  The thread is reused between calls and
+ * only rebuilt after an error, since an errored thread is dead.
+ */
+static int run_periodic(struct lua_run_state *rs)
+{
+        if (!rs->thread) {
+                rs->thread = lua_newthread(rs->lua_state);
+                rs->thread_ref = luaL_ref(rs->lua_state, LUA_REGISTRYINDEX);
+        }
+
+        lua_State *ls = rs->thread;
+        if (!rs->thread_yielded) {
+                lua_getglobal(ls, LUA_PERIODIC_FUNCTION);
+                if (lua_isnil(ls, -1)) {
+                        /* No longer a failure per Issue #707 */
+                        lua_pop(ls, 1);
+                        return LUA_NO_PERIODIC_FUNCTION;
+                }
+        }
+
+        const int status = lua_resume(ls, 0);
+        switch (status) {
+        case LUA_YIELD:
+                rs->thread_yielded = true;
+                /* Intentional fall through */
+        case 0:
+                /* Drop any yielded/returned values */
+                lua_settop(ls, 0);
+                return LUA_ERR_NONE;
+        default:
+                pr_error_str_msg(_LOG_PFX "Script error: ",
+                                 lua_tostring(ls, -1));
+                drop_thread(rs);
+                return status;
+        }
+}
+
 static int lua_invocation(struct lua_run_state *rs)
 {
+        PERF_REGION_BEGIN("lua_invocation");
         int status = LUA_ERR_BUG;
-        const char function[] = LUA_PERIODIC_FUNCTION;
         get_lock();
 
         /* First load our script if needed */
@@ -177,6 +235,7 @@ static int lua_invocation(struct lua_run_state *rs)
                  */
                 reset_virtual_channels();
 
+                lua_budget_start(LUA_BUDGET_LOAD);
                 if (!load_script(rs->lua_state)) {
                         status = LUA_ERR_SCRIPT_LOAD_FAILED;
                         goto done;
@@ -185,25 +244,15 @@ static int lua_invocation(struct lua_run_state *rs)
                 rs->script_loaded = true;
         }
 
-        /* Now run the callback */
-        lua_getglobal(rs->lua_state, function);
-        if (lua_isnil(rs->lua_state, -1)) {
-                /* No longer a failure per Issue #707 */
-                lua_pop(rs->lua_state, 1);
-                status = LUA_NO_PERIODIC_FUNCTION;
-                goto done;
-        }
+        lua_budget_start(LUA_BUDGET_TICK);
 
-        status = lua_pcall(rs->lua_state, 0, 0, 0);
-        if (0 != status) {
-                pr_error_str_msg(_LOG_PFX "Script error: ",
-                                 lua_tostring(rs->lua_state, -1));
-                lua_pop(rs->lua_state, 1);
-        }
+        /* Now run the callback */
+        status = run_periodic(rs);
 
 done:
         lua_settop(rs->lua_state, 0);
         release_lock();
+        PERF_REGION_END("lua_invocation");
         return status;
 }
 
@@ -257,6 +306,7 @@ static bool lua_interactive(struct lua_run_state *rs)
                 goto done;
         }
 
+        lua_budget_start(LUA_BUDGET_TICK);
         state.interactive.status = luaL_dostring(ls, state.interactive.cmd) ?
                                    LUA_CMD_FAILURE : LUA_CMD_SUCCESS;
 
@@ -282,6 +332,9 @@ static void lua_task(void *params)
         struct lua_run_state rs = {
                 .lua_state = params,
                 .script_loaded = false,
+                .thread = NULL,
+                .thread_ref = LUA_NOREF,
+                .thread_yielded = false,
         };
 
         int consecutive_failures = 0;
@@ -378,6 +431,12 @@ static lua_State* setup_lua_state()
         lua_gc(ls, LUA_GCSETPAUSE, LUA_GC_PAUSE_PCT);
         lua_gc(ls, LUA_GCSETSTEPMUL, LUA_GC_STEP_MULT_PCT);
 
+        /*
+         * Bound how long any single invocation may hold the Lua lock.
+         * Threads created later inherit this hook from the main state.
+         */
+        lua_budget_install(ls);
+
         return ls;
 }
 
@@ -463,6 +522,7 @@ struct lua_runtime_info lua_task_get_runtime_info()
         lua_State *ls = state.lua_runtime;
         ri.top_index = lua_gettop(ls);
         ri.mem_usage_kb = lua_gc(ls, LUA_GCCOUNT, 0);
+        ri.budget_overruns = lua_budget_get_overruns();
 
         return ri;
 }
@@ -485,6 +545,16 @@ size_t lua_task_get_callback_freq()
         return 1000 / ticksToMs(state.callback_interval);
 }
 
+void lua_task_set_budget(const size_t max_insns, const size_t max_ms)
+{
+        lua_budget_set(max_insns, max_ms);
+}
+
+struct lua_budget lua_task_get_budget()
+{
+        return lua_budget_get();
+}
+
 bool lua_task_stop()
 {
         if (!is_init(false) || !is_runtime_active()) {
@@ -546,6 +616,7 @@ bool lua_task_start()
 
         /* Make all task names 16 chars including NULL char */
         static const signed portCHAR task_name[] = "Lua Exec Task  ";
+        perf_register_task(task_name, LUA_STACK_SIZE);
         ok = pdPASS == xTaskCreate(lua_task, task_name, LUA_STACK_SIZE,
                                    state.lua_runtime, state.priority,
                                    &state.task_handle);
@@ -640,5 +711,7 @@ bool lua_task_init(const int priority)
         initialize_script();
 
         lua_task_set_callback_freq(LUA_DEFAULT_ONTICK_HZ);
+        lua_task_set_budget(LUA_DEFAULT_INSN_BUDGET,
+                            LUA_DEFAULT_TIME_BUDGET_MS);
         return lua_task_start();
 }
@@ -26,6 +26,8 @@
 #include "gps.h"
 #include <string.h>
 #include "predictive_timer_2.h"
+#include "reference_lap.h"
+#include "track_frame.h"
 
 /* What is the required GPS fix quality to be used as a sample */
 #define GPS_FIX_QUALITY_REQUIRED GPS_QUALITY_3D
@@ -44,29 +46,53 @@
  */
 #define MIN_PREDICTED_TIME 10000
 
-// A smaller TimeLoc value for space savings
+// A decoded sample
 struct PtTimeLoc {
-        GeoPoint point;
+        struct track_point point;
         tiny_millis_t time;
 };
 
 /*
- * What is the maximum number of samples available per predictive time
- * buffer.  More samples == better resolution. Each slot is 12 bytes.
- * This is defined in capabilities.h
+ * Positions are stored to the nearest POS_UNIT_CM.  Each sample is then
+ * encoded as the difference from a linear extrapolation of the two before
+ * it, as zigzag varints for x, y and time.  On a smooth path at a steady
+ * poll interval most of these fit in a byte or two, where a full sample
+ * takes 12.
  */
-static struct PtTimeLoc buff1[PREDICTIVE_TIME_MAX_SAMPLES];
-static struct PtTimeLoc buff2[PREDICTIVE_TIME_MAX_SAMPLES];
+#define POS_UNIT_CM		10
+#define MAX_SAMPLE_BYTES	15
+
+struct pt_lap {
+        uint8_t buff[PREDICTIVE_TIME_BUFFER_SIZE];
+        size_t len;
+        int count;
+        /* The last two samples, most recent last */
+        struct PtTimeLoc tail[2];
+};
 
-// Our pointers that maintain the fast lap and current lap buffers.
-static struct PtTimeLoc *currLap = buff1;
-static struct PtTimeLoc *fastLap = buff2;
+/*
+ * Decodes a lap one sample at a time.
+ */
+struct pt_cursor {
+        const uint8_t *buff;
+        int count;
+        size_t pos;
+        int index;
+        struct PtTimeLoc tail[2];
+};
 
-// Index to track current slot in buffer
-static int buffIndex;
+/*
+ * Points are stored in a frame anchored at the first lap start after a
+ * reset so that the closest point search is plain integer math.
+ */
+static struct track_frame frame;
 
-// Index to track high slot in fastLapTimer.  Its points to the next open slot there.
-static int fastLapIndex;
+static struct pt_lap buff1;
+static struct pt_lap buff2;
+
+// Our pointers that maintain the fast lap and current lap buffers.
+static struct pt_lap *currLap = &buff1;
+static struct pt_lap *fastLap = &buff2;
 
 // Time of the fast lap.
 static tiny_millis_t fastLapTime;
@@ -112,23 +138,146 @@ static bool verify_gps_quality(const GpsSample *sample)
                && sample->DOP <= GPS_MAXIMUM_DOP_ALLOWED;
 }
 
+static size_t putVarint(uint8_t *buf, const int32_t v)
+{
+        /* Zigzag so small negative values stay small */
+        uint32_t z = ((uint32_t) v << 1) ^ (uint32_t) (v >> 31);
+        size_t n = 0;
+
+        while (z >= 0x80) {
+                buf[n++] = (uint8_t) (z | 0x80);
+                z >>= 7;
+        }
+        buf[n++] = (uint8_t) z;
+        return n;
+}
+
+static int32_t getVarint(const uint8_t *buf, size_t *pos)
+{
+        uint32_t z = 0;
+        unsigned shift = 0;
+        uint8_t b;
+
+        do {
+                b = buf[(*pos)++];
+                z |= (uint32_t) (b & 0x7F) << shift;
+                shift += 7;
+        } while (b & 0x80);
+
+        return (int32_t) (z >> 1) ^ -(int32_t) (z & 1);
+}
+
 /**
- * Creates a timeLoc sample and places it in the currBuff.  Increments counter as needed.
- * @return true if the insert succeeded, false otherwise.
+ * Linearly extrapolates the next sample from the ones before it.
+ */
+static struct PtTimeLoc predictNextSample(const struct PtTimeLoc tail[2],
+                                          const int count)
+{
+        struct PtTimeLoc next = {{0, 0}, 0};
+
+        if (count == 1)
+                next = tail[1];
+
+        if (count >= 2) {
+                next.point.x = 2 * tail[1].point.x - tail[0].point.x;
+                next.point.y = 2 * tail[1].point.y - tail[0].point.y;
+                next.time = 2 * tail[1].time - tail[0].time;
+        }
+
+        return next;
+}
+
+static void pushTail(struct PtTimeLoc tail[2], const struct PtTimeLoc *tl)
+{
+        tail[0] = tail[1];
+        tail[1] = *tl;
+}
+
+static void initCursor(struct pt_cursor *c, const uint8_t *buff,
+                       const int count)
+{
+        memset(c, 0, sizeof(struct pt_cursor));
+        c->buff = buff;
+        c->count = count;
+}
+
+/**
+ * Decodes the next sample of a lap.
+ * @return true if there was one, false at the end of the lap.
  */
-static bool insertTimeLocSample(const GeoPoint * point, tiny_millis_t time)
+static bool nextSample(struct pt_cursor *c, struct PtTimeLoc *tl)
 {
-        if (buffIndex >= PREDICTIVE_TIME_MAX_SAMPLES)
+        if (c->index >= c->count)
                 return false;
 
-        struct PtTimeLoc *timeLoc = currLap + buffIndex;
-        timeLoc->point = *point;
-        timeLoc->time = getCurrentLapTime(time);
+        *tl = predictNextSample(c->tail, c->index);
+        tl->point.x += getVarint(c->buff, &c->pos) * POS_UNIT_CM;
+        tl->point.y += getVarint(c->buff, &c->pos) * POS_UNIT_CM;
+        tl->time += getVarint(c->buff, &c->pos);
+
+        pushTail(c->tail, tl);
+        ++c->index;
+        return true;
+}
+
+static int32_t roundToUnit(const int32_t cm)
+{
+        const int32_t half = cm < 0 ? -POS_UNIT_CM / 2 : POS_UNIT_CM / 2;
+        return (cm + half) / POS_UNIT_CM * POS_UNIT_CM;
+}
+
+static struct PtTimeLoc toTimeLoc(const struct track_frame *f,
+                                  const GeoPoint *point,
+                                  const tiny_millis_t lapTime)
+{
+        const struct track_point tp = track_frame_project(f, point);
+        struct PtTimeLoc tl;
+        tl.point.x = roundToUnit(tp.x);
+        tl.point.y = roundToUnit(tp.y);
+        tl.time = lapTime;
+        return tl;
+}
+
+/**
+ * Encodes a sample as its difference from the one predicted by the
+ * samples before it.
+ * @return The number of bytes written to enc.
+ */
+static size_t encodeSample(uint8_t enc[MAX_SAMPLE_BYTES],
+                           const struct PtTimeLoc *tl,
+                           const struct PtTimeLoc tail[2], const int count)
+{
+        const struct PtTimeLoc pred = predictNextSample(tail, count);
+        size_t len = putVarint(enc, (tl->point.x - pred.point.x) / POS_UNIT_CM);
+        len += putVarint(enc + len, (tl->point.y - pred.point.y) / POS_UNIT_CM);
+        len += putVarint(enc + len, tl->time - pred.time);
+        return len;
+}
+
+/**
+ * Encodes a timeLoc sample onto the end of the current lap.
+ * @param reserve Bytes that must remain free after this sample.
+ * @return true if the insert succeeded, false otherwise.
+ */
+static bool insertTimeLocSample(const GeoPoint * point, tiny_millis_t time,
+                                const size_t reserve)
+{
+        const struct PtTimeLoc tl = toTimeLoc(&frame, point,
+                                              getCurrentLapTime(time));
+        uint8_t enc[MAX_SAMPLE_BYTES];
+        const size_t len = encodeSample(enc, &tl, currLap->tail,
+                                        currLap->count);
 
-        if (++buffIndex >= PREDICTIVE_TIME_MAX_SAMPLES) {
+        if (currLap->len + len + reserve > PREDICTIVE_TIME_BUFFER_SIZE) {
                 DEBUG("Buffer now Full!\n");
+                return false;
         }
 
+        memcpy(currLap->buff + currLap->len, enc, len);
+        currLap->len += len;
+        ++currLap->count;
+        pushTail(currLap->tail, &tl);
+
         return true;
 }
 
@@ -142,38 +291,51 @@ static void setNewFastLap(tiny_millis_t lapTime)
         fastLapTime = lapTime;
 
         // Swap out our buffers.
-        fastLapIndex = buffIndex;
         fastLap = currLap;
-        currLap = currLap == buff1 ? buff2 : buff1;
+        currLap = currLap == &buff1 ? &buff2 : &buff1;
 }
 
 bool isPredictiveTimeAvailable()
 {
-        return fastLapIndex != 0;
+        return fastLap->count != 0;
+}
+
+/**
+ * @return The poll interval that would fill 90% of the buffer on a lap
+ * like this one.
+ */
+static tiny_millis_t targetPollInterval(const struct pt_lap *lap,
+                                        tiny_millis_t lapTime)
+{
+        /* Samples vary in size, so plan on what this lap averaged */
+        const float slots = (float) PREDICTIVE_TIME_BUFFER_SIZE * lap->count / lap->len;
+        DEBUG("Recorded %d samples.  Targeting ~ %f samples.\n", lap->count, slots * 0.9);
+
+        // Careful here of gotchas with tiny_millis_t and floats.
+        return lapTime / (slots * 0.9);
 }
 
 /**
  * Adjusts the poll interval so that we can effectively use our buffer.  The more full it
  * gets the better timing accuracy we can give.
  */
-static tiny_millis_t adjustPollInterval(tiny_millis_t lapTime)
+static tiny_millis_t adjustPollInterval(const struct pt_lap *lap,
+                                        tiny_millis_t lapTime)
 {
         // If no hotLap is set there no data to work with.
         if (!isPredictiveTimeAvailable())
                 return pollInterval;
 
         // Target 90% buffer use +- 10%.
-        const float slots = (float) PREDICTIVE_TIME_MAX_SAMPLES;
-        const float percentUsed = ((float) buffIndex) / slots;
-        DEBUG("Recorded %d samples.  Targeting ~ %f samples.\n", buffIndex, slots * 0.9);
+        const float size = (float) PREDICTIVE_TIME_BUFFER_SIZE;
+        const float percentUsed = ((float) lap->len) / size;
 
         if (percentUsed > 0.8 && status != FULL) {
                 DEBUG("Within target range.  Not adjusting sample rate.\n");
                 return pollInterval;
         }
 
-        // Careful here of gotchas with tiny_millis_t and floats.
-        pollInterval = lapTime / (slots / 0.9);
+        pollInterval = targetPollInterval(lap, lapTime);
         DEBUG("Setting poll interval to %ull\n", pollInterval);
 
         return pollInterval;
@@ -185,7 +347,7 @@ static tiny_millis_t adjustPollInterval(tiny_millis_t lapTime)
  */
 static tiny_millis_t getTimeSinceLastSample(tiny_millis_t time)
 {
-        return time - currLapStartTime - currLap[buffIndex - 1].time;
+        return time - currLapStartTime - currLap->tail[1].time;
 }
 
 /**
@@ -199,11 +361,9 @@ void finishLap(const GpsSnapshot *gpsSnapshot)
         const tiny_millis_t time = gpsSnapshot->deltaFirstFix;
         const GeoPoint *point = &gpsSnapshot->sample.point;
 
-        // Drop last entry if necessary to record end of lap.
-        if (buffIndex >= PREDICTIVE_TIME_MAX_SAMPLES)
-                buffIndex = PREDICTIVE_TIME_MAX_SAMPLES - 1;
-
-        insertTimeLocSample(point, time);
+        /* Space for this was reserved by addGpsSample */
+        struct pt_lap *lap = currLap;
+        insertTimeLocSample(point, time, 0);
 
         tiny_millis_t lapTime = getCurrentLapTime(time);
         INFO("Last lap time was %f seconds\n", lapTime);
@@ -212,7 +372,7 @@ void finishLap(const GpsSnapshot *gpsSnapshot)
                 setNewFastLap(lapTime);
         }
 
-        adjustPollInterval(lapTime);
+        adjustPollInterval(lap, lapTime);
         status = DISABLED;
 }
 
@@ -223,16 +383,21 @@ void startLap(const GeoPoint *point, const tiny_millis_t time)
 {
         if (status != DISABLED) return;
 
+        /* No fast lap to stay consistent with, so re-anchor our frame */
+        if (!isPredictiveTimeAvailable())
+                track_frame_init(&frame, point);
+
         status = RECORDING;
         currLapStartTime = time;
         lastPredictedDelta = 0;
         lastPredictedTime = 0;
-        buffIndex = 0;
+        currLap->len = 0;
+        currLap->count = 0;
 
-        DEBUG("Starting new lap.  Status %d, buffIndex = %d, startTime = %ull\n",
-              status, buffIndex, time);
+        DEBUG("Starting new lap.  Status %d, startTime = %ull\n",
+              status, time);
 
-        insertTimeLocSample(point, time);
+        insertTimeLocSample(point, time, MAX_SAMPLE_BYTES);
 }
 
 /**
@@ -263,7 +428,8 @@ bool addGpsSample(const GpsSnapshot *gpsSnapshot)
                 return false;
         }
 
-        if (!insertTimeLocSample(point, time)) {
+        /* Always leave room to record the end of the lap */
+        if (!insertTimeLocSample(point, time, MAX_SAMPLE_BYTES)) {
                 status = FULL;
                 DEVEL("DROPPING - Buffer full\n");
                 return false;
@@ -273,75 +439,90 @@ bool addGpsSample(const GpsSnapshot *gpsSnapshot)
         return true;
 }
 
-float distPctBtwnTwoPoints(const GeoPoint *s, const GeoPoint *e, const GeoPoint *m)
+/*
+ * Projection of m onto the vector s->e as a fraction of its length:
+ * ((m - s) . (e - s)) / |e - s|^2
+ */
+static float trackPctBtwnTwoPoints(const struct track_point *s,
+                                   const struct track_point *e,
+                                   const struct track_point *m)
 {
-        const float distSM = distPythag(s, m); // A
-        const float distME = distPythag(m, e); // B
-        const float distSE = distPythag(s, e); // C
+        const int64_t sex = (int64_t) e->x - s->x;
+        const int64_t sey = (int64_t) e->y - s->y;
+        const int64_t smx = (int64_t) m->x - s->x;
+        const int64_t smy = (int64_t) m->y - s->y;
 
-        // projDist = (A^2 + C^2 - B^2) / 2 * C
-        const float projDistFromS = ((distSM * distSM) + (distSE * distSE)
-                                     - (distME * distME)) / (2 * distSE);
+        const int64_t lenSq = sex * sex + sey * sey;
+        const int64_t dot = smx * sex + smy * sey;
 
-        DEVEL("distSE = %f, distSM = %f, distME = %f, projDist = %f\n", distSE,
-              distSM, distME, projDistFromS);
+        DEVEL("lenSq = %lld, dot = %lld\n", lenSq, dot);
 
-        return projDistFromS / distSE;
+        return (float) dot / (float) lenSq;
 }
 
-static bool inBounds(float v)
+float distPctBtwnTwoPoints(const GeoPoint *s, const GeoPoint *e, const GeoPoint *m)
 {
-        return v >= 0 && v <= 1;
+        struct track_frame f;
+        track_frame_init(&f, s);
+
+        const struct track_point ts = track_frame_project(&f, s);
+        const struct track_point te = track_frame_project(&f, e);
+        const struct track_point tm = track_frame_project(&f, m);
+        return trackPctBtwnTwoPoints(&ts, &te, &tm);
 }
 
-/**
- * Finds the  closest point to the given point in the fastLap buffer.  Orders the output buffer
- * such that the lower time is always first.
- * @param currPoint The current point of measurement.
- * @return The index of the closest point in the fastLap buffer to the current point, or -1 if
- * no closest point is available.
- */
-static int findClosestPt(const GeoPoint *currPoint)
+static bool inBounds(float v)
 {
-        if (!isPredictiveTimeAvailable())
-                return -1;
-
-        // First find the closest point.  Start with index 0 as your best.
-        int bestIndex = 0;
-        GeoPoint *fastLapPoint = &(fastLap[bestIndex].point);
-        float lowestDistance = distPythag(currPoint, fastLapPoint);
-
-        for (int i = 1; i < fastLapIndex; ++i) {
-                fastLapPoint = &(fastLap[i].point);
-                float distance = distPythag(currPoint, fastLapPoint);
-
-                if (distance < lowestDistance) {
-                        lowestDistance = distance;
-                        bestIndex = i;
-                }
-        }
-
-        DEVEL("Smallest distance is %f from point %d\n", lowestDistance, bestIndex);
-        return bestIndex;
+        return v >= 0 && v <= 1;
 }
 
 /**
  * Finds the two points closest to the given point in the fastLap buffer.  Orders the output buffer
- * such that the lower time is always first.
+ * such that the lower time is always first.  The buffer is decoded in a single pass, keeping the
+ * neighbours of the closest point seen so far.
  * @param currPoint The current point of measurement.
  * @param tlPts Output buffer where the two closest points will go.  Lower time point first.
  * Undefined values if method returns false.
  * @return true if a fast lap is set and the points are next to each other in the fastLap buffer
  * and the given point is between the two points, false otherwise.
  */
-static bool findTwoClosestPts(const GeoPoint *currPoint, struct PtTimeLoc *tlPts[])
+static bool findTwoClosestPts(const struct track_point *currPoint,
+                              struct PtTimeLoc tlPts[])
 {
         if (!isPredictiveTimeAvailable())
                 return false;
 
-        int bestIndex = findClosestPt(currPoint);
-        if (bestIndex < 0)
-                return false;
+        struct pt_cursor c;
+        initCursor(&c, fastLap->buff, fastLap->count);
+
+        struct PtTimeLoc tl = {0}, prev = {0};
+        struct PtTimeLoc best = {0}, bestDn = {0}, bestUp = {0};
+        bool hasBestDn = false;
+        bool hasBestUp = false;
+        int bestIndex = -1;
+        int64_t lowestDistance = 0;
+
+        for (int i = 0; nextSample(&c, &tl); ++i) {
+                const int64_t distance = track_point_dist_sq(currPoint, &tl.point);
+
+                if (bestIndex < 0 || distance < lowestDistance) {
+                        lowestDistance = distance;
+                        bestIndex = i;
+                        best = tl;
+                        /* The first sample has no point before it */
+                        hasBestDn = i > 0;
+                        if (hasBestDn)
+                                bestDn = prev;
+                        hasBestUp = false;
+                } else if (i == bestIndex + 1) {
+                        bestUp = tl;
+                        hasBestUp = true;
+                }
+
+                prev = tl;
+        }
+
+        DEVEL("Smallest distance^2 is %lld from point %d\n", lowestDistance, bestIndex);
 
         /*
          * Next we have two neighboring points.  We want to choose the point such that point s is before
@@ -349,16 +530,8 @@ static bool findTwoClosestPts(const GeoPoint *currPoint, struct PtTimeLoc *tlPts
          * know.  So how do we find this point?  Use our distPctBtwnTwoPoints method.  Values between
          * 0 - 1 indicate a point between the two points.
          */
-        GeoPoint *gpBest = &(fastLap[bestIndex].point);
-
-        int upIdx = bestIndex + 1;
-        int dnIdx = bestIndex - 1;
-
-        GeoPoint *gpUp = upIdx >= fastLapIndex ? NULL : &(fastLap[upIdx].point);
-        GeoPoint *gpDn = dnIdx < 0 ? NULL : &(fastLap[dnIdx].point);
-
-        float distUp = gpUp == NULL ? -1 : distPctBtwnTwoPoints(gpBest, gpUp, currPoint);
-        float distDn = gpDn == NULL ? -1 : distPctBtwnTwoPoints(gpBest, gpDn, currPoint);
+        float distUp = !hasBestUp ? -1 : trackPctBtwnTwoPoints(&best.point, &bestUp.point, currPoint);
+        float distDn = !hasBestDn ? -1 : trackPctBtwnTwoPoints(&best.point, &bestDn.point, currPoint);
 
         if (!inBounds(distUp) && !inBounds(distDn)) {
                 DEBUG("Both points not in bounds (up: %f, dn: %f).  Close to Start/Finish?\n",
@@ -366,15 +539,13 @@ static bool findTwoClosestPts(const GeoPoint *currPoint, struct PtTimeLoc *tlPts
                 return false;
         }
 
-        int secondaryIndex = inBounds(distUp) ? upIdx : dnIdx;
-
-        tlPts[0] = &(fastLap[bestIndex]);
-        tlPts[1] = &(fastLap[secondaryIndex]);
+        tlPts[0] = best;
+        tlPts[1] = inBounds(distUp) ? bestUp : bestDn;
 
-        // Swap the buffers so the lower time is always first.  Just use
-        if (tlPts[1]->time < tlPts[0]->time) {
-                DEVEL("Swapping buffers: %f < %f\n", tlPts[1]->time, tlPts[0]->time);
-                struct PtTimeLoc *tmp = tlPts[0];
+        // Swap the buffers so the lower time is always first.
+        if (tlPts[1].time < tlPts[0].time) {
+                DEVEL("Swapping buffers: %f < %f\n", tlPts[1].time, tlPts[0].time);
+                const struct PtTimeLoc tmp = tlPts[0];
                 tlPts[0] = tlPts[1];
                 tlPts[1] = tmp;
         }
@@ -400,14 +571,15 @@ tiny_millis_t getSplitAgainstFastLap(const GeoPoint * point, tiny_millis_t curre
          * Figure out the two closest points.  Order of closestPts is with lower time first.  If this
          * fails then we can't continue.
          */
-        struct PtTimeLoc *closestPts[2];
-        if (!findTwoClosestPts(point, closestPts))
+        const struct track_point tp = track_frame_project(&frame, point);
+        struct PtTimeLoc closestPts[2];
+        if (!findTwoClosestPts(&tp, closestPts))
                 // TODO: Perhaps return false here?  Make this better for the caller.
                 return lastPredictedDelta;
 
-        const GeoPoint *pointA = &(closestPts[0]->point);
-        const GeoPoint *pointB = &(closestPts[1]->point);
-        float percentage = distPctBtwnTwoPoints(pointA, pointB, point);
+        const struct track_point *pointA = &(closestPts[0].point);
+        const struct track_point *pointB = &(closestPts[1].point);
+        float percentage = trackPctBtwnTwoPoints(pointA, pointB, &tp);
         DEVEL("Percentage value is 0 < %f < 1\n", percentage);
 
         if (!inBounds(percentage)) {
@@ -415,8 +587,8 @@ tiny_millis_t getSplitAgainstFastLap(const GeoPoint * point, tiny_millis_t curre
                 return lastPredictedDelta;
         }
 
-        const tiny_millis_t timeDeltaBtwnPoints = closestPts[1]->time - closestPts[0]->time;
-        const tiny_millis_t estFastTime = closestPts[0]->time + timeDeltaBtwnPoints  * percentage;
+        const tiny_millis_t timeDeltaBtwnPoints = closestPts[1].time - closestPts[0].time;
+        const tiny_millis_t estFastTime = closestPts[0].time + timeDeltaBtwnPoints  * percentage;
         DEBUG("Estimated fast lap time at this point is %f\n", estFastTime);
 
         lastPredictedDelta = estFastTime - getCurrentLapTime(currentTime);
@@ -462,8 +634,8 @@ void resetPredictiveTimer()
 {
         DEBUG("Resetting predictive timer\n");
         status = DISABLED;
-        buffIndex = 0;
-        fastLapIndex = 0;
+        buff1.len = buff1.count = 0;
+        buff2.len = buff2.count = 0;
         fastLapTime = 0;
         lastPredictedTime = 0;
         lastPredictedDelta = 0;
@@ -476,3 +648,96 @@ float getPredictedTimeInMinutes()
         const GpsSnapshot snapshot = getGpsSnapshot();
         return tinyMillisToMinutes(getPredictedTime(&snapshot));
 }
+
+tiny_millis_t getFastLapTime()
+{
+        return isPredictiveTimeAvailable() ? fastLapTime : 0;
+}
+
+bool getReferenceLap(struct reference_lap *ref)
+{
+        if (!isPredictiveTimeAvailable())
+                return false;
+
+        ref->lap_time = fastLapTime;
+        ref->origin = frame.origin;
+        ref->len = fastLap->len;
+        ref->count = fastLap->count;
+        memcpy(ref->buff, fastLap->buff, fastLap->len);
+
+        return true;
+}
+
+/**
+ * Checks that the buffer holds exactly count samples of three varints so
+ * that a corrupt reference can never be decoded past its end.
+ */
+static bool isReferenceLapIntact(const struct reference_lap *ref)
+{
+        if (ref->count == 0 || ref->len > PREDICTIVE_TIME_BUFFER_SIZE)
+                return false;
+
+        size_t varints = 0;
+        size_t varint_len = 0;
+        for (size_t i = 0; i < ref->len; ++i) {
+                if (++varint_len > 5)
+                        return false;
+
+                if (!(ref->buff[i] & 0x80)) {
+                        ++varints;
+                        varint_len = 0;
+                }
+        }
+
+        return varint_len == 0 && varints == 3 * (size_t) ref->count;
+}
+
+bool setReferenceLap(const struct reference_lap *ref)
+{
+        if (ref->lap_time <= 0 || !isValidPoint(&ref->origin) ||
+            !isReferenceLapIntact(ref)) {
+                DEBUG("Rejecting invalid reference lap\n");
+                return false;
+        }
+
+        resetPredictiveTimer();
+        track_frame_init(&frame, &ref->origin);
+
+        fastLap->len = ref->len;
+        fastLap->count = ref->count;
+        memcpy(fastLap->buff, ref->buff, ref->len);
+        fastLapTime = ref->lap_time;
+        pollInterval = targetPollInterval(fastLap, fastLapTime);
+
+        return true;
+}
+
+bool appendReferenceLapSample(struct reference_lap *ref,
+                              const GeoPoint *point, const tiny_millis_t time)
+{
+        if (ref->count == 0) {
+                ref->origin = *point;
+                ref->len = 0;
+        }
+
+        /* Find the samples the new one is predicted from */
+        struct pt_cursor c;
+        struct PtTimeLoc tl;
+        initCursor(&c, ref->buff, ref->count);
+        while (nextSample(&c, &tl));
+
+        struct track_frame f;
+        track_frame_init(&f, &ref->origin);
+        tl = toTimeLoc(&f, point, time);
+
+        uint8_t enc[MAX_SAMPLE_BYTES];
+        const size_t len = encodeSample(enc, &tl, c.tail, ref->count);
+        if (ref->len + len > PREDICTIVE_TIME_BUFFER_SIZE)
+                return false;
+
+        memcpy(ref->buff + ref->len, enc, len);
+        ref->len += len;
+        ++ref->count;
+
+        return true;
+}
@@ -0,0 +1,318 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "mem_mang.h"
+#include "memory.h"
+#include "predictive_timer_2.h"
+#include "printk.h"
+#include "reference_lap.h"
+#include "semphr.h"
+#include "task.h"
+#include "taskUtil.h"
+#include <string.h>
+
+#define _LOG_PFX   "[RefLap] "
+/* An upload that hasn't sent a chunk in this long has been abandoned */
+#define UPLOAD_TIMEOUT_MS	10000
+
+/*
+ * Reference laps live in the flash sector set aside for channels, which
+ * nothing else uses.  Platforms without a spare sector have no slots.
+ */
+#if REFERENCE_LAP_SLOTS > 0
+#ifndef RCP_TESTING
+static const volatile struct reference_laps g_ref_laps __attribute__((section(".ref_laps\n\t#")));
+#else
+static struct reference_laps g_ref_laps = {};
+#endif
+
+/*
+ * A copy of the stored laps while one is being changed, and the slot
+ * being filled in.  The API task uploads laps and the GPS task saves
+ * them, so whoever holds the buffer is decided under this lock.  Host
+ * tools that never call initialize_reference_laps run unlocked.
+ */
+static xSemaphoreHandle g_ref_laps_lock;
+static struct reference_laps *g_ref_laps_buffer;
+static struct reference_lap *g_ref;
+/* Set while an upload holds the buffer, with the time of its last chunk */
+static bool g_uploading;
+static portTickType g_upload_ticks;
+
+static void lock(void)
+{
+        if (g_ref_laps_lock)
+                xSemaphoreTake(g_ref_laps_lock, portMAX_DELAY);
+}
+
+static void unlock(void)
+{
+        if (g_ref_laps_lock)
+                xSemaphoreGive(g_ref_laps_lock);
+}
+
+void initialize_reference_laps()
+{
+        if (!g_ref_laps_lock)
+                g_ref_laps_lock = xSemaphoreCreateMutex();
+
+        const VersionInfo vi = g_ref_laps.versionInfo;
+        if (version_check_changed(&vi))
+                flash_default_reference_laps();
+}
+
+static int flash_reference_laps(const struct reference_laps *source)
+{
+        return memory_flash_region((void *) &g_ref_laps, (void *) source,
+                                   sizeof(struct reference_laps));
+}
+
+int flash_default_reference_laps(void)
+{
+        struct reference_laps *def = calloc(1, sizeof(struct reference_laps));
+        if (NULL == def)
+                return -1;
+
+        const VersionInfo* cv = get_current_version_info();
+        memcpy(&def->versionInfo, cv, sizeof(VersionInfo));
+
+        pr_info(_LOG_PFX "flashing default reference laps\r\n");
+        const int status = flash_reference_laps(def);
+
+        free(def);
+        return status;
+}
+
+static int find_slot(const struct reference_laps *laps, const int32_t track_id)
+{
+        for (int i = 0; i < REFERENCE_LAP_SLOTS; ++i) {
+                if (laps->laps[i].track_id == track_id)
+                        return i;
+        }
+
+        return -1;
+}
+
+const struct reference_lap* reference_lap_find(const int32_t track_id)
+{
+        const struct reference_laps *laps = (struct reference_laps *) &g_ref_laps;
+        const int slot = track_id == 0 ? -1 : find_slot(laps, track_id);
+
+        return slot < 0 ? NULL : laps->laps + slot;
+}
+
+static void release_buffer(void)
+{
+        portFree(g_ref_laps_buffer);
+        g_ref_laps_buffer = NULL;
+        g_ref = NULL;
+        g_uploading = false;
+}
+
+static bool upload_stale(void)
+{
+        return g_uploading && xTaskGetTickCount() - g_upload_ticks >
+                msToTicks(UPLOAD_TIMEOUT_MS);
+}
+
+/**
+ * Copies the stored laps into a buffer and picks the slot for the track:
+ * its existing one, else an empty one, else the least recently saved.
+ * Call with the lock held.
+ * @return The slot to fill in or NULL if another change is in progress.
+ */
+static struct reference_lap* begin_update(const int32_t track_id)
+{
+        if (upload_stale()) {
+                pr_info(_LOG_PFX "Dropping abandoned upload\r\n");
+                release_buffer();
+        }
+
+        if (NULL != g_ref_laps_buffer) {
+                pr_info(_LOG_PFX "Update already in progress\r\n");
+                return NULL;
+        }
+
+        g_ref_laps_buffer = portMalloc(sizeof(struct reference_laps));
+        if (NULL == g_ref_laps_buffer) {
+                pr_error(_LOG_PFX "Failed to allocate reference lap buffer\r\n");
+                return NULL;
+        }
+        memcpy(g_ref_laps_buffer, (void *) &g_ref_laps,
+               sizeof(struct reference_laps));
+
+        struct reference_lap *laps = g_ref_laps_buffer->laps;
+        int slot = find_slot(g_ref_laps_buffer, track_id);
+        if (slot < 0)
+                slot = find_slot(g_ref_laps_buffer, 0);
+
+        uint32_t serial = 0;
+        int oldest = 0;
+        for (int i = 0; i < REFERENCE_LAP_SLOTS; ++i) {
+                if (laps[i].serial < laps[oldest].serial)
+                        oldest = i;
+                if (laps[i].serial > serial)
+                        serial = laps[i].serial;
+        }
+
+        if (slot < 0)
+                slot = oldest;
+
+        g_ref = laps + slot;
+        memset(g_ref, 0, sizeof(struct reference_lap));
+        g_ref->track_id = track_id;
+        g_ref->serial = serial + 1;
+
+        return g_ref;
+}
+
+/**
+ * Flashes the buffer if asked to and gives it up.  Only its holder may
+ * call this.  The lock is not held while flashing; others just find the
+ * buffer busy.
+ */
+static bool end_update(const bool commit)
+{
+        int rc = 0;
+        if (commit) {
+                pr_info(_LOG_PFX "Flashing reference laps... ");
+                rc = flash_reference_laps(g_ref_laps_buffer);
+                pr_info(rc == 0 ? "win\r\n" : "fail\r\n");
+        }
+
+        lock();
+        release_buffer();
+        unlock();
+
+        return commit && rc == 0;
+}
+
+bool reference_lap_copy_fast_lap(const int32_t track_id)
+{
+        if (track_id == 0)
+                return false;
+
+        lock();
+        struct reference_lap *ref = begin_update(track_id);
+        const bool copied = NULL != ref && getReferenceLap(ref);
+        if (NULL != ref && !copied)
+                release_buffer();
+        unlock();
+
+        return copied;
+}
+
+bool reference_lap_flash_copy(void)
+{
+        lock();
+        const bool copied = NULL != g_ref_laps_buffer && !g_uploading;
+        unlock();
+
+        return copied && end_update(true);
+}
+
+bool reference_lap_add_samples(const int32_t track_id,
+                               const tiny_millis_t lap_time,
+                               const size_t index, const GeoPoint *points,
+                               const tiny_millis_t *times, const size_t count,
+                               const enum reference_lap_add_mode mode)
+{
+        lock();
+
+        /* A new upload drops any that was not completed */
+        if (0 == index && g_uploading)
+                release_buffer();
+
+        if (0 == index && track_id != 0 && begin_update(track_id)) {
+                g_uploading = true;
+                g_upload_ticks = xTaskGetTickCount();
+        }
+
+        if (upload_stale())
+                release_buffer();
+
+        if (!g_uploading) {
+                unlock();
+                return false;
+        }
+
+        struct reference_lap *ref = g_ref;
+        bool ok = ref->track_id == track_id && ref->count == index;
+        for (size_t i = 0; ok && i < count; ++i)
+                ok = appendReferenceLapSample(ref, points + i, times[i]);
+
+        if (!ok) {
+                pr_error(_LOG_PFX "Invalid reference lap samples\r\n");
+                release_buffer();
+                unlock();
+                return false;
+        }
+
+        g_upload_ticks = xTaskGetTickCount();
+        if (REFERENCE_LAP_ADD_MODE_COMPLETE != mode) {
+                unlock();
+                return true;
+        }
+
+        /* Still ours; nobody else takes the buffer while we flash it */
+        ref->lap_time = lap_time;
+        ok = lap_time > 0 && ref->count > 0;
+        g_uploading = false;
+        unlock();
+
+        return end_update(ok);
+}
+
+#else
+
+void initialize_reference_laps() {}
+
+int flash_default_reference_laps(void)
+{
+        return 0;
+}
+
+const struct reference_lap* reference_lap_find(const int32_t track_id)
+{
+        return NULL;
+}
+
+bool reference_lap_copy_fast_lap(const int32_t track_id)
+{
+        return false;
+}
+
+bool reference_lap_flash_copy(void)
+{
+        return false;
+}
+
+bool reference_lap_add_samples(const int32_t track_id,
+                               const tiny_millis_t lap_time,
+                               const size_t index, const GeoPoint *points,
+                               const tiny_millis_t *times, const size_t count,
+                               const enum reference_lap_add_mode mode)
+{
+        return false;
+}
+
+#endif /* REFERENCE_LAP_SLOTS > 0 */
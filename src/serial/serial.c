@@ -442,6 +442,32 @@ int serial_read_byte(struct Serial *serial, uint8_t *b, const size_t delay)
         return serial_read_c_wait(serial, (char*) b, delay);
 }
 
+/**
+ * Reads a block of bytes from a serial device.  Waits for the first byte
+ * only, then takes whatever else is already queued without blocking.
+ * @param s The Serial device to read from.
+ * @param buff The buffer to put the data into.
+ * @param len The length of the buffer.
+ * @param delay The number of ticks to wait for the first byte.
+ * @return Number of bytes read, or -1 if the device is closed.
+ */
+int serial_read_buff_wait(struct Serial *s, uint8_t *buff, const size_t len,
+                          const size_t delay)
+{
+        if (0 == len)
+                return 0;
+
+        const int res = serial_read_c_wait(s, (char*) buff, delay);
+        if (res <= 0)
+                return res;
+
+        size_t i = 1;
+        while (i < len && 1 == serial_read_c_wait(s, (char*) buff + i, 0))
+                ++i;
+
+        return i;
+}
+
 xQueueHandle serial_get_rx_queue(struct Serial *s)
 {
         return s->rx_queue;
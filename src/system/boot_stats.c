@@ -0,0 +1,80 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "boot_stats.h"
+#include "dateTime.h"
+#include "task.h"
+#include <string.h>
+
+static struct boot_phase_time g_phases[BOOT_PHASE_COUNT];
+static bool g_started[BOOT_PHASE_COUNT];
+
+void boot_stats_begin(const enum boot_phase phase)
+{
+        if (g_started[phase])
+                return;
+
+        g_phases[phase].start = getUptime();
+        g_started[phase] = true;
+}
+
+void boot_stats_end(const enum boot_phase phase)
+{
+        /* Called per sample and per fix, so keep the common case cheap */
+        if (g_phases[phase].done)
+                return;
+
+        g_phases[phase].end = getUptime();
+        g_phases[phase].done = true;
+}
+
+bool boot_stats_get(const enum boot_phase phase,
+                    struct boot_phase_time *time)
+{
+        taskENTER_CRITICAL();
+        *time = g_phases[phase];
+        taskEXIT_CRITICAL();
+
+        return time->done;
+}
+
+const char* boot_stats_phase_name(const enum boot_phase phase)
+{
+        static const char* const names[BOOT_PHASE_COUNT] = {
+                [BOOT_PHASE_SETUP] = "setup",
+                [BOOT_PHASE_GPS] = "gps",
+                [BOOT_PHASE_BLUETOOTH] = "bt",
+                [BOOT_PHASE_CELLULAR] = "cell",
+                [BOOT_PHASE_WIFI] = "wifi",
+                [BOOT_PHASE_FIRST_SAMPLE] = "firstSample",
+                [BOOT_PHASE_GPS_FIX] = "gpsFix",
+                [BOOT_PHASE_CONNECTION] = "connection",
+        };
+
+        return names[phase];
+}
+
+void boot_stats_reset(void)
+{
+        memset(g_phases, 0, sizeof(g_phases));
+        memset(g_started, 0, sizeof(g_started));
+}
@@ -0,0 +1,335 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "cpu_device.h"
+#include "mem_mang.h"
+#include "perf.h"
+#include "queue.h"
+#include "task.h"
+#include "taskUtil.h"
+#include "timers.h"
+#include <stdbool.h>
+#include <string.h>
+
+/*
+ * The run time stats clock is the core cycle counter divided down so
+ * that the 32 bit per task counters FreeRTOS keeps take tens of minutes
+ * to wrap instead of seconds.
+ */
+#define PERF_RUNTIME_SHIFT	6
+
+struct task_entry {
+        const signed char *name;
+        uint16_t stack_size;
+};
+
+struct task_runtime {
+        xTaskHandle handle;
+        unsigned long runtime;
+};
+
+struct queue_entry {
+        const char *owner;
+        const char *name;
+        xQueueHandle queue;
+        uint16_t length;
+        volatile uint16_t peak;
+        volatile uint32_t drops;
+};
+
+static const char* counter_names[] = {
+        "logOverflow",
+        "apiEventDrop",
+        "canRxDrop",
+        "serialRxDrop",
+        "loggerTickMiss",
+};
+
+static struct task_entry g_tasks[PERF_MAX_TASKS];
+
+static struct queue_entry g_queues[PERF_MAX_QUEUES];
+static volatile uint32_t g_counters[PERF_COUNTER_COUNT];
+static portTickType g_last_read;
+
+static bool task_name_equals(const signed char *a, const signed char *b)
+{
+        /* FreeRTOS truncates names to configMAX_TASK_NAME_LEN - 1 */
+        return 0 == strncmp((const char *) a, (const char *) b,
+                            configMAX_TASK_NAME_LEN - 1);
+}
+
+void perf_register_task(const signed char *name, const size_t stack_size)
+{
+        for (size_t i = 0; i < PERF_MAX_TASKS; ++i) {
+                struct task_entry *te = g_tasks + i;
+                if (NULL == te->name || task_name_equals(te->name, name)) {
+                        te->name = name;
+                        te->stack_size = stack_size;
+                        return;
+                }
+        }
+}
+
+void perf_register_queue(const char *owner, const char *name,
+                         xQueueHandle queue, const size_t length)
+{
+        if (NULL == queue)
+                return;
+
+        for (size_t i = 0; i < PERF_MAX_QUEUES; ++i) {
+                struct queue_entry *qe = g_queues + i;
+                if (queue == qe->queue)
+                        return;
+
+                if (NULL != qe->queue)
+                        continue;
+
+                qe->owner = owner;
+                qe->name = name;
+                qe->length = length;
+                qe->queue = queue;
+#if configUSE_TRACE_FACILITY == 1
+                /* Queue numbers are how the trace hooks find our entry */
+                vQueueSetQueueNumber(queue, i + 1);
+#endif
+                return;
+        }
+}
+
+void perf_count(const enum perf_counter counter)
+{
+        ++g_counters[counter];
+}
+
+uint32_t perf_counter_value(const enum perf_counter counter)
+{
+        return g_counters[counter];
+}
+
+const char* perf_counter_name(const enum perf_counter counter)
+{
+        return counter_names[counter];
+}
+
+#if configUSE_TRACE_FACILITY == 1
+#if configGENERATE_RUN_TIME_STATS == 1
+static struct task_runtime g_last_runtime[PERF_MAX_TASKS];
+#endif
+
+static uint16_t registered_stack_size(const signed char *name)
+{
+        for (size_t i = 0; i < PERF_MAX_TASKS && g_tasks[i].name; ++i) {
+                if (task_name_equals(g_tasks[i].name, name))
+                        return g_tasks[i].stack_size;
+        }
+
+        return 0;
+}
+
+/*
+ * The kernel creates the idle and timer tasks itself, so they never
+ * register.  Know them by handle; their names vary between kernel builds.
+ */
+static uint16_t kernel_stack_size(const xTaskHandle handle)
+{
+#if INCLUDE_xTaskGetIdleTaskHandle == 1
+        if (handle == xTaskGetIdleTaskHandle())
+                return configMINIMAL_STACK_SIZE;
+#endif
+#if configUSE_TIMERS == 1 && INCLUDE_xTimerGetTimerDaemonTaskHandle == 1
+        if (handle == xTimerGetTimerDaemonTaskHandle())
+                return configTIMER_TASK_STACK_DEPTH;
+#endif
+        return 0;
+}
+
+static void copy_task_name(char *dest, const signed char *name)
+{
+        strncpy(dest, (const char *) name, PERF_TASK_NAME_LEN - 1);
+        dest[PERF_TASK_NAME_LEN - 1] = '\0';
+
+        /* Most of our task names are space padded to a fixed width */
+        for (size_t len = strlen(dest); len && ' ' == dest[len - 1]; --len)
+                dest[len - 1] = '\0';
+}
+
+#if configGENERATE_RUN_TIME_STATS == 1
+static unsigned long last_runtime(const xTaskHandle handle)
+{
+        for (size_t i = 0; i < PERF_MAX_TASKS; ++i) {
+                if (handle == g_last_runtime[i].handle)
+                        return g_last_runtime[i].runtime;
+        }
+
+        return 0;
+}
+#endif
+
+static size_t read_tasks(struct perf_task *tasks, const size_t max)
+{
+        xTaskStatusType *status =
+                portMalloc(sizeof(xTaskStatusType) * PERF_MAX_TASKS);
+        if (NULL == status)
+                return 0;
+
+        const size_t count = uxTaskGetSystemState(status, PERF_MAX_TASKS,
+                                                  NULL);
+
+#if configGENERATE_RUN_TIME_STATS == 1
+        unsigned long total = 0;
+        for (size_t i = 0; i < count; ++i)
+                total += status[i].ulRunTimeCounter -
+                        last_runtime(status[i].xHandle);
+#endif
+
+        size_t filled = 0;
+        for (size_t i = 0; i < count && filled < max; ++i) {
+                const xTaskStatusType *ts = status + i;
+                struct perf_task *pt = tasks + filled++;
+
+                copy_task_name(pt->name, ts->pcTaskName);
+                pt->stack_size = registered_stack_size(ts->pcTaskName);
+                if (!pt->stack_size)
+                        pt->stack_size = kernel_stack_size(ts->xHandle);
+                pt->stack_free = ts->usStackHighWaterMark;
+                pt->cpu = 0;
+#if configGENERATE_RUN_TIME_STATS == 1
+                if (total) {
+                        const uint64_t delta = ts->ulRunTimeCounter -
+                                last_runtime(ts->xHandle);
+                        pt->cpu = delta * 1000 / total;
+                }
+#endif
+        }
+
+#if configGENERATE_RUN_TIME_STATS == 1
+        memset(g_last_runtime, 0, sizeof(g_last_runtime));
+        for (size_t i = 0; i < count; ++i) {
+                g_last_runtime[i].handle = status[i].xHandle;
+                g_last_runtime[i].runtime = status[i].ulRunTimeCounter;
+        }
+#endif
+
+        portFree(status);
+        return filled;
+}
+#endif /* configUSE_TRACE_FACILITY */
+
+uint32_t perf_get_tasks(struct perf_task *tasks, const size_t max,
+                        size_t *count)
+{
+        *count = 0;
+
+        /* Serializes readers; the window is shared between them */
+        vTaskSuspendAll();
+
+#if configUSE_TRACE_FACILITY == 1
+        *count = read_tasks(tasks, max);
+#endif
+        const portTickType now = xTaskGetTickCount();
+        const uint32_t window = ticksToMs(now - g_last_read);
+        g_last_read = now;
+
+        xTaskResumeAll();
+        return window;
+}
+
+size_t perf_get_queues(struct perf_queue *queues, const size_t max)
+{
+        size_t count = 0;
+        for (size_t i = 0; i < PERF_MAX_QUEUES && count < max; ++i) {
+                struct queue_entry *qe = g_queues + i;
+                if (NULL == qe->queue)
+                        continue;
+
+                const uint16_t depth = uxQueueMessagesWaiting(qe->queue);
+                if (depth > qe->peak)
+                        qe->peak = depth;
+
+                struct perf_queue *pq = queues + count++;
+                pq->owner = qe->owner;
+                pq->name = qe->name;
+                pq->length = qe->length;
+                pq->depth = depth;
+                pq->peak = qe->peak;
+                pq->drops = qe->drops;
+        }
+
+        return count;
+}
+
+void perf_reset(void)
+{
+        for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+                g_counters[i] = 0;
+
+        for (size_t i = 0; i < PERF_MAX_QUEUES; ++i) {
+                g_queues[i].peak = 0;
+                g_queues[i].drops = 0;
+        }
+}
+
+#if configUSE_TRACE_FACILITY == 1
+/*
+ * Called by the kernel from traceQUEUE_SEND* (see FreeRTOSConfig.h) with
+ * the queue locked, for queues that were given a number at registration.
+ */
+void perf_trace_queue_send(unsigned char queue, unsigned long depth)
+{
+        struct queue_entry *qe = g_queues + queue - 1;
+        if (depth > qe->peak)
+                qe->peak = depth;
+}
+
+void perf_trace_queue_drop(unsigned char queue)
+{
+        ++g_queues[queue - 1].drops;
+}
+#endif /* configUSE_TRACE_FACILITY */
+
+#if configGENERATE_RUN_TIME_STATS == 1
+static uint32_t g_last_cycles;
+static uint64_t g_cycles;
+
+void perf_runtime_init(void)
+{
+        cpu_device_cycle_counter_init();
+        g_last_cycles = cpu_device_cycle_count();
+}
+
+/*
+ * Called by the kernel on every context switch, so the cycle counter is
+ * folded into the 64 bit total long before it can wrap.
+ */
+unsigned long perf_runtime_counter(void)
+{
+        const unsigned portBASE_TYPE mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+        const uint32_t cycles = cpu_device_cycle_count();
+        g_cycles += cycles - g_last_cycles;
+        g_last_cycles = cycles;
+        const unsigned long counter = g_cycles >> PERF_RUNTIME_SHIFT;
+
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+        return counter;
+}
+#endif /* configGENERATE_RUN_TIME_STATS */
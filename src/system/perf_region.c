@@ -0,0 +1,119 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "cpu_device.h"
+#include "perf_region.h"
+#include "task.h"
+#include <string.h>
+
+static struct perf_region g_regions[PERF_REGION_MAX];
+
+static struct perf_region* find_region(const char *name)
+{
+        struct perf_region *region = NULL;
+
+        taskENTER_CRITICAL();
+        for (size_t i = 0; i < PERF_REGION_MAX; ++i) {
+                struct perf_region *r = g_regions + i;
+                if (NULL == r->name) {
+                        r->name = name;
+                        r->min = UINT32_MAX;
+                }
+
+                if (r->name == name || 0 == strcmp(r->name, name)) {
+                        region = r;
+                        break;
+                }
+        }
+        taskEXIT_CRITICAL();
+
+        return region;
+}
+
+uint32_t perf_region_begin(struct perf_region **region, const char *name)
+{
+        if (NULL == *region)
+                *region = find_region(name);
+
+        return cpu_device_cycle_count();
+}
+
+void perf_region_end(struct perf_region *region, const uint32_t start)
+{
+        const uint32_t cycles = cpu_device_cycle_count() - start;
+        if (region)
+                perf_region_record(region, cycles);
+}
+
+static size_t bucket(const uint32_t cycles)
+{
+        const size_t b = cycles ? 32 - __builtin_clz(cycles) : 0;
+        return b < PERF_REGION_BUCKETS ? b : PERF_REGION_BUCKETS - 1;
+}
+
+void perf_region_record(struct perf_region *region, const uint32_t cycles)
+{
+        /* Some regions are entered from more than one task */
+        taskENTER_CRITICAL();
+        ++region->count;
+        region->total += cycles;
+        if (cycles < region->min)
+                region->min = cycles;
+        if (cycles > region->max)
+                region->max = cycles;
+        ++region->hist[bucket(cycles)];
+        taskEXIT_CRITICAL();
+}
+
+bool perf_region_get(const size_t index, struct perf_region *region)
+{
+        if (index >= PERF_REGION_MAX || NULL == g_regions[index].name)
+                return false;
+
+        taskENTER_CRITICAL();
+        *region = g_regions[index];
+        taskEXIT_CRITICAL();
+
+        if (!region->count)
+                region->min = 0;
+
+        return true;
+}
+
+uint32_t perf_region_hz(void)
+{
+        return cpu_device_cycle_hz();
+}
+
+void perf_region_reset(void)
+{
+        taskENTER_CRITICAL();
+        for (size_t i = 0; i < PERF_REGION_MAX; ++i) {
+                struct perf_region *r = g_regions + i;
+                r->count = 0;
+                r->total = 0;
+                r->min = UINT32_MAX;
+                r->max = 0;
+                memset(r->hist, 0, sizeof(r->hist));
+        }
+        taskEXIT_CRITICAL();
+}
@@ -0,0 +1,284 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "cpu_device.h"
+#include "mem_mang.h"
+#include "perf.h"
+#include "task.h"
+#include "trace.h"
+#include <string.h>
+
+#if SDCARD_SUPPORT
+#include "fileWriter.h"
+#endif
+
+#define TRACE_MASK	(TRACE_BUFFER_EVENTS - 1)
+#define TRACE_NAME_LEN	32
+
+#if TRACE_BUFFER_EVENTS & TRACE_MASK
+#error "TRACE_BUFFER_EVENTS must be a power of 2"
+#endif
+
+static const char* const isr_names[TRACE_ISR_COUNT] = {
+        "USART",
+        "CAN",
+        "USB",
+};
+
+static const char* const event_names[TRACE_EVENT_COUNT] = {
+        "logger tick",
+        "sample queued",
+        "sample dropped",
+        "file write",
+        "file flush",
+};
+
+static struct trace_record *g_buffer;
+/* Slots claimed since the start; the ring index is this masked */
+static volatile uint32_t g_head;
+static volatile bool g_running;
+static enum trace_mode g_mode;
+
+bool trace_start(const enum trace_mode mode)
+{
+        if (NULL == g_buffer)
+                g_buffer = portMalloc(sizeof(struct trace_record) *
+                                      TRACE_BUFFER_EVENTS);
+        if (NULL == g_buffer)
+                return false;
+
+        g_running = false;
+        g_mode = mode;
+        g_head = 0;
+        g_running = true;
+        return true;
+}
+
+void trace_stop(void)
+{
+        g_running = false;
+}
+
+bool trace_is_running(void)
+{
+        return g_running;
+}
+
+size_t trace_count(uint32_t *lost)
+{
+        const uint32_t head = g_head;
+        const size_t count = head < TRACE_BUFFER_EVENTS ?
+                head : TRACE_BUFFER_EVENTS;
+
+        if (lost)
+                *lost = head - count;
+
+        return count;
+}
+
+void trace_record(const enum trace_type type, const uint8_t id,
+                  const uint16_t arg)
+{
+        if (!g_running)
+                return;
+
+        /* Claiming the slot atomically is what makes this ISR safe */
+        const uint32_t slot = __atomic_fetch_add(&g_head, 1,
+                                                 __ATOMIC_RELAXED);
+        /* A full buffer in once mode just counts what it refuses */
+        if (TRACE_MODE_ONCE == g_mode && slot >= TRACE_BUFFER_EVENTS)
+                return;
+
+        struct trace_record *r = g_buffer + (slot & TRACE_MASK);
+        r->cycles = cpu_device_cycle_count();
+        r->type = type;
+        r->id = id;
+        r->arg = arg;
+}
+
+void trace_task_in(const unsigned long task)
+{
+        trace_record(TRACE_TYPE_TASK_IN, 0, task);
+}
+
+void trace_task_out(const unsigned long task)
+{
+        trace_record(TRACE_TYPE_TASK_OUT, 0, task);
+}
+
+void trace_queue_send(const unsigned char queue, const unsigned long depth)
+{
+        trace_record(TRACE_TYPE_QUEUE_SEND, queue, depth);
+}
+
+void trace_queue_receive(const unsigned char queue,
+                         const unsigned long depth)
+{
+        trace_record(TRACE_TYPE_QUEUE_RECEIVE, queue, depth);
+}
+
+void trace_queue_drop(const unsigned char queue)
+{
+        trace_record(TRACE_TYPE_QUEUE_DROP, queue, 0);
+}
+
+/*
+ * The header needs the number and size of the names up front, so the
+ * names are walked twice: once to count them, once to write them.
+ */
+struct dump {
+        trace_write_func_t *write;
+        void *arg;
+        bool ok;
+        uint16_t names;
+        uint32_t size;
+#if configUSE_TRACE_FACILITY == 1
+        xTaskStatusType *tasks;
+        size_t task_count;
+#endif
+};
+
+static void dump_bytes(struct dump *d, const void *data, const size_t len)
+{
+        d->size += len;
+        if (d->ok && d->write)
+                d->ok = d->write(d->arg, data, len);
+}
+
+static void dump_name(struct dump *d, const enum trace_name_kind kind,
+                      const uint16_t id, const char *name)
+{
+        size_t len = strlen(name);
+
+        /* Most of our task names are space padded to a fixed width */
+        while (len && ' ' == name[len - 1])
+                --len;
+
+        const struct trace_name tn = {
+                .kind = kind,
+                .len = len,
+                .id = id,
+        };
+        dump_bytes(d, &tn, sizeof(tn));
+        dump_bytes(d, name, len);
+        ++d->names;
+}
+
+static void dump_names(struct dump *d)
+{
+#if configUSE_TRACE_FACILITY == 1
+        for (size_t i = 0; i < d->task_count; ++i)
+                dump_name(d, TRACE_NAME_TASK, d->tasks[i].xTaskNumber,
+                          (const char *) d->tasks[i].pcTaskName);
+#endif
+
+        struct perf_queue queues[PERF_MAX_QUEUES];
+        const size_t queue_count = perf_get_queues(queues, PERF_MAX_QUEUES);
+        for (size_t i = 0; i < queue_count; ++i) {
+                char name[TRACE_NAME_LEN];
+                strncpy(name, queues[i].owner, sizeof(name) - 1);
+                name[sizeof(name) - 1] = '\0';
+                strncat(name, " ", sizeof(name) - strlen(name) - 1);
+                strncat(name, queues[i].name, sizeof(name) - strlen(name) - 1);
+
+                /* Queue numbers follow registration order, from 1 */
+                dump_name(d, TRACE_NAME_QUEUE, i + 1, name);
+        }
+
+        for (size_t i = 0; i < TRACE_ISR_COUNT; ++i)
+                dump_name(d, TRACE_NAME_ISR, i, isr_names[i]);
+
+        for (size_t i = 0; i < TRACE_EVENT_COUNT; ++i)
+                dump_name(d, TRACE_NAME_EVENT, i, event_names[i]);
+}
+
+bool trace_dump(trace_write_func_t *write, void *arg)
+{
+        trace_stop();
+
+        uint32_t lost;
+        const size_t count = trace_count(&lost);
+
+        struct dump d;
+        memset(&d, 0, sizeof(d));
+        d.ok = true;
+
+#if configUSE_TRACE_FACILITY == 1
+        const size_t max_tasks = uxTaskGetNumberOfTasks();
+        d.tasks = portMalloc(sizeof(xTaskStatusType) * max_tasks);
+        if (d.tasks)
+                d.task_count = uxTaskGetSystemState(d.tasks, max_tasks, NULL);
+#endif
+
+        dump_names(&d);
+
+        struct trace_header header;
+        memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+        header.version = TRACE_VERSION;
+        header.record_size = sizeof(struct trace_record);
+        header.names = d.names;
+        header.size = sizeof(header) + d.size +
+                count * sizeof(struct trace_record);
+        header.hz = cpu_device_cycle_hz();
+        header.events = count;
+        header.lost = lost;
+
+        d.write = write;
+        d.arg = arg;
+        d.names = 0;
+        d.size = 0;
+        dump_bytes(&d, &header, sizeof(header));
+        dump_names(&d);
+
+        /*
+         * Oldest first.  In ring mode that is just past the newest, in
+         * once mode the buffer never wrapped.
+         */
+        const uint32_t first = TRACE_MODE_ONCE == g_mode ? 0 : g_head - count;
+        for (size_t i = 0; i < count && d.ok; ++i)
+                dump_bytes(&d, g_buffer + ((first + i) & TRACE_MASK),
+                           sizeof(struct trace_record));
+
+#if configUSE_TRACE_FACILITY == 1
+        portFree(d.tasks);
+#endif
+
+        return d.ok;
+}
+
+#if SDCARD_SUPPORT
+static bool produce_dump(log_file_sink_t *write, void *sink, void *arg)
+{
+        return trace_dump(write, sink);
+}
+
+int trace_save(const char *path)
+{
+        /* The file writer owns the card; it writes the dump for us */
+        return log_file_write(path, produce_dump, NULL);
+}
+#else
+int trace_save(const char *path)
+{
+        return -1;
+}
+#endif /* SDCARD_SUPPORT */
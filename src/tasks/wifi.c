@@ -33,6 +33,7 @@
 #include "loggerApi.h"
 #include "loggerSampleData.h"
 #include "panic.h"
+#include "perf.h"
 #include "printk.h"
 #include "rx_buff.h"
 #include "serial.h"
@@ -770,6 +771,8 @@ bool wifi_init_task(const int wifi_task_priority,
                                          sizeof(struct wifi_event));
         if (!state.event_queue)
                 goto init_failed;
+        perf_register_queue("WiFi", "events", state.event_queue,
+                            WIFI_EVENT_QUEUE_DEPTH);
 
         /* Allocate our RX buffer for incoming data */
         state.rx_msgs.rxb = rx_buff_create(RX_MAX_MSG_LEN);
@@ -785,6 +788,7 @@ bool wifi_init_task(const int wifi_task_priority,
 
         static const signed char task_name[] = THREAD_NAME;
         const size_t stack_size = STACK_SIZE;
+        perf_register_task(task_name, stack_size);
         xTaskCreate(_task, task_name, stack_size, NULL,
                     wifi_task_priority, NULL);
 
@@ -33,6 +33,7 @@
 #define US_IN_A_SEC	1000000
 
 static Filter g_timer_filter[CONFIG_TIMER_CHANNELS];
+static struct channel_filter g_timer_channel_filter[CONFIG_TIMER_CHANNELS];
 
 /**
  * Calculates the highest quiet period usable based on the timer
@@ -82,6 +83,33 @@ int timer_init(LoggerConfig *loggerConfig)
         return 1;
 }
 
+void timer_init_filters(LoggerConfig *loggerConfig, const unsigned int rate_hz)
+{
+        for (size_t i = 0; i < CONFIG_TIMER_CHANNELS; i++) {
+                TimerConfig *tc = &loggerConfig->TimerConfigs[i];
+                channel_filter_init(&g_timer_channel_filter[i], &tc->filter,
+                                    rate_hz);
+        }
+}
+
+/*
+ * Feeds the measured periods through the legacy alpha filter and then the
+ * channel filter at the filter rate.  Channels without a filter stage
+ * are left to the alpha filter that runs when the period is read.
+ */
+void timer_sample_all(void)
+{
+        for (size_t i = 0; i < CONFIG_TIMER_CHANNELS; i++) {
+                struct channel_filter *f = &g_timer_channel_filter[i];
+                if (!channel_filter_enabled(f))
+                        continue;
+
+                Filter *filter = &g_timer_filter[i];
+                update_filter(filter, timer_device_get_usec(i));
+                channel_filter_update(f, filter->current_value);
+        }
+}
+
 uint32_t timer_get_raw(size_t channel)
 {
         return timer_device_get_period(channel);
@@ -105,6 +133,10 @@ uint32_t timer_get_rpm(size_t channel)
 
 uint32_t timer_get_usec(size_t channel)
 {
+        const struct channel_filter *cf = &g_timer_channel_filter[channel];
+        if (channel_filter_enabled(cf))
+                return cf->value;
+
         Filter *filter = &g_timer_filter[channel];
         unsigned int period = timer_device_get_usec(channel);
         update_filter(filter, period);
@@ -68,6 +68,7 @@ void set_default_timer_config(TimerConfig tim_cfg[], const size_t cnt)
                 tc->timerSpeed = TIMER_MEDIUM;
                 tc->filter_period_us = TIMER_DEFAULT_FILTER;
                 tc->edge = TIMER_DEFAULT_EDGE;
+                channel_filter_reset_config(&tc->filter);
         }
 }
 
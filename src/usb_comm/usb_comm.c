@@ -25,6 +25,7 @@
 #include "loggerSampleData.h"
 #include "messaging.h"
 #include "panic.h"
+#include "perf.h"
 #include "printk.h"
 #include "rx_buff.h"
 #include "serial.h"
@@ -278,6 +279,8 @@ void startUSBCommTask(int priority)
                                              sizeof(struct usb_event));
         if (!usb_state.event_queue)
                 goto init_fail;
+        perf_register_queue("USB", "events", usb_state.event_queue,
+                            USB_EVENT_QUEUE_DEPTH);
 
         usb_state.serial = USB_CDC_get_serial();
         if (!usb_state.serial)
@@ -290,6 +293,7 @@ void startUSBCommTask(int priority)
 
         /* Make all task names 16 chars including NULL char */
         static const signed portCHAR task_name[] = "USB Comm Task  ";
+        perf_register_task(task_name, USB_COMM_STACK_SIZE);
         xTaskCreate(usb_comm_task, task_name, USB_COMM_STACK_SIZE,
                     NULL, priority, NULL);
         return;
@@ -0,0 +1,147 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "block_pool.h"
+#include "mem_mang.h"
+#include "task.h"
+
+static struct block_pool *g_pools[BLOCK_POOL_MAX_POOLS];
+
+static void register_pool(struct block_pool *pool)
+{
+        for (size_t i = 0; i < BLOCK_POOL_MAX_POOLS; ++i) {
+                if (pool == g_pools[i])
+                        return;
+
+                if (NULL == g_pools[i]) {
+                        g_pools[i] = pool;
+                        return;
+                }
+        }
+}
+
+/* Call with the scheduler locked out */
+static void carve(struct block_pool *pool, const size_t block_size)
+{
+        pool->block_size = block_size;
+        pool->capacity = block_size ? pool->storage_size / block_size : 0;
+        pool->free_list = NULL;
+        pool->peak = 0;
+
+        /* Chain the blocks through their first word, lowest address first */
+        for (size_t i = pool->capacity; i; --i) {
+                void **block = (void **) (pool->storage + (i - 1) * block_size);
+                *block = pool->free_list;
+                pool->free_list = block;
+        }
+
+        pool->formatted = true;
+        register_pool(pool);
+}
+
+bool block_pool_format(struct block_pool *pool, const size_t block_size)
+{
+        taskENTER_CRITICAL();
+        const bool idle = 0 == pool->used;
+        if (idle)
+                carve(pool, BLOCK_POOL_BLOCK_SIZE(block_size));
+        taskEXIT_CRITICAL();
+
+        return idle;
+}
+
+void* block_pool_alloc(struct block_pool *pool, const size_t size)
+{
+        void **block = NULL;
+
+        taskENTER_CRITICAL();
+        if (!pool->formatted)
+                carve(pool, pool->block_size);
+
+        if (size <= pool->block_size && pool->free_list) {
+                block = pool->free_list;
+                pool->free_list = *block;
+                if (++pool->used > pool->peak)
+                        pool->peak = pool->used;
+        } else {
+                ++pool->failures;
+        }
+        taskEXIT_CRITICAL();
+
+        return block;
+}
+
+void block_pool_free(struct block_pool *pool, void *block)
+{
+        if (NULL == block)
+                return;
+
+        taskENTER_CRITICAL();
+        *(void **) block = pool->free_list;
+        pool->free_list = block;
+        --pool->used;
+        taskEXIT_CRITICAL();
+}
+
+bool block_pool_owns(const struct block_pool *pool, const void *ptr)
+{
+        const uint8_t *p = ptr;
+        return p >= pool->storage && p < pool->storage + pool->storage_size;
+}
+
+void* block_pool_alloc_fallback(struct block_pool *pool, const size_t size)
+{
+        void *block = block_pool_alloc(pool, size);
+        return block ? block : portMalloc(size);
+}
+
+void block_pool_free_fallback(struct block_pool *pool, void *ptr)
+{
+        if (block_pool_owns(pool, ptr)) {
+                block_pool_free(pool, ptr);
+        } else {
+                portFree(ptr);
+        }
+}
+
+size_t block_pool_get_stats(struct block_pool_stats *stats, const size_t max)
+{
+        size_t count = 0;
+
+        taskENTER_CRITICAL();
+        for (size_t i = 0; i < BLOCK_POOL_MAX_POOLS && count < max; ++i) {
+                const struct block_pool *pool = g_pools[i];
+                if (NULL == pool)
+                        break;
+
+                struct block_pool_stats *bps = stats + count++;
+                bps->name = pool->name;
+                bps->block_size = pool->block_size;
+                bps->capacity = pool->capacity;
+                bps->used = pool->used;
+                bps->peak = pool->peak;
+                bps->failures = pool->failures;
+        }
+        taskEXIT_CRITICAL();
+
+        return count;
+}
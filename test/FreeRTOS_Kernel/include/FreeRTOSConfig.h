@@ -54,7 +54,7 @@ CPP_GUARD_BEGIN
 
 #define configUSE_PREEMPTION		1
 #define configUSE_IDLE_HOOK			0
-#define configUSE_TICK_HOOK			1
+#define configUSE_TICK_HOOK			0
 #define configCPU_CLOCK_TRIM_HZ		-149096
 #define configCPU_CLOCK_HZ			( ( unsigned portLONG ) 48054840 + configCPU_CLOCK_TRIM_HZ )
 #define configTICK_RATE_HZ			200
@@ -62,10 +62,14 @@ CPP_GUARD_BEGIN
 #define configMINIMAL_STACK_SIZE	( ( unsigned portSHORT ) 100 )
 //#define configTOTAL_HEAP_SIZE		( ( size_t ) 10000 ) //14200
 #define configMAX_TASK_NAME_LEN		( 16 )
-#define configUSE_TRACE_FACILITY	0
+#define configUSE_TRACE_FACILITY	1
 #define configUSE_16_BIT_TICKS		0
 #define configIDLE_SHOULD_YIELD		1
 
+/* Software timer definitions. */
+#define configUSE_TIMERS			1
+#define configTIMER_TASK_STACK_DEPTH	( configMINIMAL_STACK_SIZE * 2 )
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
@@ -80,6 +84,8 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_xTaskGetIdleTaskHandle	1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle	1
 
 CPP_GUARD_END
 
@@ -1247,6 +1247,10 @@ void vQueueAddToRegistry( xQueueHandle xQueue, signed char *pcName );
 portBASE_TYPE xQueueGenericReset( xQueueHandle xQueue, portBASE_TYPE xNewQueue ) PRIVILEGED_FUNCTION;
 #define xQueueReset( xQueue ) xQueueGenericReset( xQueue, pdFALSE )
 
+#if configUSE_TRACE_FACILITY == 1
+void vQueueSetQueueNumber( xQueueHandle xQueue, unsigned char ucQueueNumber );
+#endif
+
 
 CPP_GUARD_END
 #endif /* QUEUE_H */
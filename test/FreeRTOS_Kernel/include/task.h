@@ -112,6 +112,28 @@ typedef struct xTASK_PARAMTERS {
         xMemoryRegion xRegions[ portNUM_CONFIGURABLE_REGIONS ];
 } xTaskParameters;
 
+/* Task states returned by eTaskGetState. */
+typedef enum {
+        eRunning = 0,
+        eReady,
+        eBlocked,
+        eSuspended,
+        eDeleted
+} eTaskState;
+
+/* Used with the uxTaskGetSystemState() function to return the state of each task
+in the system. */
+typedef struct xTASK_STATUS {
+        xTaskHandle xHandle;
+        const signed char *pcTaskName;
+        unsigned portBASE_TYPE xTaskNumber;
+        eTaskState eCurrentState;
+        unsigned portBASE_TYPE uxCurrentPriority;
+        unsigned portBASE_TYPE uxBasePriority;
+        unsigned long ulRunTimeCounter;
+        unsigned short usStackHighWaterMark;
+} xTaskStatusType;
+
 /*
  * Defines the priority used by the idle task.  This must not be modified.
  *
@@ -1208,6 +1230,16 @@ void vTaskSwitchContext( void ) PRIVILEGED_FUNCTION;
  */
 xTaskHandle xTaskGetCurrentTaskHandle( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Return the handle of the idle task.
+ */
+xTaskHandle xTaskGetIdleTaskHandle( void );
+
+/*
+ * Fills in an xTaskStatusType structure for each task in the system.
+ */
+unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType *pxTaskStatusArray, const unsigned portBASE_TYPE uxArraySize, unsigned long *pulTotalRunTime );
+
 /*
  * Capture the current time status for future reference.
  */
@@ -22,6 +22,7 @@
 #define _TASK_TESTING_H_
 
 #include "FreeRTOS.h"
+#include "task.h"
 #include "cpp_guard.h"
 
 CPP_GUARD_BEGIN
@@ -32,6 +33,13 @@ void reset_ticks( void );
 
 void increment_tick( void );
 
+void set_current_task(xTaskHandle task);
+
+/**
+ * Forgets every task created, leaving only the kernel's own.
+ */
+void reset_tasks( void );
+
 CPP_GUARD_END
 
 #endif /* _TASK_TESTING_H_ */
@@ -53,6 +53,7 @@ FRESULT f_write (
         UINT* bw			/* Pointer to number of bytes written */
 )
 {
+        *bw = btw;
         return FR_OK;
 }
 
@@ -63,3 +64,45 @@ FRESULT f_lseek (
 {
         return FR_OK;
 }
+
+FRESULT f_truncate (FIL* fp)
+{
+        return FR_OK;
+}
+
+FRESULT f_unlink (const TCHAR* path)
+{
+        return FR_OK;
+}
+
+FRESULT f_stat (const TCHAR* path, FILINFO* fno)
+{
+        return FR_NO_FILE;
+}
+
+FRESULT f_mkdir (const TCHAR* path)
+{
+        return FR_OK;
+}
+
+FRESULT f_opendir (DIR* dp, const TCHAR* path)
+{
+        return FR_OK;
+}
+
+FRESULT f_closedir (DIR* dp)
+{
+        return FR_OK;
+}
+
+FRESULT f_readdir (DIR* dp, FILINFO* fno)
+{
+        fno->fname[0] = '\0';
+        return FR_OK;
+}
+
+FRESULT f_read (FIL* fp, void* buff, UINT btr, UINT* br)
+{
+        *br = 0;
+        return FR_OK;
+}
@@ -21,8 +21,10 @@
 
 
 #include "FreeRTOS.h"
+#include "mem_mang.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 void *pvPortMalloc( size_t xSize )
 {
@@ -34,3 +36,8 @@ void vPortFree( void *pv )
 {
         free(pv);
 }
+
+void vPortGetHeapStats(xHeapStats *pxHeapStats)
+{
+        memset(pxHeapStats, 0, sizeof(*pxHeapStats));
+}
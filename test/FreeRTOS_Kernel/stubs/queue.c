@@ -104,3 +104,7 @@ portBASE_TYPE xQueueGenericReset( xQueueHandle pxQueue, portBASE_TYPE xNewQueue
 {
         return pdTRUE;
 }
+
+void vQueueSetQueueNumber( xQueueHandle xQueue, unsigned char ucQueueNumber )
+{
+}
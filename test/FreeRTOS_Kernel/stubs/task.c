@@ -22,10 +22,31 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "task_testing.h"
+#include "timers.h"
 
+#include <string.h>
 #include <unistd.h>
 
+#define STUB_MAX_TASKS	32
+#define STUB_KERNEL_TASKS	2
+
+struct stub_task {
+        const signed char *name;
+        unsigned short stack_depth;
+};
+
 static portTickType ticks;
+static xTaskHandle current_task;
+
+/*
+ * Every task created so far, after the two the kernel starts for itself.
+ * Those carry the names the target kernel gives them.
+ */
+static struct stub_task tasks[STUB_MAX_TASKS] = {
+        {(const signed char *) "IDLE Task      ", configMINIMAL_STACK_SIZE},
+        {(const signed char *) "Timer Service  ", configTIMER_TASK_STACK_DEPTH},
+};
+static size_t task_count = STUB_KERNEL_TASKS;
 
 portTickType xTaskGetTickCount()
 {
@@ -47,11 +68,67 @@ void increment_tick()
         ticks++;
 }
 
+xTaskHandle xTaskGetCurrentTaskHandle()
+{
+        return current_task;
+}
+
+void set_current_task(xTaskHandle task)
+{
+        current_task = task;
+}
+
+void reset_tasks()
+{
+        task_count = STUB_KERNEL_TASKS;
+}
+
+xTaskHandle xTaskGetIdleTaskHandle()
+{
+        return tasks;
+}
+
+xTaskHandle xTimerGetTimerDaemonTaskHandle()
+{
+        return tasks + 1;
+}
+
+unsigned portBASE_TYPE uxTaskGetNumberOfTasks()
+{
+        return task_count;
+}
+
+unsigned portBASE_TYPE uxTaskGetSystemState(xTaskStatusType *status,
+                                            const unsigned portBASE_TYPE size,
+                                            unsigned long *total_runtime)
+{
+        size_t i;
+        for (i = 0; i < task_count && i < size; i++) {
+                memset(status + i, 0, sizeof(*status));
+                status[i].xHandle = tasks + i;
+                status[i].pcTaskName = tasks[i].name;
+                status[i].xTaskNumber = i + 1;
+                /* No task ever gets deeper than half its stack */
+                status[i].usStackHighWaterMark = tasks[i].stack_depth / 2;
+        }
+
+        if (total_runtime)
+                *total_runtime = 0;
+
+        return i;
+}
+
 void vTaskDelay(portTickType xTicksToDelay)
 {
         usleep((useconds_t)xTicksToDelay * 1000);
 }
 
+void vTaskDelayUntil(portTickType * const pxPreviousWakeTime,
+                     portTickType xTimeIncrement)
+{
+        *pxPreviousWakeTime += xTimeIncrement;
+}
+
 signed portBASE_TYPE xTaskGenericCreate(
         pdTASK_CODE pvTaskCode,
         const signed char * const pcName,
@@ -62,5 +139,31 @@ signed portBASE_TYPE xTaskGenericCreate(
         portSTACK_TYPE *puxStackBuffer,
         const xMemoryRegion * const xRegions )
 {
-        return 0;
+        if (task_count >= STUB_MAX_TASKS)
+                return errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+
+        struct stub_task *task = tasks + task_count++;
+        task->name = pcName;
+        task->stack_depth = usStackDepth;
+        if (pxCreatedTask)
+                *pxCreatedTask = task;
+
+        return pdPASS;
+}
+
+void vTaskSuspendAll(void)
+{
+}
+
+signed portBASE_TYPE xTaskResumeAll(void)
+{
+        return pdFALSE;
+}
+
+void vPortEnterCritical(void)
+{
+}
+
+void vPortExitCritical(void)
+{
 }
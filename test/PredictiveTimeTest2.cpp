@@ -14,6 +14,8 @@
 #include "mock_serial.h"
 #include "predictive_timer_2.h"
 #include "rcp_cpp_unit.hh"
+#include "track_frame.h"
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -178,3 +180,209 @@ void PredictiveTimeTest2::testPredictedTimeGpsFeed()
 
         }
 }
+
+/*
+ * Drives repeated identical laps of a 20km circle at a speed that swings
+ * between 20 and 60m/s every 800m, with 10Hz fixes.  Once the poll
+ * interval has settled the prediction should match the lap time closely
+ * all the way round.
+ */
+void PredictiveTimeTest2::testLongCircuitAccuracy()
+{
+        const double length = 20000;
+        const double radius = length / (2 * M_PI);
+        const GeoPoint start = {50.335, 6.947};
+        struct track_frame tf;
+        track_frame_init(&tf, &start);
+
+        GpsSnapshot snap;
+        memset(&snap, 0, sizeof(snap));
+        snap.sample.quality = GPS_QUALITY_3D;
+        snap.sample.DOP = 1;
+
+        tiny_millis_t time = 0;
+        tiny_millis_t lap_time = 0;
+        double max_err = 0;
+        double err_sum = 0;
+        size_t err_count = 0;
+
+        for (int lap = 0; lap < 6; ++lap) {
+                const tiny_millis_t lap_start = time;
+                double dist = 0;
+
+                startLap(&start, time);
+                while (dist < length) {
+                        const double v = 40 + 20 * sin(2 * M_PI * dist / 800);
+                        dist += v / 10;
+                        time += 100;
+
+                        const double a = dist / radius;
+                        const struct track_point tp = {
+                                (int32_t) lrint(radius * sin(a) * 100),
+                                (int32_t) lrint((radius - radius * cos(a)) * 100),
+                        };
+                        snap.sample.point = track_frame_unproject(&tf, &tp);
+                        snap.deltaFirstFix = time;
+
+                        if (dist >= length)
+                                break;
+
+                        addGpsSample(&snap);
+
+                        /* Score the last lap away from the start/finish */
+                        const tiny_millis_t elapsed = time - lap_start;
+                        if (lap < 5 || elapsed < 10000 ||
+                            elapsed > lap_time - 10000)
+                                continue;
+
+                        const double err = fabs((double) getPredictedTime(&snap) -
+                                                lap_time);
+                        max_err = fmax(max_err, err);
+                        err_sum += err;
+                        ++err_count;
+                }
+                finishLap(&snap);
+                lap_time = time - lap_start;
+        }
+
+        if (getenv("TRACE"))
+                printf("\rpredictive timer: %dms lap, mean error %.1fms, "
+                       "max %.0fms\r\n", lap_time, err_sum / err_count,
+                       max_err);
+
+        CPPUNIT_ASSERT(err_count > 4000);
+        CPPUNIT_ASSERT(err_sum / err_count < 100);
+        CPPUNIT_ASSERT(max_err < 500);
+}
+
+#define REF_CIRCLE_LENGTH	2000.0
+#define REF_CIRCLE_SPEED	30.0
+
+/*
+ * The point dist meters around a 2km circle starting at start.
+ */
+static GeoPoint refCirclePoint(const GeoPoint *start, const double dist)
+{
+        const double radius = REF_CIRCLE_LENGTH / (2 * M_PI);
+        const double a = dist / radius;
+        const struct track_point tp = {
+                (int32_t) lrint(radius * sin(a) * 100),
+                (int32_t) lrint((radius - radius * cos(a)) * 100),
+        };
+
+        struct track_frame tf;
+        track_frame_init(&tf, start);
+        return track_frame_unproject(&tf, &tp);
+}
+
+/*
+ * Drives the given fraction of a lap of the circle at a steady speed with
+ * 10Hz fixes, finishing the lap if it is driven in full.
+ * @return The last snapshot.
+ */
+static GpsSnapshot driveRefCircle(const GeoPoint *start,
+                                  const tiny_millis_t lapStart,
+                                  const double fraction)
+{
+        GpsSnapshot snap;
+        memset(&snap, 0, sizeof(snap));
+        snap.sample.quality = GPS_QUALITY_3D;
+        snap.sample.DOP = 1;
+
+        startLap(start, lapStart);
+        const double end = REF_CIRCLE_LENGTH * fraction;
+        for (int i = 1; i * REF_CIRCLE_SPEED / 10 <= end; ++i) {
+                snap.sample.point = refCirclePoint(start, i * REF_CIRCLE_SPEED / 10);
+                snap.deltaFirstFix = lapStart + i * 100;
+                addGpsSample(&snap);
+        }
+
+        if (fraction >= 1)
+                finishLap(&snap);
+
+        return snap;
+}
+
+/**
+ * A fast lap saved as a reference and loaded after a reset predicts
+ * exactly as it did before.
+ */
+void PredictiveTimeTest2::testReferenceLapRoundTrip()
+{
+        const GeoPoint start = {38.1615, -122.4547};
+        driveRefCircle(&start, 0, 1);
+        driveRefCircle(&start, 100000, 1);
+
+        struct reference_lap ref;
+        CPPUNIT_ASSERT(getReferenceLap(&ref));
+        CPPUNIT_ASSERT(ref.count > 10);
+        CPPUNIT_ASSERT_EQUAL(getFastLapTime(), ref.lap_time);
+
+        GpsSnapshot snap = driveRefCircle(&start, 200000, 0.5);
+        const tiny_millis_t before = getPredictedTime(&snap);
+
+        resetPredictiveTimer();
+        CPPUNIT_ASSERT(!isPredictiveTimeAvailable());
+        CPPUNIT_ASSERT(setReferenceLap(&ref));
+        CPPUNIT_ASSERT(isPredictiveTimeAvailable());
+
+        snap = driveRefCircle(&start, 200000, 0.5);
+        CPPUNIT_ASSERT(before > 0);
+        CPPUNIT_ASSERT_EQUAL(before, getPredictedTime(&snap));
+}
+
+/**
+ * A reference built from sparse uploaded samples gives predictions on the
+ * very first lap.
+ */
+void PredictiveTimeTest2::testReferenceLapUpload()
+{
+        const GeoPoint start = {38.1615, -122.4547};
+        const tiny_millis_t lapTime = REF_CIRCLE_LENGTH / REF_CIRCLE_SPEED * 1000;
+
+        struct reference_lap ref;
+        memset(&ref, 0, sizeof(ref));
+        for (int t = 0; t <= lapTime; t += 1000) {
+                const GeoPoint p = refCirclePoint(&start, REF_CIRCLE_SPEED * t / 1000);
+                CPPUNIT_ASSERT(appendReferenceLapSample(&ref, &p, t));
+        }
+        ref.lap_time = lapTime;
+
+        CPPUNIT_ASSERT(setReferenceLap(&ref));
+        const GpsSnapshot snap = driveRefCircle(&start, 0, 0.5);
+        CPPUNIT_ASSERT(abs(getPredictedTime(&snap) - lapTime) < 100);
+}
+
+/**
+ * Damaged references are never loaded.
+ */
+void PredictiveTimeTest2::testReferenceLapCorrupt()
+{
+        const GeoPoint start = {38.1615, -122.4547};
+        struct reference_lap ref;
+        memset(&ref, 0, sizeof(ref));
+        for (int i = 0; i < 10; ++i) {
+                const GeoPoint p = refCirclePoint(&start, 30 * i);
+                appendReferenceLapSample(&ref, &p, 1000 * i);
+        }
+        ref.lap_time = 10000;
+
+        struct reference_lap bad = ref;
+        bad.count++;
+        CPPUNIT_ASSERT(!setReferenceLap(&bad));
+
+        bad = ref;
+        bad.buff[bad.len - 1] |= 0x80;
+        CPPUNIT_ASSERT(!setReferenceLap(&bad));
+
+        bad = ref;
+        bad.len = PREDICTIVE_TIME_BUFFER_SIZE + 1;
+        CPPUNIT_ASSERT(!setReferenceLap(&bad));
+
+        bad = ref;
+        bad.lap_time = 0;
+        CPPUNIT_ASSERT(!setReferenceLap(&bad));
+
+        CPPUNIT_ASSERT(!isPredictiveTimeAvailable());
+        CPPUNIT_ASSERT(setReferenceLap(&ref));
+}
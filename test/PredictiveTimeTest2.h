@@ -40,6 +40,10 @@ class PredictiveTimeTest2 : public CppUnit::TestFixture
         CPPUNIT_TEST_SUITE( PredictiveTimeTest2 );
         //	CPPUNIT_TEST( testPredictedTimeGpsFeed );
         CPPUNIT_TEST( testProjectedDistance );
+        CPPUNIT_TEST( testLongCircuitAccuracy );
+        CPPUNIT_TEST( testReferenceLapRoundTrip );
+        CPPUNIT_TEST( testReferenceLapUpload );
+        CPPUNIT_TEST( testReferenceLapCorrupt );
         CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -48,6 +52,10 @@ public:
         void tearDown();
         void testPredictedTimeGpsFeed();
         void testProjectedDistance();
+        void testLongCircuitAccuracy();
+        void testReferenceLapRoundTrip();
+        void testReferenceLapUpload();
+        void testReferenceLapCorrupt();
 
 private:
         string readFile(string filename);
@@ -0,0 +1,937 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rcpbench: microbenchmarks for the firmware hot paths, run on the host.
+ *
+ * Each benchmark is calibrated until one sample takes at least the target
+ * time, then sampled a number of times; the median ns/op is reported along
+ * with the min and max.  A JSON summary of the run can be written out so
+ * numbers can be compared between builds.
+ *
+ * Absolute numbers are host numbers, not ARM ones.  What they are good for
+ * is comparing one revision of the code against another on the same box.
+ */
+
+#include "CAN.h"
+#include "can_mapping.h"
+#include "diskio_host.h"
+#include "fileWriter.h"
+#include "fileWriter_testing.h"
+#include "gps.h"
+#include "jsmn.h"
+#include "lap_stats.h"
+#include "loggerApi.h"
+#include "loggerConfig.h"
+#include "loggerHardware.h"
+#include "loggerSampleData.h"
+#include "mock_serial.h"
+#include "modp_numtoa.h"
+#include "predictive_timer_2.h"
+#include "sampleRecord.h"
+#include "sdcard.h"
+#include "serial.h"
+#include "task_testing.h"
+#include "tracks.h"
+#include "versionInfo.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <fstream>
+#include <glob.h>
+#include <sstream>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#define KPH_PER_MPH		1.609344f
+#define MAX_JSON_TOKENS		4096
+#define NUMTOA_VALUES		64
+#define CAN_MAPPING_COUNT	4
+
+struct options {
+        int samples;
+        int target_ms;
+        const char *data_dir;
+        const char *summary;
+        struct diskio_host_latency latency;
+};
+
+struct bench {
+        const char *name;
+        /* Prepares state outside of the timed region.  May be NULL */
+        bool (*setup)(void);
+        /* Runs iters operations, returning the ns spent in the timed part */
+        uint64_t (*run)(size_t iters);
+};
+
+struct bench_result {
+        const char *name;
+        double median;
+        double min;
+        double max;
+        size_t ops;
+        double bytes_per_op;
+        double sectors_per_op;
+};
+
+static const struct options *g_opts;
+
+/* Results land here so the optimizer can't drop the work */
+static volatile uintptr_t g_sink;
+
+/* Cost of one now_ns() pair, taken off of the per call timings */
+static uint64_t g_clock_overhead;
+
+/* Set by setups whose ops have a meaningful size, 0 otherwise */
+static double g_bytes_per_op;
+
+static uint64_t now_ns(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void usage(const char *name)
+{
+        fprintf(stderr,
+                "usage: %s [-r samples] [-t ms] [-d datadir] [-o summary.json]"
+                " [-l read,write,sync,jitter] [filter...]\n"
+                "  -r  samples taken per benchmark (default: 7)\n"
+                "  -t  minimum time per sample in ms (default: 20)\n"
+                "  -d  directory holding sonoma.log and json_api_files"
+                " (default: .)\n"
+                "  -o  also write a JSON summary of the results\n"
+                "  -l  SD card latency in ns: per sector read and write, per"
+                " sync\n      and the most jitter added to each (default: 0)\n"
+                "  filter  only run benchmarks whose name contains it\n",
+                name);
+}
+
+static bool read_file(const string &path, string &contents)
+{
+        std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+        if (!in.is_open())
+                return false;
+
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        contents = ss.str();
+        return true;
+}
+
+static string data_path(const char *name)
+{
+        return string(g_opts->data_dir) + "/" + name;
+}
+
+static vector<string> split(const string &s, const char delim)
+{
+        vector<string> elems;
+        std::stringstream ss(s);
+        string item;
+        while (std::getline(ss, item, delim))
+                elems.push_back(item);
+
+        return elems;
+}
+
+/*
+ * modp_ftoa / modp_dtoa
+ */
+static float g_floats[NUMTOA_VALUES];
+static double g_doubles[NUMTOA_VALUES];
+
+static bool setup_numtoa(void)
+{
+        /* A fixed spread of magnitudes and signs, like real channel data */
+        srand(42);
+        for (size_t i = 0; i < NUMTOA_VALUES; i++) {
+                const double scale = 1.0 / (1 << (i % 12)) * (i % 7 + 1) * 1000;
+                const double v = (rand() / (double) RAND_MAX - 0.5) * scale;
+                g_floats[i] = v;
+                g_doubles[i] = v * 1.000001;
+        }
+
+        return true;
+}
+
+static uint64_t run_ftoa(size_t iters)
+{
+        char buf[64];
+        const uint64_t start = now_ns();
+        for (size_t i = 0; i < iters; i++) {
+                modp_ftoa(g_floats[i % NUMTOA_VALUES], buf, 4);
+                g_sink += buf[0];
+        }
+
+        return now_ns() - start;
+}
+
+static uint64_t run_dtoa(size_t iters)
+{
+        char buf[64];
+        const uint64_t start = now_ns();
+        for (size_t i = 0; i < iters; i++) {
+                modp_dtoa(g_doubles[i % NUMTOA_VALUES], buf, 6);
+                g_sink += buf[0];
+        }
+
+        return now_ns() - start;
+}
+
+/*
+ * jsmn_parse over the API request corpus.  One op is one file.
+ */
+static vector<string> g_json_files;
+static size_t g_json_bytes;
+static vector<jsmntok_t> g_tokens(MAX_JSON_TOKENS);
+
+static bool load_json_files(void)
+{
+        /* ff.h has its own DIR, so the corpus is listed with glob() */
+        const string pattern = data_path("json_api_files") + "/*.json";
+        glob_t files;
+        if (glob(pattern.c_str(), 0, NULL, &files) != 0) {
+                fprintf(stderr, "%s: no JSON files\n", pattern.c_str());
+                return false;
+        }
+
+        for (size_t i = 0; i < files.gl_pathc; i++) {
+                string json;
+                if (!read_file(files.gl_pathv[i], json))
+                        continue;
+
+                g_json_files.push_back(json);
+                g_json_bytes += json.size();
+        }
+        globfree(&files);
+
+        return !g_json_files.empty();
+}
+
+static bool setup_jsmn(void)
+{
+        if (g_json_files.empty() && !load_json_files())
+                return false;
+
+        g_bytes_per_op = (double) g_json_bytes / g_json_files.size();
+        return true;
+}
+
+static uint64_t run_jsmn(size_t iters)
+{
+        const size_t count = g_json_files.size();
+        const uint64_t start = now_ns();
+        for (size_t i = 0; i < iters; i++) {
+                const string &json = g_json_files[i % count];
+                jsmn_parser parser;
+                jsmn_init(&parser);
+                g_sink += jsmn_parse(&parser, json.c_str(), &g_tokens[0],
+                                     g_tokens.size());
+        }
+
+        return now_ns() - start;
+}
+
+/*
+ * canmapping_map_value over a mix of the common mapping types.
+ */
+static CANMapping g_mappings[CAN_MAPPING_COUNT];
+static CAN_msg g_can_msgs[CAN_MAPPING_COUNT];
+
+static bool setup_can_mapping(void)
+{
+        memset(g_mappings, 0, sizeof(g_mappings));
+        memset(g_can_msgs, 0, sizeof(g_can_msgs));
+
+        for (size_t i = 0; i < CAN_MAPPING_COUNT; i++) {
+                CANMapping *m = g_mappings + i;
+                CAN_msg *msg = g_can_msgs + i;
+
+                m->can_id = 0x100 + i;
+                m->sub_id = -1;
+                m->multiplier = 1.0f;
+                m->divider = 1.0f;
+                msg->addressValue = m->can_id;
+                msg->dataLength = CAN_MSG_SIZE;
+                for (size_t b = 0; b < CAN_MSG_SIZE; b++)
+                        msg->data[b] = 0x11 * (b + 1) + i;
+        }
+
+        /* 16 bit unsigned, big endian RPM style */
+        g_mappings[0].offset = 2;
+        g_mappings[0].length = 2;
+        g_mappings[0].big_endian = true;
+        g_mappings[0].multiplier = 0.25f;
+
+        /* 16 bit signed, little endian with an adder */
+        g_mappings[1].type = CANMappingType_signed;
+        g_mappings[1].offset = 4;
+        g_mappings[1].length = 2;
+        g_mappings[1].adder = -40.0f;
+
+        /* 12 bits in bit mode */
+        g_mappings[2].bit_mode = true;
+        g_mappings[2].offset = 12;
+        g_mappings[2].length = 12;
+        g_mappings[2].divider = 10.0f;
+
+        /* IEEE754 float */
+        g_mappings[3].type = CANMappingType_IEEE754;
+        g_mappings[3].length = 4;
+        const float f = 12.5f;
+        memcpy(g_can_msgs[3].data, &f, sizeof(f));
+
+        return true;
+}
+
+static uint64_t run_can_mapping(size_t iters)
+{
+        float value = 0;
+        const uint64_t start = now_ns();
+        for (size_t i = 0; i < iters; i++) {
+                const size_t m = i % CAN_MAPPING_COUNT;
+                g_sink += canmapping_map_value(&value, g_can_msgs + m,
+                                               g_mappings + m);
+        }
+
+        g_sink += (uintptr_t) value;
+        return now_ns() - start;
+}
+
+/*
+ * Sample buffers.  The enabled channels of the default config are repeated
+ * until the buffer has the requested number of channels, each repeat with
+ * its own config so labels stay unique.
+ */
+static struct sample g_sample;
+static vector<ChannelConfig> g_sample_cfgs;
+
+static bool build_sample(const size_t channels)
+{
+        LoggerConfig *lc = getWorkingLoggerConfig();
+
+        struct sample base;
+        memset(&base, 0, sizeof(base));
+        const size_t base_count = get_enabled_channel_count(lc);
+        if (!init_sample_buffer(&base, base_count)) {
+                fprintf(stderr, "failed to allocate sample buffer\n");
+                return false;
+        }
+
+        free_sample_buffer(&g_sample);
+        if (!init_sample_buffer(&g_sample, channels)) {
+                free_sample_buffer(&base);
+                fprintf(stderr, "failed to allocate sample buffer\n");
+                return false;
+        }
+
+        g_sample_cfgs.resize(channels);
+        for (size_t i = 0; i < channels; i++) {
+                const ChannelSample *src = base.channel_samples + i % base_count;
+                ChannelConfig *cfg = &g_sample_cfgs[i];
+
+                *cfg = *src->cfg;
+                if (i >= base_count)
+                        snprintf(cfg->label, sizeof(cfg->label), "%.7s%zu",
+                                 src->cfg->label, i);
+
+                g_sample.channel_samples[i] = *src;
+                g_sample.channel_samples[i].cfg = cfg;
+        }
+
+        free_sample_buffer(&base);
+
+        /* Tick 0 samples every channel; the worst case for a logger tick */
+        populate_sample_buffer(&g_sample, 0);
+        return true;
+}
+
+static bool setup_sample_50(void)
+{
+        return build_sample(50);
+}
+
+static bool setup_sample_200(void)
+{
+        return build_sample(200);
+}
+
+static uint64_t run_populate(size_t iters)
+{
+        const uint64_t start = now_ns();
+        for (size_t i = 0; i < iters; i++)
+                g_sink += populate_sample_buffer(&g_sample, 0);
+
+        return now_ns() - start;
+}
+
+/*
+ * write_samples_data, through logging_sample with the file always open,
+ * on the real FatFs over a RAM disk.  Logs are rolled over outside of the
+ * timed part so the disk never fills up.
+ */
+#define BENCH_DISK_SECTORS	(64 * 1024 * 1024 / DISKIO_HOST_SECTOR_SIZE)
+#define ROWS_PER_LOG		2000
+
+static struct logging_status g_ls;
+static bool g_file_writer_started;
+
+static void stop_log(void)
+{
+        if (!g_ls.logging)
+                return;
+
+        char name[FILENAME_LEN];
+        strcpy(name, g_ls.name);
+        logging_stop(&g_ls);
+
+        /* The sidecar index shares the log's name */
+        f_unlink(name);
+        const size_t len = strlen(name);
+        if (len > 3) {
+                strcpy(name + len - 3, "idx");
+                f_unlink(name);
+        }
+}
+
+static bool start_log(void)
+{
+        stop_log();
+        memset(&g_ls, 0, sizeof(g_ls));
+        logging_start(&g_ls);
+
+        /* First row carries the header; get it out of the way */
+        LoggerMessage msg;
+        msg.type = LoggerMessageType_Sample;
+        msg.ticks = g_sample.ticks = 1;
+        msg.sample = &g_sample;
+        if (logging_sample(&g_ls, &msg) != 0) {
+                fprintf(stderr, "failed to start the log file\n");
+                return false;
+        }
+
+        return true;
+}
+
+static bool setup_file_writer(size_t channels)
+{
+        if (!build_sample(channels))
+                return false;
+
+        if (!g_file_writer_started) {
+                startFileWriterTask(1);
+                g_file_writer_started = true;
+        }
+
+        return start_log();
+}
+
+static bool setup_file_writer_50(void)
+{
+        return setup_file_writer(50);
+}
+
+static bool setup_file_writer_200(void)
+{
+        return setup_file_writer(200);
+}
+
+static uint64_t run_file_writer(size_t iters)
+{
+        LoggerMessage msg;
+        msg.type = LoggerMessageType_Sample;
+        msg.sample = &g_sample;
+
+        uint64_t elapsed = 0;
+        for (size_t done = 0; done < iters;) {
+                if (g_ls.rows_written >= ROWS_PER_LOG && !start_log())
+                        break;
+
+                const size_t rows = std::min(iters - done,
+                                             (size_t) (ROWS_PER_LOG -
+                                                       g_ls.rows_written));
+                const uint64_t start = now_ns();
+                for (size_t i = 0; i < rows; i++) {
+                        msg.ticks = g_sample.ticks = g_ls.last_sample_tick + 1;
+                        g_sink += logging_sample(&g_ls, &msg);
+                }
+                elapsed += now_ns() - start;
+                done += rows;
+        }
+
+        return elapsed;
+}
+
+/*
+ * api_send_sample_record into a serial port that discards what it is sent.
+ */
+static struct Serial *g_null_serial;
+static size_t g_null_serial_bytes;
+
+static void null_serial_post_tx(xQueueHandle q, void *arg)
+{
+        char c;
+        while (xQueueReceive(q, &c, 0))
+                g_null_serial_bytes++;
+}
+
+static bool setup_api_sample(size_t channels)
+{
+        if (!build_sample(channels))
+                return false;
+
+        if (!g_null_serial)
+                g_null_serial = serial_create("Bench", 64, 64, NULL, NULL,
+                                              null_serial_post_tx, NULL);
+        if (!g_null_serial) {
+                fprintf(stderr, "failed to create serial\n");
+                return false;
+        }
+
+        g_null_serial_bytes = 0;
+        api_send_sample_record(g_null_serial, &g_sample, 0, false);
+        g_bytes_per_op = g_null_serial_bytes;
+        return true;
+}
+
+static bool setup_api_sample_50(void)
+{
+        return setup_api_sample(50);
+}
+
+static bool setup_api_sample_200(void)
+{
+        return setup_api_sample(200);
+}
+
+static uint64_t run_api_sample(size_t iters)
+{
+        const uint64_t start = now_ns();
+        for (size_t i = 0; i < iters; i++)
+                api_send_sample_record(g_null_serial, &g_sample, i, false);
+
+        g_sink += g_null_serial_bytes;
+        return now_ns() - start;
+}
+
+/*
+ * Lap timing over sonoma.log.  Fixes are replayed in order, wrapping back
+ * to a fresh session at the end of the log.
+ */
+#define Sonoma_Track { \
+        5555, \
+        TRACK_TYPE_CIRCUIT, \
+        { \
+                { \
+                        {38.161531, -122.454724}, \
+                        {38.161825, -122.457959}, \
+                        {38.161382, -122.459771}, \
+                        {38.162606, -122.46197}, \
+                        {38.164462, -122.462384}, \
+                } \
+        } \
+}
+
+static vector<GpsSample> g_fixes;
+static size_t g_next_fix;
+static millis_t g_first_utc;
+static millis_t g_last_utc;
+
+static bool load_sonoma(void)
+{
+        if (!g_fixes.empty())
+                return true;
+
+        const string path = data_path("sonoma.log");
+        std::ifstream in(path.c_str());
+        string line;
+        if (!in.is_open() || !std::getline(in, line)) {
+                fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+                return false;
+        }
+
+        int utc = -1, lat = -1, lon = -1, speed = -1;
+        float speed_scale = 1.0f;
+        const vector<string> header = split(line, ',');
+        for (size_t i = 0; i < header.size(); i++) {
+                const vector<string> meta = split(header[i], '|');
+                if (meta.empty())
+                        continue;
+
+                if (meta[0] == "\"Utc\"") {
+                        utc = i;
+                } else if (meta[0] == "\"Latitude\"") {
+                        lat = i;
+                } else if (meta[0] == "\"Longitude\"") {
+                        lon = i;
+                } else if (meta[0] == "\"Speed\"") {
+                        speed = i;
+                        if (meta.size() > 1 && meta[1] == "\"MPH\"")
+                                speed_scale = KPH_PER_MPH;
+                }
+        }
+
+        const int last_col = std::max(std::max(utc, lat), std::max(lon, speed));
+        if (utc < 0 || lat < 0 || lon < 0 || speed < 0) {
+                fprintf(stderr, "%s: missing GPS channels\n", path.c_str());
+                return false;
+        }
+
+        while (std::getline(in, line)) {
+                if (line.empty() || line[0] == '#')
+                        continue;
+
+                const vector<string> values = split(line, ',');
+                if ((int) values.size() <= last_col || values[utc].empty() ||
+                    values[lat].empty() || values[lon].empty() ||
+                    values[speed].empty())
+                        continue;
+
+                GpsSample sample;
+                memset(&sample, 0, sizeof(sample));
+                sample.time = strtoull(values[utc].c_str(), NULL, 10);
+                sample.point.latitude = atof(values[lat].c_str());
+                sample.point.longitude = atof(values[lon].c_str());
+                sample.speed = atof(values[speed].c_str()) * speed_scale;
+                sample.quality = GPS_QUALITY_3D;
+                sample.satellites = 8;
+                sample.DOP = 1.0f;
+                g_fixes.push_back(sample);
+        }
+
+        if (g_fixes.empty()) {
+                fprintf(stderr, "%s: no GPS fixes\n", path.c_str());
+                return false;
+        }
+
+        return true;
+}
+
+static void reset_session(void)
+{
+        LoggerConfig *lc = getWorkingLoggerConfig();
+        const Track track = Sonoma_Track;
+        lc->TrackConfigs.track = track;
+        lc->TrackConfigs.auto_detect = 0;
+
+        reset_ticks();
+        GPS_init(10, getMockSerial());
+        resetPredictiveTimer();
+        lapstats_config_changed();
+
+        g_next_fix = 0;
+        g_first_utc = 0;
+        g_last_utc = 0;
+}
+
+/**
+ * Feeds the next fix through the GPS and lap stats pipeline the way the
+ * GPS task does.
+ * @return the ns spent in lapstats_processUpdate.
+ */
+static uint64_t replay_fix(void)
+{
+        if (g_next_fix == g_fixes.size())
+                reset_session();
+
+        GpsSample sample = g_fixes[g_next_fix++];
+
+        /* Logged UTC jitters; never let the tick count run backwards */
+        if (!g_first_utc)
+                g_first_utc = sample.time;
+        if (sample.time > g_last_utc) {
+                set_ticks(sample.time - g_first_utc);
+                g_last_utc = sample.time;
+        }
+
+        lapstats_process_incremental(&sample);
+        GPS_sample_update(&sample);
+        lapstats_update_distance();
+        GpsSnapshot snap = getGpsSnapshot();
+
+        const uint64_t start = now_ns();
+        lapstats_processUpdate(&snap);
+        return now_ns() - start;
+}
+
+static bool setup_lapstats(void)
+{
+        if (!load_sonoma())
+                return false;
+
+        reset_session();
+        return true;
+}
+
+static uint64_t run_lapstats(size_t iters)
+{
+        uint64_t elapsed = 0;
+        for (size_t i = 0; i < iters; i++) {
+                const uint64_t ns = replay_fix();
+                elapsed += ns > g_clock_overhead ? ns - g_clock_overhead : 0;
+        }
+
+        return elapsed;
+}
+
+/*
+ * getSplitAgainstFastLap, which is mostly the closest point search over
+ * the fast lap buffer.  The whole log is replayed first to set a fast lap.
+ */
+static bool setup_fast_lap_split(void)
+{
+        if (!load_sonoma())
+                return false;
+
+        reset_session();
+        while (g_next_fix < g_fixes.size())
+                replay_fix();
+
+        if (!isPredictiveTimeAvailable()) {
+                fprintf(stderr, "sonoma.log did not produce a fast lap\n");
+                return false;
+        }
+
+        return true;
+}
+
+static uint64_t run_fast_lap_split(size_t iters)
+{
+        const size_t count = g_fixes.size();
+        const uint64_t start = now_ns();
+        for (size_t i = 0; i < iters; i++) {
+                const GpsSample *fix = &g_fixes[i % count];
+                g_sink += getSplitAgainstFastLap(&fix->point,
+                                                 fix->time - g_first_utc);
+        }
+
+        return now_ns() - start;
+}
+
+static const struct bench benches[] = {
+        {"modp_ftoa", setup_numtoa, run_ftoa},
+        {"modp_dtoa", setup_numtoa, run_dtoa},
+        {"jsmn_parse/json_api_files", setup_jsmn, run_jsmn},
+        {"canmapping_map_value", setup_can_mapping, run_can_mapping},
+        {"populate_sample_buffer/50", setup_sample_50, run_populate},
+        {"populate_sample_buffer/200", setup_sample_200, run_populate},
+        {"write_samples_data/50", setup_file_writer_50, run_file_writer},
+        {"write_samples_data/200", setup_file_writer_200, run_file_writer},
+        {"api_send_sample_record/50", setup_api_sample_50, run_api_sample},
+        {"api_send_sample_record/200", setup_api_sample_200, run_api_sample},
+        {"getSplitAgainstFastLap", setup_fast_lap_split, run_fast_lap_split},
+        {"lapstats_processUpdate/sonoma", setup_lapstats, run_lapstats},
+};
+
+static uint64_t measure_clock_overhead(void)
+{
+        uint64_t best = UINT64_MAX;
+        for (int i = 0; i < 1000; i++) {
+                const uint64_t start = now_ns();
+                const uint64_t ns = now_ns() - start;
+                best = std::min(best, ns);
+        }
+
+        return best;
+}
+
+/**
+ * Doubles the op count until one run takes at least the target time,
+ * then takes the samples at that op count.
+ */
+static bool run_bench(const struct bench *b, struct bench_result *res)
+{
+        g_bytes_per_op = 0;
+        if (b->setup && !b->setup())
+                return false;
+
+        const uint64_t target = (uint64_t) g_opts->target_ms * 1000000ull;
+        size_t iters = 1;
+        while (b->run(iters) < target && iters < ((size_t) 1 << 40))
+                iters *= 2;
+
+        struct diskio_host_stats before, after;
+        diskio_host_get_stats(&before);
+
+        vector<double> samples;
+        for (int i = 0; i < g_opts->samples; i++)
+                samples.push_back((double) b->run(iters) / iters);
+        std::sort(samples.begin(), samples.end());
+
+        diskio_host_get_stats(&after);
+        const uint32_t sectors = after.sectors_written - before.sectors_written;
+
+        res->name = b->name;
+        res->median = samples[samples.size() / 2];
+        res->min = samples.front();
+        res->max = samples.back();
+        res->ops = iters;
+        res->bytes_per_op = g_bytes_per_op;
+        res->sectors_per_op = (double) sectors / ((double) iters * samples.size());
+        return true;
+}
+
+static void print_result(const struct bench_result *res)
+{
+        printf("%-32s %12.1f ns/op  (min %.1f, max %.1f, %zu ops)",
+               res->name, res->median, res->min, res->max, res->ops);
+        if (res->bytes_per_op > 0)
+                printf("  %.1f MB/s", res->bytes_per_op * 1000 / res->median);
+        if (res->sectors_per_op > 0)
+                printf("  %.2f sectors/op", res->sectors_per_op);
+        printf("\n");
+        fflush(stdout);
+}
+
+static bool write_summary(const char *path,
+                          const vector<bench_result> &results)
+{
+        FILE *out = fopen(path, "w");
+        if (!out) {
+                fprintf(stderr, "%s: %s\n", path, strerror(errno));
+                return false;
+        }
+
+        fprintf(out, "{\"version\":\"%s\",\"samples\":%d,\"target_ms\":%d,"
+                "\"results\":[", version_full(), g_opts->samples,
+                g_opts->target_ms);
+        for (size_t i = 0; i < results.size(); i++) {
+                const struct bench_result *res = &results[i];
+                fprintf(out, "%s\n{\"name\":\"%s\",\"ns_per_op\":%.2f,"
+                        "\"min_ns\":%.2f,\"max_ns\":%.2f,\"ops\":%zu,"
+                        "\"bytes_per_op\":%.1f,\"sectors_per_op\":%.3f}",
+                        i ? "," : "", res->name, res->median, res->min,
+                        res->max, res->ops, res->bytes_per_op,
+                        res->sectors_per_op);
+        }
+        fprintf(out, "\n]}\n");
+        fclose(out);
+
+        return true;
+}
+
+static bool selected(const char *name, int argc, char *argv[])
+{
+        if (optind >= argc)
+                return true;
+
+        for (int i = optind; i < argc; i++) {
+                if (strstr(name, argv[i]))
+                        return true;
+        }
+
+        return false;
+}
+
+int main(int argc, char* argv[])
+{
+        struct options opts;
+        opts.samples = 7;
+        opts.target_ms = 20;
+        opts.data_dir = ".";
+        opts.summary = NULL;
+        memset(&opts.latency, 0, sizeof(opts.latency));
+
+        int opt;
+        while ((opt = getopt(argc, argv, "r:t:d:o:l:h")) != -1) {
+                switch (opt) {
+                case 'r':
+                        opts.samples = atoi(optarg);
+                        break;
+                case 't':
+                        opts.target_ms = atoi(optarg);
+                        break;
+                case 'd':
+                        opts.data_dir = optarg;
+                        break;
+                case 'o':
+                        opts.summary = optarg;
+                        break;
+                case 'l':
+                        if (sscanf(optarg, "%u,%u,%u,%u",
+                                   &opts.latency.read_ns,
+                                   &opts.latency.write_ns,
+                                   &opts.latency.sync_ns,
+                                   &opts.latency.jitter_ns) < 2) {
+                                usage(argv[0]);
+                                return 1;
+                        }
+                        break;
+                default:
+                        usage(argv[0]);
+                        return 1;
+                }
+        }
+
+        if (opts.samples < 1 || opts.target_ms < 1) {
+                usage(argv[0]);
+                return 1;
+        }
+        g_opts = &opts;
+
+        InitLoggerHardware();
+        initApi();
+        initialize_logger_config();
+        setupMockSerial();
+        GPS_init(10, getMockSerial());
+        lapstats_reset(false);
+        g_clock_overhead = measure_clock_overhead();
+
+        if (!diskio_host_ram(BENCH_DISK_SECTORS) || diskio_host_format()) {
+                fprintf(stderr, "failed to set up the RAM disk\n");
+                return 1;
+        }
+        diskio_host_set_latency(&opts.latency);
+        InitFSHardware();
+
+        vector<bench_result> results;
+        int failed = 0;
+        for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+                if (!selected(benches[i].name, argc, argv))
+                        continue;
+
+                struct bench_result res;
+                if (!run_bench(&benches[i], &res)) {
+                        fprintf(stderr, "%s: setup failed\n", benches[i].name);
+                        failed++;
+                        continue;
+                }
+
+                print_result(&res);
+                results.push_back(res);
+        }
+
+        if (opts.summary && !write_summary(opts.summary, results))
+                return 1;
+
+        return failed ? 1 : 0;
+}
@@ -0,0 +1,686 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rcplap: re-runs the firmware lap timing over recorded logs on the host.
+ *
+ * The track DB (the response to a getTrackDb request) is loaded through
+ * the same addTrackDb API the app uses, then every log is replayed GPS
+ * fix by GPS fix through lap_stats and the predictive timer.  Laps,
+ * sectors and, optionally, the predicted time trace are written out per
+ * log as CSV or JSON.
+ *
+ * The firmware modules are singletons, so logs are processed in forked
+ * worker processes rather than threads.
+ */
+
+#include "gps.h"
+#include "jsmn.h"
+#include "lap_stats.h"
+#include "loggerApi.h"
+#include "loggerConfig.h"
+#include "mock_serial.h"
+#include "predictive_timer_2.h"
+#include "sector_stats.h"
+#include "task_testing.h"
+#include "tracks.h"
+
+#include <algorithm>
+#include <dirent.h>
+#include <errno.h>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#define KPH_PER_MPH	1.609344f
+#define MAX_JSON_TOKENS	4096
+
+enum output_format {
+        FORMAT_CSV,
+        FORMAT_JSON,
+};
+
+struct options {
+        enum output_format format;
+        const char *out_dir;
+        bool trace;
+        float radius;
+        int jobs;
+};
+
+struct columns {
+        int utc;
+        int latitude;
+        int longitude;
+        int speed;
+        int sats;
+        int quality;
+        int dop;
+        float speed_scale;
+};
+
+struct trace_point {
+        millis_t utc;
+        int lap;
+        float distance;
+        tiny_millis_t predicted;
+};
+
+struct lap_result {
+        struct lap_history_entry lap;
+        millis_t utc;
+};
+
+struct log_result {
+        int32_t track_id;
+        vector<lap_result> laps;
+        vector<trace_point> trace;
+};
+
+static void usage(const char *name)
+{
+        fprintf(stderr,
+                "usage: %s [-j jobs] [-f csv|json] [-o outdir] [-r radius] [-t]"
+                " trackdb.json log|dir...\n"
+                "  -j  number of logs processed in parallel (default: cores)\n"
+                "  -f  output format (default: csv)\n"
+                "  -o  output directory (default: next to each log)\n"
+                "  -r  start/finish target radius in meters\n"
+                "  -t  also write the predicted time trace\n", name);
+}
+
+static bool read_file(const string &path, string &contents)
+{
+        std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+        if (!in.is_open())
+                return false;
+
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        contents = ss.str();
+        return true;
+}
+
+static const jsmntok_t* skip_token(const jsmntok_t *tok, const jsmntok_t *end)
+{
+        const int stop = tok->end;
+        for (tok++; tok < end && tok->start < stop; tok++);
+        return tok;
+}
+
+/**
+ * Loads every track of a getTrackDb response into the track DB by
+ * replaying it as addTrackDb requests.
+ * @return the number of tracks loaded, or -1 on error.
+ */
+static int load_track_db(const string &path)
+{
+        string json;
+        if (!read_file(path, json)) {
+                fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+                return -1;
+        }
+
+        vector<jsmntok_t> toks(MAX_JSON_TOKENS);
+        jsmn_parser parser;
+        jsmn_init(&parser);
+        const int rc = jsmn_parse(&parser, json.c_str(), &toks[0], toks.size());
+        if (rc != JSMN_SUCCESS) {
+                fprintf(stderr, "%s: failed to parse track DB (%d)\n",
+                        path.c_str(), rc);
+                return -1;
+        }
+
+        const jsmntok_t *end = &toks[0] + parser.toknext;
+        const jsmntok_t *tracks = NULL;
+        for (const jsmntok_t *tok = &toks[0]; tok + 1 < end; tok++) {
+                if (tok->type == JSMN_STRING &&
+                    json.compare(tok->start, tok->end - tok->start, "tracks") == 0 &&
+                    tok[1].type == JSMN_ARRAY) {
+                        tracks = tok + 1;
+                        break;
+                }
+        }
+        if (tracks == NULL) {
+                fprintf(stderr, "%s: no tracks array found\n", path.c_str());
+                return -1;
+        }
+
+        const int count = tracks->size;
+        if (count == 0 || count > MAX_TRACK_COUNT) {
+                fprintf(stderr, "%s: unsupported track count %d\n",
+                        path.c_str(), count);
+                return -1;
+        }
+
+        const jsmntok_t *track = tracks + 1;
+        for (int i = 0; i < count; i++) {
+                const int mode = i == count - 1 ?
+                        TRACK_ADD_MODE_COMPLETE : TRACK_ADD_MODE_IN_PROGRESS;
+                std::ostringstream msg;
+                msg << "{\"addTrackDb\":{\"index\":" << i << ",\"mode\":"
+                    << mode << ",\"track\":"
+                    << json.substr(track->start, track->end - track->start)
+                    << "}}";
+                string req = msg.str();
+
+                mock_resetTxBuffer();
+                process_api(getMockSerial(), &req[0], req.size());
+                if (strstr(mock_getTxBuffer(), "\"rc\":1") == NULL) {
+                        fprintf(stderr, "%s: track %d rejected: %s\n",
+                                path.c_str(), i, mock_getTxBuffer());
+                        return -1;
+                }
+                track = skip_token(track, end);
+        }
+
+        return count;
+}
+
+static vector<string> split(const string &s, const char delim)
+{
+        vector<string> elems;
+        std::stringstream ss(s);
+        string item;
+        while (std::getline(ss, item, delim))
+                elems.push_back(item);
+
+        return elems;
+}
+
+/**
+ * Maps the channels we need onto log columns using the header line,
+ * whose cells are "Name"|"units"|min|max|sampleRate.
+ */
+static bool parse_header(const string &line, struct columns *cols)
+{
+        memset(cols, 0, sizeof(*cols));
+        cols->utc = cols->latitude = cols->longitude = cols->speed = -1;
+        cols->sats = cols->quality = cols->dop = -1;
+        cols->speed_scale = 1.0f;
+
+        const vector<string> cells = split(line, ',');
+        for (size_t i = 0; i < cells.size(); i++) {
+                const vector<string> meta = split(cells[i], '|');
+                if (meta.empty())
+                        continue;
+
+                const string &name = meta[0];
+                if (name == "\"Utc\"") {
+                        cols->utc = i;
+                } else if (name == "\"Latitude\"") {
+                        cols->latitude = i;
+                } else if (name == "\"Longitude\"") {
+                        cols->longitude = i;
+                } else if (name == "\"Speed\"") {
+                        cols->speed = i;
+                        if (meta.size() > 1 && meta[1] == "\"MPH\"")
+                                cols->speed_scale = KPH_PER_MPH;
+                } else if (name == "\"GPSSats\"") {
+                        cols->sats = i;
+                } else if (name == "\"GPSQual\"") {
+                        cols->quality = i;
+                } else if (name == "\"GPSDOP\"") {
+                        cols->dop = i;
+                }
+        }
+
+        return cols->utc >= 0 && cols->latitude >= 0 &&
+                cols->longitude >= 0 && cols->speed >= 0;
+}
+
+static const char* cell(const vector<string> &values, const int col)
+{
+        if (col < 0 || (size_t) col >= values.size() || values[col].empty())
+                return NULL;
+
+        return values[col].c_str();
+}
+
+static void reset_firmware_state(const struct options *opts)
+{
+        TrackConfig *track_cfg = &getWorkingLoggerConfig()->TrackConfigs;
+        track_cfg->auto_detect = 1;
+        if (opts->radius > 0)
+                track_cfg->radius = opts->radius;
+
+        reset_ticks();
+        GPS_init(10, getMockSerial());
+        resetPredictiveTimer();
+        lapstats_config_changed();
+}
+
+static bool replay_log(const string &path, const struct options *opts,
+                       struct log_result *result)
+{
+        std::ifstream in(path.c_str());
+        if (!in.is_open()) {
+                fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+                return false;
+        }
+
+        string line;
+        struct columns cols;
+        if (!std::getline(in, line) || !parse_header(line, &cols)) {
+                fprintf(stderr, "%s: missing Utc/Latitude/Longitude/Speed "
+                        "channels\n", path.c_str());
+                return false;
+        }
+
+        reset_firmware_state(opts);
+        result->track_id = 0;
+
+        millis_t first_utc = 0;
+        millis_t last_utc = 0;
+        int last_lap_count = 0;
+
+        while (std::getline(in, line)) {
+                if (line.empty() || line[0] == '#')
+                        continue;
+
+                const vector<string> values = split(line, ',');
+                const char *utc = cell(values, cols.utc);
+                const char *lat = cell(values, cols.latitude);
+                const char *lon = cell(values, cols.longitude);
+                const char *speed = cell(values, cols.speed);
+                if (!utc || !lat || !lon || !speed)
+                        continue;
+
+                GpsSample sample;
+                memset(&sample, 0, sizeof(sample));
+                sample.time = strtoull(utc, NULL, 10);
+                sample.point.latitude = atof(lat);
+                sample.point.longitude = atof(lon);
+                sample.speed = atof(speed) * cols.speed_scale;
+
+                const char *quality = cell(values, cols.quality);
+                sample.quality = quality ? (enum GpsSignalQuality) atoi(quality) :
+                        GPS_QUALITY_3D;
+                const char *sats = cell(values, cols.sats);
+                sample.satellites = sats ? atoi(sats) : 8;
+                const char *dop = cell(values, cols.dop);
+                sample.DOP = dop ? atof(dop) : 1.0f;
+
+                /* Logged UTC jitters; never let the tick count run backwards */
+                if (!first_utc)
+                        first_utc = sample.time;
+                if (sample.time > last_utc) {
+                        set_ticks(sample.time - first_utc);
+                        last_utc = sample.time;
+                }
+
+                lapstats_process_incremental(&sample);
+                GPS_sample_update(&sample);
+                lapstats_update_distance();
+                GpsSnapshot snap = getGpsSnapshot();
+                lapstats_processUpdate(&snap);
+
+                if (!result->track_id && lapstats_is_track_valid())
+                        result->track_id = lapstats_get_selected_track_id();
+
+                const int lap_count = getLapCount();
+                if (lap_count != last_lap_count) {
+                        const struct lap_history_entry *lap =
+                                sector_stats_history_lap(0);
+                        if (lap) {
+                                struct lap_result lr;
+                                lr.lap = *lap;
+                                lr.utc = sample.time;
+                                result->laps.push_back(lr);
+                        }
+                        last_lap_count = lap_count;
+                }
+
+                if (opts->trace && lapstats_lap_in_progress()) {
+                        struct trace_point tp;
+                        tp.utc = sample.time;
+                        tp.lap = lapstats_current_lap();
+                        tp.distance = getLapDistance();
+                        tp.predicted = getPredictedTime(&snap);
+                        result->trace.push_back(tp);
+                }
+        }
+
+        return true;
+}
+
+static string output_path(const string &log, const struct options *opts,
+                          const char *suffix)
+{
+        string base = log;
+        const size_t dot = base.rfind('.');
+        const size_t slash = base.rfind('/');
+        if (dot != string::npos && (slash == string::npos || dot > slash))
+                base.erase(dot);
+
+        if (opts->out_dir) {
+                const size_t sep = base.rfind('/');
+                if (sep != string::npos)
+                        base.erase(0, sep + 1);
+                base = string(opts->out_dir) + "/" + base;
+        }
+
+        return base + suffix;
+}
+
+static int max_sectors(const struct log_result *result)
+{
+        int sectors = 0;
+        for (size_t i = 0; i < result->laps.size(); i++) {
+                if (result->laps[i].lap.sector_count > sectors)
+                        sectors = result->laps[i].lap.sector_count;
+        }
+
+        return sectors;
+}
+
+static void write_csv(FILE *out, const struct log_result *result)
+{
+        const int sectors = max_sectors(result);
+
+        fprintf(out, "track,lap,utc,time");
+        for (int i = 0; i < sectors; i++)
+                fprintf(out, ",sector%d", i + 1);
+        fprintf(out, "\n");
+
+        for (size_t i = 0; i < result->laps.size(); i++) {
+                const struct lap_result *lr = &result->laps[i];
+                fprintf(out, "%d,%d,%llu,%d", (int) result->track_id,
+                        lr->lap.lap, (unsigned long long) lr->utc,
+                        (int) lr->lap.lap_time);
+                for (int s = 0; s < sectors; s++) {
+                        if (s < lr->lap.sector_count)
+                                fprintf(out, ",%d", (int) lr->lap.sectors[s]);
+                        else
+                                fprintf(out, ",");
+                }
+                fprintf(out, "\n");
+        }
+}
+
+static void write_trace_csv(FILE *out, const struct log_result *result)
+{
+        fprintf(out, "utc,lap,distance,predicted\n");
+        for (size_t i = 0; i < result->trace.size(); i++) {
+                const struct trace_point *tp = &result->trace[i];
+                fprintf(out, "%llu,%d,%.4f,%d\n",
+                        (unsigned long long) tp->utc, tp->lap, tp->distance,
+                        (int) tp->predicted);
+        }
+}
+
+static void write_json(FILE *out, const string &log,
+                       const struct log_result *result)
+{
+        tiny_millis_t best = 0;
+        for (size_t i = 0; i < result->laps.size(); i++) {
+                const tiny_millis_t t = result->laps[i].lap.lap_time;
+                if (t > 0 && (!best || t < best))
+                        best = t;
+        }
+
+        fprintf(out, "{\"log\":\"%s\",\"track\":%d,\"best\":%d,\"laps\":[",
+                log.c_str(), (int) result->track_id, (int) best);
+        for (size_t i = 0; i < result->laps.size(); i++) {
+                const struct lap_result *lr = &result->laps[i];
+                fprintf(out, "%s{\"lap\":%d,\"utc\":%llu,\"time\":%d,\"sectors\":[",
+                        i ? "," : "", lr->lap.lap,
+                        (unsigned long long) lr->utc, (int) lr->lap.lap_time);
+                for (int s = 0; s < lr->lap.sector_count; s++)
+                        fprintf(out, "%s%d", s ? "," : "",
+                                (int) lr->lap.sectors[s]);
+                fprintf(out, "]}");
+        }
+        fprintf(out, "]");
+
+        if (!result->trace.empty()) {
+                fprintf(out, ",\"trace\":[");
+                for (size_t i = 0; i < result->trace.size(); i++) {
+                        const struct trace_point *tp = &result->trace[i];
+                        fprintf(out, "%s[%llu,%d,%.4f,%d]", i ? "," : "",
+                                (unsigned long long) tp->utc, tp->lap,
+                                tp->distance, (int) tp->predicted);
+                }
+                fprintf(out, "]");
+        }
+        fprintf(out, "}\n");
+}
+
+static bool write_results(const string &log, const struct options *opts,
+                          const struct log_result *result)
+{
+        const bool json = opts->format == FORMAT_JSON;
+        const string path = output_path(log, opts, json ?
+                                        ".laps.json" : ".laps.csv");
+        FILE *out = fopen(path.c_str(), "w");
+        if (!out) {
+                fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+                return false;
+        }
+
+        if (json)
+                write_json(out, log, result);
+        else
+                write_csv(out, result);
+        fclose(out);
+
+        if (json || !opts->trace)
+                return true;
+
+        const string trace_path = output_path(log, opts, ".trace.csv");
+        out = fopen(trace_path.c_str(), "w");
+        if (!out) {
+                fprintf(stderr, "%s: %s\n", trace_path.c_str(), strerror(errno));
+                return false;
+        }
+        write_trace_csv(out, result);
+        fclose(out);
+
+        return true;
+}
+
+static int process_log(const string &log, const struct options *opts)
+{
+        struct log_result result;
+        if (!replay_log(log, opts, &result) ||
+            !write_results(log, opts, &result))
+                return 1;
+
+        const tiny_millis_t optimal = sector_stats_optimal_lap();
+        printf("%s: track %d, %zu laps, optimal %d ms\n", log.c_str(),
+               (int) result.track_id, result.laps.size(), (int) optimal);
+        fflush(stdout);
+        return 0;
+}
+
+static bool is_log_output(const string &name)
+{
+        const char *suffixes[] = {".laps.csv", ".laps.json", ".trace.csv"};
+        for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++) {
+                const size_t len = strlen(suffixes[i]);
+                if (name.size() >= len &&
+                    name.compare(name.size() - len, len, suffixes[i]) == 0)
+                        return true;
+        }
+
+        return false;
+}
+
+static void collect_logs(const char *path, vector<string> &logs)
+{
+        struct stat st;
+        if (stat(path, &st) != 0) {
+                fprintf(stderr, "%s: %s\n", path, strerror(errno));
+                return;
+        }
+
+        if (!S_ISDIR(st.st_mode)) {
+                logs.push_back(path);
+                return;
+        }
+
+        DIR *dir = opendir(path);
+        if (!dir) {
+                fprintf(stderr, "%s: %s\n", path, strerror(errno));
+                return;
+        }
+
+        vector<string> found;
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != NULL) {
+                const string name = ent->d_name;
+                if (name[0] == '.' || is_log_output(name))
+                        continue;
+
+                const size_t len = name.size();
+                if ((len > 4 && name.compare(len - 4, 4, ".log") == 0) ||
+                    (len > 4 && name.compare(len - 4, 4, ".csv") == 0))
+                        found.push_back(string(path) + "/" + name);
+        }
+        closedir(dir);
+
+        std::sort(found.begin(), found.end());
+        logs.insert(logs.end(), found.begin(), found.end());
+}
+
+/**
+ * Runs each log in its own forked process, keeping at most opts->jobs
+ * of them alive at once.
+ * @return the number of logs that failed.
+ */
+static int run_jobs(const vector<string> &logs, const struct options *opts)
+{
+        size_t next = 0;
+        int running = 0;
+        int failed = 0;
+
+        while (next < logs.size() || running > 0) {
+                if (next < logs.size() && running < opts->jobs) {
+                        const pid_t pid = fork();
+                        if (pid == 0)
+                                _exit(process_log(logs[next], opts));
+
+                        if (pid < 0) {
+                                perror("fork");
+                                failed++;
+                        } else {
+                                running++;
+                        }
+                        next++;
+                        continue;
+                }
+
+                int status;
+                if (wait(&status) < 0)
+                        break;
+
+                running--;
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                        failed++;
+        }
+
+        return failed;
+}
+
+int main(int argc, char* argv[])
+{
+        struct options opts;
+        opts.format = FORMAT_CSV;
+        opts.out_dir = NULL;
+        opts.trace = false;
+        opts.radius = 0;
+        opts.jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+        int opt;
+        while ((opt = getopt(argc, argv, "j:f:o:r:th")) != -1) {
+                switch (opt) {
+                case 'j':
+                        opts.jobs = atoi(optarg);
+                        break;
+                case 'f':
+                        if (strcmp(optarg, "json") == 0) {
+                                opts.format = FORMAT_JSON;
+                        } else if (strcmp(optarg, "csv") == 0) {
+                                opts.format = FORMAT_CSV;
+                        } else {
+                                usage(argv[0]);
+                                return 1;
+                        }
+                        break;
+                case 'o':
+                        opts.out_dir = optarg;
+                        break;
+                case 'r':
+                        opts.radius = atof(optarg);
+                        break;
+                case 't':
+                        opts.trace = true;
+                        break;
+                default:
+                        usage(argv[0]);
+                        return 1;
+                }
+        }
+
+        if (argc - optind < 2) {
+                usage(argv[0]);
+                return 1;
+        }
+        if (opts.jobs < 1)
+                opts.jobs = 1;
+
+        initApi();
+        initialize_logger_config();
+        setupMockSerial();
+
+        if (load_track_db(argv[optind]) < 0)
+                return 1;
+
+        vector<string> logs;
+        for (int i = optind + 1; i < argc; i++)
+                collect_logs(argv[i], logs);
+
+        if (logs.empty()) {
+                fprintf(stderr, "no logs to process\n");
+                return 1;
+        }
+
+        if (opts.out_dir && mkdir(opts.out_dir, 0755) != 0 && errno != EEXIST) {
+                fprintf(stderr, "%s: %s\n", opts.out_dir, strerror(errno));
+                return 1;
+        }
+
+        const int failed = run_jobs(logs, &opts);
+        if (failed)
+                fprintf(stderr, "%d of %zu logs failed\n", failed, logs.size());
+
+        return failed ? 1 : 0;
+}
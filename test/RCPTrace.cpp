@@ -0,0 +1,571 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rcptrace: turns a binary dump from the firmware event trace recorder
+ * (see trace.h) into Chrome trace JSON, which both chrome://tracing and
+ * ui.perfetto.dev open.
+ *
+ * The dump comes from a file (the "trace save" command, or anything
+ * captured from "trace dump" with the leading console text left in) or
+ * straight from a unit over its USB or serial port.
+ *
+ * The timeline has one track showing which task holds the CPU, a track
+ * per ISR source, and a track per task for the logger events raised from
+ * it.  Queue depths are counters.
+ */
+
+#include "trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+#define PORT_TIMEOUT_MS	3000
+
+#define TID_CPU		0
+#define TID_UNKNOWN	1
+#define TID_TASK_BASE	2
+#define TID_ISR_BASE	100000
+
+struct options {
+        const char *port;
+        const char *out;
+        const char *raw;
+};
+
+struct names {
+        map<unsigned, string> tasks;
+        map<unsigned, string> queues;
+        map<unsigned, string> isrs;
+        map<unsigned, string> events;
+};
+
+struct open_slice {
+        double start;
+        unsigned id;
+        unsigned arg;
+};
+
+static void usage(const char *name)
+{
+        fprintf(stderr,
+                "usage: %s [-o out.json] trace.bin\n"
+                "       %s -p port [-r raw.bin] [-o out.json]\n"
+                "  -o  output file (default: stdout)\n"
+                "  -p  fetch the trace from a unit with \"trace dump\" over"
+                " its\n      USB or serial port\n"
+                "  -r  also keep the raw dump fetched with -p\n",
+                name, name);
+}
+
+static bool read_file(const char *path, string &contents)
+{
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        if (!in.is_open())
+                return false;
+
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        contents = ss.str();
+        return true;
+}
+
+static bool write_file(const char *path, const string &contents)
+{
+        std::ofstream out(path, std::ios::out | std::ios::binary);
+        out << contents;
+        return out.good();
+}
+
+static bool wait_readable(const int fd)
+{
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(fd, &fds);
+        struct timeval tv = {
+                PORT_TIMEOUT_MS / 1000,
+                (PORT_TIMEOUT_MS % 1000) * 1000,
+        };
+        return select(fd + 1, &fds, NULL, NULL, &tv) > 0;
+}
+
+/*
+ * Reads until the header has been seen and the whole dump it announces
+ * has arrived, or the port goes quiet.
+ */
+static bool fetch(const char *port, string &raw)
+{
+        const int fd = open(port, O_RDWR | O_NOCTTY);
+        if (fd < 0) {
+                fprintf(stderr, "%s: %s\n", port, strerror(errno));
+                return false;
+        }
+
+        struct termios tio;
+        if (0 == tcgetattr(fd, &tio)) {
+                cfmakeraw(&tio);
+                tcsetattr(fd, TCSANOW, &tio);
+        }
+        tcflush(fd, TCIOFLUSH);
+
+        const char cmd[] = "trace dump\r";
+        if (write(fd, cmd, sizeof(cmd) - 1) != sizeof(cmd) - 1) {
+                fprintf(stderr, "%s: %s\n", port, strerror(errno));
+                close(fd);
+                return false;
+        }
+
+        size_t want = 0;
+        while (wait_readable(fd)) {
+                char buf[4096];
+                const ssize_t rd = read(fd, buf, sizeof(buf));
+                if (rd <= 0)
+                        break;
+                raw.append(buf, rd);
+
+                const size_t start = raw.find(TRACE_MAGIC);
+                if (!want && string::npos != start &&
+                    raw.size() - start >= sizeof(struct trace_header)) {
+                        struct trace_header h;
+                        memcpy(&h, raw.data() + start, sizeof(h));
+                        want = start + h.size;
+                }
+                if (want && raw.size() >= want)
+                        break;
+        }
+
+        close(fd);
+        if (!want || raw.size() < want) {
+                fprintf(stderr, "%s: no complete trace received\n", port);
+                return false;
+        }
+
+        return true;
+}
+
+static string escape(const string &s)
+{
+        string out;
+        for (size_t i = 0; i < s.size(); ++i) {
+                const char c = s[i];
+                if ('"' == c || '\\' == c)
+                        out += '\\';
+                if ((unsigned char) c >= ' ')
+                        out += c;
+        }
+        return out;
+}
+
+static string lookup(const map<unsigned, string> &m, const unsigned id,
+                     const char *kind)
+{
+        map<unsigned, string>::const_iterator it = m.find(id);
+        if (it != m.end())
+                return it->second;
+
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%s %u", kind, id);
+        return buf;
+}
+
+class Timeline {
+public:
+        Timeline(FILE *out, const struct names &names)
+                : out(out), names(names), first(true), task(-1) {}
+
+        void meta(const struct trace_header &h)
+        {
+                emit("{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\","
+                     "\"args\":{\"name\":\"RaceCapture\"}}");
+                thread(TID_CPU, "CPU", 0);
+
+                char buf[128];
+                snprintf(buf, sizeof(buf),
+                         "{\"ph\":\"M\",\"pid\":1,\"name\":\"trace_info\","
+                         "\"args\":{\"hz\":%u,\"events\":%u,\"lost\":%u}}",
+                         h.hz, h.events, h.lost);
+                emit(buf);
+        }
+
+        void event(const double ts, const struct trace_record &r)
+        {
+                last = ts;
+                switch (r.type) {
+                case TRACE_TYPE_TASK_IN:
+                        task = r.arg;
+                        running[task] = ts;
+                        break;
+                case TRACE_TYPE_TASK_OUT:
+                        task_out(ts, r.arg);
+                        break;
+                case TRACE_TYPE_QUEUE_SEND:
+                case TRACE_TYPE_QUEUE_RECEIVE:
+                        counter(ts, r.id, r.arg);
+                        break;
+                case TRACE_TYPE_QUEUE_DROP:
+                        instant(ts, context(), "drop " +
+                                lookup(names.queues, r.id, "queue"), 0);
+                        break;
+                case TRACE_TYPE_ISR_ENTER:
+                        isrs.push_back((struct open_slice) {ts, r.id, r.arg});
+                        break;
+                case TRACE_TYPE_ISR_EXIT:
+                        isr_exit(ts, r.id, r.arg);
+                        break;
+                case TRACE_TYPE_BEGIN:
+                        slices[context()].push_back(
+                                (struct open_slice) {ts, r.id, r.arg});
+                        break;
+                case TRACE_TYPE_END:
+                        end(ts, r.id);
+                        break;
+                case TRACE_TYPE_MARK:
+                        instant(ts, context(),
+                                lookup(names.events, r.id, "event"), r.arg);
+                        break;
+                }
+        }
+
+        /* Closes whatever was still open when the trace stopped */
+        void finish()
+        {
+                if (task >= 0)
+                        task_out(last, task);
+
+                map<unsigned, vector<struct open_slice> >::iterator it;
+                for (it = slices.begin(); it != slices.end(); ++it) {
+                        while (!it->second.empty()) {
+                                const struct open_slice s = it->second.back();
+                                it->second.pop_back();
+                                slice(it->first,
+                                      lookup(names.events, s.id, "event"),
+                                      s.start, last, s.arg);
+                        }
+                }
+        }
+
+private:
+        FILE *out;
+        const struct names &names;
+        bool first;
+        long task;
+        double last;
+        map<unsigned, double> running;
+        vector<struct open_slice> isrs;
+        map<unsigned, vector<struct open_slice> > slices;
+        map<unsigned, bool> threads;
+
+        void emit(const string &json)
+        {
+                fprintf(out, "%s\n%s", first ? "" : ",", json.c_str());
+                first = false;
+        }
+
+        void thread(const unsigned tid, const string &name,
+                    const unsigned order)
+        {
+                if (threads[tid])
+                        return;
+                threads[tid] = true;
+
+                char buf[128];
+                snprintf(buf, sizeof(buf), "{\"ph\":\"M\",\"pid\":1,"
+                         "\"tid\":%u,\"name\":\"thread_name\",", tid);
+                emit(string(buf) + "\"args\":{\"name\":\"" + escape(name) +
+                     "\"}}");
+                snprintf(buf, sizeof(buf), "{\"ph\":\"M\",\"pid\":1,"
+                         "\"tid\":%u,\"name\":\"thread_sort_index\","
+                         "\"args\":{\"sort_index\":%u}}", tid, order);
+                emit(buf);
+        }
+
+        static unsigned isr_tid(const unsigned isr, const unsigned n)
+        {
+                return TID_ISR_BASE + isr * 256 + n;
+        }
+
+        string isr_name(const unsigned isr, const unsigned n)
+        {
+                char buf[16];
+                snprintf(buf, sizeof(buf), " %u", n);
+                return lookup(names.isrs, isr, "ISR") + buf;
+        }
+
+        unsigned task_tid(const unsigned t)
+        {
+                const unsigned tid = TID_TASK_BASE + t;
+                thread(tid, lookup(names.tasks, t, "task"), tid);
+                return tid;
+        }
+
+        /* Where events raised now belong: the ISR or the running task */
+        unsigned context()
+        {
+                if (!isrs.empty()) {
+                        const struct open_slice &s = isrs.back();
+                        const unsigned tid = isr_tid(s.id, s.arg);
+                        thread(tid, isr_name(s.id, s.arg), tid);
+                        return tid;
+                }
+
+                if (task >= 0)
+                        return task_tid(task);
+
+                thread(TID_UNKNOWN, "Unknown task", TID_UNKNOWN);
+                return TID_UNKNOWN;
+        }
+
+        void slice(const unsigned tid, const string &name, const double start,
+                   const double stop, const unsigned arg)
+        {
+                char buf[128];
+                snprintf(buf, sizeof(buf), "{\"ph\":\"X\",\"pid\":1,"
+                         "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,", tid, start,
+                         stop - start);
+                snprintf(buf + strlen(buf), sizeof(buf) - strlen(buf),
+                         "\"args\":{\"arg\":%u},", arg);
+                emit(string(buf) + "\"name\":\"" + escape(name) + "\"}");
+        }
+
+        void instant(const double ts, const unsigned tid, const string &name,
+                     const unsigned arg)
+        {
+                char buf[128];
+                snprintf(buf, sizeof(buf), "{\"ph\":\"i\",\"s\":\"t\","
+                         "\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+                         "\"args\":{\"arg\":%u},", tid, ts, arg);
+                emit(string(buf) + "\"name\":\"" + escape(name) + "\"}");
+        }
+
+        void counter(const double ts, const unsigned queue,
+                     const unsigned depth)
+        {
+                char buf[96];
+                snprintf(buf, sizeof(buf), "{\"ph\":\"C\",\"pid\":1,"
+                         "\"ts\":%.3f,\"args\":{\"depth\":%u},", ts, depth);
+                emit(string(buf) + "\"name\":\"" +
+                     escape(lookup(names.queues, queue, "queue")) + "\"}");
+        }
+
+        void task_out(const double ts, const unsigned t)
+        {
+                /* A ring dump can start part way through a time slice */
+                map<unsigned, double>::iterator it = running.find(t);
+                if (it != running.end()) {
+                        task_tid(t);
+                        slice(TID_CPU, lookup(names.tasks, t, "task"),
+                              it->second, ts, t);
+                        running.erase(it);
+                }
+
+                if (task == (long) t)
+                        task = -1;
+        }
+
+        void isr_exit(const double ts, const unsigned isr, const unsigned n)
+        {
+                if (isrs.empty())
+                        return;
+
+                const struct open_slice s = isrs.back();
+                isrs.pop_back();
+                if (s.id != isr || s.arg != n)
+                        return;
+
+                const unsigned tid = isr_tid(isr, n);
+                thread(tid, isr_name(isr, n), tid);
+                slice(tid, isr_name(isr, n), s.start, ts, n);
+        }
+
+        void end(const double ts, const unsigned id)
+        {
+                const unsigned tid = context();
+                vector<struct open_slice> &open = slices[tid];
+                for (size_t i = open.size(); i--;) {
+                        if (open[i].id != id)
+                                continue;
+
+                        const struct open_slice s = open[i];
+                        open.erase(open.begin() + i);
+                        slice(tid, lookup(names.events, id, "event"),
+                              s.start, ts, s.arg);
+                        return;
+                }
+        }
+};
+
+static bool convert(const string &raw, FILE *out)
+{
+        const size_t start = raw.find(TRACE_MAGIC);
+        if (string::npos == start ||
+            raw.size() - start < sizeof(struct trace_header)) {
+                fprintf(stderr, "no trace found\n");
+                return false;
+        }
+
+        struct trace_header h;
+        memcpy(&h, raw.data() + start, sizeof(h));
+        if (TRACE_VERSION != h.version ||
+            sizeof(struct trace_record) != h.record_size || !h.hz) {
+                fprintf(stderr, "unsupported trace version %u\n", h.version);
+                return false;
+        }
+        if (raw.size() - start < h.size) {
+                fprintf(stderr, "trace is truncated\n");
+                return false;
+        }
+
+        const char *p = raw.data() + start + sizeof(h);
+        const char *const end = raw.data() + start + h.size;
+
+        struct names names;
+        for (size_t i = 0; i < h.names; ++i) {
+                struct trace_name tn;
+                if (end - p < (long) sizeof(tn))
+                        return false;
+                memcpy(&tn, p, sizeof(tn));
+                p += sizeof(tn);
+                if (end - p < tn.len)
+                        return false;
+
+                const string name(p, tn.len);
+                p += tn.len;
+                switch (tn.kind) {
+                case TRACE_NAME_TASK:
+                        names.tasks[tn.id] = name;
+                        break;
+                case TRACE_NAME_QUEUE:
+                        names.queues[tn.id] = name;
+                        break;
+                case TRACE_NAME_ISR:
+                        names.isrs[tn.id] = name;
+                        break;
+                case TRACE_NAME_EVENT:
+                        names.events[tn.id] = name;
+                        break;
+                }
+        }
+
+        if ((size_t) (end - p) != h.events * sizeof(struct trace_record)) {
+                fprintf(stderr, "trace is corrupt\n");
+                return false;
+        }
+
+        fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+        Timeline timeline(out, names);
+        timeline.meta(h);
+
+        /*
+         * The cycle counter wraps, so time is rebuilt from the deltas.
+         * Signed, as an ISR can stamp its record ahead of the task it
+         * interrupted.
+         */
+        int64_t cycles = 0;
+        uint32_t prev = 0;
+        for (size_t i = 0; i < h.events; ++i) {
+                struct trace_record r;
+                memcpy(&r, p + i * sizeof(r), sizeof(r));
+                if (i)
+                        cycles += (int32_t) (r.cycles - prev);
+                prev = r.cycles;
+
+                timeline.event(cycles * 1e6 / h.hz, r);
+        }
+        timeline.finish();
+
+        fprintf(out, "\n]}\n");
+        if (h.lost)
+                fprintf(stderr, "%u events were lost before the dump\n",
+                        h.lost);
+
+        return true;
+}
+
+int main(int argc, char* argv[])
+{
+        struct options opts;
+        opts.port = NULL;
+        opts.out = NULL;
+        opts.raw = NULL;
+
+        int opt;
+        while ((opt = getopt(argc, argv, "p:o:r:h")) != -1) {
+                switch (opt) {
+                case 'p':
+                        opts.port = optarg;
+                        break;
+                case 'o':
+                        opts.out = optarg;
+                        break;
+                case 'r':
+                        opts.raw = optarg;
+                        break;
+                default:
+                        usage(argv[0]);
+                        return 1;
+                }
+        }
+
+        if (!opts.port == (argc - optind != 1)) {
+                usage(argv[0]);
+                return 1;
+        }
+
+        string raw;
+        if (opts.port) {
+                if (!fetch(opts.port, raw))
+                        return 1;
+                if (opts.raw && !write_file(opts.raw, raw)) {
+                        fprintf(stderr, "%s: %s\n", opts.raw, strerror(errno));
+                        return 1;
+                }
+        } else if (!read_file(argv[optind], raw)) {
+                fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+                return 1;
+        }
+
+        FILE *out = opts.out ? fopen(opts.out, "w") : stdout;
+        if (!out) {
+                fprintf(stderr, "%s: %s\n", opts.out, strerror(errno));
+                return 1;
+        }
+
+        const bool ok = convert(raw, out);
+        if (opts.out)
+                fclose(out);
+
+        return ok ? 0 : 1;
+}
@@ -40,11 +40,15 @@ CPP_GUARD_BEGIN
 #define CELLULAR_SUPPORT	1
 #define BLUETOOTH_SUPPORT	1
 #define WIFI_SUPPORT		1
+#define PERF_REGION_SUPPORT	1
+#define PRINTK_DEFERRED_SUPPORT	1
+#define TRACE_SUPPORT	1
 #define CAMERA_CONTROL      1
 
 //configuration
 #define MAX_TRACKS				240
 #define MAX_SECTORS				20
+#define LAP_HISTORY_SIZE	10
 #define MAX_VIRTUAL_CHANNELS	10
 
 /* Wifi Specific Info */
@@ -56,11 +60,19 @@ CPP_GUARD_BEGIN
 #define RX_MAX_MSG_LEN	768
 
 /*
- * What is the maximum number of samples available per predictive time
- * buffer.  More samples == better resolution. Each slot is 12 bytes.
+ * Size in bytes of each predictive time buffer.  More samples == better
+ * resolution.  Samples are delta encoded and average a few bytes each.
  */
-#define PREDICTIVE_TIME_MAX_SAMPLES	96
+#define PREDICTIVE_TIME_BUFFER_SIZE	1152
+
+/*
+ * Number of per track reference laps kept in flash.  These seed the
+ * predictive timer so it works from the first lap of a session.
+ */
+#define REFERENCE_LAP_SLOTS	8
 #define LOGGER_MESSAGE_BUFFER_SIZE	5
+#define SAMPLE_POOL_SIZE	(1024 * 12)
+#define JSON_TOKEN_ARRAYS	2
 
 /* LUA Configuration */
 
@@ -110,6 +122,7 @@ CPP_GUARD_BEGIN
 #define CAN_SW_TERMINATION      true
 #define CAN_MAPPINGS            10
 #define OBD2_CHANNELS           10
+#define MATH_CHANNELS           10
 
 //wireless links
 #define CONNECTIVITY_CHANNELS	2
@@ -129,6 +142,20 @@ CPP_GUARD_BEGIN
 //logging
 #define LOG_BUFFER_SIZE			1024
 
+/*
+ * Deferred printk: number of per task record rings and the records
+ * in each (power of 2).  Rings are allocated the first time a task
+ * logs with deferral enabled.
+ */
+#define PRINTK_DEFERRED_RINGS		8
+#define PRINTK_DEFERRED_RING_SIZE	32
+
+/*
+ * Event trace recorder: records held in RAM (power of 2, 8 bytes each).
+ * The buffer is allocated when tracing is first started.
+ */
+#define TRACE_BUFFER_EVENTS		64
+
 //system info
 #define DEVICE_NAME    "RCP_SIM"
 #define FRIENDLY_DEVICE_NAME "RaceCapture/Pro Sim"
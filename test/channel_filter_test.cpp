@@ -0,0 +1,218 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "can_channels.h"
+#include "channel_filter_test.h"
+#include "filter.h"
+#include "loggerConfig.h"
+#include <stdlib.h>
+#include <string.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ChannelFilterTest );
+
+static void init(struct channel_filter *f, const uint8_t type,
+                 const uint8_t size, const float param,
+                 const unsigned int rate_hz)
+{
+        struct channel_filter_config cfg;
+        cfg.type = type;
+        cfg.size = size;
+        cfg.param = param;
+        channel_filter_init(f, &cfg, rate_hz);
+}
+
+void ChannelFilterTest::testNone()
+{
+        struct channel_filter f;
+        init(&f, CHANNEL_FILTER_NONE, 1, 1, 100);
+
+        CPPUNIT_ASSERT(!channel_filter_enabled(&f));
+        CPPUNIT_ASSERT_EQUAL((int32_t) 1234, channel_filter_update(&f, 1234));
+        CPPUNIT_ASSERT_EQUAL((int32_t) -7, channel_filter_update(&f, -7));
+}
+
+void ChannelFilterTest::testEma()
+{
+        struct channel_filter f;
+        init(&f, CHANNEL_FILTER_EMA, 1, 0.5f, 100);
+
+        CPPUNIT_ASSERT(channel_filter_enabled(&f));
+        /* The first sample primes the filter */
+        CPPUNIT_ASSERT_EQUAL((int32_t) 0, channel_filter_update(&f, 0));
+        CPPUNIT_ASSERT_EQUAL((int32_t) 500, channel_filter_update(&f, 1000));
+        CPPUNIT_ASSERT_EQUAL((int32_t) 750, channel_filter_update(&f, 1000));
+        CPPUNIT_ASSERT_EQUAL((int32_t) 875, channel_filter_update(&f, 1000));
+
+        /* A slow filter still converges on small steps */
+        init(&f, CHANNEL_FILTER_EMA, 1, 0.01f, 100);
+        channel_filter_update(&f, 0);
+        for (int i = 0; i < 2000; ++i)
+                channel_filter_update(&f, 10);
+
+        CPPUNIT_ASSERT_EQUAL((int32_t) 10, f.value);
+}
+
+void ChannelFilterTest::testMovingAverage()
+{
+        struct channel_filter f;
+        init(&f, CHANNEL_FILTER_MOVING_AVERAGE, 4, 1, 100);
+
+        CPPUNIT_ASSERT_EQUAL((int32_t) 100, channel_filter_update(&f, 100));
+        CPPUNIT_ASSERT_EQUAL((int32_t) 125, channel_filter_update(&f, 200));
+        CPPUNIT_ASSERT_EQUAL((int32_t) 150, channel_filter_update(&f, 200));
+        CPPUNIT_ASSERT_EQUAL((int32_t) 175, channel_filter_update(&f, 200));
+        CPPUNIT_ASSERT_EQUAL((int32_t) 200, channel_filter_update(&f, 200));
+
+        /* Windows are rounded down to a power of two */
+        init(&f, CHANNEL_FILTER_MOVING_AVERAGE, 6, 1, 100);
+        CPPUNIT_ASSERT_EQUAL((uint8_t) 4, f.size);
+}
+
+void ChannelFilterTest::testMedian()
+{
+        struct channel_filter f;
+        init(&f, CHANNEL_FILTER_MEDIAN, 3, 1, 100);
+
+        CPPUNIT_ASSERT_EQUAL((int32_t) 10, channel_filter_update(&f, 10));
+        channel_filter_update(&f, 11);
+        /* A single spike is rejected */
+        CPPUNIT_ASSERT_EQUAL((int32_t) 11, channel_filter_update(&f, 5000));
+        CPPUNIT_ASSERT_EQUAL((int32_t) 12, channel_filter_update(&f, 12));
+        CPPUNIT_ASSERT_EQUAL((int32_t) 12, channel_filter_update(&f, -3000));
+}
+
+void ChannelFilterTest::testBiquadLowpass()
+{
+        struct channel_filter f;
+        init(&f, CHANNEL_FILTER_BIQUAD_LOWPASS, 1, 5, 100);
+
+        /* Unity gain at DC */
+        channel_filter_update(&f, 0);
+        for (int i = 0; i < 200; ++i)
+                channel_filter_update(&f, 1000);
+
+        CPPUNIT_ASSERT(abs(f.value - 1000) <= 1);
+
+        /* Strong attenuation near Nyquist */
+        init(&f, CHANNEL_FILTER_BIQUAD_LOWPASS, 1, 5, 100);
+        int32_t peak = 0;
+        for (int i = 0; i < 200; ++i) {
+                const int32_t v = channel_filter_update(&f, i % 2 ? 1000 : -1000);
+                if (i > 100)
+                        peak = abs(v) > peak ? abs(v) : peak;
+        }
+
+        CPPUNIT_ASSERT(peak < 50);
+
+        /* Without a rate the biquad can not be designed */
+        init(&f, CHANNEL_FILTER_BIQUAD_LOWPASS, 1, 5, 0);
+        CPPUNIT_ASSERT(!channel_filter_enabled(&f));
+}
+
+void ChannelFilterTest::testSanitizeConfig()
+{
+        struct channel_filter_config cfg;
+        cfg.type = CHANNEL_FILTER_ENUM_COUNT;
+        cfg.size = 100;
+        cfg.param = -1;
+        channel_filter_sanitize_config(&cfg);
+
+        CPPUNIT_ASSERT_EQUAL((uint8_t) CHANNEL_FILTER_NONE, cfg.type);
+        CPPUNIT_ASSERT_EQUAL((uint8_t) CHANNEL_FILTER_MAX_SIZE, cfg.size);
+        CPPUNIT_ASSERT_EQUAL(1.0f, cfg.param);
+
+        /* An alpha too small for the kernel would freeze the channel */
+        cfg.type = CHANNEL_FILTER_EMA;
+        cfg.param = 1e-6f;
+        channel_filter_sanitize_config(&cfg);
+        CPPUNIT_ASSERT(cfg.param > 1e-6f);
+
+        struct channel_filter f;
+        channel_filter_init(&f, &cfg, 100);
+        channel_filter_update(&f, 0);
+        for (int i = 0; i < 100000; ++i)
+                channel_filter_update(&f, 1000);
+        CPPUNIT_ASSERT(f.value > 0);
+
+        /* The moving average window is reported as it is run */
+        cfg.type = CHANNEL_FILTER_MOVING_AVERAGE;
+        cfg.size = 6;
+        channel_filter_sanitize_config(&cfg);
+        CPPUNIT_ASSERT_EQUAL((uint8_t) 4, cfg.size);
+
+        /* The median filter takes any size */
+        cfg.type = CHANNEL_FILTER_MEDIAN;
+        cfg.size = 5;
+        channel_filter_sanitize_config(&cfg);
+        CPPUNIT_ASSERT_EQUAL((uint8_t) 5, cfg.size);
+}
+
+void ChannelFilterTest::testLegacyFilterRange()
+{
+        /* A long window of timer periods overflows a 32 bit total */
+        Filter filter;
+        init_filter(&filter, 0.0001f);
+        for (int i = 0; i < 20000; ++i)
+                update_filter(&filter, 1000000);
+
+        CPPUNIT_ASSERT_EQUAL((int32_t) 1000000, filter.current_value);
+}
+
+void ChannelFilterTest::testCanChannels()
+{
+        CANChannelConfig cfg;
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.enabled = 1;
+        cfg.enabled_mappings = 3;
+        for (size_t i = 0; i < cfg.enabled_mappings; ++i) {
+                ChannelConfig *cc = &cfg.can_channels[i].mapping.channel_cfg;
+                cc->min = 0;
+                cc->max = 1000;
+                cc->precision = 0;
+                channel_filter_reset_config(&cfg.can_channels[i].filter);
+        }
+        cfg.can_channels[1].filter.type = CHANNEL_FILTER_MEDIAN;
+        cfg.can_channels[1].filter.size = 3;
+
+        CPPUNIT_ASSERT(CAN_init_current_values(cfg.enabled_mappings));
+        CPPUNIT_ASSERT(CAN_init_filters(&cfg, 50));
+
+        const float values[] = {10, 500, 20, 30};
+        for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+                for (size_t c = 0; c < cfg.enabled_mappings; ++c)
+                        CAN_set_current_channel_value(c, values[i]);
+                CAN_sample_all();
+        }
+
+        /* Only the filtered channel rejects the spike */
+        CPPUNIT_ASSERT_EQUAL(30.0f, CAN_get_current_channel_value(0));
+        CPPUNIT_ASSERT_EQUAL(30.0f, CAN_get_current_channel_value(1));
+        CPPUNIT_ASSERT_EQUAL(30.0f, CAN_get_current_channel_value(2));
+
+        CAN_set_current_channel_value(1, 900);
+        CAN_set_current_channel_value(2, 900);
+        CAN_sample_all();
+        CPPUNIT_ASSERT_EQUAL(30.0f, CAN_get_current_channel_value(1));
+        CPPUNIT_ASSERT_EQUAL(900.0f, CAN_get_current_channel_value(2));
+
+        cfg.enabled = 0;
+        CPPUNIT_ASSERT(CAN_init_filters(&cfg, 50));
+}
@@ -0,0 +1,51 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CHANNEL_FILTER_TEST_H_
+#define _CHANNEL_FILTER_TEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ChannelFilterTest : public CppUnit::TestFixture
+{
+        CPPUNIT_TEST_SUITE( ChannelFilterTest );
+        CPPUNIT_TEST( testNone );
+        CPPUNIT_TEST( testEma );
+        CPPUNIT_TEST( testMovingAverage );
+        CPPUNIT_TEST( testMedian );
+        CPPUNIT_TEST( testBiquadLowpass );
+        CPPUNIT_TEST( testSanitizeConfig );
+        CPPUNIT_TEST( testLegacyFilterRange );
+        CPPUNIT_TEST( testCanChannels );
+        CPPUNIT_TEST_SUITE_END();
+
+public:
+        void testNone();
+        void testEma();
+        void testMovingAverage();
+        void testMedian();
+        void testBiquadLowpass();
+        void testSanitizeConfig();
+        void testLegacyFilterRange();
+        void testCanChannels();
+};
+
+#endif /* _CHANNEL_FILTER_TEST_H_ */
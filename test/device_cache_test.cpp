@@ -0,0 +1,106 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "device_cache.h"
+#include "device_cache_test.h"
+#include "loggerConfig.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( DeviceCacheTest );
+
+static const int bauds[] = {115200, 9600, 38400};
+
+void DeviceCacheTest::setUp()
+{
+        initialize_logger_config();
+        flash_default_logger_config();
+}
+
+void DeviceCacheTest::tearDown()
+{
+        flash_default_logger_config();
+}
+
+void DeviceCacheTest::testProbeOrderUncached()
+{
+        int order[4];
+        const size_t len = device_cache_probe_order(DEVICE_CACHE_GPS_BAUD,
+                                                    bauds, 3, order);
+
+        CPPUNIT_ASSERT_EQUAL((size_t) 3, len);
+        CPPUNIT_ASSERT_EQUAL(115200, order[0]);
+        CPPUNIT_ASSERT_EQUAL(9600, order[1]);
+        CPPUNIT_ASSERT_EQUAL(38400, order[2]);
+}
+
+void DeviceCacheTest::testProbeOrderCached()
+{
+        int order[4];
+        device_cache_set(DEVICE_CACHE_GPS_BAUD, 38400);
+        size_t len = device_cache_probe_order(DEVICE_CACHE_GPS_BAUD,
+                                              bauds, 3, order);
+
+        CPPUNIT_ASSERT_EQUAL((size_t) 3, len);
+        CPPUNIT_ASSERT_EQUAL(38400, order[0]);
+        CPPUNIT_ASSERT_EQUAL(115200, order[1]);
+        CPPUNIT_ASSERT_EQUAL(9600, order[2]);
+
+        /* A cached rate that is not in the list is tried as well */
+        device_cache_set(DEVICE_CACHE_GPS_BAUD, 57600);
+        len = device_cache_probe_order(DEVICE_CACHE_GPS_BAUD, bauds, 3,
+                                       order);
+
+        CPPUNIT_ASSERT_EQUAL((size_t) 4, len);
+        CPPUNIT_ASSERT_EQUAL(57600, order[0]);
+        CPPUNIT_ASSERT_EQUAL(38400, order[3]);
+}
+
+void DeviceCacheTest::testSetSaves()
+{
+        device_cache_set(DEVICE_CACHE_BT_BAUD, 9600);
+
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 9600,
+                             device_cache_get(DEVICE_CACHE_BT_BAUD));
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 9600,
+                             getSavedLoggerConfig()->device_cache.values[DEVICE_CACHE_BT_BAUD]);
+}
+
+void DeviceCacheTest::testSetDefersUnsaved()
+{
+        LoggerConfig *lc = getWorkingLoggerConfig();
+        lc->GPSConfigs.speed.sampleRate++;
+        device_cache_set(DEVICE_CACHE_CELL_MODEM, 2);
+
+        /* The user's edit must not be saved behind their back */
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 2,
+                             device_cache_get(DEVICE_CACHE_CELL_MODEM));
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0,
+                             getSavedLoggerConfig()->device_cache.values[DEVICE_CACHE_CELL_MODEM]);
+        CPPUNIT_ASSERT(getSavedLoggerConfig()->GPSConfigs.speed.sampleRate !=
+                       lc->GPSConfigs.speed.sampleRate);
+
+        /* And goes out with the next config save */
+        flashLoggerConfig();
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 2,
+                             getSavedLoggerConfig()->device_cache.values[DEVICE_CACHE_CELL_MODEM]);
+}
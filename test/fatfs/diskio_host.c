@@ -0,0 +1,296 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * FatFs disk I/O for the host builds, standing in for the SD card.  The
+ * disk is either RAM or a FAT image file.  On top of plain storage it can
+ * add latency to model slow cards, counts what the file system asks of
+ * it and can cut the power part way through a write.
+ */
+
+#include "diskio.h"
+#include "diskio_host.h"
+#include "ff.h"
+#include "sdcard_device.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SD_DRIVE		0
+/* Erase block size in sectors, as reported by a typical SD card */
+#define SD_BLOCK_SIZE		128
+
+static struct {
+        uint8_t *ram;
+        int fd;
+        DWORD sectors;
+        bool powered;
+        /* Sectors left to write before the power goes, if armed */
+        bool cut_armed;
+        uint32_t cut_after;
+        uint32_t jitter_seed;
+        struct diskio_host_latency latency;
+        struct diskio_host_stats stats;
+} disk = {
+        .fd = -1,
+};
+
+static bool disk_present(void)
+{
+        return disk.powered && (disk.ram || disk.fd >= 0);
+}
+
+/* Deterministic so runs with jitter are repeatable */
+static uint32_t next_jitter(void)
+{
+        disk.jitter_seed = disk.jitter_seed * 1103515245 + 12345;
+        const uint32_t max = disk.latency.jitter_ns;
+        return max ? (disk.jitter_seed >> 8) % max : 0;
+}
+
+static void delay(const uint64_t base_ns)
+{
+        const uint64_t ns = base_ns + next_jitter();
+        if (!ns)
+                return;
+
+        disk.stats.delay_ns += ns;
+        struct timespec ts = {
+                .tv_sec = ns / 1000000000ull,
+                .tv_nsec = ns % 1000000000ull,
+        };
+        while (nanosleep(&ts, &ts));
+}
+
+bool diskio_host_ram(const size_t sectors)
+{
+        diskio_host_close();
+
+        disk.ram = calloc(sectors, DISKIO_HOST_SECTOR_SIZE);
+        if (!disk.ram)
+                return false;
+
+        disk.sectors = sectors;
+        disk.powered = true;
+        return true;
+}
+
+bool diskio_host_image(const char *path)
+{
+        diskio_host_close();
+
+        disk.fd = open(path, O_RDWR);
+        if (disk.fd < 0)
+                return false;
+
+        struct stat st;
+        if (fstat(disk.fd, &st)) {
+                diskio_host_close();
+                return false;
+        }
+
+        disk.sectors = st.st_size / DISKIO_HOST_SECTOR_SIZE;
+        disk.powered = true;
+        return true;
+}
+
+void diskio_host_close(void)
+{
+        free(disk.ram);
+        disk.ram = NULL;
+
+        if (disk.fd >= 0)
+                close(disk.fd);
+        disk.fd = -1;
+
+        disk.sectors = 0;
+        disk.cut_armed = false;
+        disk.powered = false;
+}
+
+int diskio_host_format(void)
+{
+        FATFS fs;
+        FRESULT res = f_mount(&fs, "0", 0);
+        if (FR_OK == res)
+                res = f_mkfs("0", 1, 0);
+
+        f_mount(NULL, "0", 0);
+        return res;
+}
+
+void diskio_host_set_latency(const struct diskio_host_latency *latency)
+{
+        disk.latency = *latency;
+        disk.jitter_seed = 1;
+}
+
+void diskio_host_get_stats(struct diskio_host_stats *stats)
+{
+        *stats = disk.stats;
+}
+
+void diskio_host_reset_stats(void)
+{
+        memset(&disk.stats, 0, sizeof(disk.stats));
+}
+
+void diskio_host_power_cut(const uint32_t sectors)
+{
+        disk.cut_armed = true;
+        disk.cut_after = sectors;
+        if (!sectors)
+                disk.powered = false;
+}
+
+void diskio_host_power_restore(void)
+{
+        disk.cut_armed = false;
+        disk.powered = true;
+}
+
+void disk_init_hardware(void)
+{
+        if (!disk.ram && disk.fd < 0)
+                diskio_host_ram(DISKIO_HOST_DEFAULT_SECTORS);
+}
+
+bool sdcard_device_card_present(void)
+{
+        return disk_present();
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+        if (SD_DRIVE != pdrv)
+                return STA_NOINIT;
+
+        return disk_present() ? 0 : STA_NOINIT | STA_NODISK;
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+        if (SD_DRIVE != pdrv)
+                return STA_NOINIT;
+
+        return disk_present() ? 0 : STA_NOINIT;
+}
+
+static bool in_range(const DWORD sector, const UINT count)
+{
+        return sector < disk.sectors && count <= disk.sectors - sector;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+{
+        if (SD_DRIVE != pdrv || !count || !in_range(sector, count))
+                return RES_PARERR;
+
+        if (!disk_present())
+                return RES_NOTRDY;
+
+        disk.stats.reads++;
+        disk.stats.sectors_read += count;
+        delay((uint64_t) disk.latency.read_ns * count);
+
+        const size_t len = (size_t) count * DISKIO_HOST_SECTOR_SIZE;
+        const off_t offset = (off_t) sector * DISKIO_HOST_SECTOR_SIZE;
+        if (disk.ram) {
+                memcpy(buff, disk.ram + offset, len);
+                return RES_OK;
+        }
+
+        return pread(disk.fd, buff, len, offset) == (ssize_t) len ?
+                RES_OK : RES_ERROR;
+}
+
+static bool store(const BYTE *buff, const DWORD sector, const UINT count)
+{
+        const size_t len = (size_t) count * DISKIO_HOST_SECTOR_SIZE;
+        const off_t offset = (off_t) sector * DISKIO_HOST_SECTOR_SIZE;
+        if (disk.ram) {
+                memcpy(disk.ram + offset, buff, len);
+                return true;
+        }
+
+        return pwrite(disk.fd, buff, len, offset) == (ssize_t) len;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+{
+        if (SD_DRIVE != pdrv || !count || !in_range(sector, count))
+                return RES_PARERR;
+
+        if (!disk_present())
+                return RES_NOTRDY;
+
+        disk.stats.writes++;
+        delay((uint64_t) disk.latency.write_ns * count);
+
+        UINT landed = count;
+        if (disk.cut_armed && disk.cut_after < count) {
+                landed = disk.cut_after;
+                disk.stats.sectors_lost += count - landed;
+                disk.powered = false;
+        }
+        if (disk.cut_armed)
+                disk.cut_after -= landed;
+
+        disk.stats.sectors_written += landed;
+        if (landed && !store(buff, sector, landed))
+                return RES_ERROR;
+
+        return landed == count ? RES_OK : RES_NOTRDY;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
+{
+        if (SD_DRIVE != pdrv)
+                return RES_PARERR;
+
+        if (!disk_present())
+                return RES_NOTRDY;
+
+        switch (cmd) {
+        case CTRL_SYNC:
+                disk.stats.syncs++;
+                delay(disk.latency.sync_ns);
+                if (disk.fd >= 0 && fdatasync(disk.fd))
+                        return RES_ERROR;
+
+                return RES_OK;
+        case GET_SECTOR_COUNT:
+                *(DWORD*) buff = disk.sectors;
+                return RES_OK;
+        case GET_SECTOR_SIZE:
+                *(WORD*) buff = DISKIO_HOST_SECTOR_SIZE;
+                return RES_OK;
+        case GET_BLOCK_SIZE:
+                *(DWORD*) buff = SD_BLOCK_SIZE;
+                return RES_OK;
+        default:
+                return RES_PARERR;
+        }
+}
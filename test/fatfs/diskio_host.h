@@ -0,0 +1,111 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DISKIO_HOST_H_
+#define _DISKIO_HOST_H_
+
+#include "cpp_guard.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+CPP_GUARD_BEGIN
+
+#define DISKIO_HOST_SECTOR_SIZE	512
+
+/* 32MB formats as FAT16, like a small SD card */
+#define DISKIO_HOST_DEFAULT_SECTORS	(32 * 1024 * 1024 / DISKIO_HOST_SECTOR_SIZE)
+
+/**
+ * Artificial latency, to model a slow card.  Every read or write costs
+ * its per sector time for each sector it covers, every sync costs
+ * sync_ns, and each operation gets a pseudo random extra of up to
+ * jitter_ns on top.  The delays are real sleeps.
+ */
+struct diskio_host_latency {
+        uint32_t read_ns;
+        uint32_t write_ns;
+        uint32_t sync_ns;
+        uint32_t jitter_ns;
+};
+
+struct diskio_host_stats {
+        uint32_t reads;
+        uint32_t writes;
+        uint32_t syncs;
+        uint32_t sectors_read;
+        uint32_t sectors_written;
+        /* Writes lost, in sectors, because the power was cut */
+        uint32_t sectors_lost;
+        /* Total artificial latency added */
+        uint64_t delay_ns;
+};
+
+/**
+ * Backs the SD card drive with a zeroed RAM disk.  Any previous disk is
+ * dropped.
+ * @param sectors Size of the disk in 512 byte sectors.
+ * @return true on success.
+ */
+bool diskio_host_ram(const size_t sectors);
+
+/**
+ * Backs the SD card drive with an existing FAT image file.
+ * @return true if the image could be opened read/write.
+ */
+bool diskio_host_image(const char *path);
+
+/**
+ * Drops the disk.  The card then reads as not present.
+ */
+void diskio_host_close(void);
+
+/**
+ * Puts a fresh FAT file system on the disk.  The volume must not be
+ * mounted.
+ * @return the FRESULT of the format.
+ */
+int diskio_host_format(void);
+
+void diskio_host_set_latency(const struct diskio_host_latency *latency);
+
+void diskio_host_get_stats(struct diskio_host_stats *stats);
+
+void diskio_host_reset_stats(void);
+
+/**
+ * Cuts the power to the card once another sectors sectors have been
+ * written.  A write that crosses the cut is torn: only its leading
+ * sectors land.  After the cut the card reads as not present and the disk
+ * keeps what it had at that moment.
+ * @param sectors Sectors still written before the cut, 0 to cut now.
+ */
+void diskio_host_power_cut(const uint32_t sectors);
+
+/**
+ * Brings the card back after a power cut, with its contents as they were
+ * when the power went.
+ */
+void diskio_host_power_restore(void);
+
+CPP_GUARD_END
+
+#endif /* _DISKIO_HOST_H_ */
@@ -0,0 +1,234 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "diskio_host_test.h"
+#include "diskio_host.h"
+#include "ff.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+
+using std::string;
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( DiskioHostTest );
+
+#define TEST_SECTORS	(8 * 1024 * 1024 / DISKIO_HOST_SECTOR_SIZE)
+
+static FATFS fs;
+
+static void write_file(const char *path, const string &data)
+{
+        FIL f;
+        UINT written;
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_open(&f, path, FA_WRITE | FA_CREATE_ALWAYS));
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_write(&f, data.c_str(), data.size(), &written));
+        CPPUNIT_ASSERT_EQUAL((UINT) data.size(), written);
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_close(&f));
+}
+
+static string read_file(const char *path)
+{
+        FIL f;
+        if (FR_OK != f_open(&f, path, FA_READ))
+                return "";
+
+        string data(f_size(&f), '\0');
+        UINT read = 0;
+        if (!data.empty())
+                f_read(&f, &data[0], data.size(), &read);
+        f_close(&f);
+
+        data.resize(read);
+        return data;
+}
+
+static string pattern(const size_t len)
+{
+        string s;
+        for (size_t i = 0; i < len; i++)
+                s += (char) ('a' + i % 26);
+
+        return s;
+}
+
+/* Mounts the disk afresh, as it would be found after a reboot */
+static FRESULT remount(void)
+{
+        f_mount(NULL, "0", 0);
+        return f_mount(&fs, "0", 1);
+}
+
+void DiskioHostTest::setUp()
+{
+        const struct diskio_host_latency none = {0, 0, 0, 0};
+        diskio_host_set_latency(&none);
+
+        CPPUNIT_ASSERT(diskio_host_ram(TEST_SECTORS));
+        CPPUNIT_ASSERT_EQUAL((int) FR_OK, diskio_host_format());
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_mount(&fs, "0", 1));
+        diskio_host_reset_stats();
+}
+
+void DiskioHostTest::tearDown()
+{
+        f_mount(NULL, "0", 0);
+        diskio_host_close();
+}
+
+void DiskioHostTest::test_format_and_mount(void)
+{
+        DWORD free_clusters;
+        FATFS *pfs;
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_getfree("0", &free_clusters, &pfs));
+        CPPUNIT_ASSERT(free_clusters > 0);
+        CPPUNIT_ASSERT(free_clusters * pfs->csize <= (DWORD) TEST_SECTORS);
+
+        /* An unformatted disk has no file system to mount */
+        f_mount(NULL, "0", 0);
+        CPPUNIT_ASSERT(diskio_host_ram(TEST_SECTORS));
+        CPPUNIT_ASSERT_EQUAL(FR_NO_FILESYSTEM, f_mount(&fs, "0", 1));
+}
+
+void DiskioHostTest::test_read_back(void)
+{
+        const string data = pattern(10000);
+        write_file("a.txt", data);
+        CPPUNIT_ASSERT_EQUAL(FR_OK, remount());
+        CPPUNIT_ASSERT(data == read_file("a.txt"));
+}
+
+void DiskioHostTest::test_counters(void)
+{
+        write_file("a.txt", pattern(4096));
+
+        struct diskio_host_stats stats;
+        diskio_host_get_stats(&stats);
+        CPPUNIT_ASSERT(stats.writes > 0);
+        CPPUNIT_ASSERT(stats.sectors_written >= 4096 / DISKIO_HOST_SECTOR_SIZE);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 1, stats.syncs);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0, stats.sectors_lost);
+
+        diskio_host_reset_stats();
+        CPPUNIT_ASSERT_EQUAL(FR_OK, remount());
+        read_file("a.txt");
+        diskio_host_get_stats(&stats);
+        CPPUNIT_ASSERT(stats.reads > 0);
+        CPPUNIT_ASSERT(stats.sectors_read >= stats.reads);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0, stats.writes);
+}
+
+void DiskioHostTest::test_latency(void)
+{
+        const struct diskio_host_latency latency = {3000, 5000, 7000, 0};
+        diskio_host_set_latency(&latency);
+        write_file("a.txt", pattern(2048));
+
+        struct diskio_host_stats stats;
+        diskio_host_get_stats(&stats);
+        const uint64_t expected = 3000ull * stats.sectors_read +
+                5000ull * stats.sectors_written + 7000ull * stats.syncs;
+        CPPUNIT_ASSERT_EQUAL(expected, stats.delay_ns);
+
+        /* Jitter adds up to jitter_ns to every operation */
+        const struct diskio_host_latency jittery = {3000, 5000, 7000, 1000};
+        diskio_host_set_latency(&jittery);
+        diskio_host_reset_stats();
+        write_file("b.txt", pattern(2048));
+
+        diskio_host_get_stats(&stats);
+        const uint64_t base = 3000ull * stats.sectors_read +
+                5000ull * stats.sectors_written + 7000ull * stats.syncs;
+        const uint64_t ops = stats.reads + stats.writes + stats.syncs;
+        CPPUNIT_ASSERT(stats.delay_ns > base);
+        CPPUNIT_ASSERT(stats.delay_ns < base + 1000 * ops);
+}
+
+void DiskioHostTest::test_power_cut(void)
+{
+        const string synced = pattern(3000);
+        write_file("a.txt", synced);
+
+        diskio_host_power_cut(0);
+        FIL f;
+        UINT written;
+        CPPUNIT_ASSERT(FR_OK != f_open(&f, "a.txt", FA_WRITE | FA_OPEN_ALWAYS) ||
+                       FR_OK != f_write(&f, "more", 4, &written) ||
+                       FR_OK != f_sync(&f));
+
+        diskio_host_power_restore();
+        CPPUNIT_ASSERT_EQUAL(FR_OK, remount());
+        CPPUNIT_ASSERT(synced == read_file("a.txt"));
+}
+
+void DiskioHostTest::test_torn_write(void)
+{
+        diskio_host_power_cut(2);
+
+        FIL f;
+        UINT written;
+        const string data = pattern(8 * DISKIO_HOST_SECTOR_SIZE);
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_open(&f, "a.txt", FA_WRITE | FA_CREATE_ALWAYS));
+        f_write(&f, data.c_str(), data.size(), &written);
+        f_sync(&f);
+
+        struct diskio_host_stats stats;
+        diskio_host_get_stats(&stats);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 2, stats.sectors_written);
+        CPPUNIT_ASSERT(stats.sectors_lost > 0);
+
+        /* Dead until the power comes back */
+        const uint32_t lost = stats.sectors_lost;
+        CPPUNIT_ASSERT(FR_OK != f_sync(&f));
+        diskio_host_get_stats(&stats);
+        CPPUNIT_ASSERT_EQUAL(lost, stats.sectors_lost);
+
+        diskio_host_power_restore();
+        CPPUNIT_ASSERT_EQUAL(FR_OK, remount());
+}
+
+void DiskioHostTest::test_image(void)
+{
+        f_mount(NULL, "0", 0);
+
+        char path[] = "/tmp/rcp_diskio_XXXXXX";
+        const int fd = mkstemp(path);
+        CPPUNIT_ASSERT(fd >= 0);
+        CPPUNIT_ASSERT_EQUAL(0, ftruncate(fd, TEST_SECTORS * DISKIO_HOST_SECTOR_SIZE));
+        close(fd);
+
+        const string data = pattern(5000);
+        CPPUNIT_ASSERT(diskio_host_image(path));
+        CPPUNIT_ASSERT_EQUAL((int) FR_OK, diskio_host_format());
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_mount(&fs, "0", 1));
+        write_file("a.txt", data);
+        f_mount(NULL, "0", 0);
+        diskio_host_close();
+
+        /* The image keeps the data once the disk is gone */
+        CPPUNIT_ASSERT(diskio_host_image(path));
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_mount(&fs, "0", 1));
+        const string read = read_file("a.txt");
+        unlink(path);
+        CPPUNIT_ASSERT(data == read);
+}
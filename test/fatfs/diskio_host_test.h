@@ -0,0 +1,51 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DISKIO_HOST_TEST_H
+#define DISKIO_HOST_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class DiskioHostTest : public CppUnit::TestFixture
+{
+        CPPUNIT_TEST_SUITE( DiskioHostTest );
+        CPPUNIT_TEST( test_format_and_mount );
+        CPPUNIT_TEST( test_read_back );
+        CPPUNIT_TEST( test_counters );
+        CPPUNIT_TEST( test_latency );
+        CPPUNIT_TEST( test_power_cut );
+        CPPUNIT_TEST( test_torn_write );
+        CPPUNIT_TEST( test_image );
+        CPPUNIT_TEST_SUITE_END();
+
+public:
+        void setUp();
+        void tearDown();
+        void test_format_and_mount(void);
+        void test_read_back(void);
+        void test_counters(void);
+        void test_latency(void);
+        void test_power_cut(void);
+        void test_torn_write(void);
+        void test_image(void);
+};
+
+#endif /* DISKIO_HOST_TEST_H */
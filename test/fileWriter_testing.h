@@ -32,6 +32,10 @@ int flush_logfile(struct logging_status *ls);
 int logging_stop(struct logging_status *ls);
 int logging_start(struct logging_status *ls);
 int logging_sample(struct logging_status *ls, LoggerMessage *msg);
+void prepare_next_log_file(void);
+int log_file_index(const char *name);
+void log_dir_name(char *dir, const millis_t utc);
+void log_file_path(char *path, const char *dir, const int index);
 
 CPP_GUARD_END
 
@@ -0,0 +1,279 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gps_fusion.h"
+#include "gps_fusion_test.h"
+#include "track_frame.h"
+#include <cppunit/extensions/HelperMacros.h>
+#include <fstream>
+#include <math.h>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using std::ifstream;
+using std::string;
+using std::vector;
+
+CPPUNIT_TEST_SUITE_REGISTRATION( GpsFusionTest );
+
+static const GeoPoint origin = {38.161531, -122.454724};
+
+static GpsSample make_fix(const GeoPoint &p, const float kph,
+                          const millis_t time)
+{
+        GpsSample s;
+        memset(&s, 0, sizeof(s));
+        s.quality = GPS_QUALITY_3D;
+        s.point = p;
+        s.speed = kph;
+        s.time = time;
+        return s;
+}
+
+/* Distance between the fused position and a point within its frame */
+static float fused_error_m(const struct gps_fusion *f, const GeoPoint &p)
+{
+        const struct track_point tp = track_frame_project(&f->frame, &p);
+        const struct track_point fp = {
+                (int32_t) (f->x >> GPS_FUSION_POS_SHIFT),
+                (int32_t) (f->y >> GPS_FUSION_POS_SHIFT),
+        };
+        return track_point_dist(&tp, &fp);
+}
+
+void GpsFusionTest::testSeed()
+{
+        struct gps_fusion f;
+        gps_fusion_init(&f);
+
+        /* Nothing happens until the first fix */
+        gps_fusion_predict(&f, 1, 10, 100);
+        CPPUNIT_ASSERT(!f.initialized);
+
+        GpsSample s = make_fix(origin, 72, 1000);
+        gps_fusion_correct(&f, &s);
+        CPPUNIT_ASSERT(f.initialized);
+        CPPUNIT_ASSERT(fabs(gps_fusion_get_speed(&f) - 72) < 0.01);
+        CPPUNIT_ASSERT(fused_error_m(&f, origin) < 0.01);
+
+        /* Heading comes from the course between fixes: 20m due east */
+        GeoPoint east = origin;
+        east.longitude += 20.0 / (111195.0 * cos(origin.latitude * M_PI / 180));
+        s = make_fix(east, 72, 2000);
+        gps_fusion_correct(&f, &s);
+        CPPUNIT_ASSERT(f.heading_valid);
+        CPPUNIT_ASSERT(fabs(gps_fusion_get_heading(&f) - 90) < 1);
+
+        /* The second fix seeds the position */
+        CPPUNIT_ASSERT(fused_error_m(&f, east) < 0.01);
+
+        /* 20m/s east for 500ms with no acceleration or yaw */
+        for (int i = 0; i < 50; ++i)
+                gps_fusion_predict(&f, 0, 0, 10);
+        GeoPoint ahead = east;
+        ahead.longitude += 10.0 / (111195.0 * cos(origin.latitude * M_PI / 180));
+        CPPUNIT_ASSERT(fused_error_m(&f, ahead) < 0.5);
+
+        /* 1G for 500ms adds ~4.9m/s */
+        for (int i = 0; i < 50; ++i)
+                gps_fusion_predict(&f, 1, 0, 10);
+        CPPUNIT_ASSERT(fabs(gps_fusion_get_speed(&f) - (72 + 4.9 * 3.6)) < 0.5);
+}
+
+/*
+ * Drives a 100m radius circle clockwise at 25m/s with 10Hz fixes and a
+ * 100Hz gyro that reads 2 deg/s high.  The fused position should track
+ * the circle between fixes far better than holding the last fix.
+ */
+void GpsFusionTest::testSyntheticCircle()
+{
+        const double radius = 100;
+        const double speed = 25;
+        const double rate = speed / radius;
+        struct track_frame tf;
+        track_frame_init(&tf, &origin);
+
+        struct gps_fusion f;
+        gps_fusion_init(&f);
+
+        float max_err = 0;
+        float max_hold_err = 0;
+        GeoPoint last_fix = origin;
+
+        for (int ms = 0; ms <= 20000; ms += 10) {
+                /* Clockwise from due north of the centre, heading east */
+                const double a = rate * ms / 1000;
+                const struct track_point tp = {
+                        (int32_t) lrint(radius * sin(a) * 100),
+                        (int32_t) lrint((radius * cos(a) - radius) * 100),
+                };
+                const GeoPoint truth = track_frame_unproject(&tf, &tp);
+
+                gps_fusion_predict(&f, 0, rate * 180 / M_PI + 2, 10);
+
+                if (ms % 100 == 0) {
+                        GpsSample s = make_fix(truth, speed * 3.6, 1000 + ms);
+                        gps_fusion_correct(&f, &s);
+                        last_fix = truth;
+                        continue;
+                }
+
+                /* Give the heading and bias a few seconds to settle */
+                if (ms < 5000)
+                        continue;
+
+                max_err = fmaxf(max_err, fused_error_m(&f, truth));
+                max_hold_err = fmaxf(max_hold_err, distPythag(&last_fix, &truth));
+        }
+
+        if (getenv("TRACE"))
+                printf("\rgps_fusion: circle max error %.2fm, holding fixes "
+                       "%.2fm, yaw bias %.2f deg/s\r\n", max_err, max_hold_err,
+                       f.yaw_bias / 1000.0);
+
+        CPPUNIT_ASSERT(max_err < 1.0);
+        CPPUNIT_ASSERT(max_hold_err > 2.0);
+        CPPUNIT_ASSERT(abs(f.yaw_bias - 2000) < 500);
+}
+
+struct log_row {
+        int interval;
+        bool imu;
+        float accel_y;
+        bool fix;
+        GeoPoint point;
+        float speed_kph;
+};
+
+static vector<log_row> read_session(const string &name)
+{
+        ifstream t(name.c_str());
+        if (!t.is_open())
+                t.open(("test/" + name).c_str());
+        if (!t.is_open())
+                throw ("Can not find file " + name);
+
+        vector<log_row> rows;
+        GeoPoint last = {0, 0};
+        string line;
+        while (std::getline(t, line)) {
+                vector<string> values;
+                std::stringstream ls(line);
+                string item;
+                while (std::getline(ls, item, ','))
+                        values.push_back(item);
+
+                if (values.size() < 17 || values[0][0] == '"')
+                        continue;
+
+                log_row r;
+                r.interval = atoi(values[0].c_str());
+                r.imu = !values[4].empty();
+                r.accel_y = atof(values[4].c_str());
+                r.fix = !values[14].empty() && !values[15].empty();
+                r.point.latitude = atof(values[14].c_str());
+                r.point.longitude = atof(values[15].c_str());
+                /* Logged in MPH */
+                r.speed_kph = atof(values[16].c_str()) * 1.609344;
+
+                /*
+                 * Fixes were logged against the logger's clock, so some
+                 * are repeated on the next row.  Drop the repeats.
+                 */
+                if (r.fix && are_geo_points_equal(&r.point, &last))
+                        r.fix = false;
+                if (r.fix)
+                        last = r.point;
+
+                rows.push_back(r);
+        }
+
+        return rows;
+}
+
+/*
+ * Replays sonoma.log with every other fix withheld and measures how well
+ * the fused position predicts the withheld fixes.  The recorded gyro is
+ * uncalibrated so only the longitudinal accelerometer is used.
+ */
+void GpsFusionTest::testRecordedSession()
+{
+        const vector<log_row> rows = read_session("sonoma.log");
+        CPPUNIT_ASSERT(rows.size() > 1000);
+
+        struct gps_fusion f;
+        gps_fusion_init(&f);
+
+        int last_interval = rows[0].interval;
+        float accel = 0;
+        size_t fixes = 0;
+        size_t checked = 0;
+        double err_sum = 0;
+        double hold_err_sum = 0;
+        GeoPoint last_fix = {0, 0};
+
+        for (size_t i = 0; i < rows.size(); ++i) {
+                const log_row &r = rows[i];
+                const int dt = r.interval - last_interval;
+                last_interval = r.interval;
+
+                if (dt > 0)
+                        gps_fusion_predict(&f, accel, 0, dt);
+                if (r.imu)
+                        accel = r.accel_y;
+                if (!r.fix)
+                        continue;
+
+                if (fixes++ % 2 == 0 || !f.initialized) {
+                        GpsSample s = make_fix(r.point, r.speed_kph, r.interval);
+                        gps_fusion_correct(&f, &s);
+                        last_fix = r.point;
+                        continue;
+                }
+
+                /* Only score the car at speed, once it is on track */
+                if (r.speed_kph < 30)
+                        continue;
+
+                err_sum += fused_error_m(&f, r.point);
+                hold_err_sum += distPythag(&last_fix, &r.point);
+                ++checked;
+        }
+
+        const double mean_err = err_sum / checked;
+        const double mean_hold_err = hold_err_sum / checked;
+
+        if (getenv("TRACE"))
+                printf("\rgps_fusion: %zu withheld fixes, mean error %.2fm, "
+                       "holding fixes %.2fm\r\n", checked, mean_err,
+                       mean_hold_err);
+
+        CPPUNIT_ASSERT(checked > 1000);
+        /*
+         * The logged fixes are up to a sample period stale, which
+         * limits how closely any estimate can match them.
+         */
+        CPPUNIT_ASSERT(mean_err < mean_hold_err / 2);
+}
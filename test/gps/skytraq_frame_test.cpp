@@ -0,0 +1,274 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "skytraq_frame.h"
+#include "skytraq_frame_test.h"
+#include <cppunit/extensions/HelperMacros.h>
+#include <fstream>
+#include <sstream>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+using std::ifstream;
+using std::string;
+using std::vector;
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SkytraqFrameTest );
+
+#define PAYLOAD_SIZE	256
+#define NAV_MSG_ID	0xA8
+#define NAV_MSG_LEN	59
+
+static void append_frame(vector<uint8_t> &stream, const vector<uint8_t> &payload,
+                         const bool corrupt = false)
+{
+        uint8_t checksum = 0;
+        for (size_t i = 0; i < payload.size(); ++i)
+                checksum ^= payload[i];
+
+        stream.push_back(SKYTRAQ_FRAME_SYNC1);
+        stream.push_back(SKYTRAQ_FRAME_SYNC2);
+        stream.push_back(payload.size() >> 8);
+        stream.push_back(payload.size() & 0xFF);
+        stream.insert(stream.end(), payload.begin(), payload.end());
+        stream.push_back(corrupt ? ~checksum : checksum);
+        stream.push_back(0x0D);
+        stream.push_back(0x0A);
+}
+
+static void append_noise(vector<uint8_t> &stream, const char *s)
+{
+        while (*s)
+                stream.push_back(*s++);
+}
+
+static void put_be32(vector<uint8_t> &buf, const size_t offset, const int32_t v)
+{
+        buf[offset + 0] = (v >> 24) & 0xFF;
+        buf[offset + 1] = (v >> 16) & 0xFF;
+        buf[offset + 2] = (v >> 8) & 0xFF;
+        buf[offset + 3] = v & 0xFF;
+}
+
+static int32_t get_be32(const uint8_t *buf)
+{
+        return (int32_t) (((uint32_t) buf[0] << 24) | ((uint32_t) buf[1] << 16) |
+                          ((uint32_t) buf[2] << 8) | buf[3]);
+}
+
+/*
+ * Feeds the stream to the parser block_size bytes at a time, the way the
+ * GPS driver does, and hands every completed frame to the callback.
+ */
+template <typename F>
+static void parse_stream(struct skytraq_frame_parser *p,
+                         const vector<uint8_t> &stream,
+                         const size_t block_size, F on_frame)
+{
+        for (size_t off = 0; off < stream.size(); off += block_size) {
+                size_t len = stream.size() - off;
+                if (len > block_size)
+                        len = block_size;
+
+                const uint8_t *block = &stream[off];
+                while (len) {
+                        size_t consumed;
+                        const enum skytraq_frame_result res =
+                                skytraq_frame_parse(p, block, len, &consumed);
+                        block += consumed;
+                        len -= consumed;
+
+                        if (SKYTRAQ_FRAME_READY == res)
+                                on_frame(p);
+                }
+        }
+}
+
+static int count_frames(struct skytraq_frame_parser *p,
+                        const vector<uint8_t> &stream,
+                        const size_t block_size)
+{
+        int frames = 0;
+        parse_stream(p, stream, block_size,
+                     [&frames](struct skytraq_frame_parser *) { ++frames; });
+        return frames;
+}
+
+void SkytraqFrameTest::testSingleFrame()
+{
+        uint8_t payload[PAYLOAD_SIZE];
+        struct skytraq_frame_parser p;
+        skytraq_frame_init(&p, payload, sizeof(payload));
+
+        vector<uint8_t> stream;
+        append_frame(stream, {0x83, 0x05});
+
+        size_t consumed;
+        CPPUNIT_ASSERT_EQUAL(SKYTRAQ_FRAME_READY,
+                             skytraq_frame_parse(&p, stream.data(),
+                                                 stream.size(), &consumed));
+        CPPUNIT_ASSERT_EQUAL(stream.size(), consumed);
+        CPPUNIT_ASSERT_EQUAL((uint16_t) 2, p.len);
+        CPPUNIT_ASSERT_EQUAL((uint8_t) 0x83, payload[0]);
+        CPPUNIT_ASSERT_EQUAL((uint8_t) 0x05, payload[1]);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 1, p.frames);
+}
+
+void SkytraqFrameTest::testResyncOnNoise()
+{
+        uint8_t payload[PAYLOAD_SIZE];
+        struct skytraq_frame_parser p;
+        skytraq_frame_init(&p, payload, sizeof(payload));
+
+        vector<uint8_t> stream;
+        append_noise(stream, "$GPGGA,123519,4807.038,N,01131.000,E*47\r\n");
+        stream.push_back(SKYTRAQ_FRAME_SYNC1);
+        stream.push_back('x');
+        stream.push_back(SKYTRAQ_FRAME_SYNC1);
+        append_frame(stream, {0x83, 0x09});
+        append_noise(stream, "garbage");
+        append_frame(stream, {0x86, 0x32});
+
+        CPPUNIT_ASSERT_EQUAL(2, count_frames(&p, stream, stream.size()));
+        CPPUNIT_ASSERT_EQUAL((uint8_t) 0x86, payload[0]);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0, p.errors);
+}
+
+void SkytraqFrameTest::testChecksumError()
+{
+        uint8_t payload[PAYLOAD_SIZE];
+        struct skytraq_frame_parser p;
+        skytraq_frame_init(&p, payload, sizeof(payload));
+
+        vector<uint8_t> stream;
+        append_frame(stream, {0x83, 0x0E}, true);
+        append_frame(stream, {0x83, 0x11});
+
+        CPPUNIT_ASSERT_EQUAL(1, count_frames(&p, stream, 3));
+        CPPUNIT_ASSERT_EQUAL((uint8_t) 0x11, payload[1]);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 1, p.errors);
+}
+
+void SkytraqFrameTest::testOversizedFrame()
+{
+        uint8_t payload[8];
+        struct skytraq_frame_parser p;
+        skytraq_frame_init(&p, payload, sizeof(payload));
+
+        vector<uint8_t> stream;
+        append_frame(stream, vector<uint8_t>(9, 0x55));
+        append_frame(stream, {0x83, 0x64});
+
+        CPPUNIT_ASSERT_EQUAL(1, count_frames(&p, stream, 5));
+        CPPUNIT_ASSERT_EQUAL((uint8_t) 0x64, payload[1]);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 1, p.errors);
+}
+
+static string read_log(const string &name)
+{
+        ifstream t(name.c_str());
+        if (!t.is_open())
+                t.open(("test/" + name).c_str());
+        if (!t.is_open())
+                throw ("Can not find file " + name);
+
+        std::stringstream ss;
+        ss << t.rdbuf();
+        return ss.str();
+}
+
+/*
+ * Re-encodes the GPS fixes of a recorded session as navigation data
+ * frames, interleaved with ACKs and stray NMEA the way the module emits
+ * them while being provisioned, then checks every fix comes back out
+ * intact regardless of how the stream is split into blocks.
+ */
+void SkytraqFrameTest::testRecordedStream()
+{
+        std::istringstream log(read_log("sonoma.log"));
+        vector<uint8_t> stream;
+        vector<int32_t> latitudes;
+        string line;
+
+        while (std::getline(log, line)) {
+                vector<string> values;
+                std::stringstream ls(line);
+                string item;
+                while (std::getline(ls, item, ','))
+                        values.push_back(item);
+
+                if (values.size() < 16 || values[14].empty() ||
+                    values[15].empty() || values[0][0] == '"')
+                        continue;
+
+                const int32_t lat = atof(values[14].c_str()) * 10000000;
+                const int32_t lon = atof(values[15].c_str()) * 10000000;
+
+                vector<uint8_t> nav(NAV_MSG_LEN, 0);
+                nav[0] = NAV_MSG_ID;
+                nav[1] = 2;
+                nav[2] = 8;
+                put_be32(nav, 9, lat);
+                put_be32(nav, 13, lon);
+                append_frame(stream, nav);
+                latitudes.push_back(lat);
+
+                if (latitudes.size() % 50 == 0) {
+                        append_frame(stream, {0x83, 0x11});
+                        append_noise(stream, "$GPRMC,,V,,,,,,,,,,N*53\r\n");
+                }
+        }
+
+        CPPUNIT_ASSERT(latitudes.size() > 1000);
+
+        const size_t block_sizes[] = {1, 7, 64, 4096};
+        for (size_t b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); ++b) {
+                uint8_t payload[PAYLOAD_SIZE];
+                struct skytraq_frame_parser p;
+                skytraq_frame_init(&p, payload, sizeof(payload));
+
+                size_t fixes = 0;
+                bool ok = true;
+                const clock_t start = clock();
+                parse_stream(&p, stream, block_sizes[b],
+                             [&](struct skytraq_frame_parser *parser) {
+                        if (parser->payload[0] != NAV_MSG_ID)
+                                return;
+                        if (fixes >= latitudes.size() ||
+                            get_be32(parser->payload + 9) != latitudes[fixes])
+                                ok = false;
+                        ++fixes;
+                });
+                const double secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+                CPPUNIT_ASSERT(ok);
+                CPPUNIT_ASSERT_EQUAL(latitudes.size(), fixes);
+                CPPUNIT_ASSERT_EQUAL((uint32_t) 0, p.errors);
+
+                if (getenv("TRACE") && secs > 0)
+                        printf("\rskytraq: %zu byte blocks: %.1f MB/s\r\n",
+                               block_sizes[b], stream.size() / secs / 1e6);
+        }
+}
@@ -0,0 +1,166 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geopoint.h"
+#include "track_frame.h"
+#include "track_frame_test.h"
+#include <cppunit/extensions/HelperMacros.h>
+#include <fstream>
+#include <math.h>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+using std::ifstream;
+using std::string;
+using std::vector;
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TrackFrameTest );
+
+void TrackFrameTest::testProject()
+{
+        const GeoPoint origin = {38.161531, -122.454724};
+        struct track_frame f;
+        track_frame_init(&f, &origin);
+
+        const struct track_point o = track_frame_project(&f, &origin);
+        CPPUNIT_ASSERT_EQUAL((int32_t) 0, o.x);
+        CPPUNIT_ASSERT_EQUAL((int32_t) 0, o.y);
+
+        /* 0.001 deg of latitude is ~111.19m north */
+        const GeoPoint north = {38.162531, -122.454724};
+        const struct track_point n = track_frame_project(&f, &north);
+        CPPUNIT_ASSERT(abs(n.x) <= 1);
+        CPPUNIT_ASSERT(abs(n.y - 11119) <= 100);
+
+        /* Far away points are clamped rather than overflowing */
+        const GeoPoint far = {-38.0, 57.0};
+        const struct track_point fp = track_frame_project(&f, &far);
+        CPPUNIT_ASSERT(track_point_dist_sq(&fp, &o) > 0);
+}
+
+static vector<GeoPoint> read_session(const string &name)
+{
+        ifstream t(name.c_str());
+        if (!t.is_open())
+                t.open(("test/" + name).c_str());
+        if (!t.is_open())
+                throw ("Can not find file " + name);
+
+        vector<GeoPoint> points;
+        string line;
+        while (std::getline(t, line)) {
+                vector<string> values;
+                std::stringstream ls(line);
+                string item;
+                while (std::getline(ls, item, ','))
+                        values.push_back(item);
+
+                if (values.size() < 16 || values[14].empty() ||
+                    values[15].empty() || values[0][0] == '"')
+                        continue;
+
+                GeoPoint p;
+                p.latitude = atof(values[14].c_str());
+                p.longitude = atof(values[15].c_str());
+                points.push_back(p);
+        }
+
+        return points;
+}
+
+/*
+ * Compares the frame against distPythag over every fix of a recorded
+ * session, both for the error it introduces and, when TRACE is set, for
+ * the time a closest point search takes each way.
+ */
+void TrackFrameTest::testRecordedSessionAccuracy()
+{
+        const vector<GeoPoint> points = read_session("sonoma.log");
+        CPPUNIT_ASSERT(points.size() > 1000);
+
+        struct track_frame f;
+        track_frame_init(&f, &points[0]);
+
+        vector<struct track_point> projected;
+        for (size_t i = 0; i < points.size(); ++i)
+                projected.push_back(track_frame_project(&f, &points[i]));
+
+        float max_err = 0;
+        for (size_t i = 1; i < points.size(); ++i) {
+                /* Fix to fix and fix to origin distances */
+                const float d1 = distPythag(&points[i - 1], &points[i]);
+                const float e1 = track_point_dist(&projected[i - 1],
+                                                  &projected[i]);
+                const float d2 = distPythag(&points[0], &points[i]);
+                const float e2 = track_point_dist(&projected[0],
+                                                  &projected[i]);
+
+                max_err = fmaxf(max_err, fabsf(d1 - e1));
+                max_err = fmaxf(max_err, fabsf(d2 - e2));
+        }
+
+        /* Within a few cm across a ~2km circuit */
+        CPPUNIT_ASSERT(max_err < 0.1f);
+
+        /* Closest point searches, the predictive timer's hot loop */
+        const size_t step = 37;
+        volatile size_t sink = 0;
+
+        clock_t start = clock();
+        for (size_t q = 0; q < points.size(); q += step) {
+                size_t best = 0;
+                float best_d = distPythag(&points[q], &points[0]);
+                for (size_t i = 1; i < points.size(); ++i) {
+                        const float d = distPythag(&points[q], &points[i]);
+                        if (d < best_d) {
+                                best_d = d;
+                                best = i;
+                        }
+                }
+                sink += best;
+        }
+        const double pythag_secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+        start = clock();
+        for (size_t q = 0; q < points.size(); q += step) {
+                const struct track_point tq = track_frame_project(&f, &points[q]);
+                size_t best = 0;
+                int64_t best_d = track_point_dist_sq(&tq, &projected[0]);
+                for (size_t i = 1; i < projected.size(); ++i) {
+                        const int64_t d = track_point_dist_sq(&tq, &projected[i]);
+                        if (d < best_d) {
+                                best_d = d;
+                                best = i;
+                        }
+                }
+                sink += best;
+        }
+        const double frame_secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+        if (getenv("TRACE"))
+                printf("\rtrack_frame: %zu fixes, max error %.3fm, "
+                       "closest point search %.3fs -> %.3fs\r\n",
+                       points.size(), max_err, pythag_secs, frame_secs);
+}
@@ -271,6 +271,10 @@ void LapStatsTest::circuit_lap_finish_event_test()
         CPPUNIT_ASSERT_EQUAL(true, (bool) getAtStartFinish());
         CPPUNIT_ASSERT_EQUAL(false, (bool) lapstats_lap_in_progress());
 
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, sector_stats_history_size());
+        CPPUNIT_ASSERT_EQUAL(getLastLapTime(),
+                             sector_stats_history_lap(0)->lap_time);
+
         /* Stays tripped in CIRCUIT tracks */
         CPPUNIT_ASSERT_EQUAL(true,
                              isGeoTriggerTripped(&g_start_geo_trigger));
@@ -323,6 +327,7 @@ void LapStatsTest::sector_boundary_event_test()
         CPPUNIT_ASSERT_EQUAL(1, getSector());
         CPPUNIT_ASSERT_EQUAL(0, getLastSector());
         CPPUNIT_ASSERT_EQUAL(true, (bool) getAtSector());
+        CPPUNIT_ASSERT_EQUAL(getLastSectorTime(), sector_stats_best_sector(0));
 }
 
 void LapStatsTest::update_distance_test()
@@ -520,3 +525,131 @@ void LapStatsTest::config_changed_test()
 
         CPPUNIT_ASSERT_EQUAL(0, lapstats_get_selected_track_id());
 }
+
+/* Degrees of latitude per 100m */
+#define LAT_DEG_100M	0.00089932f
+
+/*
+ * Sets up a 1Hz fix that passes straight over the finish line, 100m
+ * before it to 100m beyond it, with the lap armed for finishing.
+ */
+static void setup_finish_pass(const float lon_offset)
+{
+        const Track track = TEST_TRACK_VALID_CIRCUIT_TRACK;
+        lapstats_set_active_track(&track, 10);
+
+        const GeoPoint pt = gps_ss.sample.point;
+        lap_started_event(1000, &pt, 0);
+        geo_trigger_trip(&g_finish_geo_trigger);
+        set_distance(1);
+
+        const GeoPoint finish = getFinishPoint(&track);
+        gps_ss.previousPoint.latitude = finish.latitude - LAT_DEG_100M;
+        gps_ss.previousPoint.longitude = finish.longitude + lon_offset;
+        gps_ss.sample.point.latitude = finish.latitude + LAT_DEG_100M;
+        gps_ss.sample.point.longitude = finish.longitude + lon_offset;
+        gps_ss.delta_last_sample = 1000;
+        gps_ss.deltaFirstFix = 10000;
+}
+
+void LapStatsTest::finish_crossing_interpolated_test()
+{
+        setup_finish_pass(0);
+
+        struct gps_segment seg;
+        init_gps_segment(&seg, &gps_ss);
+        process_finish_logic(&seg);
+
+        /* 10m circle is entered 90m into the 200m path; 450ms in. */
+        CPPUNIT_ASSERT_EQUAL(1, getLapCount());
+        CPPUNIT_ASSERT(abs(getLastLapTime() - (9450 - 1000)) <= 5);
+        CPPUNIT_ASSERT(fabs(seg.cursor - 0.45) < 0.005);
+}
+
+void LapStatsTest::finish_crossing_missed_test()
+{
+        /* Same pass, 20m to the side of the finish circle */
+        setup_finish_pass(0.00027f);
+
+        struct gps_segment seg;
+        init_gps_segment(&seg, &gps_ss);
+        process_finish_logic(&seg);
+
+        CPPUNIT_ASSERT_EQUAL(0, getLapCount());
+        CPPUNIT_ASSERT_EQUAL(true, (bool) lapstats_lap_in_progress());
+}
+
+void LapStatsTest::reference_lap_test()
+{
+        Track track = TEST_TRACK_VALID_CIRCUIT_TRACK;
+        track.trackId = 5678;
+        const GeoPoint start = getStartPoint(&track);
+        const GeoPoint pts[] = {
+                start,
+                {start.latitude + 0.001f, start.longitude},
+        };
+        const tiny_millis_t times[] = {0, 10000};
+        CPPUNIT_ASSERT(reference_lap_add_samples(track.trackId, 60000, 0, pts,
+                                                 times, 2,
+                                                 REFERENCE_LAP_ADD_MODE_COMPLETE));
+
+        /* The stored lap is the fast lap as soon as the track is set */
+        lapstats_set_active_track(&track, 10);
+        CPPUNIT_ASSERT(isPredictiveTimeAvailable());
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 60000, getFastLapTime());
+
+        /* A new best is only saved once we have slowed down */
+        const uint32_t serial = reference_lap_find(track.trackId)->serial;
+        g_reference_lap_pending = true;
+        save_reference_lap(&gps_ss);
+        CPPUNIT_ASSERT(g_reference_lap_pending);
+
+        /* Nor while logging, as erasing flash would drop samples */
+        gps_ss.sample.speed = 5;
+        logging_set_logging_start(1);
+        save_reference_lap(&gps_ss);
+        logging_set_logging_start(0);
+        CPPUNIT_ASSERT(g_reference_lap_pending);
+        CPPUNIT_ASSERT_EQUAL(serial,
+                             reference_lap_find(track.trackId)->serial);
+
+        save_reference_lap(&gps_ss);
+        CPPUNIT_ASSERT(!g_reference_lap_pending);
+        CPPUNIT_ASSERT(reference_lap_find(track.trackId)->serial > serial);
+}
+
+void LapStatsTest::reference_lap_upload_abandoned_test()
+{
+        Track track = TEST_TRACK_VALID_CIRCUIT_TRACK;
+        track.trackId = 6789;
+        const GeoPoint start = getStartPoint(&track);
+        const GeoPoint pts[] = {
+                start,
+                {start.latitude + 0.001f, start.longitude},
+        };
+        const tiny_millis_t times[] = {0, 10000};
+
+        CPPUNIT_ASSERT(reference_lap_add_samples(track.trackId, 60000, 0, pts,
+                                                 times, 2,
+                                                 REFERENCE_LAP_ADD_MODE_COMPLETE));
+        lapstats_set_active_track(&track, 10);
+        CPPUNIT_ASSERT(isPredictiveTimeAvailable());
+
+        /* An upload that never finishes holds the buffer for a while */
+        reset_ticks();
+        CPPUNIT_ASSERT(reference_lap_add_samples(track.trackId, 50000, 0, pts,
+                                                 times, 1,
+                                                 REFERENCE_LAP_ADD_MODE_IN_PROGRESS));
+        CPPUNIT_ASSERT(!reference_lap_copy_fast_lap(track.trackId));
+
+        /* But not forever */
+        set_ticks(msToTicks(60000));
+        CPPUNIT_ASSERT(!reference_lap_add_samples(track.trackId, 50000, 1,
+                                                  pts + 1, times + 1, 1,
+                                                  REFERENCE_LAP_ADD_MODE_COMPLETE));
+        CPPUNIT_ASSERT(reference_lap_copy_fast_lap(track.trackId));
+        CPPUNIT_ASSERT(reference_lap_flash_copy());
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 60000,
+                             reference_lap_find(track.trackId)->lap_time);
+        reset_ticks();
+}
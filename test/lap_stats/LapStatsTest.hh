@@ -47,6 +47,10 @@ class LapStatsTest : public CppUnit::TestFixture
         CPPUNIT_TEST( update_elapsed_time_test );
         CPPUNIT_TEST( at_sf_reset_test );
         CPPUNIT_TEST( at_sector_reset_test );
+        CPPUNIT_TEST( finish_crossing_interpolated_test );
+        CPPUNIT_TEST( finish_crossing_missed_test );
+        CPPUNIT_TEST( reference_lap_test );
+        CPPUNIT_TEST( reference_lap_upload_abandoned_test );
         CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -71,6 +75,10 @@ public:
         void update_elapsed_time_test();
         void at_sf_reset_test();
         void at_sector_reset_test();
+        void finish_crossing_interpolated_test();
+        void finish_crossing_missed_test();
+        void reference_lap_test();
+        void reference_lap_upload_abandoned_test();
 };
 
 
@@ -0,0 +1,115 @@
+/*
+ * Race Capture Pro Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture Pro fimrware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SectorStatsTest.hh"
+#include "sector_stats.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SectorStatsTest );
+
+static void drive_lap(const int lap, const tiny_millis_t *sectors,
+                      const int count)
+{
+        tiny_millis_t lap_time = 0;
+
+        sector_stats_lap_started(lap);
+        for (int i = 0; i < count; ++i) {
+                sector_stats_sector_finished(i, sectors[i]);
+                lap_time += sectors[i];
+        }
+        sector_stats_lap_finished(lap_time);
+}
+
+void SectorStatsTest::setUp()
+{
+        sector_stats_reset();
+}
+
+void SectorStatsTest::best_and_delta_test()
+{
+        const tiny_millis_t lap1[] = {30000, 40000, 50000};
+        drive_lap(1, lap1, 3);
+
+        /* Nothing to compare against on the first lap */
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 0, sector_stats_sector_delta(1));
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 40000, sector_stats_best_sector(1));
+
+        sector_stats_lap_started(2);
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 0, sector_stats_last_delta());
+
+        sector_stats_sector_finished(0, 29500);
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) -500, sector_stats_sector_delta(0));
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 29500, sector_stats_best_sector(0));
+
+        sector_stats_sector_finished(1, 41000);
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 1000, sector_stats_last_delta());
+        CPPUNIT_ASSERT_EQUAL(1.0f, sector_stats_last_delta_seconds());
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 40000, sector_stats_best_sector(1));
+}
+
+void SectorStatsTest::optimal_lap_test()
+{
+        /* Not known until a whole lap has been seen */
+        const tiny_millis_t lap1[] = {30000, 40000, 50000};
+        sector_stats_lap_started(1);
+        sector_stats_sector_finished(0, lap1[0]);
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 0, sector_stats_optimal_lap());
+        sector_stats_sector_finished(1, lap1[1]);
+        sector_stats_sector_finished(2, lap1[2]);
+        sector_stats_lap_finished(120000);
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 120000, sector_stats_optimal_lap());
+        CPPUNIT_ASSERT_EQUAL(3, sector_stats_sector_count());
+
+        const tiny_millis_t lap2[] = {29000, 41000, 49000};
+        drive_lap(2, lap2, 3);
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 118000, sector_stats_optimal_lap());
+
+        /* A lap that misses its later sectors doesn't change the count */
+        const tiny_millis_t lap3[] = {28000};
+        drive_lap(3, lap3, 1);
+        CPPUNIT_ASSERT_EQUAL(3, sector_stats_sector_count());
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 117000, sector_stats_optimal_lap());
+
+        sector_stats_reset();
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 0, sector_stats_optimal_lap());
+}
+
+void SectorStatsTest::history_test()
+{
+        CPPUNIT_ASSERT(sector_stats_history_lap(0) == NULL);
+
+        const tiny_millis_t sectors[] = {30000, 40000};
+        for (int lap = 1; lap <= LAP_HISTORY_SIZE + 2; ++lap)
+                drive_lap(lap, sectors, 2);
+
+        CPPUNIT_ASSERT_EQUAL((size_t) LAP_HISTORY_SIZE,
+                             sector_stats_history_size());
+        CPPUNIT_ASSERT(sector_stats_history_lap(LAP_HISTORY_SIZE) == NULL);
+
+        const struct lap_history_entry *latest = sector_stats_history_lap(0);
+        CPPUNIT_ASSERT_EQUAL(LAP_HISTORY_SIZE + 2, latest->lap);
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 70000, latest->lap_time);
+        CPPUNIT_ASSERT_EQUAL(2, latest->sector_count);
+        CPPUNIT_ASSERT_EQUAL((tiny_millis_t) 40000, latest->sectors[1]);
+
+        const struct lap_history_entry *oldest =
+                sector_stats_history_lap(LAP_HISTORY_SIZE - 1);
+        CPPUNIT_ASSERT_EQUAL(3, oldest->lap);
+}
@@ -0,0 +1,42 @@
+/*
+ * Race Capture Pro Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture Pro fimrware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SECTORSTATSTEST_H_
+#define _SECTORSTATSTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class SectorStatsTest : public CppUnit::TestFixture
+{
+        CPPUNIT_TEST_SUITE( SectorStatsTest );
+        CPPUNIT_TEST( best_and_delta_test );
+        CPPUNIT_TEST( optimal_lap_test );
+        CPPUNIT_TEST( history_test );
+        CPPUNIT_TEST_SUITE_END();
+
+public:
+        void setUp();
+        void best_and_delta_test();
+        void optimal_lap_test();
+        void history_test();
+};
+
+#endif /* _SECTORSTATSTEST_H_ */
@@ -0,0 +1,169 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "log_index.h"
+#include "log_index_test.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( LogIndexTest );
+
+static struct log_index li;
+
+void LogIndexTest::setUp()
+{
+        log_index_init(&li);
+}
+
+void LogIndexTest::tearDown() {}
+
+void LogIndexTest::testHeader()
+{
+        struct log_index_header hdr;
+        log_index_header(&hdr);
+
+        CPPUNIT_ASSERT_EQUAL((size_t) 8, sizeof(hdr));
+        CPPUNIT_ASSERT_EQUAL((size_t) 12, sizeof(struct log_index_entry));
+        CPPUNIT_ASSERT(!memcmp("RCIX", hdr.magic, 4));
+        CPPUNIT_ASSERT_EQUAL(LOG_INDEX_VERSION, (int) hdr.version);
+        CPPUNIT_ASSERT_EQUAL(LOG_INDEX_INTERVAL_MS, (int) hdr.interval_ms);
+}
+
+void LogIndexTest::testStart()
+{
+        log_index_start(&li, 120, 3, 1);
+
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, li.count);
+        CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_START, (int) li.pending[0].type);
+        CPPUNIT_ASSERT_EQUAL(120, (int) li.pending[0].offset);
+        CPPUNIT_ASSERT_EQUAL(0, (int) li.pending[0].time);
+        CPPUNIT_ASSERT_EQUAL(3, (int) li.pending[0].lap);
+        CPPUNIT_ASSERT_EQUAL(1, (int) li.pending[0].sector);
+
+        /* Same lap and sector as at the start, so nothing to mark */
+        log_index_row(&li, 200, 100, 3, 1);
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, li.count);
+
+        log_index_consumed(&li);
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, li.count);
+}
+
+void LogIndexTest::testTimeEntries()
+{
+        log_index_start(&li, 100, 0, 0);
+        log_index_consumed(&li);
+
+        uint32_t offset = 100;
+        for (uint32_t time = 0; time < 3500; time += 100, offset += 50)
+                log_index_row(&li, offset, time, 0, 0);
+
+        CPPUNIT_ASSERT_EQUAL((size_t) 3, li.count);
+        for (size_t i = 0; i < li.count; i++) {
+                const uint32_t time = (i + 1) * LOG_INDEX_INTERVAL_MS;
+                CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_TIME,
+                                     (int) li.pending[i].type);
+                CPPUNIT_ASSERT_EQUAL(time, li.pending[i].time);
+                CPPUNIT_ASSERT_EQUAL(100 + time / 2, li.pending[i].offset);
+        }
+
+        /* A late row still lands on the next whole interval */
+        log_index_consumed(&li);
+        log_index_row(&li, 5000, 4250, 0, 0);
+        log_index_row(&li, 5050, 4900, 0, 0);
+        log_index_row(&li, 5100, 5000, 0, 0);
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, li.count);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 4250, li.pending[0].time);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 5000, li.pending[1].time);
+}
+
+void LogIndexTest::testLapAndSectorMarkers()
+{
+        log_index_start(&li, 0, 0, 0);
+        log_index_consumed(&li);
+
+        log_index_row(&li, 10, 10, 1, 0);
+        log_index_row(&li, 20, 20, 1, 1);
+        log_index_row(&li, 30, 30, 1, 1);
+        log_index_row(&li, 40, 40, 2, 0);
+
+        CPPUNIT_ASSERT_EQUAL((size_t) 3, li.count);
+        CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_LAP, (int) li.pending[0].type);
+        CPPUNIT_ASSERT_EQUAL(1, (int) li.pending[0].lap);
+        CPPUNIT_ASSERT_EQUAL(10, (int) li.pending[0].offset);
+        CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_SECTOR, (int) li.pending[1].type);
+        CPPUNIT_ASSERT_EQUAL(1, (int) li.pending[1].sector);
+        CPPUNIT_ASSERT_EQUAL(20, (int) li.pending[1].offset);
+        CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_LAP, (int) li.pending[2].type);
+        CPPUNIT_ASSERT_EQUAL(2, (int) li.pending[2].lap);
+        CPPUNIT_ASSERT_EQUAL(0, (int) li.pending[2].sector);
+}
+
+void LogIndexTest::testStop()
+{
+        log_index_start(&li, 0, 0, 0);
+        log_index_row(&li, 10, 400, 2, 1);
+        log_index_consumed(&li);
+
+        /* The stop carries the last row's time, lap and sector */
+        log_index_stop(&li, 20);
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, li.count);
+        CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_STOP, (int) li.pending[0].type);
+        CPPUNIT_ASSERT_EQUAL(20, (int) li.pending[0].offset);
+        CPPUNIT_ASSERT_EQUAL(400, (int) li.pending[0].time);
+        CPPUNIT_ASSERT_EQUAL(2, (int) li.pending[0].lap);
+        CPPUNIT_ASSERT_EQUAL(1, (int) li.pending[0].sector);
+}
+
+void LogIndexTest::testDiscard()
+{
+        log_index_start(&li, 0, 0, 0);
+        log_index_row(&li, 10, 1000, 0, 0);
+        log_index_row(&li, 20, 1100, 1, 0);
+        log_index_row(&li, 30, 1200, 1, 1);
+        CPPUNIT_ASSERT_EQUAL((size_t) 4, li.count);
+
+        log_index_discard(&li, 10);
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, li.count);
+        CPPUNIT_ASSERT_EQUAL(10, (int) li.pending[1].offset);
+
+        /* The rows that take the place of the lost ones are marked again */
+        log_index_row(&li, 20, 1300, 1, 1);
+        CPPUNIT_ASSERT_EQUAL((size_t) 3, li.count);
+        CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_LAP, (int) li.pending[2].type);
+        CPPUNIT_ASSERT_EQUAL(1, (int) li.pending[2].lap);
+        CPPUNIT_ASSERT_EQUAL(20, (int) li.pending[2].offset);
+}
+
+void LogIndexTest::testOverflow()
+{
+        for (int i = 0; i < LOG_INDEX_PENDING; i++)
+                CPPUNIT_ASSERT(log_index_add(&li, LOG_INDEX_TIME, i, i, 0, 0));
+
+        CPPUNIT_ASSERT(!log_index_add(&li, LOG_INDEX_LAP, 99, 99, 1, 0));
+        CPPUNIT_ASSERT(li.overflow);
+        CPPUNIT_ASSERT_EQUAL((size_t) LOG_INDEX_PENDING, li.count);
+
+        log_index_consumed(&li);
+        CPPUNIT_ASSERT(!li.overflow);
+        CPPUNIT_ASSERT(log_index_add(&li, LOG_INDEX_LAP, 99, 99, 1, 0));
+}
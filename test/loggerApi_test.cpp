@@ -22,11 +22,13 @@
 #include "FreeRTOS.h"
 #include "api.h"
 #include "auto_logger.h"
+#include "boot_stats.h"
 #include "bluetooth.h"
 #include "cellular.h"
 #include "channel_config.h"
 #include "constants.h"
 #include "cpu.h"
+#include "device_cache.h"
 #include "imu.h"
 #include "jsmn.h"
 #include "lap_stats.h"
@@ -38,9 +40,12 @@
 #include "luaScript.h"
 #include "memory_mock.h"
 #include "mock_serial.h"
+#include "perf.h"
 #include "predictive_timer_2.h"
 #include "printk.h"
 #include "rcp_cpp_unit.hh"
+#include "reference_lap.h"
+#include "sector_stats.h"
 #include "sim900.h"
 #include "task.h"
 #include "task_testing.h"
@@ -362,6 +367,18 @@ void LoggerApiTest::testSetAnalogCfg()
         testSetAnalogConfigFile("setAnalogCfg3.json");
 }
 
+void LoggerApiTest::testSetAnalogCfgFilter()
+{
+        /* The filter object must not disturb the fields that follow it */
+        testSetAnalogConfigFile("setAnalogCfgFilter.json");
+
+        const struct channel_filter_config *filter =
+                &getWorkingLoggerConfig()->ADCConfigs[0].filter;
+        CPPUNIT_ASSERT_EQUAL((uint8_t) CHANNEL_FILTER_BIQUAD_LOWPASS, filter->type);
+        CPPUNIT_ASSERT_EQUAL((uint8_t) 1, filter->size);
+        CPPUNIT_ASSERT_EQUAL(2.5F, filter->param);
+}
+
 void LoggerApiTest::testGetImuConfigFile(string filename, int index)
 {
         LoggerConfig *c = getWorkingLoggerConfig();
@@ -892,7 +909,8 @@ void LoggerApiTest::testSetLapConfigFile(string filename)
         testChannelConfig(&cfg->sectorTimeCfg, string("SectorTime"), string("Min"), 50);
         testChannelConfig(&cfg->predTimeCfg, string("PredTime"), string("Min"), 50);
         testChannelConfig(&cfg->distance, string("Distance"), string(units_get_label(distance_unit)), 50);
-
+        testChannelConfig(&cfg->sector_delta_cfg, string("SectorDelta"), string("Sec"), 25);
+        testChannelConfig(&cfg->optimal_time_cfg, string("OptimalTime"), string("Min"), 25);
 }
 
 void LoggerApiTest::testGetLapConfigFile(string filename)
@@ -907,6 +925,8 @@ void LoggerApiTest::testGetLapConfigFile(string filename)
         populateChannelConfig(&cfg->sectorTimeCfg, 4, 50);
         populateChannelConfig(&cfg->predTimeCfg, 5, 50);
         populateChannelConfig(&cfg->distance, 6, 50);
+        populateChannelConfig(&cfg->sector_delta_cfg, 7, 50);
+        populateChannelConfig(&cfg->optimal_time_cfg, 8, 50);
 
         const char *response = processApiGeneric(filename);
         Object json;
@@ -918,6 +938,8 @@ void LoggerApiTest::testGetLapConfigFile(string filename)
         Object &lapSectorTime = json["lapCfg"]["sectorTime"];
         Object &lapPredTime = json["lapCfg"]["predTime"];
         Object &lapDist = json["lapCfg"]["dist"];
+        Object &sectorDelta = json["lapCfg"]["sectorDelta"];
+        Object &optimalTime = json["lapCfg"]["optimalTime"];
 
         string str1 = string("1");
         string str2 = string("2");
@@ -932,6 +954,41 @@ void LoggerApiTest::testGetLapConfigFile(string filename)
         check_channel_config(lapSectorTime, &cfg->sectorTimeCfg);
         check_channel_config(lapPredTime, &cfg->predTimeCfg);
         check_channel_config(lapDist, &cfg->distance);
+        check_channel_config(sectorDelta, &cfg->sector_delta_cfg);
+        check_channel_config(optimalTime, &cfg->optimal_time_cfg);
+}
+
+void LoggerApiTest::testGetLapHistory()
+{
+        sector_stats_reset();
+        sector_stats_lap_started(1);
+        sector_stats_sector_finished(0, 30000);
+        sector_stats_sector_finished(1, 40000);
+        sector_stats_lap_finished(70000);
+        sector_stats_lap_started(2);
+        sector_stats_sector_finished(0, 29000);
+
+        const char *response = processApiGeneric("getLapHist1.json");
+        Object json;
+        stringToJson(response, json);
+
+        Object &hist = json["lapHist"];
+        CPPUNIT_ASSERT_EQUAL(69000, (int)(Number) hist["optimal"]);
+
+        Array &best = hist["best"];
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, best.Size());
+        CPPUNIT_ASSERT_EQUAL(29000, (int)(Number) best[0]);
+        Array &delta = hist["delta"];
+        CPPUNIT_ASSERT_EQUAL(-1000, (int)(Number) delta[0]);
+
+        Array &laps = hist["laps"];
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, laps.Size());
+        Object &lap = laps[0];
+        CPPUNIT_ASSERT_EQUAL(1, (int)(Number) lap["lap"]);
+        CPPUNIT_ASSERT_EQUAL(70000, (int)(Number) lap["time"]);
+        Array &sectors = lap["sectors"];
+        CPPUNIT_ASSERT_EQUAL(40000, (int)(Number) sectors[1]);
+        sector_stats_reset();
 }
 
 void LoggerApiTest::testGetLapCfg()
@@ -1275,6 +1332,255 @@ void LoggerApiTest::testSetCanChanCfgFile(string filename)
         }
 }
 
+void LoggerApiTest::testGetMathCfg()
+{
+        LoggerConfig *c = getWorkingLoggerConfig();
+        struct math_channel_config *cfg = &c->math_channel_cfg;
+
+        cfg->enabled_channels = 2;
+        for (size_t i = 0; i < cfg->enabled_channels; i++) {
+                populateChannelConfig(&(cfg->channels[i].cfg), i, 50);
+                strcpy(cfg->channels[i].expr, "max(RPM, 1000) / 2");
+        }
+
+        const char *response = processApiGeneric("getMathCfg1.json");
+        Object json;
+        stringToJson(response, json);
+
+        Array chans = (Array)json["mathCfg"]["chans"];
+        CPPUNIT_ASSERT_EQUAL((size_t)2, chans.Size());
+        for (size_t i = 0; i < cfg->enabled_channels; i++) {
+                Object ch = (Object)chans[i];
+                check_channel_config(ch, &(cfg->channels[i].cfg));
+                CPPUNIT_ASSERT_EQUAL(string("max(RPM, 1000) / 2"), (string)(String)ch["expr"]);
+        }
+}
+
+void LoggerApiTest::testSetMathCfg()
+{
+        processApiGeneric("setMathCfg1.json");
+
+        Object json;
+        string json_string = readFile("setMathCfg1.json");
+        stringToJson(json_string.c_str(), json);
+
+        char *txBuffer = mock_getTxBuffer();
+        assertGenericResponse(txBuffer, "setMathCfg", API_SUCCESS);
+
+        struct math_channel_config *cfg = &getWorkingLoggerConfig()->math_channel_cfg;
+        Object jch = (Object)json["setMathCfg"]["chans"][0];
+        check_channel_config(jch, &(cfg->channels[0].cfg));
+        CPPUNIT_ASSERT_EQUAL(string("(RPM / Speed) * 0.5"), string(cfg->channels[0].expr));
+        CPPUNIT_ASSERT_EQUAL(1, (int)cfg->enabled_channels);
+}
+
+void LoggerApiTest::testSetMathCfgInvalidExpr()
+{
+        processApiGeneric("setMathCfg_invalid_expr.json");
+
+        char *txBuffer = mock_getTxBuffer();
+        assertGenericResponse(txBuffer, "setMathCfg", API_ERROR_PARAMETER);
+
+        struct math_channel_config *cfg = &getWorkingLoggerConfig()->math_channel_cfg;
+        CPPUNIT_ASSERT_EQUAL(string(""), string(cfg->channels[0].expr));
+        CPPUNIT_ASSERT_EQUAL(0, (int)cfg->enabled_channels);
+}
+
+void LoggerApiTest::testSetMathCfgPartialInvalid()
+{
+        processApiGeneric("setMathCfg_partial_invalid.json");
+
+        char *txBuffer = mock_getTxBuffer();
+        assertGenericResponse(txBuffer, "setMathCfg", API_ERROR_PARAMETER);
+
+        /* The valid first entry must not have been applied either */
+        struct math_channel_config *cfg = &getWorkingLoggerConfig()->math_channel_cfg;
+        CPPUNIT_ASSERT(string("Ratio") != string(cfg->channels[0].cfg.label));
+        CPPUNIT_ASSERT_EQUAL(string(""), string(cfg->channels[0].expr));
+        CPPUNIT_ASSERT(string("Broken") != string(cfg->channels[1].cfg.label));
+        CPPUNIT_ASSERT_EQUAL(0, (int)cfg->enabled_channels);
+}
+
+void LoggerApiTest::testSetMathCfgExprTooLong()
+{
+        /* Would compile if it were silently cut down to size */
+        processApiGeneric("setMathCfg_expr_too_long.json");
+
+        char *txBuffer = mock_getTxBuffer();
+        assertGenericResponse(txBuffer, "setMathCfg", API_ERROR_PARAMETER);
+
+        struct math_channel_config *cfg = &getWorkingLoggerConfig()->math_channel_cfg;
+        CPPUNIT_ASSERT_EQUAL(string(""), string(cfg->channels[0].expr));
+        CPPUNIT_ASSERT_EQUAL(0, (int)cfg->enabled_channels);
+}
+
+void LoggerApiTest::testGetFusionCfg()
+{
+        struct gps_fusion_config *cfg = &getWorkingLoggerConfig()->fusion_cfg;
+        cfg->speed.sampleRate = encodeSampleRate(25);
+        cfg->lap_timing = true;
+
+        const char *response = processApiGeneric("getFusionCfg1.json");
+        Object json;
+        stringToJson(response, json);
+
+        Object fc = (Object)json["fusionCfg"];
+        CPPUNIT_ASSERT_EQUAL(25, (int)(Number)fc["sr"]);
+        CPPUNIT_ASSERT_EQUAL(0, (int)(Number)fc["pos"]);
+        CPPUNIT_ASSERT_EQUAL(1, (int)(Number)fc["speed"]);
+        CPPUNIT_ASSERT_EQUAL(0, (int)(Number)fc["heading"]);
+        CPPUNIT_ASSERT_EQUAL(true, (bool)(Boolean)fc["lap"]);
+        CPPUNIT_ASSERT_EQUAL(string("mph"), (string)(String)fc["units"]["speed"]);
+}
+
+void LoggerApiTest::testSetFusionCfg()
+{
+        processApiGeneric("setFusionCfg1.json");
+
+        char *txBuffer = mock_getTxBuffer();
+        assertGenericResponse(txBuffer, "setFusionCfg", API_SUCCESS);
+
+        const struct gps_fusion_config *cfg = &getWorkingLoggerConfig()->fusion_cfg;
+        CPPUNIT_ASSERT_EQUAL(50, decodeSampleRate(cfg->latitude.sampleRate));
+        CPPUNIT_ASSERT_EQUAL(50, decodeSampleRate(cfg->longitude.sampleRate));
+        CPPUNIT_ASSERT_EQUAL(50, decodeSampleRate(cfg->speed.sampleRate));
+        CPPUNIT_ASSERT_EQUAL(SAMPLE_DISABLED, (int)cfg->heading.sampleRate);
+        CPPUNIT_ASSERT(cfg->lap_timing);
+        CPPUNIT_ASSERT_EQUAL(string("kph"), string(cfg->speed.units));
+}
+
+void LoggerApiTest::testGetLogList()
+{
+        processApiGeneric("getLogList1.json");
+        assertGenericResponse(mock_getTxBuffer(), "getLogList",
+                              API_ERROR_PARAMETER);
+
+        /* No file writer task is running to serve the request */
+        processApiGeneric("getLogList2.json");
+        assertGenericResponse(mock_getTxBuffer(), "getLogList",
+                              API_ERROR_SEVERE);
+}
+
+void LoggerApiTest::testReadLog()
+{
+        processApiGeneric("readLog1.json");
+        assertGenericResponse(mock_getTxBuffer(), "readLog",
+                              API_ERROR_MALFORMED);
+
+        processApiGeneric("readLog2.json");
+        assertGenericResponse(mock_getTxBuffer(), "readLog",
+                              API_ERROR_PARAMETER);
+
+        processApiGeneric("readLog3.json");
+        assertGenericResponse(mock_getTxBuffer(), "readLog",
+                              API_ERROR_SEVERE);
+}
+
+void LoggerApiTest::testGetPerf()
+{
+        perf_reset();
+        perf_register_queue("Test", "samples", (xQueueHandle) this, 4);
+        perf_count(PERF_COUNTER_CAN_RX_DROP);
+        perf_count(PERF_COUNTER_CAN_RX_DROP);
+
+        const char *response = processApiGeneric("getPerf1.json");
+        Object json;
+        stringToJson(response, json);
+
+        Object &perf = json["perf"];
+        Array &queues = perf["queues"];
+        CPPUNIT_ASSERT(queues.Size() > 0);
+        Object &queue = queues[queues.Size() - 1];
+        CPPUNIT_ASSERT_EQUAL(string("Test"), string((String) queue["owner"]));
+        CPPUNIT_ASSERT_EQUAL(string("samples"), string((String) queue["name"]));
+        CPPUNIT_ASSERT_EQUAL(4, (int)(Number) queue["len"]);
+        CPPUNIT_ASSERT_EQUAL(0, (int)(Number) queue["depth"]);
+        CPPUNIT_ASSERT_EQUAL(2, (int)(Number) perf["drops"]["canRxDrop"]);
+        CPPUNIT_ASSERT_EQUAL(0, (int)(Number) perf["drops"]["logOverflow"]);
+        CPPUNIT_ASSERT(0 < (int)(Number) perf["hz"]);
+        Array &regions = perf["regions"];
+        for (size_t i = 0; i < regions.Size(); ++i) {
+                Object &region = regions[i];
+                CPPUNIT_ASSERT((int)(Number) region["min"] <=
+                               (int)(Number) region["max"]);
+        }
+
+        /* The request itself holds one of the pooled token arrays */
+        const Object &cperf = perf;
+        const Array &pools = cperf["pools"];
+        bool found = false;
+        for (size_t i = 0; i < pools.Size(); ++i) {
+                const Object &pool = pools[i];
+                if (string("jsonTokens") != string((const String &) pool["name"]))
+                        continue;
+
+                found = true;
+                CPPUNIT_ASSERT_EQUAL(1, (int)(const Number &) pool["used"]);
+                CPPUNIT_ASSERT_EQUAL(JSON_TOKEN_ARRAYS,
+                                     (int)(const Number &) pool["cap"]);
+        }
+        CPPUNIT_ASSERT(found);
+        CPPUNIT_ASSERT_EQUAL(0, (int)(const Number &) cperf["heap"]["fails"]);
+
+        /* The request asked for a reset once the snapshot was taken */
+        response = processApiGeneric("getPerf1.json");
+        Object after;
+        stringToJson(response, after);
+        CPPUNIT_ASSERT_EQUAL(0, (int)(Number) after["perf"]["drops"]["canRxDrop"]);
+}
+
+void LoggerApiTest::testGetBoot()
+{
+        boot_stats_reset();
+        boot_stats_begin(BOOT_PHASE_SETUP);
+        boot_stats_end(BOOT_PHASE_SETUP);
+        device_cache_set(DEVICE_CACHE_WIFI_BAUD, 115200);
+
+        const char *response = processApiGeneric("getBoot1.json");
+        Object json;
+        stringToJson(response, json);
+
+        Object &boot = json["boot"];
+        Object &setup = boot["setup"];
+        CPPUNIT_ASSERT((int)(Number) setup["start"] <=
+                       (int)(Number) setup["end"]);
+
+        /* Phases that never finished have no end */
+        const Object &gps_fix = boot["gpsFix"];
+        bool null_end = true;
+        try {
+                (const Number &) gps_fix["end"];
+                null_end = false;
+        } catch (json::Exception &e) {
+        }
+        CPPUNIT_ASSERT(null_end);
+        CPPUNIT_ASSERT_EQUAL(115200, (int)(Number) boot["cache"]["wifiBaud"]);
+}
+
+void LoggerApiTest::testSetRefLap()
+{
+        processApiGeneric("setRefLap1.json");
+        assertGenericResponse(mock_getTxBuffer(), "setRefLap", API_SUCCESS);
+
+        /* Nothing is stored until the last chunk arrives */
+        CPPUNIT_ASSERT(reference_lap_find(4321) == NULL);
+
+        processApiGeneric("setRefLap2.json");
+        assertGenericResponse(mock_getTxBuffer(), "setRefLap", API_SUCCESS);
+
+        const struct reference_lap *ref = reference_lap_find(4321);
+        CPPUNIT_ASSERT(ref != NULL);
+        CPPUNIT_ASSERT_EQUAL(92000, (int) ref->lap_time);
+        CPPUNIT_ASSERT_EQUAL(5, (int) ref->count);
+        CPPUNIT_ASSERT(setReferenceLap(ref));
+
+        /* A chunk that doesn't follow on from an upload is refused */
+        processApiGeneric("setRefLap2.json");
+        assertGenericResponse(mock_getTxBuffer(), "setRefLap",
+                              API_ERROR_SEVERE);
+        resetPredictiveTimer();
+}
+
 void LoggerApiTest::testSetObd2Cfg()
 {
         testSetObd2ConfigFile("setObd2Cfg1.json");
@@ -1453,6 +1759,7 @@ void LoggerApiTest::testGetCapabilities()
         CPPUNIT_ASSERT_EQUAL(TIMER_CHANNELS, (int)(Number)json["capabilities"]["channels"]["timer"]);
         CPPUNIT_ASSERT_EQUAL(PWM_CHANNELS, (int)(Number)json["capabilities"]["channels"]["pwm"]);
         CPPUNIT_ASSERT_EQUAL(CAN_CHANNELS, (int)(Number)json["capabilities"]["channels"]["can"]);
+        CPPUNIT_ASSERT_EQUAL(MATH_CHANNELS, (int)(Number)json["capabilities"]["channels"]["math"]);
 
         CPPUNIT_ASSERT_EQUAL(MAX_SENSOR_SAMPLE_RATE, (int)(Number)json["capabilities"]["sampleRates"]["sensor"]);
         CPPUNIT_ASSERT_EQUAL(MAX_GPS_SAMPLE_RATE, (int)(Number)json["capabilities"]["sampleRates"]["gps"]);
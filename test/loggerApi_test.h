@@ -44,6 +44,7 @@ class LoggerApiTest : public CppUnit::TestFixture
         CPPUNIT_TEST( testGetAnalogCfg );
         CPPUNIT_TEST( testGetMultipleAnalogCfg );
         CPPUNIT_TEST( testSetAnalogCfg );
+        CPPUNIT_TEST( testSetAnalogCfgFilter );
         CPPUNIT_TEST( testGetImuCfg );
         CPPUNIT_TEST( testSetImuCfg );
         CPPUNIT_TEST( testGetPwmCfg );
@@ -60,6 +61,11 @@ class LoggerApiTest : public CppUnit::TestFixture
         CPPUNIT_TEST( testGetTrackCfgCircuit );
         CPPUNIT_TEST( testAddTrackDb );
         CPPUNIT_TEST( testGetTrackDb );
+        CPPUNIT_TEST( testGetLapHistory );
+        CPPUNIT_TEST( testGetLogList );
+        CPPUNIT_TEST( testReadLog );
+        CPPUNIT_TEST( testGetPerf );
+        CPPUNIT_TEST( testGetBoot );
         CPPUNIT_TEST( testSampleData1 );
         CPPUNIT_TEST( testSampleData2 );
         CPPUNIT_TEST( testHeartBeat );
@@ -74,6 +80,14 @@ class LoggerApiTest : public CppUnit::TestFixture
         CPPUNIT_TEST( testGetObd2Cfg);
         CPPUNIT_TEST( testGetCanChanCfg);
         CPPUNIT_TEST( testSetCanChanCfg);
+        CPPUNIT_TEST( testGetMathCfg);
+        CPPUNIT_TEST( testSetMathCfg);
+        CPPUNIT_TEST( testSetMathCfgInvalidExpr);
+        CPPUNIT_TEST( testSetMathCfgPartialInvalid);
+        CPPUNIT_TEST( testSetMathCfgExprTooLong);
+        CPPUNIT_TEST( testGetFusionCfg);
+        CPPUNIT_TEST( testSetFusionCfg);
+        CPPUNIT_TEST( testSetRefLap);
         CPPUNIT_TEST( testGetScript);
         CPPUNIT_TEST( testSetScript);
         CPPUNIT_TEST( testRunScript);
@@ -123,6 +137,7 @@ public:
         void testGetAnalogCfg();
         void testGetMultipleAnalogCfg();
         void testSetAnalogCfg();
+        void testSetAnalogCfgFilter();
         void testGetImuCfg();
         void testSetImuCfg();
         void testGetPwmCfg();
@@ -139,6 +154,11 @@ public:
         void testGetTrackCfgCircuit();
         void testAddTrackDb();
         void testGetTrackDb();
+        void testGetLapHistory();
+        void testGetLogList();
+        void testReadLog();
+        void testGetPerf();
+        void testGetBoot();
         void testCalibrateImu();
         void testFlashConfig();
         void testSetLogLevel();
@@ -146,6 +166,14 @@ public:
         void testSetCanCfg();
         void testGetCanChanCfg();
         void testSetCanChanCfg();
+        void testGetMathCfg();
+        void testSetMathCfg();
+        void testSetMathCfgInvalidExpr();
+        void testSetMathCfgPartialInvalid();
+        void testSetMathCfgExprTooLong();
+        void testGetFusionCfg();
+        void testSetFusionCfg();
+        void testSetRefLap();
         void testSetObd2Cfg();
         void testSetObd2ConfigFile_fromIndex();
         void testSetObd2ConfigFile_invalid();
@@ -276,3 +276,23 @@ void LoggerConfigTest::testLoggerInitConnectivityConfig()
         CPPUNIT_ASSERT_EQUAL(string(DEFAULT_TELEMETRY_SERVER_HOST),
                              string(tc->telemetryServerHost));
 }
+
+void LoggerConfigTest::testSampleRateGcd()
+{
+        CPPUNIT_ASSERT_EQUAL(SAMPLE_50Hz,
+                             getCommonSampleRate(SAMPLE_25Hz, SAMPLE_10Hz));
+        CPPUNIT_ASSERT_EQUAL(SAMPLE_5Hz,
+                             getCommonSampleRate(SAMPLE_DISABLED, SAMPLE_5Hz));
+        CPPUNIT_ASSERT_EQUAL(SAMPLE_5Hz,
+                             getCommonSampleRate(SAMPLE_5Hz, SAMPLE_DISABLED));
+
+        /* The defaults run at 1, 5, 10 and 25Hz */
+        LoggerConfig *lc = getWorkingLoggerConfig();
+        CPPUNIT_ASSERT_EQUAL((unsigned int) SAMPLE_50Hz, getSampleRateGcd(lc));
+
+        lc->ADCConfigs[1].cfg.sampleRate = SAMPLE_200Hz;
+        CPPUNIT_ASSERT_EQUAL((unsigned int) SAMPLE_200Hz, getSampleRateGcd(lc));
+
+        lc->ADCConfigs[2].cfg.sampleRate = SAMPLE_500Hz;
+        CPPUNIT_ASSERT_EQUAL((unsigned int) SAMPLE_1000Hz, getSampleRateGcd(lc));
+}
@@ -1,5 +1,6 @@
 #include "loggerData_test.h"
 #include "loggerSampleData.test.h"
+#include "analog_scaling.h"
 #include "loggerApi.h"
 #include <string.h>
 #include "mock_serial.h"
@@ -47,3 +48,57 @@ void LoggerDataTest::testMappedValue()
                 CPPUNIT_ASSERT_CLOSE_ENOUGH(scaled, expected);
         }
 }
+
+void LoggerDataTest::testMappedValueShortMap()
+{
+        /* Bins past the first non ascending raw value are ignored */
+        ScalingMap m;
+        m.rawValues[0] = 100;
+        m.rawValues[1] = 200;
+        m.rawValues[2] = 300;
+        m.rawValues[3] = 0;
+        m.rawValues[4] = 0;
+
+        m.scaledValues[0] = 10.0f;
+        m.scaledValues[1] = 0.0f;
+        m.scaledValues[2] = 5.0f;
+        m.scaledValues[3] = 0.0f;
+        m.scaledValues[4] = 0.0f;
+
+        CPPUNIT_ASSERT_CLOSE_ENOUGH(get_mapped_value(50, &m), 10.0f);
+        CPPUNIT_ASSERT_CLOSE_ENOUGH(get_mapped_value(150, &m), 5.0f);
+        CPPUNIT_ASSERT_CLOSE_ENOUGH(get_mapped_value(200, &m), 0.0f);
+        CPPUNIT_ASSERT_CLOSE_ENOUGH(get_mapped_value(250, &m), 2.5f);
+        CPPUNIT_ASSERT_CLOSE_ENOUGH(get_mapped_value(1000, &m), 5.0f);
+}
+
+void LoggerDataTest::testAnalogScaling()
+{
+        struct analog_scaling s;
+        ADCConfig ac;
+        memset(&ac, 0, sizeof(ac));
+        ac.linearScaling = 2.5f;
+        ac.linearOffset = -1.0f;
+
+        ac.scalingMode = SCALING_MODE_RAW;
+        analog_scaling_compile(&s, &ac);
+        CPPUNIT_ASSERT_CLOSE_ENOUGH(analog_scaling_apply(&s, 3.0f), 3.0f);
+
+        ac.scalingMode = SCALING_MODE_LINEAR;
+        analog_scaling_compile(&s, &ac);
+        CPPUNIT_ASSERT_CLOSE_ENOUGH(analog_scaling_apply(&s, 3.0f), 6.5f);
+
+        for (int i = 0; i < ANALOG_SCALING_BINS; i++) {
+                ac.scalingMap.rawValues[i] = i;
+                ac.scalingMap.scaledValues[i] = i * i;
+        }
+        ac.scalingMode = SCALING_MODE_MAP;
+        analog_scaling_compile(&s, &ac);
+        CPPUNIT_ASSERT_CLOSE_ENOUGH(analog_scaling_apply(&s, -1.0f), 0.0f);
+        CPPUNIT_ASSERT_CLOSE_ENOUGH(analog_scaling_apply(&s, 1.5f), 2.5f);
+        CPPUNIT_ASSERT_CLOSE_ENOUGH(analog_scaling_apply(&s, 2.0f), 4.0f);
+
+        ac.scalingMode = 42;
+        analog_scaling_compile(&s, &ac);
+        CPPUNIT_ASSERT_CLOSE_ENOUGH(analog_scaling_apply(&s, 3.0f), -1.0f);
+}
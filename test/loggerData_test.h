@@ -28,6 +28,8 @@ class LoggerDataTest : public CppUnit::TestFixture
 {
         CPPUNIT_TEST_SUITE( LoggerDataTest );
         CPPUNIT_TEST( testMappedValue );
+        CPPUNIT_TEST( testMappedValueShortMap );
+        CPPUNIT_TEST( testAnalogScaling );
         CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -38,6 +40,8 @@ public:
         void testGpsChannels();
         void testImuChannels();
         void testMappedValue();
+        void testMappedValueShortMap();
+        void testAnalogScaling();
 };
 
 #endif /* LOGGERDATA_TEST_H_ */
@@ -0,0 +1,386 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "loggerFileWriterFsTest.hh"
+#include "FreeRTOS.h"
+#include "diskio_host.h"
+#include "ff.h"
+#include "fileWriter.h"
+#include "fileWriter_testing.h"
+#include "gps.h"
+#include "log_index.h"
+#include "loggerConfig.h"
+#include "loggerHardware.h"
+#include "loggerSampleData.h"
+#include "mock_serial.h"
+#include "sampleRecord.h"
+#include "sdcard.h"
+#include "task.h"
+#include "task_testing.h"
+#include "taskUtil.h"
+
+#include <algorithm>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( LoggerFileWriterFsTest );
+
+/* With no GPS time the logs go in the root of the card */
+#define LOG_NAME	"rc_0.log"
+#define INDEX_NAME	"rc_0.idx"
+
+static struct logging_status fs_ls;
+static struct sample fs_sample;
+static size_t fs_sample_ticks;
+
+static void log_rows(const int rows, const int expected_rc)
+{
+        LoggerMessage msg;
+        msg.type = LoggerMessageType_Sample;
+        msg.sample = &fs_sample;
+
+        for (int i = 0; i < rows; i++) {
+                msg.ticks = fs_sample.ticks = ++fs_sample_ticks;
+                const int rc = logging_sample(&fs_ls, &msg);
+                if (expected_rc)
+                        CPPUNIT_ASSERT(0 != rc);
+                else
+                        CPPUNIT_ASSERT_EQUAL(0, rc);
+        }
+}
+
+static void flush_rows(void)
+{
+        set_ticks(xTaskGetTickCount() + FLUSH_INTERVAL_MS / portTICK_RATE_MS);
+        CPPUNIT_ASSERT_EQUAL(0, flush_logfile(&fs_ls));
+}
+
+static DWORD file_size(const char *path)
+{
+        FILINFO info;
+        memset(&info, 0, sizeof(info));
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_stat(path, &info));
+        return info.fsize;
+}
+
+static DWORD free_clusters(void)
+{
+        FATFS *fs;
+        DWORD clusters = 0;
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_getfree("0", &clusters, &fs));
+        return clusters;
+}
+
+static string read_log(const char *path, const size_t max)
+{
+        FIL f;
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_open(&f, path, FA_READ));
+
+        string data(std::min((size_t) f_size(&f), max), '\0');
+        UINT read = 0;
+        if (!data.empty())
+                CPPUNIT_ASSERT_EQUAL(FR_OK, f_read(&f, &data[0], data.size(), &read));
+        f_close(&f);
+
+        CPPUNIT_ASSERT_EQUAL(data.size(), (size_t) read);
+        return data;
+}
+
+/**
+ * Checks that a log is nothing but whole rows, each with as many cells
+ * as the header.
+ * @return the number of rows, header included.
+ */
+static int check_rows(const string &log)
+{
+        CPPUNIT_ASSERT_EQUAL(string::npos, log.find('\0'));
+        CPPUNIT_ASSERT(!log.empty());
+        CPPUNIT_ASSERT_EQUAL('\n', log[log.size() - 1]);
+
+        int rows = 0;
+        long cells = -1;
+        size_t start = 0;
+        for (size_t end; (end = log.find('\n', start)) != string::npos;
+             start = end + 1, rows++) {
+                const long n = std::count(log.begin() + start,
+                                          log.begin() + end, ',');
+                if (cells < 0)
+                        cells = n;
+                CPPUNIT_ASSERT_EQUAL(cells, n);
+        }
+
+        return rows;
+}
+
+static vector<struct log_index_entry> read_index(void)
+{
+        const string data = read_log(INDEX_NAME, SIZE_MAX);
+        const size_t start = sizeof(struct log_index_header);
+        CPPUNIT_ASSERT(data.size() >= start);
+
+        vector<struct log_index_entry> entries((data.size() - start) /
+                                               sizeof(struct log_index_entry));
+        if (!entries.empty())
+                memcpy(&entries[0], data.data() + start,
+                       entries.size() * sizeof(struct log_index_entry));
+        return entries;
+}
+
+/* Mounts the card afresh, as the firmware would find it after a reboot */
+static FRESULT reboot_mount(FATFS *fs)
+{
+        UnmountFS();
+        return f_mount(fs, "0", 1);
+}
+
+void LoggerFileWriterFsTest::setUp()
+{
+        static bool started;
+        if (!started) {
+                InitLoggerHardware();
+                setupMockSerial();
+                GPS_init(10, getMockSerial());
+                startFileWriterTask(1);
+                started = true;
+        }
+
+        /* Pull the old card so the writer forgets about it, then a new one */
+        diskio_host_close();
+        prepare_next_log_file();
+        UnmountFS();
+
+        CPPUNIT_ASSERT(diskio_host_ram(DISKIO_HOST_DEFAULT_SECTORS));
+        CPPUNIT_ASSERT_EQUAL((int) FR_OK, diskio_host_format());
+        InitFSHardware();
+
+        initialize_logger_config();
+        reset_ticks();
+        memset(&fs_ls, 0, sizeof(fs_ls));
+        memset(&fs_sample, 0, sizeof(fs_sample));
+        init_sample_buffer(&fs_sample,
+                           get_enabled_channel_count(getWorkingLoggerConfig()));
+        populate_sample_buffer(&fs_sample, 0);
+        fs_sample_ticks = 0;
+}
+
+void LoggerFileWriterFsTest::tearDown()
+{
+        logging_stop(&fs_ls);
+        free_sample_buffer(&fs_sample);
+}
+
+void LoggerFileWriterFsTest::testLogRows()
+{
+        logging_start(&fs_ls);
+        log_rows(100, 0);
+        CPPUNIT_ASSERT_EQUAL(string(LOG_NAME), string(fs_ls.name));
+        logging_stop(&fs_ls);
+
+        const string log = read_log(LOG_NAME, SIZE_MAX);
+        CPPUNIT_ASSERT_EQUAL(101, check_rows(log));
+        CPPUNIT_ASSERT(file_size(INDEX_NAME) > 0);
+}
+
+void LoggerFileWriterFsTest::testPreparedFileHoldsNoClusters()
+{
+        FATFS fs;
+        CPPUNIT_ASSERT_EQUAL(FR_OK, reboot_mount(&fs));
+        const DWORD blank = free_clusters();
+        f_mount(NULL, "0", 0);
+        prepare_next_log_file();
+
+        /* Nothing is allocated ahead of the data */
+        CPPUNIT_ASSERT_EQUAL((DWORD) 0, file_size(LOG_NAME));
+        CPPUNIT_ASSERT_EQUAL(blank, free_clusters());
+
+        logging_start(&fs_ls);
+        CPPUNIT_ASSERT_EQUAL(string(LOG_NAME), string(fs_ls.name));
+        log_rows(10, 0);
+        logging_stop(&fs_ls);
+
+        const string log = read_log(LOG_NAME, SIZE_MAX);
+        CPPUNIT_ASSERT_EQUAL(11, check_rows(log));
+        CPPUNIT_ASSERT_EQUAL((DWORD) log.size(), file_size(LOG_NAME));
+}
+
+void LoggerFileWriterFsTest::testUnusedPreparedFileReused()
+{
+        FATFS fs;
+        CPPUNIT_ASSERT_EQUAL(FR_OK, reboot_mount(&fs));
+        const DWORD blank = free_clusters();
+        f_mount(NULL, "0", 0);
+
+        /* Prepare a file, then lose power before logging to it */
+        prepare_next_log_file();
+        diskio_host_power_cut(0);
+        prepare_next_log_file();
+        diskio_host_power_restore();
+
+        /* The empty leftover is taken over rather than skipped */
+        logging_start(&fs_ls);
+        log_rows(10, 0);
+        CPPUNIT_ASSERT_EQUAL(string(LOG_NAME), string(fs_ls.name));
+        logging_stop(&fs_ls);
+        CPPUNIT_ASSERT_EQUAL(11, check_rows(read_log(LOG_NAME, SIZE_MAX)));
+
+        /* Only the log and its index hold on to any clusters */
+        CPPUNIT_ASSERT_EQUAL(blank - 2, free_clusters());
+}
+
+void LoggerFileWriterFsTest::testPowerLossKeepsSyncedRows()
+{
+        FATFS fs;
+        CPPUNIT_ASSERT_EQUAL(FR_OK, reboot_mount(&fs));
+        const DWORD blank = free_clusters();
+        f_mount(NULL, "0", 0);
+
+        prepare_next_log_file();
+        logging_start(&fs_ls);
+        log_rows(50, 0);
+        flush_rows();
+        const unsigned int synced = fs_ls.synced_size;
+        CPPUNIT_ASSERT(synced > 0);
+
+        log_rows(50, 0);
+        diskio_host_power_cut(0);
+        diskio_host_power_restore();
+
+        /* The file holds everything up to the last sync, whole, and no more */
+        CPPUNIT_ASSERT_EQUAL(FR_OK, reboot_mount(&fs));
+        CPPUNIT_ASSERT_EQUAL((DWORD) synced, file_size(LOG_NAME));
+        CPPUNIT_ASSERT_EQUAL(51, check_rows(read_log(LOG_NAME, SIZE_MAX)));
+
+        /* No clusters are left claimed past what the files record */
+        const DWORD cluster = fs.csize * _MAX_SS;
+        const DWORD used = (synced + cluster - 1) / cluster +
+                (file_size(INDEX_NAME) + cluster - 1) / cluster;
+        CPPUNIT_ASSERT_EQUAL(blank - used, free_clusters());
+        f_mount(NULL, "0", 0);
+}
+
+void LoggerFileWriterFsTest::testIndexFollowsSamples()
+{
+        logging_start(&fs_ls);
+
+        /*
+         * A queue full of samples that the writer gets to all at once:
+         * the index goes by the tick and lap they were taken at.
+         */
+        LoggerMessage msg;
+        msg.type = LoggerMessageType_Sample;
+        msg.sample = &fs_sample;
+        for (int i = 0; i < 10; i++) {
+                msg.ticks = fs_sample.ticks = 1000 + i * msToTicks(250);
+                fs_sample.lap = i / 5;
+                CPPUNIT_ASSERT_EQUAL(0, logging_sample(&fs_ls, &msg));
+        }
+        logging_stop(&fs_ls);
+
+        const vector<struct log_index_entry> entries = read_index();
+        CPPUNIT_ASSERT_EQUAL((size_t) 5, entries.size());
+        CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_START, (int) entries[0].type);
+        CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_TIME, (int) entries[1].type);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 1000, entries[1].time);
+        CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_LAP, (int) entries[2].type);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 1250, entries[2].time);
+        CPPUNIT_ASSERT_EQUAL(1, (int) entries[2].lap);
+        CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_TIME, (int) entries[3].type);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 2000, entries[3].time);
+        CPPUNIT_ASSERT_EQUAL((int) LOG_INDEX_STOP, (int) entries[4].type);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 2250, entries[4].time);
+        CPPUNIT_ASSERT_EQUAL(1, (int) entries[4].lap);
+}
+
+void LoggerFileWriterFsTest::testResumeCutsIndex()
+{
+        logging_start(&fs_ls);
+        log_rows(20, 0);
+        flush_rows();
+        const unsigned int synced = fs_ls.synced_size;
+
+        /* A lap starts in rows that never get synced... */
+        log_rows(3, 0);
+        fs_sample.lap = 1;
+        log_rows(3, 0);
+        diskio_host_power_cut(0);
+        log_rows(1, -1);
+        diskio_host_power_restore();
+
+        /* ...and the index on the card has run ahead of the log */
+        FATFS fs;
+        FIL f;
+        CPPUNIT_ASSERT_EQUAL(FR_OK, reboot_mount(&fs));
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_open(&f, INDEX_NAME, FA_WRITE));
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_lseek(&f, f_size(&f)));
+        const struct log_index_entry stale = {
+                synced + 1000, 99999, 0, 0, LOG_INDEX_TIME,
+        };
+        UINT written;
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_write(&f, &stale, sizeof(stale),
+                                            &written));
+        CPPUNIT_ASSERT_EQUAL(FR_OK, f_close(&f));
+        f_mount(NULL, "0", 0);
+
+        log_rows(20, 0);
+        logging_stop(&fs_ls);
+
+        /* Only the lap as the resumed log has it is marked */
+        const string log = read_log(LOG_NAME, SIZE_MAX);
+        const vector<struct log_index_entry> entries = read_index();
+        int laps = 0;
+        for (size_t i = 0; i < entries.size(); i++) {
+                const struct log_index_entry &e = entries[i];
+                CPPUNIT_ASSERT(e.time != stale.time);
+                CPPUNIT_ASSERT(e.offset <= log.size());
+                CPPUNIT_ASSERT_EQUAL('\n', log[e.offset - 1]);
+                if (LOG_INDEX_LAP == e.type) {
+                        CPPUNIT_ASSERT_EQUAL(synced, e.offset);
+                        ++laps;
+                }
+        }
+        CPPUNIT_ASSERT_EQUAL(1, laps);
+}
+
+void LoggerFileWriterFsTest::testResumeAfterCardDropout()
+{
+        logging_start(&fs_ls);
+        log_rows(20, 0);
+        flush_rows();
+
+        /* Rows logged while the card is gone are lost... */
+        diskio_host_power_cut(0);
+        log_rows(5, -1);
+        CPPUNIT_ASSERT_EQUAL(SD_CARD_NOT_PRESENT, fs_ls.writing_status);
+
+        /* ...and logging picks up in the same file from the last sync */
+        diskio_host_power_restore();
+        log_rows(20, 0);
+        CPPUNIT_ASSERT_EQUAL(string(LOG_NAME), string(fs_ls.name));
+        logging_stop(&fs_ls);
+
+        const string log = read_log(LOG_NAME, SIZE_MAX);
+        CPPUNIT_ASSERT_EQUAL(41, check_rows(log));
+}
@@ -0,0 +1,58 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LOGGERFILEWRITER_FS_TEST_H_
+#define _LOGGERFILEWRITER_FS_TEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/**
+ * File writer tests against the real FatFs on a RAM disk, for what the
+ * stubbed file system can't show: what lands on the card and what
+ * survives losing it.
+ */
+class LoggerFileWriterFsTest : public CppUnit::TestFixture
+{
+        CPPUNIT_TEST_SUITE( LoggerFileWriterFsTest );
+        CPPUNIT_TEST( testLogRows );
+        CPPUNIT_TEST( testPreparedFileHoldsNoClusters );
+        CPPUNIT_TEST( testUnusedPreparedFileReused );
+        CPPUNIT_TEST( testPowerLossKeepsSyncedRows );
+        CPPUNIT_TEST( testIndexFollowsSamples );
+        CPPUNIT_TEST( testResumeCutsIndex );
+        CPPUNIT_TEST( testResumeAfterCardDropout );
+        CPPUNIT_TEST_SUITE_END();
+
+public:
+
+        void setUp();
+        void tearDown();
+
+        void testLogRows();
+        void testPreparedFileHoldsNoClusters();
+        void testUnusedPreparedFileReused();
+        void testPowerLossKeepsSyncedRows();
+        void testIndexFollowsSamples();
+        void testResumeCutsIndex();
+        void testResumeAfterCardDropout();
+};
+
+#endif /* _LOGGERFILEWRITER_FS_TEST_H_ */
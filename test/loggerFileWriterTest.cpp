@@ -94,6 +94,34 @@ void LoggerFileWriterTest::testLoggingSampleSkip()
         CPPUNIT_ASSERT_EQUAL(0, rc);
 }
 
+void LoggerFileWriterTest::testLogFileIndex()
+{
+        CPPUNIT_ASSERT_EQUAL(0, log_file_index("rc_0.log"));
+        CPPUNIT_ASSERT_EQUAL(42, log_file_index("RC_42.LOG"));
+        CPPUNIT_ASSERT_EQUAL(99999, log_file_index("rc_99999.log"));
+        CPPUNIT_ASSERT_EQUAL(-1, log_file_index("rc_100000.log"));
+        CPPUNIT_ASSERT_EQUAL(-1, log_file_index("rc_.log"));
+        CPPUNIT_ASSERT_EQUAL(-1, log_file_index("rc_12.txt"));
+        CPPUNIT_ASSERT_EQUAL(-1, log_file_index("foo.log"));
+}
+
+void LoggerFileWriterTest::testLogFilePath()
+{
+        char dir[9];
+        char path[FILENAME_LEN];
+
+        log_dir_name(dir, 0);
+        CPPUNIT_ASSERT_EQUAL(std::string(""), std::string(dir));
+        log_file_path(path, dir, 7);
+        CPPUNIT_ASSERT_EQUAL(std::string("rc_7.log"), std::string(path));
+
+        log_dir_name(dir, 1429743738020ULL);
+        CPPUNIT_ASSERT_EQUAL(std::string("20150422"), std::string(dir));
+        log_file_path(path, dir, 99999);
+        CPPUNIT_ASSERT_EQUAL(std::string("20150422/rc_99999.log"),
+                             std::string(path));
+}
+
 /*
  * TODO: Build in tests for file open and close methods.
  */
@@ -30,6 +30,8 @@ class LoggerFileWriterTest : public CppUnit::TestFixture
         CPPUNIT_TEST( testLoggingStart );
         CPPUNIT_TEST( testLoggingStop );
         CPPUNIT_TEST( testLoggingSampleSkip );
+        CPPUNIT_TEST( testLogFileIndex );
+        CPPUNIT_TEST( testLogFilePath );
         CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -41,6 +43,8 @@ public:
         void testLoggingStart();
         void testLoggingStop();
         void testLoggingSampleSkip();
+        void testLogFileIndex();
+        void testLogFilePath();
 };
 
 #endif /* _LOGGERFILEWRITER_TEST_H_ */
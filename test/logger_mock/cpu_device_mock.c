@@ -21,6 +21,7 @@
 
 
 #include "cpu_device.h"
+#include <time.h>
 
 int cpu_device_init(void)
 {
@@ -38,3 +39,18 @@ const char * cpu_device_get_serialnumber(void)
 }
 
 void cpu_device_spin(uint32_t ms) {}
+
+void cpu_device_cycle_counter_init(void) {}
+
+/* The host has no cycle counter, so count nanoseconds instead */
+uint32_t cpu_device_cycle_count(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+uint32_t cpu_device_cycle_hz(void)
+{
+        return 1000000000;
+}
@@ -61,3 +61,12 @@ size_t lua_task_get_callback_freq()
 {
         return 1;
 }
+
+void lua_task_set_budget(const size_t max_insns, const size_t max_ms) {}
+
+struct lua_budget lua_task_get_budget()
+{
+        return (struct lua_budget) {
+                0
+        };
+}
@@ -0,0 +1,93 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+extern "C" {
+#include "lauxlib.h"
+}
+#include "luaBudget.h"
+#include "luaBudget_test.h"
+#include "task.h"
+#include "taskUtil.h"
+#include "task_testing.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( LuaBudgetTest );
+
+#define TICK_MAX_INSNS	10000
+
+/* A top level chunk that runs far longer than one tick is allowed to */
+static const char slow_chunk[] =
+        "local n = 0\n"
+        "for i = 1, 100000 do n = n + i end\n"
+        "loaded = n\n";
+
+void LuaBudgetTest::setUp()
+{
+        set_ticks(0);
+        ls = luaL_newstate();
+        lua_budget_install(ls);
+        lua_budget_set(TICK_MAX_INSNS, 0);
+}
+
+void LuaBudgetTest::tearDown()
+{
+        lua_close(ls);
+        set_ticks(0);
+}
+
+void LuaBudgetTest::testTickBudget()
+{
+        const size_t overruns = lua_budget_get_overruns();
+
+        lua_budget_start(LUA_BUDGET_TICK);
+        CPPUNIT_ASSERT(0 != luaL_dostring(ls, slow_chunk));
+        CPPUNIT_ASSERT(strstr(lua_tostring(ls, -1),
+                              "Instruction budget exceeded"));
+        CPPUNIT_ASSERT_EQUAL(overruns + 1, lua_budget_get_overruns());
+}
+
+void LuaBudgetTest::testSlowLoad()
+{
+        const size_t overruns = lua_budget_get_overruns();
+
+        lua_budget_start(LUA_BUDGET_LOAD);
+        CPPUNIT_ASSERT_EQUAL(0, luaL_dostring(ls, slow_chunk));
+        CPPUNIT_ASSERT_EQUAL(overruns, lua_budget_get_overruns());
+
+        lua_getglobal(ls, "loaded");
+        CPPUNIT_ASSERT_EQUAL(5000050000.0, lua_tonumber(ls, -1));
+
+        /* The load window must not leak into the tick that follows */
+        const struct lua_budget lb = lua_budget_get();
+        CPPUNIT_ASSERT_EQUAL((size_t) TICK_MAX_INSNS, lb.max_insns);
+}
+
+void LuaBudgetTest::testLoadTimeLimit()
+{
+        lua_budget_start(LUA_BUDGET_LOAD);
+        set_ticks(msToTicks(LUA_BUDGET_LOAD_MAX_MS) + 1);
+
+        CPPUNIT_ASSERT(0 != luaL_dostring(ls, slow_chunk));
+        CPPUNIT_ASSERT(strstr(lua_tostring(ls, -1), "Time budget exceeded"));
+}
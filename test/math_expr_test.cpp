@@ -0,0 +1,189 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "math_expr.h"
+#include "math_expr_test.h"
+#include <string.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION( MathExprTest );
+
+static float rpm = 6000;
+static float speed = 100;
+
+static float get_test_channel(int id)
+{
+        return id ? speed : rpm;
+}
+
+static bool resolve_test_channel(const char *name, const size_t len,
+                                 ChannelSample *input, void *ctx)
+{
+        int id;
+
+        if (3 == len && !strncmp(name, "RPM", len))
+                id = 0;
+        else if (5 == len && !strncmp(name, "Speed", len))
+                id = 1;
+        else
+                return false;
+
+        input->sampleData = SampleData_Float;
+        input->channelIndex = id;
+        input->get_float_sample = get_test_channel;
+        return true;
+}
+
+static float eval(const char *expr)
+{
+        struct math_expr prog;
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_OK,
+                             math_expr_compile(&prog, expr,
+                                               resolve_test_channel, NULL));
+        return math_expr_eval(&prog);
+}
+
+static enum math_expr_status compile(const char *expr)
+{
+        struct math_expr prog;
+        return math_expr_compile(&prog, expr, resolve_test_channel, NULL);
+}
+
+void MathExprTest::testArithmetic()
+{
+        CPPUNIT_ASSERT_EQUAL(3.0f, eval("1 + 2"));
+        CPPUNIT_ASSERT_EQUAL(-1.0f, eval("1 - 2"));
+        CPPUNIT_ASSERT_EQUAL(6.0f, eval("2*3"));
+        CPPUNIT_ASSERT_EQUAL(2.5f, eval("5 / 2"));
+        CPPUNIT_ASSERT_EQUAL(1.0f, eval("7 % 3"));
+        CPPUNIT_ASSERT_EQUAL(-4.0f, eval("-4"));
+        CPPUNIT_ASSERT_EQUAL(0.25f, eval(".25"));
+}
+
+void MathExprTest::testPrecedence()
+{
+        CPPUNIT_ASSERT_EQUAL(7.0f, eval("1 + 2 * 3"));
+        CPPUNIT_ASSERT_EQUAL(9.0f, eval("(1 + 2) * 3"));
+        CPPUNIT_ASSERT_EQUAL(1.0f, eval("8 - 4 - 3"));
+        CPPUNIT_ASSERT_EQUAL(1.0f, eval("1 + 1 == 2"));
+        CPPUNIT_ASSERT_EQUAL(1.0f, eval("1 < 2 && 3 > 2 || 0"));
+        CPPUNIT_ASSERT_EQUAL(-6.0f, eval("-2 * 3"));
+}
+
+void MathExprTest::testFunctions()
+{
+        CPPUNIT_ASSERT_EQUAL(2.0f, eval("min(2, 3)"));
+        CPPUNIT_ASSERT_EQUAL(3.0f, eval("max(2, 3)"));
+        CPPUNIT_ASSERT_EQUAL(5.0f, eval("abs(-5)"));
+        CPPUNIT_ASSERT_EQUAL(3.0f, eval("sqrt(9)"));
+        CPPUNIT_ASSERT_EQUAL(0.0f, eval("sqrt(-9)"));
+        CPPUNIT_ASSERT_EQUAL(4.0f, eval("max(min(4, 10), abs(-1))"));
+}
+
+void MathExprTest::testConditionals()
+{
+        CPPUNIT_ASSERT_EQUAL(10.0f, eval("1 ? 10 : 20"));
+        CPPUNIT_ASSERT_EQUAL(20.0f, eval("0 ? 10 : 20"));
+        CPPUNIT_ASSERT_EQUAL(30.0f, eval("0 ? 10 : 0 ? 20 : 30"));
+        CPPUNIT_ASSERT_EQUAL(20.0f, eval("if(2 > 3, 10, 20)"));
+        CPPUNIT_ASSERT_EQUAL(1.0f, eval("!0"));
+        CPPUNIT_ASSERT_EQUAL(1.0f, eval("2 != 3"));
+}
+
+void MathExprTest::testChannelInputs()
+{
+        rpm = 6000;
+        speed = 100;
+
+        struct math_expr prog;
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_OK,
+                             math_expr_compile(&prog, "(RPM / Speed) * 0.5",
+                                               resolve_test_channel, NULL));
+        CPPUNIT_ASSERT_EQUAL(30.0f, math_expr_eval(&prog));
+
+        /* Inputs are read at evaluation time */
+        speed = 50;
+        CPPUNIT_ASSERT_EQUAL(60.0f, math_expr_eval(&prog));
+
+        /* Repeated references share a single input */
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_OK,
+                             math_expr_compile(&prog, "RPM + RPM + Speed",
+                                               resolve_test_channel, NULL));
+        CPPUNIT_ASSERT_EQUAL((uint8_t) 2, prog.input_count);
+        CPPUNIT_ASSERT_EQUAL(12050.0f, math_expr_eval(&prog));
+}
+
+void MathExprTest::testDivideByZero()
+{
+        CPPUNIT_ASSERT_EQUAL(0.0f, eval("1 / 0"));
+        CPPUNIT_ASSERT_EQUAL(0.0f, eval("1 % 0"));
+}
+
+void MathExprTest::testErrors()
+{
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_SYNTAX_ERROR, compile(""));
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_SYNTAX_ERROR, compile("(1 + 2"));
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_SYNTAX_ERROR, compile("1 +"));
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_SYNTAX_ERROR, compile("1 2"));
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_SYNTAX_ERROR, compile("1 ? 2"));
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_SYNTAX_ERROR, compile("min(1)"));
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_UNKNOWN_CHANNEL, compile("Foo * 2"));
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_UNKNOWN_FUNCTION, compile("foo(2)"));
+
+        /* A failed program evaluates to 0 */
+        struct math_expr prog;
+        math_expr_compile(&prog, "1 +", resolve_test_channel, NULL);
+        CPPUNIT_ASSERT_EQUAL(0.0f, math_expr_eval(&prog));
+}
+
+void MathExprTest::testTooComplex()
+{
+        /* Exceeds the evaluation stack */
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_TOO_COMPLEX,
+                             compile("1+(2+(3+(4+(5+(6+(7+(8+(9+1))))))))"));
+
+        /* Exceeds the constant table */
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_TOO_COMPLEX,
+                             compile("1+2+3+4+5+6+7"));
+
+        /* Repeated constants do not use more of the table */
+        CPPUNIT_ASSERT_EQUAL(4.0f, eval("1+1+1+1"));
+}
+
+void MathExprTest::testNesting()
+{
+        /* Nesting alone uses no code or stack, only parser recursion */
+        CPPUNIT_ASSERT_EQUAL(1.0f, eval("((((((1))))))"));
+        CPPUNIT_ASSERT_EQUAL(1.0f, eval("-(-(-(-1)))"));
+
+        char expr[1024];
+        const size_t levels = (sizeof(expr) - 2) / 2;
+
+        memset(expr, '(', levels);
+        expr[levels] = '1';
+        memset(expr + levels + 1, ')', levels);
+        expr[2 * levels + 1] = 0;
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_TOO_COMPLEX, compile(expr));
+
+        memset(expr, '!', sizeof(expr) - 2);
+        expr[sizeof(expr) - 2] = '1';
+        expr[sizeof(expr) - 1] = 0;
+        CPPUNIT_ASSERT_EQUAL(MATH_EXPR_TOO_COMPLEX, compile(expr));
+}
@@ -0,0 +1,53 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MATH_EXPR_TEST_H_
+#define _MATH_EXPR_TEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class MathExprTest : public CppUnit::TestFixture
+{
+        CPPUNIT_TEST_SUITE( MathExprTest );
+        CPPUNIT_TEST( testArithmetic );
+        CPPUNIT_TEST( testPrecedence );
+        CPPUNIT_TEST( testFunctions );
+        CPPUNIT_TEST( testConditionals );
+        CPPUNIT_TEST( testChannelInputs );
+        CPPUNIT_TEST( testDivideByZero );
+        CPPUNIT_TEST( testErrors );
+        CPPUNIT_TEST( testTooComplex );
+        CPPUNIT_TEST( testNesting );
+        CPPUNIT_TEST_SUITE_END();
+
+public:
+        void testArithmetic();
+        void testPrecedence();
+        void testFunctions();
+        void testConditionals();
+        void testChannelInputs();
+        void testDivideByZero();
+        void testErrors();
+        void testTooComplex();
+        void testNesting();
+};
+
+#endif /* _MATH_EXPR_TEST_H_ */
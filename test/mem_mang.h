@@ -30,6 +30,23 @@ CPP_GUARD_BEGIN
 
 #define portMalloc malloc
 #define portFree free
+#define portGetHeapStats vPortGetHeapStats
+
+/* As in the heap.h of the hardware platforms */
+typedef struct xHEAP_STATS {
+        size_t xTotalHeapSize;
+        size_t xAvailableHeapSpaceInBytes;
+        size_t xSizeOfLargestFreeBlockInBytes;
+        size_t xSizeOfSmallestFreeBlockInBytes;
+        size_t xNumberOfFreeBlocks;
+        size_t xMinimumEverFreeBytesRemaining;
+        size_t xNumberOfSuccessfulAllocations;
+        size_t xNumberOfSuccessfulFrees;
+        size_t xNumberOfFailedAllocations;
+} xHeapStats;
+
+/* The host heap has no such statistics; this reports all zeros */
+void vPortGetHeapStats(xHeapStats *pxHeapStats);
 
 CPP_GUARD_END
 
@@ -0,0 +1,119 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "perf_region.h"
+#include "perf_region_test.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( PerfRegionTest );
+
+static bool find(const char *name, struct perf_region *region)
+{
+        for (size_t i = 0; perf_region_get(i, region); ++i)
+                if (0 == strcmp(name, region->name))
+                        return true;
+
+        return false;
+}
+
+static void timed(void)
+{
+        PERF_REGION_BEGIN("test_timed");
+        for (volatile int i = 0; i < 1000; ++i);
+        PERF_REGION_END("test_timed");
+}
+
+static void timed_elsewhere(void)
+{
+        PERF_REGION_BEGIN("test_timed");
+        PERF_REGION_END("test_timed");
+}
+
+void PerfRegionTest::setUp()
+{
+        perf_region_reset();
+}
+
+void PerfRegionTest::tearDown() {}
+
+void PerfRegionTest::testRecord()
+{
+        struct perf_region *slot = NULL;
+        perf_region_begin(&slot, "test_record");
+        CPPUNIT_ASSERT(slot != NULL);
+
+        perf_region_record(slot, 1);
+        perf_region_record(slot, 3);
+        perf_region_record(slot, 1000);
+
+        struct perf_region r;
+        CPPUNIT_ASSERT(find("test_record", &r));
+        CPPUNIT_ASSERT_EQUAL(3, (int) r.count);
+        CPPUNIT_ASSERT_EQUAL(1, (int) r.min);
+        CPPUNIT_ASSERT_EQUAL(1000, (int) r.max);
+        CPPUNIT_ASSERT_EQUAL(1004, (int) r.total);
+        CPPUNIT_ASSERT_EQUAL(1, (int) r.hist[1]);
+        CPPUNIT_ASSERT_EQUAL(1, (int) r.hist[2]);
+        CPPUNIT_ASSERT_EQUAL(1, (int) r.hist[10]);
+
+        /* Anything too long for the histogram lands in the last bucket */
+        perf_region_record(slot, UINT32_MAX);
+        CPPUNIT_ASSERT(find("test_record", &r));
+        CPPUNIT_ASSERT_EQUAL(1, (int) r.hist[PERF_REGION_BUCKETS - 1]);
+}
+
+void PerfRegionTest::testMacros()
+{
+        timed();
+        timed();
+
+        struct perf_region r;
+        CPPUNIT_ASSERT(find("test_timed", &r));
+        CPPUNIT_ASSERT_EQUAL(2, (int) r.count);
+        CPPUNIT_ASSERT(r.max > 0);
+        CPPUNIT_ASSERT(r.min <= r.max);
+        CPPUNIT_ASSERT(perf_region_hz() > 0);
+}
+
+void PerfRegionTest::testSharedName()
+{
+        timed();
+        timed_elsewhere();
+
+        struct perf_region r;
+        CPPUNIT_ASSERT(find("test_timed", &r));
+        CPPUNIT_ASSERT_EQUAL(2, (int) r.count);
+}
+
+void PerfRegionTest::testReset()
+{
+        timed();
+        perf_region_reset();
+
+        struct perf_region r;
+        CPPUNIT_ASSERT(find("test_timed", &r));
+        CPPUNIT_ASSERT_EQUAL(0, (int) r.count);
+        CPPUNIT_ASSERT_EQUAL(0, (int) r.min);
+        CPPUNIT_ASSERT_EQUAL(0, (int) r.max);
+}
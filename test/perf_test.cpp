@@ -0,0 +1,66 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeRTOS.h"
+#include "perf.h"
+#include "perf_test.h"
+#include "task.h"
+#include "task_testing.h"
+
+#include <string>
+
+using std::string;
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( PerfTest );
+
+void PerfTest::setUp()
+{
+        reset_tasks();
+}
+
+void PerfTest::tearDown()
+{
+        reset_tasks();
+}
+
+void PerfTest::testEveryTaskHasStack()
+{
+        static const signed char name[] = "Perf Test      ";
+        perf_register_task(name, 200);
+        CPPUNIT_ASSERT_EQUAL((long) pdPASS,
+                             (long) xTaskCreate(NULL, name, 200, NULL, 1, NULL));
+
+        struct perf_task tasks[PERF_MAX_TASKS];
+        size_t count;
+        perf_get_tasks(tasks, PERF_MAX_TASKS, &count);
+
+        /* The kernel's idle and timer tasks never register, but count too */
+        CPPUNIT_ASSERT_EQUAL((size_t) 3, count);
+        CPPUNIT_ASSERT_EQUAL(string("IDLE Task"), string(tasks[0].name));
+        CPPUNIT_ASSERT_EQUAL(string("Timer Service"), string(tasks[1].name));
+        CPPUNIT_ASSERT_EQUAL(string("Perf Test"), string(tasks[2].name));
+
+        for (size_t i = 0; i < count; i++) {
+                CPPUNIT_ASSERT(tasks[i].stack_size > 0);
+                CPPUNIT_ASSERT(tasks[i].stack_free <= tasks[i].stack_size);
+        }
+}
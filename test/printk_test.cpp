@@ -0,0 +1,138 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mock_serial.h"
+#include "printk.h"
+#include "printk_deferred.h"
+#include "printk_test.h"
+#include "task_testing.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( PrintkTest );
+
+static std::string read_log(void)
+{
+        mock_resetTxBuffer();
+        read_log_to_serial(getMockSerial(), 0);
+        return std::string(mock_getTxBuffer());
+}
+
+void PrintkTest::setUp()
+{
+        setupMockSerial();
+        set_log_level(INFO);
+        set_current_task((xTaskHandle) 1);
+        reset_ticks();
+        read_log();
+}
+
+void PrintkTest::tearDown()
+{
+        printk_deferred_enable(false);
+        set_current_task(NULL);
+        reset_ticks();
+        read_log();
+}
+
+void PrintkTest::testImmediate()
+{
+        CPPUNIT_ASSERT(!printk_deferred_enabled());
+        pr_info_int_msg("int ", 5);
+        pr_debug("hidden\r\n");
+        CPPUNIT_ASSERT_EQUAL(std::string("int 5\r\n"), read_log());
+}
+
+void PrintkTest::testDeferred()
+{
+        CPPUNIT_ASSERT(printk_deferred_enable(true));
+        pr_info_int_msg("int ", -7);
+        pr_info_float_msg("float ", 1.5);
+        pr_info_bool_msg("bool ", true);
+        pr_info_char('c');
+        pr_info_int(42);
+        printk_crlf(INFO);
+        pr_info("done\r\n");
+        pr_debug("hidden\r\n");
+
+        const std::string expected = "int -7\r\nfloat 1.5\r\n"
+                "bool true\r\nc42\r\ndone\r\n";
+        CPPUNIT_ASSERT_EQUAL(expected, read_log());
+        CPPUNIT_ASSERT_EQUAL(std::string(""), read_log());
+}
+
+void PrintkTest::testRuntimeMessage()
+{
+        /* Not a literal, so it must be formatted before it changes */
+        char msg[] = "runtime ";
+
+        printk_deferred_enable(true);
+        pr_info_int_msg(msg, 1);
+        msg[0] = 'X';
+        CPPUNIT_ASSERT_EQUAL(std::string("runtime 1\r\n"), read_log());
+}
+
+void PrintkTest::testRuntimeOrder()
+{
+        /* A runtime string between literals must not jump the queue */
+        char err[] = "bad syntax";
+
+        printk_deferred_enable(true);
+        pr_error("error: (");
+        pr_error(err);
+        pr_error(")\r\n");
+        pr_info_str_msg("str ", err);
+        pr_info_int(1);
+        printk_crlf(INFO);
+
+        CPPUNIT_ASSERT_EQUAL(std::string("error: (bad syntax)\r\n"
+                                         "str bad syntax\r\n1\r\n"),
+                             read_log());
+}
+
+void PrintkTest::testOrder()
+{
+        printk_deferred_enable(true);
+
+        set_ticks(5);
+        pr_info("first task\r\n");
+
+        set_current_task((xTaskHandle) 2);
+        set_ticks(3);
+        pr_info("second task\r\n");
+
+        CPPUNIT_ASSERT_EQUAL(std::string("second task\r\nfirst task\r\n"),
+                             read_log());
+}
+
+void PrintkTest::testDropped()
+{
+        printk_deferred_enable(true);
+        for (int i = 0; i < PRINTK_DEFERRED_RING_SIZE + 8; ++i)
+                pr_info_char('x');
+
+        const std::string expected =
+                std::string(PRINTK_DEFERRED_RING_SIZE, 'x') +
+                "[printk] dropped 8 records\r\n";
+        CPPUNIT_ASSERT_EQUAL(expected, read_log());
+}
@@ -25,6 +25,7 @@
 #include "ADC_mock.h"
 #include "FreeRTOS.h"
 #include "GPIO.h"
+#include "block_pool.h"
 #include "capabilities.h"
 #include "gps.h"
 #include "imu.h"
@@ -35,6 +36,7 @@
 #include "mock_serial.h"
 #include "predictive_timer_2.h"
 #include "sampleRecord.h"
+#include "sector_stats.h"
 #include "task.h"
 #include "task_testing.h"
 
@@ -185,7 +187,7 @@ void SampleRecordTest::testInitSampleRecord()
 {
         LoggerConfig *lc = getWorkingLoggerConfig();
 
-        const size_t expectedEnabledChannels = 26;
+        const size_t expectedEnabledChannels = 28;
         size_t channelCount = get_enabled_channel_count(lc);
         CPPUNIT_ASSERT_EQUAL(expectedEnabledChannels, channelCount);
 
@@ -425,6 +427,24 @@ void SampleRecordTest::testInitSampleRecord()
                 ts++;
         }
 
+        if (lapConfig->sector_delta_cfg.sampleRate != SAMPLE_DISABLED) {
+                CPPUNIT_ASSERT_EQUAL((void *) &lapConfig->sector_delta_cfg,
+                                     (void *) ts->cfg);
+                CPPUNIT_ASSERT_EQUAL(SampleData_Float_Noarg, ts->sampleData);
+                CPPUNIT_ASSERT_EQUAL((void *) sector_stats_last_delta_seconds,
+                                     (void *) ts->get_float_sample);
+                ts++;
+        }
+
+        if (lapConfig->optimal_time_cfg.sampleRate != SAMPLE_DISABLED) {
+                CPPUNIT_ASSERT_EQUAL((void *) &lapConfig->optimal_time_cfg,
+                                     (void *) ts->cfg);
+                CPPUNIT_ASSERT_EQUAL(SampleData_Float_Noarg, ts->sampleData);
+                CPPUNIT_ASSERT_EQUAL((void *) sector_stats_optimal_lap_minutes,
+                                     (void *) ts->get_float_sample);
+                ts++;
+        }
+
         //amount shoud match
         const size_t size = ts - s.channel_samples;
         CPPUNIT_ASSERT_EQUAL(expectedEnabledChannels, size);
@@ -503,3 +523,42 @@ void SampleRecordTest::test_get_sample_value_by_name()
         result = get_sample_value_by_name(&s, "FooBar", &value, &units);
         CPPUNIT_ASSERT_EQUAL(false, result);
 }
+
+static size_t sample_pool_used()
+{
+        struct block_pool_stats stats[BLOCK_POOL_MAX_POOLS];
+        const size_t count = block_pool_get_stats(stats, BLOCK_POOL_MAX_POOLS);
+        for (size_t i = 0; i < count; ++i) {
+                if (string("samples") == stats[i].name)
+                        return stats[i].used;
+        }
+
+        return 0;
+}
+
+void SampleRecordTest::testSamplePool()
+{
+        const size_t count = get_enabled_channel_count(lc);
+
+        free_sample_buffer(&s);
+        CPPUNIT_ASSERT(format_sample_pool(count));
+
+        struct sample pooled = {0};
+        CPPUNIT_ASSERT(init_sample_buffer(&pooled, count));
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, sample_pool_used());
+
+        /* Can't re-carve while a buffer is out */
+        CPPUNIT_ASSERT(!format_sample_pool(count * 2));
+
+        /* Too big for the carved blocks, so it comes from the heap */
+        struct sample big = {0};
+        CPPUNIT_ASSERT(init_sample_buffer(&big, count * 2));
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, sample_pool_used());
+
+        free_sample_buffer(&big);
+        free_sample_buffer(&pooled);
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, sample_pool_used());
+        CPPUNIT_ASSERT(format_sample_pool(count * 2));
+
+        init_sample_buffer(&s, count);
+}
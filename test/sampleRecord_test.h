@@ -32,6 +32,7 @@ class SampleRecordTest : public CppUnit::TestFixture
         CPPUNIT_TEST( testIsValidLoggerMessage );
         CPPUNIT_TEST( testLoggerMessageAlwaysHasTime );
         CPPUNIT_TEST( test_get_sample_value_by_name );
+        CPPUNIT_TEST( testSamplePool );
         CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -43,6 +44,7 @@ public:
         void testIsValidLoggerMessage();
         void testLoggerMessageAlwaysHasTime();
         void test_get_sample_value_by_name();
+        void testSamplePool();
 
 private:
 
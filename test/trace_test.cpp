@@ -0,0 +1,210 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace.h"
+#include "trace_test.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( TraceTest );
+
+struct parsed_dump {
+        struct trace_header header;
+        std::vector<std::string> events;
+        std::vector<struct trace_record> records;
+};
+
+static bool append(void *arg, const void *data, const size_t len)
+{
+        ((std::string *) arg)->append((const char *) data, len);
+        return true;
+}
+
+static bool refuse(void *arg, const void *data, const size_t len)
+{
+        return false;
+}
+
+static std::string dump(void)
+{
+        std::string out;
+        CPPUNIT_ASSERT(trace_dump(append, &out));
+        return out;
+}
+
+static struct parsed_dump parse(const std::string &raw)
+{
+        struct parsed_dump pd;
+        CPPUNIT_ASSERT(raw.size() >= sizeof(pd.header));
+        memcpy(&pd.header, raw.data(), sizeof(pd.header));
+
+        size_t pos = sizeof(pd.header);
+        pd.events.resize(TRACE_EVENT_COUNT);
+        for (size_t i = 0; i < pd.header.names; ++i) {
+                struct trace_name tn;
+                memcpy(&tn, raw.data() + pos, sizeof(tn));
+                pos += sizeof(tn);
+
+                const std::string name = raw.substr(pos, tn.len);
+                pos += tn.len;
+                if (TRACE_NAME_EVENT == tn.kind)
+                        pd.events[tn.id] = name;
+        }
+
+        for (size_t i = 0; i < pd.header.events; ++i) {
+                struct trace_record r;
+                memcpy(&r, raw.data() + pos, sizeof(r));
+                pos += sizeof(r);
+                pd.records.push_back(r);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(raw.size(), pos);
+        return pd;
+}
+
+void TraceTest::setUp()
+{
+        CPPUNIT_ASSERT(trace_start(TRACE_MODE_RING));
+}
+
+void TraceTest::tearDown()
+{
+        trace_stop();
+}
+
+void TraceTest::testRecord()
+{
+        CPPUNIT_ASSERT(trace_is_running());
+
+        TRACE_BEGIN(TRACE_EVENT_LOGGER_TICK, 1);
+        trace_task_in(3);
+        TRACE_END(TRACE_EVENT_LOGGER_TICK, 1);
+
+        uint32_t lost;
+        CPPUNIT_ASSERT_EQUAL((size_t) 3, trace_count(&lost));
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0, lost);
+
+        const struct parsed_dump pd = parse(dump());
+        CPPUNIT_ASSERT_EQUAL((size_t) 3, pd.records.size());
+        CPPUNIT_ASSERT_EQUAL((int) TRACE_TYPE_BEGIN, (int) pd.records[0].type);
+        CPPUNIT_ASSERT_EQUAL((int) TRACE_EVENT_LOGGER_TICK,
+                             (int) pd.records[0].id);
+        CPPUNIT_ASSERT_EQUAL((int) TRACE_TYPE_TASK_IN, (int) pd.records[1].type);
+        CPPUNIT_ASSERT_EQUAL(3, (int) pd.records[1].arg);
+        CPPUNIT_ASSERT_EQUAL((int) TRACE_TYPE_END, (int) pd.records[2].type);
+
+        /* The cycle counter never runs backwards within one task */
+        CPPUNIT_ASSERT(pd.records[2].cycles - pd.records[0].cycles < 1000000);
+}
+
+void TraceTest::testStopped()
+{
+        trace_stop();
+        CPPUNIT_ASSERT(!trace_is_running());
+
+        TRACE_MARK(TRACE_EVENT_SAMPLE_QUEUED, 1);
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, trace_count(NULL));
+
+        /* Starting again clears what was there */
+        trace_start(TRACE_MODE_RING);
+        TRACE_MARK(TRACE_EVENT_SAMPLE_QUEUED, 1);
+        trace_start(TRACE_MODE_RING);
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, trace_count(NULL));
+}
+
+void TraceTest::testRingWrap()
+{
+        const size_t extra = 10;
+        for (size_t i = 0; i < TRACE_BUFFER_EVENTS + extra; ++i)
+                TRACE_MARK(TRACE_EVENT_SAMPLE_QUEUED, i);
+
+        uint32_t lost;
+        CPPUNIT_ASSERT_EQUAL((size_t) TRACE_BUFFER_EVENTS, trace_count(&lost));
+        CPPUNIT_ASSERT_EQUAL((uint32_t) extra, lost);
+
+        /* The oldest events are the ones that went */
+        const struct parsed_dump pd = parse(dump());
+        CPPUNIT_ASSERT_EQUAL((uint32_t) extra, pd.header.lost);
+        CPPUNIT_ASSERT_EQUAL((int) extra, (int) pd.records.front().arg);
+        CPPUNIT_ASSERT_EQUAL((int) (TRACE_BUFFER_EVENTS + extra - 1),
+                             (int) pd.records.back().arg);
+}
+
+void TraceTest::testOnce()
+{
+        trace_start(TRACE_MODE_ONCE);
+
+        const size_t extra = 5;
+        for (size_t i = 0; i < TRACE_BUFFER_EVENTS + extra; ++i)
+                TRACE_MARK(TRACE_EVENT_SAMPLE_QUEUED, i);
+
+        uint32_t lost;
+        CPPUNIT_ASSERT_EQUAL((size_t) TRACE_BUFFER_EVENTS, trace_count(&lost));
+        CPPUNIT_ASSERT_EQUAL((uint32_t) extra, lost);
+
+        /* The first events are kept */
+        const struct parsed_dump pd = parse(dump());
+        CPPUNIT_ASSERT_EQUAL(0, (int) pd.records.front().arg);
+        CPPUNIT_ASSERT_EQUAL((int) TRACE_BUFFER_EVENTS - 1,
+                             (int) pd.records.back().arg);
+}
+
+void TraceTest::testDump()
+{
+        TRACE_ISR_ENTER(TRACE_ISR_CAN, 1);
+        trace_queue_send(2, 7);
+        TRACE_ISR_EXIT(TRACE_ISR_CAN, 1);
+
+        const std::string raw = dump();
+        CPPUNIT_ASSERT(!trace_is_running());
+
+        const struct parsed_dump pd = parse(raw);
+        CPPUNIT_ASSERT(0 == memcmp(TRACE_MAGIC, pd.header.magic, 4));
+        CPPUNIT_ASSERT_EQUAL(TRACE_VERSION, (int) pd.header.version);
+        CPPUNIT_ASSERT_EQUAL((int) sizeof(struct trace_record),
+                             (int) pd.header.record_size);
+        CPPUNIT_ASSERT_EQUAL(raw.size(), (size_t) pd.header.size);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 1000000000, pd.header.hz);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 3, pd.header.events);
+        CPPUNIT_ASSERT_EQUAL(std::string("logger tick"),
+                             pd.events[TRACE_EVENT_LOGGER_TICK]);
+        CPPUNIT_ASSERT_EQUAL(std::string("file flush"),
+                             pd.events[TRACE_EVENT_FILE_FLUSH]);
+
+        CPPUNIT_ASSERT_EQUAL((int) TRACE_TYPE_ISR_ENTER,
+                             (int) pd.records[0].type);
+        CPPUNIT_ASSERT_EQUAL((int) TRACE_ISR_CAN, (int) pd.records[0].id);
+        CPPUNIT_ASSERT_EQUAL(1, (int) pd.records[0].arg);
+        CPPUNIT_ASSERT_EQUAL((int) TRACE_TYPE_QUEUE_SEND,
+                             (int) pd.records[1].type);
+        CPPUNIT_ASSERT_EQUAL(2, (int) pd.records[1].id);
+        CPPUNIT_ASSERT_EQUAL(7, (int) pd.records[1].arg);
+}
+
+void TraceTest::testDumpAbort()
+{
+        TRACE_MARK(TRACE_EVENT_SAMPLE_QUEUED, 1);
+        CPPUNIT_ASSERT(!trace_dump(refuse, NULL));
+}
@@ -0,0 +1,163 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "block_pool_test.h"
+#include "block_pool.h"
+#include "macros.h"
+
+#include <string.h>
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( BlockPoolTest );
+
+struct item {
+        int a;
+        double b;
+};
+
+/* Each test has its own pool; pools can't be torn down */
+BLOCK_POOL_DEFINE(alloc_pool, "alloc", struct item, 3);
+BLOCK_POOL_DEFINE(big_pool, "big", struct item, 1);
+BLOCK_POOL_DEFINE_ARENA(arena, "arena", 1000);
+BLOCK_POOL_DEFINE(fallback_pool, "fallback", struct item, 1);
+BLOCK_POOL_DEFINE(stats_pool, "stats", struct item, 2);
+
+void BlockPoolTest::setUp() {}
+
+void BlockPoolTest::tearDown() {}
+
+void BlockPoolTest::test_alloc_free(void)
+{
+        void *blocks[3];
+        for (size_t i = 0; i < ARRAY_LEN(blocks); ++i) {
+                blocks[i] = block_pool_alloc(&alloc_pool, sizeof(struct item));
+                CPPUNIT_ASSERT(blocks[i]);
+                CPPUNIT_ASSERT(block_pool_owns(&alloc_pool, blocks[i]));
+                memset(blocks[i], 0xff, sizeof(struct item));
+        }
+
+        CPPUNIT_ASSERT(blocks[0] != blocks[1]);
+        CPPUNIT_ASSERT(blocks[1] != blocks[2]);
+        CPPUNIT_ASSERT(blocks[0] != blocks[2]);
+        CPPUNIT_ASSERT(!block_pool_alloc(&alloc_pool, sizeof(struct item)));
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 1, alloc_pool.failures);
+
+        block_pool_free(&alloc_pool, blocks[1]);
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, alloc_pool.used);
+        CPPUNIT_ASSERT_EQUAL((size_t) 3, alloc_pool.peak);
+        CPPUNIT_ASSERT_EQUAL(blocks[1],
+                             block_pool_alloc(&alloc_pool, sizeof(struct item)));
+
+        for (size_t i = 0; i < ARRAY_LEN(blocks); ++i)
+                block_pool_free(&alloc_pool, blocks[i]);
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, alloc_pool.used);
+}
+
+void BlockPoolTest::test_too_big(void)
+{
+        const size_t size = BLOCK_POOL_BLOCK_SIZE(sizeof(struct item));
+        CPPUNIT_ASSERT(!block_pool_alloc(&big_pool, size + 1));
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 1, big_pool.failures);
+
+        void *block = block_pool_alloc(&big_pool, size);
+        CPPUNIT_ASSERT(block);
+        block_pool_free(&big_pool, block);
+}
+
+void BlockPoolTest::test_format(void)
+{
+        /* An arena has no blocks until it is formatted */
+        CPPUNIT_ASSERT(!block_pool_alloc(&arena, 1));
+
+        CPPUNIT_ASSERT(block_pool_format(&arena, 100));
+        CPPUNIT_ASSERT_EQUAL((size_t) 104, arena.block_size);
+        CPPUNIT_ASSERT_EQUAL((size_t) 9, arena.capacity);
+
+        void *block = block_pool_alloc(&arena, 100);
+        CPPUNIT_ASSERT(block);
+        CPPUNIT_ASSERT(!block_pool_format(&arena, 200));
+        CPPUNIT_ASSERT_EQUAL((size_t) 104, arena.block_size);
+
+        block_pool_free(&arena, block);
+        CPPUNIT_ASSERT(block_pool_format(&arena, 200));
+        CPPUNIT_ASSERT_EQUAL((size_t) 200, arena.block_size);
+        CPPUNIT_ASSERT_EQUAL((size_t) 5, arena.capacity);
+
+        /* Every block is handed out exactly once */
+        void *blocks[5];
+        for (size_t i = 0; i < ARRAY_LEN(blocks); ++i) {
+                blocks[i] = block_pool_alloc(&arena, 200);
+                CPPUNIT_ASSERT(blocks[i]);
+                memset(blocks[i], i, 200);
+        }
+        CPPUNIT_ASSERT(!block_pool_alloc(&arena, 200));
+
+        for (size_t i = 0; i < ARRAY_LEN(blocks); ++i) {
+                CPPUNIT_ASSERT_EQUAL((uint8_t) i, *(uint8_t *) blocks[i]);
+                CPPUNIT_ASSERT_EQUAL((uint8_t) i,
+                                     *((uint8_t *) blocks[i] + 199));
+                block_pool_free(&arena, blocks[i]);
+        }
+}
+
+void BlockPoolTest::test_fallback(void)
+{
+        void *pooled = block_pool_alloc_fallback(&fallback_pool,
+                                                 sizeof(struct item));
+        void *heap = block_pool_alloc_fallback(&fallback_pool,
+                                               sizeof(struct item));
+        void *large = block_pool_alloc_fallback(&fallback_pool, 1024);
+
+        CPPUNIT_ASSERT(block_pool_owns(&fallback_pool, pooled));
+        CPPUNIT_ASSERT(heap && !block_pool_owns(&fallback_pool, heap));
+        CPPUNIT_ASSERT(large && !block_pool_owns(&fallback_pool, large));
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 2, fallback_pool.failures);
+
+        block_pool_free_fallback(&fallback_pool, large);
+        block_pool_free_fallback(&fallback_pool, heap);
+        block_pool_free_fallback(&fallback_pool, pooled);
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, fallback_pool.used);
+}
+
+void BlockPoolTest::test_stats(void)
+{
+        void *block = block_pool_alloc(&stats_pool, sizeof(struct item));
+
+        struct block_pool_stats stats[BLOCK_POOL_MAX_POOLS];
+        const size_t count = block_pool_get_stats(stats, ARRAY_LEN(stats));
+
+        const struct block_pool_stats *found = NULL;
+        for (size_t i = 0; i < count; ++i) {
+                if (STR_EQ("stats", stats[i].name))
+                        found = stats + i;
+        }
+
+        CPPUNIT_ASSERT(found);
+        CPPUNIT_ASSERT_EQUAL(BLOCK_POOL_BLOCK_SIZE(sizeof(struct item)),
+                             found->block_size);
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, found->capacity);
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, found->used);
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, found->peak);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0, found->failures);
+
+        block_pool_free(&stats_pool, block);
+}
@@ -0,0 +1,47 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLOCKPOOLTEST_H
+#define BLOCKPOOLTEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class BlockPoolTest : public CppUnit::TestFixture
+{
+        CPPUNIT_TEST_SUITE( BlockPoolTest );
+        CPPUNIT_TEST( test_alloc_free );
+        CPPUNIT_TEST( test_too_big );
+        CPPUNIT_TEST( test_format );
+        CPPUNIT_TEST( test_fallback );
+        CPPUNIT_TEST( test_stats );
+        CPPUNIT_TEST_SUITE_END();
+
+public:
+        void setUp();
+        void tearDown();
+        void test_alloc_free(void);
+        void test_too_big(void);
+        void test_format(void);
+        void test_fallback(void);
+        void test_stats(void);
+};
+
+#endif  // BLOCKPOOLTEST_H
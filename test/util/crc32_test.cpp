@@ -0,0 +1,54 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "crc32_test.h"
+#include "crc32.h"
+
+#include <string.h>
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( Crc32Test );
+
+void Crc32Test::setUp() {}
+
+void Crc32Test::tearDown() {}
+
+void Crc32Test::test_check_value(void)
+{
+        const char *s = "123456789";
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0xcbf43926, crc32_update(0, s, strlen(s)));
+}
+
+void Crc32Test::test_empty(void)
+{
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0, crc32_update(0, "", 0));
+}
+
+void Crc32Test::test_incremental(void)
+{
+        const char *s = "The quick brown fox jumps over the lazy dog";
+        const size_t len = strlen(s);
+
+        uint32_t crc = crc32_update(0, s, 10);
+        crc = crc32_update(crc, s + 10, len - 10);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0x414fa339, crc);
+}
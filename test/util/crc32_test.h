@@ -0,0 +1,43 @@
+/*
+ * Race Capture Firmware
+ *
+ * Copyright (C) 2016 Autosport Labs
+ *
+ * This file is part of the Race Capture firmware suite
+ *
+ * This is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details. You should
+ * have received a copy of the GNU General Public License along with
+ * this code. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRC32TEST_H
+#define CRC32TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class Crc32Test : public CppUnit::TestFixture
+{
+        CPPUNIT_TEST_SUITE( Crc32Test );
+        CPPUNIT_TEST( test_check_value );
+        CPPUNIT_TEST( test_empty );
+        CPPUNIT_TEST( test_incremental );
+        CPPUNIT_TEST_SUITE_END();
+
+public:
+        void setUp();
+        void tearDown();
+        void test_check_value(void);
+        void test_empty(void);
+        void test_incremental(void);
+};
+
+#endif  // CRC32TEST_H